@@ -43,6 +43,8 @@
 #include <pcl/io/pcd_io.h>
 #include <pcl/features/vfh.h>
 #include <pcl/features/normal_3d.h>
+#include <pcl/features/normal_3d_omp.h>
+#include <boost/thread/thread.hpp>
 #include <pcl/apps/nn_classification.h>
 #include <sensor_msgs/PointCloud2.h>
 
@@ -86,6 +88,45 @@ namespace pcl
     return vfhs;
   }
 
+  /** \brief Helper function to extract the VFH features describing several clusters of the given point cloud. The
+    * normals and the search tree are computed once for the whole cloud and shared by all clusters, which are
+    * described in parallel.
+    * \param cloud point cloud containing the clusters
+    * \param clusters the point indices of each cluster in the cloud
+    * \param radius search radius for normal estimation
+    * \param nr_threads the number of threads to use (0 for as many as there are hardware threads)
+    * \return point cloud containing one extracted feature for each cluster
+    */
+  template <typename PointT> pcl::PointCloud<pcl::VFHSignature308>::Ptr
+  computeVFH (typename PointCloud<PointT>::ConstPtr cloud, const std::vector<pcl::PointIndices> &clusters,
+              double radius, unsigned int nr_threads = 0)
+  {
+    using namespace pcl;
+
+    if (nr_threads == 0)
+      nr_threads = boost::thread::hardware_concurrency ();
+
+    typename pcl::search::KdTree<PointT>::Ptr tree (new pcl::search::KdTree<PointT> ());
+
+    // Estimate the normals of all the clusters at once
+    NormalEstimationOMP<PointT, Normal> ne (nr_threads);
+    ne.setInputCloud (cloud);
+    ne.setSearchMethod (tree);
+    ne.setRadiusSearch (radius);
+    PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+    ne.compute (*normals);
+
+    VFHEstimation<PointT, Normal, VFHSignature308> vfh;
+    vfh.setInputCloud (cloud);
+    vfh.setInputNormals (normals);
+    vfh.setSearchMethod (tree);
+    vfh.setNumberOfThreads (nr_threads);
+
+    PointCloud<VFHSignature308>::Ptr vfhs (new PointCloud<VFHSignature308>);
+    vfh.computeClusters (clusters, *vfhs);
+    return vfhs;
+  }
+
   /**
     * \brief Utility class for nearest neighbor search based classification of VFH features.
     * \author Zoltan Csaba Marton
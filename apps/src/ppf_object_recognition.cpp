@@ -110,6 +110,7 @@ main (int argc, char** argv)
     PPFEstimation<PointNormal, PointNormal, PPFSignature> ppf_estimator;
     ppf_estimator.setInputCloud (cloud_model_input);
     ppf_estimator.setInputNormals (cloud_model_input);
+    ppf_estimator.setNumberOfThreads (boost::thread::hardware_concurrency ());
     ppf_estimator.compute (*cloud_model_ppf);
 
     PPFHashMapSearch::Ptr hashmap_search (new PPFHashMapSearch (12.0 / 180 * M_PI,
@@ -132,6 +133,7 @@ main (int argc, char** argv)
     ppf_registration.setSceneReferencePointSamplingRate (10);
     ppf_registration.setPositionClusteringThreshold (0.2);
     ppf_registration.setRotationClusteringThreshold (30.0 / 180 * M_PI);
+    ppf_registration.setNumberOfThreads (boost::thread::hardware_concurrency ());
     ppf_registration.setSearchMethod (hashmap_search_vector[model_i]);
     ppf_registration.setInputCloud (cloud_models_with_normals[model_i]);
     ppf_registration.setInputTarget (cloud_scene_input);
@@ -0,0 +1,127 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef PCL_COMMON_DESCRIPTOR_QUANTIZATION_H_
+#define PCL_COMMON_DESCRIPTOR_QUANTIZATION_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+/**
+  * \file descriptor_quantization.h
+  * Convert histogram descriptors to and from their compact 8-bit representations. Every bin is stored as
+  * round (value / step), with the fixed step given by the quantized type's quantizationStep (), so that two
+  * quantized descriptors can be compared directly in bin units (see pcl::L1_Distance, pcl::L2_SQR_Distance and
+  * pcl::CS_Distance in pcl/common/norms.h).
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  /** \brief Quantize an FPFH signature to 8 bits per bin.
+    * \param[in] in the input descriptor
+    * \param[out] out the quantized descriptor
+    * \return false if \a in contains non finite values, in which case \a out is set to 0
+    * \ingroup common
+    */
+  inline bool
+  quantizeDescriptor (const FPFHSignature33 &in, QuantizedFPFHSignature33 &out);
+
+  /** \brief Quantize a SHOT descriptor to 8 bits per bin. The local reference frame is not kept.
+    * \param[in] in the input descriptor
+    * \param[out] out the quantized descriptor
+    * \return false if \a in does not hold 352 finite values, in which case \a out is set to 0
+    * \ingroup common
+    */
+  inline bool
+  quantizeDescriptor (const SHOT &in, QuantizedSHOT352 &out);
+
+  /** \brief Quantize a VFH signature to 8 bits per bin. Bins above 100 (as produced without bin normalization)
+    * saturate at 255.
+    * \param[in] in the input descriptor
+    * \param[out] out the quantized descriptor
+    * \return false if \a in contains non finite values, in which case \a out is set to 0
+    * \ingroup common
+    */
+  inline bool
+  quantizeDescriptor (const VFHSignature308 &in, QuantizedVFHSignature308 &out);
+
+  /** \brief Restore an FPFH signature from its quantized representation.
+    * \param[in] in the quantized descriptor
+    * \param[out] out the output descriptor
+    * \ingroup common
+    */
+  inline void
+  dequantizeDescriptor (const QuantizedFPFHSignature33 &in, FPFHSignature33 &out);
+
+  /** \brief Restore a SHOT descriptor from its quantized representation. The local reference frame is set to 0.
+    * \param[in] in the quantized descriptor
+    * \param[out] out the output descriptor
+    * \ingroup common
+    */
+  inline void
+  dequantizeDescriptor (const QuantizedSHOT352 &in, SHOT &out);
+
+  /** \brief Restore a VFH signature from its quantized representation.
+    * \param[in] in the quantized descriptor
+    * \param[out] out the output descriptor
+    * \ingroup common
+    */
+  inline void
+  dequantizeDescriptor (const QuantizedVFHSignature308 &in, VFHSignature308 &out);
+
+  /** \brief Quantize every descriptor of a point cloud. The output keeps one point per input point, so indices
+    * remain valid; descriptors that cannot be quantized are set to 0 and mark the output as not dense.
+    * \param[in] cloud_in the input descriptors (FPFHSignature33, SHOT or VFHSignature308)
+    * \param[out] cloud_out the quantized descriptors (the matching Quantized* type)
+    * \ingroup common
+    */
+  template <typename PointInT, typename PointOutT> void
+  quantizeDescriptors (const pcl::PointCloud<PointInT> &cloud_in, pcl::PointCloud<PointOutT> &cloud_out);
+
+  /** \brief Restore every descriptor of a quantized point cloud.
+    * \param[in] cloud_in the quantized descriptors
+    * \param[out] cloud_out the output descriptors
+    * \ingroup common
+    */
+  template <typename PointInT, typename PointOutT> void
+  dequantizeDescriptors (const pcl::PointCloud<PointInT> &cloud_in, pcl::PointCloud<PointOutT> &cloud_out);
+}
+/*@}*/
+#include "pcl/common/impl/descriptor_quantization.hpp"
+
+#endif  //#ifndef PCL_COMMON_DESCRIPTOR_QUANTIZATION_H_
@@ -0,0 +1,154 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef PCL_COMMON_IMPL_DESCRIPTOR_QUANTIZATION_H_
+#define PCL_COMMON_IMPL_DESCRIPTOR_QUANTIZATION_H_
+
+#include <pcl/common/descriptor_quantization.h>
+#include <algorithm>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Quantize \a size bins with the given step, rounding to nearest and saturating to [0, 255].
+      * Returns false (and zeroes \a out) if any bin is not finite.
+      */
+    inline bool
+    quantizeBins (const float *in, size_t size, float step, uint8_t *out)
+    {
+      const float inv_step = 1.0f / step;
+      for (size_t i = 0; i < size; ++i)
+      {
+        if (!pcl_isfinite (in[i]))
+        {
+          std::fill (out, out + size, uint8_t (0));
+          return (false);
+        }
+        float q = in[i] * inv_step + 0.5f;
+        out[i] = q <= 0.0f ? uint8_t (0) : (q >= 255.0f ? uint8_t (255) : static_cast<uint8_t> (q));
+      }
+      return (true);
+    }
+
+    inline void
+    dequantizeBins (const uint8_t *in, size_t size, float step, float *out)
+    {
+      for (size_t i = 0; i < size; ++i)
+        out[i] = static_cast<float> (in[i]) * step;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline bool
+pcl::quantizeDescriptor (const FPFHSignature33 &in, QuantizedFPFHSignature33 &out)
+{
+  return (detail::quantizeBins (in.histogram, 33, QuantizedFPFHSignature33::quantizationStep (), out.histogram));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline bool
+pcl::quantizeDescriptor (const SHOT &in, QuantizedSHOT352 &out)
+{
+  if (in.descriptor.size () != 352)
+  {
+    std::fill (out.descriptor, out.descriptor + 352, uint8_t (0));
+    return (false);
+  }
+  return (detail::quantizeBins (&in.descriptor[0], 352, QuantizedSHOT352::quantizationStep (), out.descriptor));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline bool
+pcl::quantizeDescriptor (const VFHSignature308 &in, QuantizedVFHSignature308 &out)
+{
+  return (detail::quantizeBins (in.histogram, 308, QuantizedVFHSignature308::quantizationStep (), out.histogram));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline void
+pcl::dequantizeDescriptor (const QuantizedFPFHSignature33 &in, FPFHSignature33 &out)
+{
+  detail::dequantizeBins (in.histogram, 33, QuantizedFPFHSignature33::quantizationStep (), out.histogram);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline void
+pcl::dequantizeDescriptor (const QuantizedSHOT352 &in, SHOT &out)
+{
+  out.descriptor.resize (352);
+  detail::dequantizeBins (in.descriptor, 352, QuantizedSHOT352::quantizationStep (), &out.descriptor[0]);
+  std::fill (out.rf, out.rf + 9, 0.0f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline void
+pcl::dequantizeDescriptor (const QuantizedVFHSignature308 &in, VFHSignature308 &out)
+{
+  detail::dequantizeBins (in.histogram, 308, QuantizedVFHSignature308::quantizationStep (), out.histogram);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::quantizeDescriptors (const pcl::PointCloud<PointInT> &cloud_in, pcl::PointCloud<PointOutT> &cloud_out)
+{
+  cloud_out.header   = cloud_in.header;
+  cloud_out.width    = cloud_in.width;
+  cloud_out.height   = cloud_in.height;
+  cloud_out.is_dense = cloud_in.is_dense;
+  cloud_out.points.resize (cloud_in.points.size ());
+
+  for (size_t i = 0; i < cloud_in.points.size (); ++i)
+    if (!quantizeDescriptor (cloud_in.points[i], cloud_out.points[i]))
+      cloud_out.is_dense = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::dequantizeDescriptors (const pcl::PointCloud<PointInT> &cloud_in, pcl::PointCloud<PointOutT> &cloud_out)
+{
+  cloud_out.header   = cloud_in.header;
+  cloud_out.width    = cloud_in.width;
+  cloud_out.height   = cloud_in.height;
+  cloud_out.is_dense = cloud_in.is_dense;
+  cloud_out.points.resize (cloud_in.points.size ());
+
+  for (size_t i = 0; i < cloud_in.points.size (); ++i)
+    dequantizeDescriptor (cloud_in.points[i], cloud_out.points[i]);
+}
+
+#endif  //#ifndef PCL_COMMON_IMPL_DESCRIPTOR_QUANTIZATION_H_
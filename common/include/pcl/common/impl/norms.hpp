@@ -34,6 +34,13 @@
  */
 
 #include <pcl/pcl_macros.h>
+#include <algorithm>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace pcl
 {
@@ -230,4 +237,253 @@ HIK_Norm(FloatVectorT a, FloatVectorT b, int dim)
   return norm;
 }
 
+namespace detail
+{
+
+#ifdef __SSE__
+inline float
+horizontalSum (__m128 v)
+{
+  float tmp[4];
+  _mm_storeu_ps (tmp, v);
+  return ((tmp[0] + tmp[1]) + (tmp[2] + tmp[3]));
+}
+
+inline __m128
+accumulateChiSquared (__m128 acc, __m128 va, __m128 vb)
+{
+  const __m128 sum = _mm_add_ps (va, vb);
+  const __m128 diff = _mm_sub_ps (va, vb);
+  // Bins with a+b == 0 yield 0/0, which the mask clears
+  const __m128 valid = _mm_cmpneq_ps (sum, _mm_setzero_ps ());
+  return (_mm_add_ps (acc, _mm_and_ps (valid, _mm_div_ps (_mm_mul_ps (diff, diff), sum))));
+}
+#endif
+
+#ifdef __SSE2__
+inline int
+horizontalSum (__m128i v)
+{
+  int tmp[4];
+  _mm_storeu_si128 ((__m128i*) tmp, v);
+  return ((tmp[0] + tmp[1]) + (tmp[2] + tmp[3]));
+}
+#endif
+
+// The SIMD loops below accumulate blocks of up to 64 elements and compare the partial distance against
+// worst_dist after each block, the same early termination FLANN's own distance functors perform.
+
+inline float
+l1Distance (const float *a, const float *b, size_t size, float worst_dist)
+{
+  float result = 0.0f;
+  size_t i = 0;
+#ifdef __SSE__
+  const size_t simd_end = size & ~size_t (3);
+  const __m128 sign_mask = _mm_set1_ps (-0.0f);
+  while (i < simd_end)
+  {
+    const size_t block_end = (std::min) (simd_end, i + 64);
+    __m128 acc = _mm_setzero_ps ();
+    for (; i < block_end; i += 4)
+      acc = _mm_add_ps (acc, _mm_andnot_ps (sign_mask, _mm_sub_ps (_mm_loadu_ps (a + i), _mm_loadu_ps (b + i))));
+    result += horizontalSum (acc);
+    if (worst_dist > 0 && result > worst_dist)
+      return (result);
+  }
+#endif
+  for (; i < size; ++i)
+    result += fabsf (a[i] - b[i]);
+  return (result);
+}
+
+inline float
+l1Distance (const uint8_t *a, const uint8_t *b, size_t size, float worst_dist)
+{
+  double result = 0.0;
+  size_t i = 0;
+#ifdef __SSE2__
+  const size_t simd_end = size & ~size_t (15);
+  while (i < simd_end)
+  {
+    const size_t block_end = (std::min) (simd_end, i + 64);
+    __m128i acc = _mm_setzero_si128 ();
+    for (; i < block_end; i += 16)
+      acc = _mm_add_epi64 (acc, _mm_sad_epu8 (_mm_loadu_si128 ((const __m128i*) (a + i)),
+                                              _mm_loadu_si128 ((const __m128i*) (b + i))));
+    result += _mm_cvtsi128_si32 (acc) + _mm_cvtsi128_si32 (_mm_srli_si128 (acc, 8));
+    if (worst_dist > 0 && result > worst_dist)
+      return (static_cast<float> (result));
+  }
+#endif
+  for (; i < size; ++i)
+    result += abs (static_cast<int> (a[i]) - static_cast<int> (b[i]));
+  return (static_cast<float> (result));
+}
+
+inline float
+l2SqrDistance (const float *a, const float *b, size_t size, float worst_dist)
+{
+  float result = 0.0f;
+  size_t i = 0;
+#ifdef __SSE__
+  const size_t simd_end = size & ~size_t (3);
+  while (i < simd_end)
+  {
+    const size_t block_end = (std::min) (simd_end, i + 64);
+    __m128 acc = _mm_setzero_ps ();
+    for (; i < block_end; i += 4)
+    {
+      const __m128 diff = _mm_sub_ps (_mm_loadu_ps (a + i), _mm_loadu_ps (b + i));
+      acc = _mm_add_ps (acc, _mm_mul_ps (diff, diff));
+    }
+    result += horizontalSum (acc);
+    if (worst_dist > 0 && result > worst_dist)
+      return (result);
+  }
+#endif
+  for (; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return (result);
+}
+
+inline float
+l2SqrDistance (const uint8_t *a, const uint8_t *b, size_t size, float worst_dist)
+{
+  double result = 0.0;
+  size_t i = 0;
+#ifdef __SSE2__
+  const size_t simd_end = size & ~size_t (15);
+  const __m128i zero = _mm_setzero_si128 ();
+  while (i < simd_end)
+  {
+    const size_t block_end = (std::min) (simd_end, i + 64);
+    __m128i acc = zero;
+    for (; i < block_end; i += 16)
+    {
+      // Widen to 16 bits, subtract, and let madd square and add pairs into 32-bit lanes
+      const __m128i va = _mm_loadu_si128 ((const __m128i*) (a + i));
+      const __m128i vb = _mm_loadu_si128 ((const __m128i*) (b + i));
+      const __m128i lo = _mm_sub_epi16 (_mm_unpacklo_epi8 (va, zero), _mm_unpacklo_epi8 (vb, zero));
+      const __m128i hi = _mm_sub_epi16 (_mm_unpackhi_epi8 (va, zero), _mm_unpackhi_epi8 (vb, zero));
+      acc = _mm_add_epi32 (acc, _mm_add_epi32 (_mm_madd_epi16 (lo, lo), _mm_madd_epi16 (hi, hi)));
+    }
+    result += horizontalSum (acc);
+    if (worst_dist > 0 && result > worst_dist)
+      return (static_cast<float> (result));
+  }
+#endif
+  for (; i < size; ++i)
+  {
+    const int diff = static_cast<int> (a[i]) - static_cast<int> (b[i]);
+    result += diff * diff;
+  }
+  return (static_cast<float> (result));
+}
+
+inline float
+csDistance (const float *a, const float *b, size_t size, float worst_dist)
+{
+  float result = 0.0f;
+  size_t i = 0;
+#ifdef __SSE__
+  const size_t simd_end = size & ~size_t (3);
+  while (i < simd_end)
+  {
+    const size_t block_end = (std::min) (simd_end, i + 64);
+    __m128 acc = _mm_setzero_ps ();
+    for (; i < block_end; i += 4)
+      acc = accumulateChiSquared (acc, _mm_loadu_ps (a + i), _mm_loadu_ps (b + i));
+    result += horizontalSum (acc);
+    if (worst_dist > 0 && result > worst_dist)
+      return (result);
+  }
+#endif
+  for (; i < size; ++i)
+  {
+    const float sum = a[i] + b[i];
+    if (sum != 0)
+      result += (a[i] - b[i]) * (a[i] - b[i]) / sum;
+  }
+  return (result);
+}
+
+inline float
+csDistance (const uint8_t *a, const uint8_t *b, size_t size, float worst_dist)
+{
+  float result = 0.0f;
+  size_t i = 0;
+#ifdef __SSE2__
+  const size_t simd_end = size & ~size_t (15);
+  const __m128i zero = _mm_setzero_si128 ();
+  while (i < simd_end)
+  {
+    const size_t block_end = (std::min) (simd_end, i + 64);
+    __m128 acc = _mm_setzero_ps ();
+    for (; i < block_end; i += 16)
+    {
+      const __m128i va = _mm_loadu_si128 ((const __m128i*) (a + i));
+      const __m128i vb = _mm_loadu_si128 ((const __m128i*) (b + i));
+      const __m128i a_lo = _mm_unpacklo_epi8 (va, zero), a_hi = _mm_unpackhi_epi8 (va, zero);
+      const __m128i b_lo = _mm_unpacklo_epi8 (vb, zero), b_hi = _mm_unpackhi_epi8 (vb, zero);
+      acc = accumulateChiSquared (acc, _mm_cvtepi32_ps (_mm_unpacklo_epi16 (a_lo, zero)),
+                                       _mm_cvtepi32_ps (_mm_unpacklo_epi16 (b_lo, zero)));
+      acc = accumulateChiSquared (acc, _mm_cvtepi32_ps (_mm_unpackhi_epi16 (a_lo, zero)),
+                                       _mm_cvtepi32_ps (_mm_unpackhi_epi16 (b_lo, zero)));
+      acc = accumulateChiSquared (acc, _mm_cvtepi32_ps (_mm_unpacklo_epi16 (a_hi, zero)),
+                                       _mm_cvtepi32_ps (_mm_unpacklo_epi16 (b_hi, zero)));
+      acc = accumulateChiSquared (acc, _mm_cvtepi32_ps (_mm_unpackhi_epi16 (a_hi, zero)),
+                                       _mm_cvtepi32_ps (_mm_unpackhi_epi16 (b_hi, zero)));
+    }
+    result += horizontalSum (acc);
+    if (worst_dist > 0 && result > worst_dist)
+      return (result);
+  }
+#endif
+  for (; i < size; ++i)
+  {
+    const float sum = static_cast<float> (a[i]) + static_cast<float> (b[i]);
+    if (sum != 0)
+    {
+      const float diff = static_cast<float> (a[i]) - static_cast<float> (b[i]);
+      result += diff * diff / sum;
+    }
+  }
+  return (result);
+}
+
+}
+
+// Raw float and 8-bit arrays (e.g. the histogram of a feature point type) are routed to the SIMD kernels above
+
+template <> inline float
+L1_Norm (float *a, float *b, int dim) { return (detail::l1Distance (a, b, dim)); }
+template <> inline float
+L1_Norm (const float *a, const float *b, int dim) { return (detail::l1Distance (a, b, dim)); }
+template <> inline float
+L1_Norm (uint8_t *a, uint8_t *b, int dim) { return (detail::l1Distance (a, b, dim)); }
+template <> inline float
+L1_Norm (const uint8_t *a, const uint8_t *b, int dim) { return (detail::l1Distance (a, b, dim)); }
+
+template <> inline float
+L2_Norm_SQR (float *a, float *b, int dim) { return (detail::l2SqrDistance (a, b, dim)); }
+template <> inline float
+L2_Norm_SQR (const float *a, const float *b, int dim) { return (detail::l2SqrDistance (a, b, dim)); }
+template <> inline float
+L2_Norm_SQR (uint8_t *a, uint8_t *b, int dim) { return (detail::l2SqrDistance (a, b, dim)); }
+template <> inline float
+L2_Norm_SQR (const uint8_t *a, const uint8_t *b, int dim) { return (detail::l2SqrDistance (a, b, dim)); }
+
+template <> inline float
+CS_Norm (float *a, float *b, int dim) { return (detail::csDistance (a, b, dim)); }
+template <> inline float
+CS_Norm (const float *a, const float *b, int dim) { return (detail::csDistance (a, b, dim)); }
+template <> inline float
+CS_Norm (uint8_t *a, uint8_t *b, int dim) { return (detail::csDistance (a, b, dim)); }
+template <> inline float
+CS_Norm (const uint8_t *a, const uint8_t *b, int dim) { return (detail::csDistance (a, b, dim)); }
+
 }
@@ -34,44 +34,231 @@
  *
  */
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#include <algorithm>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Number of points transformed together in structure-of-arrays layout. */
+    const int transform_block_size = 8;
+
+    /** \brief Minimum number of blocks for which the transformation is split across threads. */
+    const int transform_parallel_blocks = 256;
+
+    /** \brief A block of 3D vectors in structure-of-arrays layout. */
+    struct TransformBlock
+    {
+      float x[transform_block_size];
+      float y[transform_block_size];
+      float z[transform_block_size];
+    };
+
+    /** \brief Compute r * v + t for all the vectors of a TransformBlock. */
+    class BlockTransform
+    {
+      public:
+        BlockTransform (const Eigen::Matrix3f &r, const Eigen::Vector3f &t)
+        {
+          for (int i = 0; i < 3; ++i)
+          {
+            for (int j = 0; j < 3; ++j)
+              m_[i * 4 + j] = r (i, j);
+            m_[i * 4 + 3] = t[i];
+          }
+        }
+
+        /** \brief Transform a block. Vectors which are masked out keep their previous value.
+          * \param[in,out] b the block to transform
+          * \param[in] mask the mask of the vectors to transform, as computed by computeFiniteMask. If NULL, all the vectors are 
+          * transformed.
+          */
+        inline void
+        apply (TransformBlock &b, const float *mask) const
+        {
+#ifdef __SSE__
+          for (int k = 0; k < transform_block_size; k += 4)
+          {
+            __m128 x = _mm_loadu_ps (b.x + k);
+            __m128 y = _mm_loadu_ps (b.y + k);
+            __m128 z = _mm_loadu_ps (b.z + k);
+            __m128 out[3];
+            for (int i = 0; i < 3; ++i)
+              out[i] = _mm_add_ps (_mm_add_ps (_mm_mul_ps (_mm_set1_ps (m_[i * 4 + 0]), x), 
+                                               _mm_mul_ps (_mm_set1_ps (m_[i * 4 + 1]), y)),
+                                   _mm_add_ps (_mm_mul_ps (_mm_set1_ps (m_[i * 4 + 2]), z), 
+                                               _mm_set1_ps (m_[i * 4 + 3])));
+            if (mask)
+            {
+              // select the transformed lanes without branching
+              __m128 m = _mm_loadu_ps (mask + k);
+              out[0] = _mm_or_ps (_mm_and_ps (m, out[0]), _mm_andnot_ps (m, x));
+              out[1] = _mm_or_ps (_mm_and_ps (m, out[1]), _mm_andnot_ps (m, y));
+              out[2] = _mm_or_ps (_mm_and_ps (m, out[2]), _mm_andnot_ps (m, z));
+            }
+            _mm_storeu_ps (b.x + k, out[0]);
+            _mm_storeu_ps (b.y + k, out[1]);
+            _mm_storeu_ps (b.z + k, out[2]);
+          }
+#else
+          for (int k = 0; k < transform_block_size; ++k)
+          {
+            float x = b.x[k], y = b.y[k], z = b.z[k];
+            bool keep = (mask && mask[k] == 0.0f);
+            b.x[k] = keep ? x : m_[0] * x + m_[1] * y + m_[2]  * z + m_[3];
+            b.y[k] = keep ? y : m_[4] * x + m_[5] * y + m_[6]  * z + m_[7];
+            b.z[k] = keep ? z : m_[8] * x + m_[9] * y + m_[10] * z + m_[11];
+          }
+#endif
+        }
+
+      private:
+        /** \brief The 3x4 transformation matrix, stored row major. */
+        float m_[12];
+    };
+
+    /** \brief Compute the mask of the vectors of a block with finite coordinates: all bits set if x, y and z 
+      * are finite, 0 otherwise. x - x is 0 for finite values and NaN for NaNs and Infs.
+      */
+    inline void
+    computeFiniteMask (const TransformBlock &b, float *mask)
+    {
+#ifdef __SSE__
+      for (int k = 0; k < transform_block_size; k += 4)
+      {
+        __m128 x = _mm_loadu_ps (b.x + k);
+        __m128 y = _mm_loadu_ps (b.y + k);
+        __m128 z = _mm_loadu_ps (b.z + k);
+        __m128 d = _mm_add_ps (_mm_add_ps (_mm_sub_ps (x, x), _mm_sub_ps (y, y)), _mm_sub_ps (z, z));
+        _mm_storeu_ps (mask + k, _mm_cmpeq_ps (d, _mm_setzero_ps ()));
+      }
+#else
+      for (int k = 0; k < transform_block_size; ++k)
+        mask[k] = (pcl_isfinite (b.x[k]) && pcl_isfinite (b.y[k]) && pcl_isfinite (b.z[k])) ? 1.0f : 0.0f;
+#endif
+    }
+
+    /** \brief Copy the xyz coordinates (and the normals) of points to and from TransformBlocks. */
+    template <typename PointT, bool with_normals>
+    struct TransformBlockAccess
+    {
+      static inline void
+      getNormals (const PointT*, int, TransformBlock&) {}
+      static inline void
+      setNormals (const TransformBlock&, int, PointT*) {}
+    };
+
+    template <typename PointT>
+    struct TransformBlockAccess<PointT, true>
+    {
+      static inline void
+      getNormals (const PointT *points, int n, TransformBlock &b)
+      {
+        for (int k = 0; k < n; ++k)
+        {
+          b.x[k] = points[k].normal_x;
+          b.y[k] = points[k].normal_y;
+          b.z[k] = points[k].normal_z;
+        }
+      }
+      static inline void
+      setNormals (const TransformBlock &b, int n, PointT *points)
+      {
+        for (int k = 0; k < n; ++k)
+        {
+          points[k].normal_x = b.x[k];
+          points[k].normal_y = b.y[k];
+          points[k].normal_z = b.z[k];
+        }
+      }
+    };
+
+    /** \brief Transform the points of a cloud in place, in blocks of transform_block_size points distributed 
+      * over the available threads.
+      * \param[in,out] points the points to transform
+      * \param[in] rotation the linear part of the transformation applied to xyz
+      * \param[in] translation the translation applied to xyz
+      * \param[in] normal_rotation the rotation applied to the normals (used only if with_normals is true)
+      * \param[in] check_finite if true, points with non-finite xyz coordinates are left untouched
+      */
+    template <typename PointT, bool with_normals> void
+    transformPointsInPlace (typename pcl::PointCloud<PointT>::VectorType &points,
+                            const Eigen::Matrix3f &rotation, const Eigen::Vector3f &translation,
+                            const Eigen::Matrix3f &normal_rotation, bool check_finite)
+    {
+      const int nr_points = static_cast<int> (points.size ());
+      const int nr_blocks = (nr_points + transform_block_size - 1) / transform_block_size;
+      const BlockTransform point_transform (rotation, translation);
+      const BlockTransform normal_transform (normal_rotation, Eigen::Vector3f::Zero ());
+
+#pragma omp parallel for schedule (static) if (nr_blocks > transform_parallel_blocks)
+      for (int block = 0; block < nr_blocks; ++block)
+      {
+        PointT *p = &points[block * transform_block_size];
+        const int n = std::min (transform_block_size, nr_points - block * transform_block_size);
+
+        TransformBlock b;
+        float mask[transform_block_size];
+        std::fill (b.x + n, b.x + transform_block_size, 0.0f);
+        std::fill (b.y + n, b.y + transform_block_size, 0.0f);
+        std::fill (b.z + n, b.z + transform_block_size, 0.0f);
+        for (int k = 0; k < n; ++k)
+        {
+          b.x[k] = p[k].x;
+          b.y[k] = p[k].y;
+          b.z[k] = p[k].z;
+        }
+        if (check_finite)
+          computeFiniteMask (b, mask);
+
+        point_transform.apply (b, check_finite ? mask : NULL);
+        for (int k = 0; k < n; ++k)
+        {
+          p[k].x = b.x[k];
+          p[k].y = b.y[k];
+          p[k].z = b.z[k];
+        }
+
+        if (with_normals)
+        {
+          TransformBlockAccess<PointT, with_normals>::getNormals (p, n, b);
+          normal_transform.apply (b, check_finite ? mask : NULL);
+          TransformBlockAccess<PointT, with_normals>::setNormals (b, n, p);
+        }
+      }
+    }
+
+    /** \brief Copy the header, organization and points of cloud_in into cloud_out, unless they are the same 
+      * cloud.
+      */
+    template <typename PointT> inline void
+    copyTransformInput (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out)
+    {
+      if (&cloud_in == &cloud_out)
+        return;
+      cloud_out.header   = cloud_in.header;
+      cloud_out.is_dense = cloud_in.is_dense;
+      cloud_out.width    = cloud_in.width;
+      cloud_out.height   = cloud_in.height;
+      cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
+    }
+  } // namespace detail
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                           pcl::PointCloud<PointT> &cloud_out,
                           const Eigen::Affine3f &transform)
 {
-  if (&cloud_in != &cloud_out)
-  {
-    // Note: could be replaced by cloud_out = cloud_in
-    cloud_out.header   = cloud_in.header;
-    cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.width    = cloud_in.width;
-    cloud_out.height   = cloud_in.height;
-    cloud_out.points.reserve (cloud_out.points.size ());
-    cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
-  }
-
-  if (cloud_in.is_dense)
-  {
-    // If the dataset is dense, simply transform it!
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-      cloud_out.points[i].getVector3fMap () = transform * 
-                                              cloud_in.points[i].getVector3fMap ();
-  }
-  else
-  {
-    // Dataset might contain NaNs and Infs, so check for them first,
-    // otherwise we get errors during the multiplication (?)
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      cloud_out.points[i].getVector3fMap () = transform * 
-                                              cloud_in.points[i].getVector3fMap ();
-    }
-  }
+  // Non-dense datasets might contain NaNs and Infs, which are masked out
+  bool check_finite = !cloud_in.is_dense;
+  detail::copyTransformInput (cloud_in, cloud_out);
+  detail::transformPointsInPlace<PointT, false> (cloud_out.points, transform.linear (), transform.translation (),
+                                                 Eigen::Matrix3f::Identity (), check_finite);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,34 +269,21 @@ pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
                           const Eigen::Affine3f &transform)
 {
   size_t npts = indices.size ();
-  // In order to transform the data, we need to remove NaNs
+  bool check_finite = !cloud_in.is_dense;
+
+  // Gather the points first, so that cloud_in can be the same cloud as cloud_out
+  typename pcl::PointCloud<PointT>::VectorType points (npts);
+  for (size_t i = 0; i < npts; ++i)
+    points[i] = cloud_in.points[indices[i]];
+
   cloud_out.is_dense = cloud_in.is_dense;
   cloud_out.header   = cloud_in.header;
-  cloud_out.width    = npts;
+  cloud_out.width    = static_cast<uint32_t> (npts);
   cloud_out.height   = 1;
-  cloud_out.points.resize (npts);
+  cloud_out.points.swap (points);
 
-  if (cloud_in.is_dense)
-  {
-    // If the dataset is dense, simply transform it!
-    for (size_t i = 0; i < npts; ++i)
-      cloud_out.points[i].getVector3fMap () = transform *
-                                              cloud_in.points[indices[i]].getVector3fMap ();
-  }
-  else
-  {
-    // Dataset might contain NaNs and Infs, so check for them first,
-    // otherwise we get errors during the multiplication (?)
-    for (size_t i = 0; i < npts; ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[indices[i]].x) || 
-          !pcl_isfinite (cloud_in.points[indices[i]].y) || 
-          !pcl_isfinite (cloud_in.points[indices[i]].z))
-        continue;
-      cloud_out.points[i].getVector3fMap () = transform *
-                                              cloud_in.points[indices[i]].getVector3fMap ();
-    }
-  }
+  detail::transformPointsInPlace<PointT, false> (cloud_out.points, transform.linear (), transform.translation (),
+                                                 Eigen::Matrix3f::Identity (), check_finite);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -118,47 +292,11 @@ pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
                                      pcl::PointCloud<PointT> &cloud_out,
                                      const Eigen::Affine3f &transform)
 {
-  if (&cloud_in != &cloud_out)
-  {
-    // Note: could be replaced by cloud_out = cloud_in
-    cloud_out.header   = cloud_in.header;
-    cloud_out.width    = cloud_in.width;
-    cloud_out.height   = cloud_in.height;
-    cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.points.reserve (cloud_out.points.size ());
-    cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
-  }
-
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      cloud_out.points[i].getVector3fMap() = transform * 
-                                             cloud_in.points[i].getVector3fMap ();
-
-      // Rotate normals
-      cloud_out.points[i].getNormalVector3fMap() = transform.rotation () * 
-                                                   cloud_in.points[i].getNormalVector3fMap ();
-    }
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      cloud_out.points[i].getVector3fMap() = transform * 
-                                             cloud_in.points[i].getVector3fMap ();
-
-      // Rotate normals
-      cloud_out.points[i].getNormalVector3fMap() = transform.rotation () * 
-                                                   cloud_in.points[i].getNormalVector3fMap ();
-    }
-  }
+  bool check_finite = !cloud_in.is_dense;
+  detail::copyTransformInput (cloud_in, cloud_out);
+  // Normals are rotated only, with the rotation part of the transformation computed once
+  detail::transformPointsInPlace<PointT, true> (cloud_out.points, transform.linear (), transform.translation (),
+                                                transform.rotation (), check_finite);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -167,39 +305,12 @@ pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
                           pcl::PointCloud<PointT> &cloud_out,
                           const Eigen::Matrix4f &transform)
 {
-  if (&cloud_in != &cloud_out)
-  {
-    // Note: could be replaced by cloud_out = cloud_in
-    cloud_out.header   = cloud_in.header;
-    cloud_out.width    = cloud_in.width;
-    cloud_out.height   = cloud_in.height;
-    cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.points.reserve (cloud_out.points.size ());
-    cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
-  }
-
+  bool check_finite = !cloud_in.is_dense;
   Eigen::Matrix3f rot   = transform.block<3, 3> (0, 0);
   Eigen::Vector3f trans = transform.block<3, 1> (0, 3);
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-      cloud_out.points[i].getVector3fMap () = rot * 
-                                              cloud_in.points[i].getVector3fMap () + trans;
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      cloud_out.points[i].getVector3fMap () = rot * 
-                                              cloud_in.points[i].getVector3fMap () + trans;
-    }
-  }
+
+  detail::copyTransformInput (cloud_in, cloud_out);
+  detail::transformPointsInPlace<PointT, false> (cloud_out.points, rot, trans, rot, check_finite);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -208,50 +319,12 @@ pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
                                      pcl::PointCloud<PointT> &cloud_out,
                                      const Eigen::Matrix4f &transform)
 {
-  if (&cloud_in != &cloud_out)
-  {
-    // Note: could be replaced by cloud_out = cloud_in
-    cloud_out.header   = cloud_in.header;
-    cloud_out.width    = cloud_in.width;
-    cloud_out.height   = cloud_in.height;
-    cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.points.reserve (cloud_out.points.size ());
-    cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
-  }
-
+  bool check_finite = !cloud_in.is_dense;
   Eigen::Matrix3f rot   = transform.block<3, 3> (0, 0);
   Eigen::Vector3f trans = transform.block<3, 1> (0, 3);
 
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      cloud_out.points[i].getVector3fMap () = rot * 
-                                              cloud_in.points[i].getVector3fMap () + trans;
-
-      // Rotate normals
-      cloud_out.points[i].getNormalVector3fMap() = rot * 
-                                                   cloud_in.points[i].getNormalVector3fMap ();
-    }
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      cloud_out.points[i].getVector3fMap () = rot * 
-                                              cloud_in.points[i].getVector3fMap () + trans;
-
-      // Rotate normals
-      cloud_out.points[i].getNormalVector3fMap() = rot * 
-                                                   cloud_in.points[i].getNormalVector3fMap ();
-    }
-  }
+  detail::copyTransformInput (cloud_in, cloud_out);
+  detail::transformPointsInPlace<PointT, true> (cloud_out.points, rot, trans, rot, check_finite);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -36,6 +36,8 @@
 #ifndef PCL_NORMS_H_
 #define PCL_NORMS_H_
 
+#include <pcl/pcl_macros.h>
+
 /**
   * \file norms.h
   * Define standard C methods to calculate different norms
@@ -191,6 +193,130 @@ namespace pcl
     */
   template <typename FloatVectorT> inline float
   HIK_Norm (FloatVectorT A, FloatVectorT B, int dim);
+
+  namespace detail
+  {
+    /** \brief Compute the L1 distance between two float arrays (SSE accelerated if available).
+      * \param[in] a the first array
+      * \param[in] b the second array
+      * \param[in] size the number of elements in \a a and \a b
+      * \param[in] worst_dist if positive, the computation stops as soon as the partial distance exceeds it
+      */
+    inline float
+    l1Distance (const float *a, const float *b, size_t size, float worst_dist = -1);
+
+    /** \brief Compute the L1 distance between two 8-bit arrays, in bin units (SSE2 accelerated if available). */
+    inline float
+    l1Distance (const uint8_t *a, const uint8_t *b, size_t size, float worst_dist = -1);
+
+    /** \brief Compute the squared L2 distance between two float arrays (SSE accelerated if available). */
+    inline float
+    l2SqrDistance (const float *a, const float *b, size_t size, float worst_dist = -1);
+
+    /** \brief Compute the squared L2 distance between two 8-bit arrays, in squared bin units (SSE2 accelerated if
+      * available).
+      */
+    inline float
+    l2SqrDistance (const uint8_t *a, const uint8_t *b, size_t size, float worst_dist = -1);
+
+    /** \brief Compute the chi-squared distance sum ((a-b)^2 / (a+b)) between two float arrays, skipping the bins
+      * where a+b is 0 (SSE accelerated if available).
+      */
+    inline float
+    csDistance (const float *a, const float *b, size_t size, float worst_dist = -1);
+
+    /** \brief Compute the chi-squared distance between two 8-bit arrays, in bin units (SSE2 accelerated if
+      * available).
+      */
+    inline float
+    csDistance (const uint8_t *a, const uint8_t *b, size_t size, float worst_dist = -1);
+  }
+
+  /** \brief L1 distance functor with the interface expected by FLANN, so that it can be given as the \a Dist
+    * template parameter of \ref KdTreeFLANN. T is float or uint8_t. For 8-bit quantized descriptors (e.g.
+    * \ref QuantizedFPFHSignature33) the distances are expressed in quantization steps.
+    * \ingroup common
+    */
+  template <typename T>
+  struct L1_Distance
+  {
+    typedef bool is_kdtree_distance;
+    typedef bool is_vector_space_distance;
+
+    typedef T ElementType;
+    typedef float ResultType;
+
+    template <typename Iterator1, typename Iterator2> inline ResultType
+    operator () (Iterator1 a, Iterator2 b, size_t size, ResultType worst_dist = -1) const
+    {
+      return (detail::l1Distance (static_cast<const T*> (&a[0]), static_cast<const T*> (&b[0]), size, worst_dist));
+    }
+
+    template <typename U, typename V> inline ResultType
+    accum_dist (const U& a, const V& b, int) const
+    {
+      return (fabsf (static_cast<ResultType> (a) - static_cast<ResultType> (b)));
+    }
+  };
+
+  /** \brief Squared L2 distance functor with the interface expected by FLANN, so that it can be given as the
+    * \a Dist template parameter of \ref KdTreeFLANN. T is float or uint8_t. For 8-bit quantized descriptors the
+    * distances are expressed in squared quantization steps.
+    * \ingroup common
+    */
+  template <typename T>
+  struct L2_SQR_Distance
+  {
+    typedef bool is_kdtree_distance;
+    typedef bool is_vector_space_distance;
+
+    typedef T ElementType;
+    typedef float ResultType;
+
+    template <typename Iterator1, typename Iterator2> inline ResultType
+    operator () (Iterator1 a, Iterator2 b, size_t size, ResultType worst_dist = -1) const
+    {
+      return (detail::l2SqrDistance (static_cast<const T*> (&a[0]), static_cast<const T*> (&b[0]), size, worst_dist));
+    }
+
+    template <typename U, typename V> inline ResultType
+    accum_dist (const U& a, const V& b, int) const
+    {
+      ResultType diff = static_cast<ResultType> (a) - static_cast<ResultType> (b);
+      return (diff * diff);
+    }
+  };
+
+  /** \brief Chi-squared distance functor with the interface expected by FLANN, so that it can be given as the
+    * \a Dist template parameter of \ref KdTreeFLANN. T is float or uint8_t. For 8-bit quantized descriptors the
+    * distances are expressed in quantization steps.
+    * \ingroup common
+    */
+  template <typename T>
+  struct CS_Distance
+  {
+    typedef bool is_kdtree_distance;
+    typedef bool is_vector_space_distance;
+
+    typedef T ElementType;
+    typedef float ResultType;
+
+    template <typename Iterator1, typename Iterator2> inline ResultType
+    operator () (Iterator1 a, Iterator2 b, size_t size, ResultType worst_dist = -1) const
+    {
+      return (detail::csDistance (static_cast<const T*> (&a[0]), static_cast<const T*> (&b[0]), size, worst_dist));
+    }
+
+    template <typename U, typename V> inline ResultType
+    accum_dist (const U& a, const V& b, int) const
+    {
+      ResultType sum = static_cast<ResultType> (a) + static_cast<ResultType> (b);
+      if (sum == 0)
+        return (0);
+      ResultType diff = static_cast<ResultType> (a) - static_cast<ResultType> (b);
+      return (diff * diff / sum);
+    }
+  };
 }
 /*@}*/
 #include "pcl/common/impl/norms.hpp"
@@ -114,6 +114,12 @@
   (pcl::VFHSignature308)        \
   (pcl::Narf36)
 
+// Define all point types that hold 8-bit quantized features
+#define PCL_QUANTIZED_FEATURE_POINT_TYPES \
+  (pcl::QuantizedFPFHSignature33)         \
+  (pcl::QuantizedSHOT352)                 \
+  (pcl::QuantizedVFHSignature308)
+
 namespace pcl
 {
 
@@ -1042,6 +1048,57 @@ namespace pcl
     return (os);
   }
 
+  /** \brief A point structure representing the Fast Point Feature Histogram (FPFH) with 8 bits per bin.
+   * A bin stores round (value / quantizationStep ()), which covers the [0, 100] range of the normalized FPFH
+   * sub-histograms in a quarter of the memory. See pcl/common/descriptor_quantization.h for the conversions.
+   * \ingroup common
+   */
+  struct QuantizedFPFHSignature33
+  {
+    uint8_t histogram[33];
+    static float quantizationStep () { return (100.0f / 255.0f); }
+  };
+  inline std::ostream& operator << (std::ostream& os, const QuantizedFPFHSignature33& p)
+  {
+    for (int i = 0; i < 33; ++i)
+    os << (i == 0 ? "(" : "") << static_cast<int> (p.histogram[i]) << (i < 32 ? ", " : ")");
+    return (os);
+  }
+
+  /** \brief A point structure representing the 352 bins of the SHOT shape descriptor with 8 bits per bin, without
+   * the local reference frame. A bin stores round (value / quantizationStep ()), which covers the [0, 1] range of
+   * the normalized SHOT descriptor.
+   * \ingroup common
+   */
+  struct QuantizedSHOT352
+  {
+    uint8_t descriptor[352];
+    static float quantizationStep () { return (1.0f / 255.0f); }
+  };
+  inline std::ostream& operator << (std::ostream& os, const QuantizedSHOT352& p)
+  {
+    for (int i = 0; i < 352; ++i)
+    os << (i == 0 ? "(" : "") << static_cast<int> (p.descriptor[i]) << (i < 351 ? ", " : ")");
+    return (os);
+  }
+
+  /** \brief A point structure representing the Viewpoint Feature Histogram (VFH) with 8 bits per bin.
+   * A bin stores round (value / quantizationStep ()), which covers the [0, 100] range of the VFH histograms
+   * computed with normalized bins.
+   * \ingroup common
+   */
+  struct QuantizedVFHSignature308
+  {
+    uint8_t histogram[308];
+    static float quantizationStep () { return (100.0f / 255.0f); }
+  };
+  inline std::ostream& operator << (std::ostream& os, const QuantizedVFHSignature308& p)
+  {
+    for (int i = 0; i < 308; ++i)
+    os << (i == 0 ? "(" : "") << static_cast<int> (p.histogram[i]) << (i < 307 ? ", " : ")");
+    return (os);
+  }
+
   /** \brief A point structure representing the GFPFH descriptor with 16 bins.
    * \ingroup common
    */
@@ -415,6 +415,23 @@ namespace pcl
   class DefaultPointRepresentation <VFHSignature308> : public DefaultFeatureRepresentation <VFHSignature308>
   {};
 
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  template <>
+  class DefaultPointRepresentation <QuantizedFPFHSignature33> : 
+    public DefaultFeatureRepresentation <QuantizedFPFHSignature33>
+  {};
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  template <>
+  class DefaultPointRepresentation <QuantizedSHOT352> : public DefaultFeatureRepresentation <QuantizedSHOT352>
+  {};
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  template <>
+  class DefaultPointRepresentation <QuantizedVFHSignature308> : 
+    public DefaultFeatureRepresentation <QuantizedVFHSignature308>
+  {};
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   template <>
   class DefaultPointRepresentation <NormalBasedSignature12> : 
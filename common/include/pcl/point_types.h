@@ -224,6 +224,21 @@ namespace pcl
     */
   struct VFHSignature308;
 
+  /** \brief Members: uint8_t histogram[33]
+    * \ingroup common
+    */
+  struct QuantizedFPFHSignature33;
+
+  /** \brief Members: uint8_t descriptor[352]
+    * \ingroup common
+    */
+  struct QuantizedSHOT352;
+
+  /** \brief Members: uint8_t histogram[308]
+    * \ingroup common
+    */
+  struct QuantizedVFHSignature308;
+
   /** \brief Members: float x, y, z, roll, pitch, yaw; float descriptor[36] 
     * \ingroup common
     */
@@ -493,6 +508,18 @@ POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::VFHSignature308,
     (float[308], histogram, vfh)
 )
 
+POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::QuantizedFPFHSignature33,
+    (uint8_t[33], histogram, fpfh_q8)
+)
+
+POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::QuantizedSHOT352,
+    (uint8_t[352], descriptor, shot_q8)
+)
+
+POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::QuantizedVFHSignature308,
+    (uint8_t[308], histogram, vfh_q8)
+)
+
 POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::Narf36,
     (float[36], descriptor, descriptor)
 )
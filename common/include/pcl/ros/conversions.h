@@ -47,6 +47,9 @@
 #include <pcl/exceptions.h>
 #include <pcl/console/print.h>
 #include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
 
 namespace pcl
 {
@@ -151,6 +154,70 @@ namespace pcl
     }
   }
 
+  namespace detail
+  {
+    /** \brief Process wide cache of the MsgFieldMaps of a point type, indexed by the layout of the message 
+      * fields. Creating a mapping walks all the fields of the point type and sorts them, which is done once 
+      * per layout instead of once per message.
+      */
+    template <typename PointT>
+    class FieldMapCache
+    {
+      public:
+        typedef boost::shared_ptr<const MsgFieldMap> MsgFieldMapConstPtr;
+
+        /** \brief Get the mapping between a message field layout and PointT, creating it on first use.
+          * \param[in] msg_fields the fields of the message
+          * \note Throws pcl::InvalidConversionException if a field of PointT is missing in msg_fields
+          */
+        static MsgFieldMapConstPtr
+        get (const std::vector<sensor_msgs::PointField>& msg_fields)
+        {
+          std::string signature;
+          BOOST_FOREACH (const sensor_msgs::PointField& field, msg_fields)
+          {
+            signature.append (field.name);
+            signature.push_back ('\0');
+            signature.append (reinterpret_cast<const char*> (&field.offset), sizeof (field.offset));
+            signature.append (reinterpret_cast<const char*> (&field.datatype), sizeof (field.datatype));
+            signature.append (reinterpret_cast<const char*> (&field.count), sizeof (field.count));
+          }
+
+          boost::mutex::scoped_lock lock (mutex ());
+          std::map<std::string, MsgFieldMapConstPtr> &mappings = cache ();
+          typename std::map<std::string, MsgFieldMapConstPtr>::const_iterator it = mappings.find (signature);
+          if (it != mappings.end ())
+            return (it->second);
+
+          boost::shared_ptr<MsgFieldMap> field_map (new MsgFieldMap);
+          createMapping<PointT> (msg_fields, *field_map);
+
+          // Only a handful of layouts are expected per point type, bound the cache anyway
+          if (mappings.size () >= max_layouts)
+            mappings.clear ();
+          mappings[signature] = field_map;
+          return (field_map);
+        }
+
+      private:
+        static const size_t max_layouts = 64;
+
+        static std::map<std::string, MsgFieldMapConstPtr>&
+        cache ()
+        {
+          static std::map<std::string, MsgFieldMapConstPtr> mappings;
+          return (mappings);
+        }
+
+        static boost::mutex&
+        mutex ()
+        {
+          static boost::mutex m;
+          return (m);
+        }
+    };
+  } //namespace detail
+
   /** \brief Convert a PointCloud2 binary data blob into a pcl::PointCloud<T> object using a field_map.
     * \param[in] msg the PointCloud2 binary blob
     * \param[out] cloud the resultant pcl::PointCloud<T>
@@ -177,6 +244,8 @@ namespace pcl
     // Copy point data
     uint32_t num_points = msg.width * msg.height;
     cloud.points.resize (num_points);
+    if (num_points == 0)
+      return;
     uint8_t* cloud_data = reinterpret_cast<uint8_t*>(&cloud.points[0]);
 
     // Check if we can copy adjacent points in a single memcpy
@@ -201,19 +270,22 @@ namespace pcl
     }
     else
     {
-      // If not, memcpy each group of contiguous fields separately
-      for (uint32_t row = 0; row < msg.height; ++row)
+      // If not, memcpy each group of contiguous fields separately, with the points split across threads
+      const uint8_t* msg_data = &msg.data[0];
+      const int nr_points = static_cast<int> (num_points);
+      const uint32_t width = msg.width;
+      const bool contiguous_rows = (msg.row_step == msg.width * msg.point_step);
+      const int nr_mappings = static_cast<int> (field_map.size ());
+      const detail::FieldMapping* mappings = field_map.empty () ? NULL : &field_map[0];
+
+#pragma omp parallel for schedule (static) if (nr_points > 16384)
+      for (int i = 0; i < nr_points; ++i)
       {
-        const uint8_t* row_data = &msg.data[row * msg.row_step];
-        for (uint32_t col = 0; col < msg.width; ++col)
-        {
-          const uint8_t* msg_data = row_data + col * msg.point_step;
-          BOOST_FOREACH (const detail::FieldMapping& mapping, field_map)
-          {
-            memcpy (cloud_data + mapping.struct_offset, msg_data + mapping.serialized_offset, mapping.size);
-          }
-          cloud_data += sizeof (PointT);
-        }
+        const uint8_t* point_data = contiguous_rows ? msg_data + static_cast<size_t> (i) * msg.point_step :
+                                    msg_data + static_cast<size_t> (i / width) * msg.row_step + (i % width) * msg.point_step;
+        uint8_t* point = cloud_data + i * sizeof (PointT);
+        for (int m = 0; m < nr_mappings; ++m)
+          memcpy (point + mappings[m].struct_offset, point_data + mappings[m].serialized_offset, mappings[m].size);
       }
     }
   }
@@ -221,13 +293,15 @@ namespace pcl
   /** \brief Convert a PointCloud2 binary data blob into a pcl::PointCloud<T> object.
     * \param[in] msg the PointCloud2 binary blob
     * \param[out] cloud the resultant pcl::PointCloud<T>
+    * \note The mapping between the message fields and PointT is cached per field layout, so that
+    * messages with the same layout do not recreate it.
     */
   template<typename PointT> void 
   fromROSMsg (const sensor_msgs::PointCloud2& msg, pcl::PointCloud<PointT>& cloud)
   {
-    MsgFieldMap field_map;
-    createMapping<PointT> (msg.fields, field_map);
-    fromROSMsg (msg, cloud, field_map);
+    typename detail::FieldMapCache<PointT>::MsgFieldMapConstPtr field_map = 
+      detail::FieldMapCache<PointT>::get (msg.fields);
+    fromROSMsg (msg, cloud, *field_map);
   }
 
   /** \brief Convert a pcl::PointCloud<T> object to a PointCloud2 binary data blob.
@@ -44,6 +44,8 @@
 #include <pcl/point_cloud.h>
 
 #include "pcl/common/centroid.h"
+#include <pcl/common/norms.h>
+#include <pcl/common/descriptor_quantization.h>
 
 using namespace pcl;
 
@@ -923,6 +925,121 @@ TEST (PCL, CopyIfFieldExists)
   EXPECT_EQ (is_xx, false);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, DescriptorQuantization)
+{
+  srand (12345);
+  PointCloud<FPFHSignature33> fpfhs;
+  fpfhs.points.resize (10);
+  fpfhs.width = 10; fpfhs.height = 1; fpfhs.is_dense = true;
+  for (size_t i = 0; i < fpfhs.points.size (); ++i)
+    for (int d = 0; d < 33; ++d)
+      fpfhs.points[i].histogram[d] = 100.0f * rand () / RAND_MAX;
+
+  PointCloud<QuantizedFPFHSignature33> fpfhs_q;
+  quantizeDescriptors (fpfhs, fpfhs_q);
+  EXPECT_EQ (fpfhs_q.points.size (), fpfhs.points.size ());
+  EXPECT_EQ (fpfhs_q.width, fpfhs.width);
+  EXPECT_EQ (fpfhs_q.is_dense, true);
+
+  PointCloud<FPFHSignature33> fpfhs_dq;
+  dequantizeDescriptors (fpfhs_q, fpfhs_dq);
+  float step = QuantizedFPFHSignature33::quantizationStep ();
+  for (size_t i = 0; i < fpfhs.points.size (); ++i)
+    for (int d = 0; d < 33; ++d)
+      EXPECT_NEAR (fpfhs_dq.points[i].histogram[d], fpfhs.points[i].histogram[d], 0.5f * step + 1e-4);
+
+  // Non finite descriptors are zeroed and reported
+  fpfhs.points[3].histogram[7] = std::numeric_limits<float>::quiet_NaN ();
+  quantizeDescriptors (fpfhs, fpfhs_q);
+  EXPECT_EQ (fpfhs_q.is_dense, false);
+  for (int d = 0; d < 33; ++d)
+    EXPECT_EQ (fpfhs_q.points[3].histogram[d], 0);
+
+  SHOT shot;
+  shot.descriptor.resize (352);
+  for (int d = 0; d < 352; ++d)
+    shot.descriptor[d] = static_cast<float> (rand ()) / RAND_MAX;
+  QuantizedSHOT352 shot_q;
+  EXPECT_EQ (quantizeDescriptor (shot, shot_q), true);
+  SHOT shot_dq;
+  dequantizeDescriptor (shot_q, shot_dq);
+  EXPECT_EQ (shot_dq.descriptor.size (), 352);
+  for (int d = 0; d < 352; ++d)
+    EXPECT_NEAR (shot_dq.descriptor[d], shot.descriptor[d], 0.5f * QuantizedSHOT352::quantizationStep () + 1e-6);
+  shot.descriptor.resize (1344);
+  EXPECT_EQ (quantizeDescriptor (shot, shot_q), false);
+
+  // Bins outside of [0, 100] saturate
+  VFHSignature308 vfh;
+  for (int d = 0; d < 308; ++d)
+    vfh.histogram[d] = 50.0f;
+  vfh.histogram[0] = 250.0f;
+  vfh.histogram[1] = -3.0f;
+  QuantizedVFHSignature308 vfh_q;
+  EXPECT_EQ (quantizeDescriptor (vfh, vfh_q), true);
+  EXPECT_EQ (vfh_q.histogram[0], 255);
+  EXPECT_EQ (vfh_q.histogram[1], 0);
+  EXPECT_EQ (vfh_q.histogram[2], 128);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, DescriptorNorms)
+{
+  srand (12345);
+  const int sizes[] = {1, 5, 16, 33, 100, 308, 352};
+  for (size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+  {
+    const int dim = sizes[s];
+    std::vector<float> a (dim), b (dim);
+    std::vector<uint8_t> qa (dim), qb (dim);
+    for (int d = 0; d < dim; ++d)
+    {
+      a[d] = 100.0f * rand () / RAND_MAX;
+      b[d] = (d % 7 == 0) ? 0.0f : 100.0f * rand () / RAND_MAX;
+      qa[d] = static_cast<uint8_t> (rand () % 256);
+      qb[d] = (d % 7 == 0) ? 0 : static_cast<uint8_t> (rand () % 256);
+    }
+    // Empty bins on both sides must not contribute to the chi-squared distance
+    a[0] = 0.0f; qa[0] = 0;
+
+    double l1 = 0, l2 = 0, cs = 0;
+    int ql1 = 0, ql2 = 0;
+    double qcs = 0;
+    for (int d = 0; d < dim; ++d)
+    {
+      l1 += fabs (a[d] - b[d]);
+      l2 += (a[d] - b[d]) * (a[d] - b[d]);
+      if (a[d] + b[d] != 0)
+        cs += (a[d] - b[d]) * (a[d] - b[d]) / (a[d] + b[d]);
+      int diff = static_cast<int> (qa[d]) - static_cast<int> (qb[d]);
+      ql1 += abs (diff);
+      ql2 += diff * diff;
+      if (qa[d] + qb[d] != 0)
+        qcs += static_cast<double> (diff * diff) / (qa[d] + qb[d]);
+    }
+
+    EXPECT_NEAR (L1_Norm (&a[0], &b[0], dim), l1, 1e-5 * l1 + 1e-5);
+    EXPECT_NEAR (L2_Norm_SQR (&a[0], &b[0], dim), l2, 1e-5 * l2 + 1e-5);
+    EXPECT_NEAR (L2_Norm (&a[0], &b[0], dim), sqrt (l2), 1e-5 * sqrt (l2) + 1e-5);
+    EXPECT_NEAR (CS_Norm (&a[0], &b[0], dim), cs, 1e-5 * cs + 1e-5);
+    EXPECT_NEAR (selectNorm (&a[0], &b[0], dim, CS), cs, 1e-5 * cs + 1e-5);
+
+    EXPECT_EQ (L1_Norm (&qa[0], &qb[0], dim), ql1);
+    EXPECT_EQ (L2_Norm_SQR (&qa[0], &qb[0], dim), ql2);
+    EXPECT_NEAR (CS_Norm (&qa[0], &qb[0], dim), qcs, 1e-5 * qcs + 1e-5);
+
+    EXPECT_EQ (L1_Distance<uint8_t> () (&qa[0], &qb[0], dim), ql1);
+    EXPECT_EQ (L2_SQR_Distance<uint8_t> () (&qa[0], &qb[0], dim), ql2);
+    EXPECT_NEAR (CS_Distance<uint8_t> () (&qa[0], &qb[0], dim), qcs, 1e-5 * qcs + 1e-5);
+    EXPECT_NEAR (L2_SQR_Distance<float> () (&a[0], &b[0], dim), l2, 1e-5 * l2 + 1e-5);
+
+    // Partial distances may be returned once worst_dist is exceeded, but never below it
+    if (ql2 > 0)
+      EXPECT_GT (L2_SQR_Distance<uint8_t> () (&qa[0], &qb[0], dim, 0.5f), 0.5f);
+  }
+}
+
 //* ---[ */
 int
 main (int argc, char** argv)
@@ -42,6 +42,7 @@
 
 #include <pcl/point_types.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/shape_context_common.h>
 #include <boost/random.hpp>
 
 namespace pcl
@@ -96,6 +97,7 @@ namespace pcl
          */
        ShapeContext3DEstimation (bool random = false) :
          radii_interval_(0), theta_divisions_(0), phi_divisions_(0), volume_lut_(0),
+         radius_lut_ (), theta_lut_ (), phi_lut_ (), x_axis_seeds_ (), point_densities_ (),
          azimuth_bins_(12), elevation_bins_(11), radius_bins_(15), 
          min_radius_(0.1), point_density_radius_(0.2)
        {
@@ -164,7 +166,9 @@ namespace pcl
       getPointDensityRadius () { return (point_density_radius_); }
       
     protected:
-      /** \brief Initialize computation by allocating all the intervals and the volume lookup table. */
+      /** \brief Initialize computation by allocating all the intervals, the bin and volume lookup tables, and by
+        * drawing the random X axis directions of all the points.
+        */
       bool 
       initCompute ();
 
@@ -197,6 +201,21 @@ namespace pcl
       /** \brief Volumes look up table */
       std::vector<float> volume_lut_;
 
+      /** \brief Radius bin look up table */
+      pcl::detail::ShapeContextBinLUT radius_lut_;
+
+      /** \brief Elevation bin look up table */
+      pcl::detail::ShapeContextBinLUT theta_lut_;
+
+      /** \brief Azimuth bin look up table */
+      pcl::detail::ShapeContextBinLUT phi_lut_;
+
+      /** \brief The random numbers the X axis of every point is built from, 3 per point of indices_ */
+      std::vector<float> x_axis_seeds_;
+
+      /** \brief The local point density of every point of the surface, or -1 if not computed yet */
+      std::vector<int> point_densities_;
+
       /** \brief Bins along the azimuth dimension */
       size_t azimuth_bins_;
 
@@ -235,6 +254,25 @@ namespace pcl
       {
         return ((*rng_) ());
       }
+
+      /** \brief Get the local point density around a point of the surface (the number of points within
+        * \ref point_density_radius_), searching for it only the first time it is needed.
+        * \note Several threads may search for the density of the same point at once; they all store the same value.
+        * \param[in] index the index of the point in surface_
+        */
+      inline int
+      getPointDensity (int index)
+      {
+        int density = point_densities_[index];
+        if (density < 0)
+        {
+          std::vector<int> neighbour_indices;
+          std::vector<float> neighbour_distances;
+          density = searchForNeighbors (*surface_, index, point_density_radius_, neighbour_indices, neighbour_distances);
+          point_densities_[index] = density;
+        }
+        return (density);
+      }
     private:
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud 
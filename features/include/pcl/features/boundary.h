@@ -131,6 +131,25 @@ namespace pcl
                        const std::vector<int> &indices, 
                        const Eigen::Vector4f &u, const Eigen::Vector4f &v, const float angle_threshold);
 
+      /** \brief Check whether a point is a boundary point in a planar patch of projected points given by indices.
+        * This version does not allocate any memory once \a angles has grown to fit the largest neighborhood, and can
+        * be called from several threads as long as each of them passes its own buffer.
+        * \note A coordinate system u-v-n must be computed a-priori using \a getCoordinateSystemOnPlane
+        * \param[in] cloud a pointer to the input point cloud
+        * \param[in] q_point a pointer to the querry point
+        * \param[in] indices the estimated point neighbors of the query point
+        * \param[in] u the u direction
+        * \param[in] v the v direction
+        * \param[in] angle_threshold the threshold angle (default \f$\pi / 2.0\f$)
+        * \param[out] angles a scratch buffer for the angles of the neighbors around the query point
+        */
+      bool 
+      isBoundaryPoint (const pcl::PointCloud<PointInT> &cloud, 
+                       const PointInT &q_point, 
+                       const std::vector<int> &indices, 
+                       const Eigen::Vector4f &u, const Eigen::Vector4f &v, const float angle_threshold,
+                       std::vector<float> &angles) const;
+
       /** \brief Set the decision boundary (angle threshold) that marks points as boundary or regular. 
         * (default \f$\pi / 2.0\f$) 
         * \param[in] angle the angle threshold
@@ -155,7 +174,7 @@ namespace pcl
         */
       inline void 
       getCoordinateSystemOnPlane (const PointNT &p_coeff, 
-                                  Eigen::Vector4f &u, Eigen::Vector4f &v)
+                                  Eigen::Vector4f &u, Eigen::Vector4f &v) const
       {
         pcl::Vector4fMapConst p_coeff_v = p_coeff.getNormalVector4fMap ();
         v = p_coeff_v.unitOrthogonal ();
@@ -57,6 +57,9 @@ namespace pcl
     *
     * The suggested PointOutT is pcl::VFHSignature308.
     *
+    * To describe many clusters of the same cloud at once, use \ref computeClusters, which shares the input cloud,
+    * normals and spatial locator between all clusters and processes them on \ref setNumberOfThreads threads.
+    *
     * \author Aitor Aldoma
     * \ingroup features
     */
@@ -81,7 +84,7 @@ namespace pcl
       CVFHEstimation () :
         vpx_ (0), vpy_ (0), vpz_ (0), 
         leaf_size_ (0.005), curv_threshold_ (0.03), 
-        cluster_tolerance_ (leaf_size_ * 3), eps_angle_threshold_ (0.125), min_points_ (50)
+        cluster_tolerance_ (leaf_size_ * 3), eps_angle_threshold_ (0.125), min_points_ (50), threads_ (1)
       {
         search_radius_ = 0;
         k_ = 1;
@@ -193,6 +196,35 @@ namespace pcl
         min_points_ = min;
       }
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads used by computeClusters (). */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
+      /** \brief Estimate the CVFH signatures of each of the given clusters of the search surface, in parallel. The
+        * spatial locator is built once on the whole surface and shared by all clusters, and so are the input normals.
+        * The centroids and normals of all dominant regions are available afterwards through getCentroidClusters ()
+        * and getCentroidNormalClusters (), in the order of the concatenated signatures.
+        * \param[in] clusters the indices of the points of each cluster in the search surface (the input cloud if
+        * no surface was given)
+        * \param[out] output the resultant CVFH signatures of each cluster, empty for clusters with less than 2 points
+        */
+      void
+      computeClusters (const std::vector<pcl::PointIndices> &clusters, std::vector<PointCloudOut> &output);
+
       /** \brief Sets wether if the CVFH signatures should be normalized or not
         * \param[in] normalize true if normalization is required, false otherwise 
         */
@@ -233,6 +265,9 @@ namespace pcl
       /** \brief Radius for the normals computation. */
       float radius_normals_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Estimate the Clustered Viewpoint Feature Histograms (CVFH) descriptors at 
         * a set of points given by <setInputCloud (), setIndices ()> using the surface in
         * setSearchSurface ()
@@ -243,13 +278,30 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output);
 
+      /** \brief Estimate the CVFH signatures of the object made of the given points of the search surface. Does not
+        * touch any member state, so that several objects can be described at once.
+        * \param[in] indices the indices of the points of the object in the search surface
+        * \param[in] tree the spatial locator of the whole search surface
+        * \param[in,out] local_indices scratch buffer as large as the search surface and filled with -1, which is
+        * left in the same state on return
+        * \param[out] output the resultant CVFH signatures
+        * \param[out] centroids the centroids of the dominant regions the signatures were computed for
+        * \param[out] normals the normal centroids of the dominant regions the signatures were computed for
+        */
+      void
+      computeCVFH (const std::vector<int> &indices, const pcl::search::Search<PointInT> &tree,
+                   std::vector<int> &local_indices, PointCloudOut &output,
+                   std::vector<Eigen::Vector3f> &centroids, std::vector<Eigen::Vector3f> &normals) const;
+
       /** \brief Region growing method using Euclidean distances and neighbors normals to 
         * add points to a region.
         * \param[in] cloud point cloud to split into regions
-        * \param[in] normals are the normals of cloud
+        * \param[in] surface_indices the index of each point of \a cloud in the search surface
+        * \param[in] local_indices the index of each point of the search surface in \a cloud, or -1 if it is not part
+        * of it
+        * \param[in] tree is the spatial search structure of the search surface for nearest neighbour search
         * \param[in] tolerance is the allowed Euclidean distance between points to be added to
         * the cluster
-        * \param[in] tree is the spatial search structure for nearest neighbour search
         * \param[out] clusters vector of indices representing the clustered regions
         * \param[in] eps_angle deviation of the normals between two points so they can be
         * clustered together
@@ -258,11 +310,12 @@ namespace pcl
         */
       void
       extractEuclideanClustersSmooth (const pcl::PointCloud<pcl::PointNormal> &cloud,
-                                      const pcl::PointCloud<pcl::PointNormal> &normals, float tolerance,
-                                      const pcl::search::Search<pcl::PointNormal>::Ptr &tree,
+                                      const std::vector<int> &surface_indices,
+                                      const std::vector<int> &local_indices,
+                                      const pcl::search::Search<PointInT> &tree, float tolerance,
                                       std::vector<pcl::PointIndices> &clusters, double eps_angle,
                                       unsigned int min_pts_per_cluster = 1,
-                                      unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
+                                      unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ()) const;
 
     protected:
       /** \brief Centroids that were used to compute different CVFH descriptors */
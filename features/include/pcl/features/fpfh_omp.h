@@ -46,6 +46,11 @@ namespace pcl
   /** \brief FPFHEstimationOMP estimates the Fast Point Feature Histogram (FPFH) descriptor for a given point cloud
     * dataset containing points and normals, in parallel, using the OpenMP standard.
     *
+    * The neighborhood of every query point is searched only once and kept in compressed sparse row form. The
+    * points that need an SPFH signature are marked from these neighborhoods, and when the input cloud is also
+    * the search surface their own neighborhoods are reused instead of being searched again. Both the SPFH and
+    * the weighting phase then run in parallel with per-thread buffers.
+    *
     * \note If you use this code in any academic work, please cite:
     *
     *   - R.B. Rusu, N. Blodow, M. Beetz.
@@ -112,7 +117,21 @@ namespace pcl
         threads_ = nr_threads; 
       }
 
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     private:
+      /** \brief Search the neighborhood of every point in <setInputCloud (), setIndices ()> once, and store all
+        * of them back to back. The neighbors of the query at position idx in indices_ are in
+        * [nn_offsets[idx], nn_offsets[idx + 1]); points that are not finite or have no neighbors get an empty range.
+        * \param[out] nn_offsets the offset of every neighborhood in \a nn_indices and \a nn_dists
+        * \param[out] nn_indices the neighbor indices of all the queries, into the search surface
+        * \param[out] nn_dists the squared distances of all the neighbors to their query
+        */
+      void
+      computeNeighborhoods (std::vector<size_t> &nn_offsets, std::vector<int> &nn_indices, std::vector<float> &nn_dists);
+
       /** \brief Estimate the Fast Point Feature Histograms (FPFH) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
         * setSearchMethod ()
@@ -123,6 +123,18 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::initCompute ()
       }
     }
   }
+
+  // Bin look up tables, with a few cells per bin
+  radius_lut_.init (radii_interval_, 8 * radius_bins_);
+  theta_lut_.init (theta_divisions_, 4 * elevation_bins_);
+  phi_lut_.init (phi_divisions_, 4 * azimuth_bins_);
+
+  // Draw the X axes up front, so that they do not depend on the order the points are processed in
+  x_axis_seeds_.resize (indices_->size () * 3);
+  for (size_t i = 0; i < x_axis_seeds_.size (); ++i)
+    x_axis_seeds_[i] = static_cast<float> (rnd ());
+
+  point_densities_.assign (surface_->points.size (), -1);
   return (true);
 }
 
@@ -167,9 +179,9 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
   normal = normals[minIndex].getNormalVector3fMap ();
 
   // Compute and store the RF direction
-  x_axis[0] = rnd ();
-  x_axis[1] = rnd ();
-  x_axis[2] = rnd ();
+  x_axis[0] = x_axis_seeds_[index * 3 + 0];
+  x_axis[1] = x_axis_seeds_[index * 3 + 1];
+  x_axis[2] = x_axis_seeds_[index * 3 + 2];
   if (!pcl::utils::equal (normal[2], 0.0f))
     x_axis[2] = - (normal[0]*x_axis[0] + normal[1]*x_axis[1]) / normal[2];
   else if (!pcl::utils::equal (normal[1], 0.0f))
@@ -215,43 +227,13 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
     float theta = normal.dot (no);
     theta = pcl::rad2deg (acos (std::min (1.0f, std::max (-1.0f, theta))));
 
-    // Bin (j, k, l)
-    size_t j = 0;
-    size_t k = 0;
-    size_t l = 0;
-
     // Compute the Bin(j, k, l) coordinates of current neighbour
-    for (size_t rad = 1; rad < radius_bins_+1; rad++) 
-    {
-      if (r <= radii_interval_[rad]) 
-      {
-        j = rad-1;
-        break;
-      }
-    }
-
-    for (size_t ang = 1; ang < elevation_bins_+1; ang++) 
-    {
-      if (theta <= theta_divisions_[ang]) 
-      {
-        k = ang-1;
-        break;
-      }
-    }
-
-    for (size_t ang = 1; ang < azimuth_bins_+1; ang++) 
-    {
-      if (phi <= phi_divisions_[ang]) 
-      {
-        l = ang-1;
-        break;
-      }
-    }
+    size_t j = radius_lut_.find (r);
+    size_t k = theta_lut_.find (theta);
+    size_t l = phi_lut_.find (phi);
 
     // Local point density = number of points in a sphere of radius "point_density_radius_" around the current neighbour
-    std::vector<int> neighbour_indices;
-    std::vector<float> neighbour_distances;
-    int point_density = searchForNeighbors (*surface_, nn_indices[ne], point_density_radius_, neighbour_indices, neighbour_distances);
+    int point_density = getPointDensity (nn_indices[ne]);
     // point_density is NOT always bigger than 0 (on error, searchForNeighbors returns 0), so we must check for that
     if (point_density == 0)
       continue;
@@ -0,0 +1,76 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_3DSC_OMP_HPP_
+#define PCL_FEATURES_IMPL_3DSC_OMP_HPP_
+
+#include "pcl/features/3dsc_omp.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const int nr_points = static_cast<int> (indices_->size ());
+
+  bool is_dense = true;
+  // Iterate over all points and compute the descriptors. The descriptor of every point is its own histogram, so
+  // the threads share nothing but the point density cache
+#pragma omp parallel for schedule (dynamic, 32) num_threads (threads_) reduction (&& : is_dense)
+  for (int point_index = 0; point_index < nr_points; ++point_index)
+  {
+    output[point_index].descriptor.assign (descriptor_length_, 0.0f);
+
+    // If the point is not finite, set the descriptor to NaN and continue
+    if (!isFinite ((*input_)[(*indices_)[point_index]]))
+    {
+      for (size_t i = 0; i < descriptor_length_; ++i)
+        output[point_index].descriptor[i] = std::numeric_limits<float>::quiet_NaN ();
+
+      memset (output[point_index].rf, 0, sizeof (output[point_index].rf[0]) * 9);
+      is_dense = false;
+      continue;
+    }
+
+    if (!this->computePoint (point_index, *normals_, output[point_index].rf, output[point_index].descriptor))
+      is_dense = false;
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_ShapeContext3DEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::ShapeContext3DEstimationOMP<T,NT,OutT>;
+
+#endif    // PCL_FEATURES_IMPL_3DSC_OMP_HPP_
@@ -42,6 +42,7 @@
 
 #include "pcl/features/boundary.h"
 #include <cfloat>
+#include <algorithm>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> bool
@@ -61,6 +62,18 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::isBoundaryPoint (
       const std::vector<int> &indices, 
       const Eigen::Vector4f &u, const Eigen::Vector4f &v, 
       const float angle_threshold)
+{
+  std::vector<float> angles;
+  return (isBoundaryPoint (cloud, q_point, indices, u, v, angle_threshold, angles));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::isBoundaryPoint (
+      const pcl::PointCloud<PointInT> &cloud, const PointInT &q_point, 
+      const std::vector<int> &indices, 
+      const Eigen::Vector4f &u, const Eigen::Vector4f &v, 
+      const float angle_threshold, std::vector<float> &angles) const
 {
   if (indices.size () < 3)
     return (false);
@@ -68,9 +81,12 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::isBoundaryPoint (
   if (!pcl_isfinite (q_point.x) || !pcl_isfinite (q_point.y) || !pcl_isfinite (q_point.z))
     return (false);
 
+  // The buffer holds the angles, followed by the smallest and the largest angle of each bucket used below
+  if (angles.size () < 3 * indices.size ())
+    angles.resize (3 * indices.size ());
+
   // Compute the angles between each neighboring point and the query point itself
-  std::vector<float> angles (indices.size ());
-  float max_dif = FLT_MIN, dif;
+  float min_angle = FLT_MAX, max_angle = -FLT_MAX;
   int cp = 0;
 
   for (size_t i = 0; i < indices.size (); ++i)
@@ -82,31 +98,48 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::isBoundaryPoint (
 
     Eigen::Vector4f delta = cloud.points[indices[i]].getVector4fMap () - q_point.getVector4fMap ();
 
-    angles[cp++] = atan2f (v.dot (delta), u.dot (delta)); // the angles are fine between -PI and PI too
+    const float angle = atan2f (v.dot (delta), u.dot (delta)); // the angles are fine between -PI and PI too
+    angles[cp++] = angle;
+    min_angle = (std::min) (min_angle, angle);
+    max_angle = (std::max) (max_angle, angle);
   }
   if (cp == 0)
     return (false);
 
-  angles.resize (cp);
-  std::sort (angles.begin (), angles.end ());
+  // Get the angle difference between the last and the first
+  float max_dif = static_cast<float> (2 * M_PI - max_angle + min_angle);
+  if (max_dif > angle_threshold)
+    return (true);
+  if (max_angle == min_angle)
+    return (false);
+
+  // The largest difference between two consecutive angles is at least (max_angle - min_angle) / (cp - 1). Putting the
+  // angles into cp buckets of that width means it can never lie within a bucket, so instead of sorting all the angles
+  // it is enough to compare the largest angle of every bucket with the smallest angle of the next non-empty one
+  float *bucket_min = &angles[cp], *bucket_max = &angles[2 * cp];
+  std::fill (bucket_min, bucket_min + cp, FLT_MAX);
+  std::fill (bucket_max, bucket_max + cp, -FLT_MAX);
+  const float range = max_angle - min_angle;
+  for (int i = 0; i < cp; ++i)
+  {
+    const int bucket = (std::min) (static_cast<int> ((angles[i] - min_angle) / range * static_cast<float> (cp - 1)), cp - 1);
+    bucket_min[bucket] = (std::min) (bucket_min[bucket], angles[i]);
+    bucket_max[bucket] = (std::max) (bucket_max[bucket], angles[i]);
+  }
 
   // Compute the maximal angle difference between two consecutive angles
-  for (size_t i = 0; i < angles.size () - 1; ++i)
+  max_dif = 0.0f;
+  float previous_max = bucket_max[0];
+  for (int bucket = 1; bucket < cp; ++bucket)
   {
-    dif = angles[i + 1] - angles[i];
-    if (max_dif < dif)
-      max_dif = dif;
+    if (bucket_min[bucket] > bucket_max[bucket])
+      continue;
+    max_dif = (std::max) (max_dif, bucket_min[bucket] - previous_max);
+    previous_max = bucket_max[bucket];
   }
-  // Get the angle difference between the last and the first
-  dif = 2 * M_PI - angles[angles.size () - 1] + angles[0];
-  if (max_dif < dif)
-    max_dif = dif;
 
   // Check results
-  if (max_dif > angle_threshold)
-    return (true);
-  else
-    return (false);
+  return (max_dif > angle_threshold);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -119,6 +152,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointClou
   std::vector<float> nn_dists (k_);
 
   Eigen::Vector4f u = Eigen::Vector4f::Zero (), v = Eigen::Vector4f::Zero ();
+  std::vector<float> angles;
 
   output.is_dense = true;
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
@@ -140,7 +174,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointClou
       getCoordinateSystemOnPlane (normals_->points[(*indices_)[idx]], u, v);
 
       // Estimate whether the point is lying on a boundary surface or not
-      output.points[idx].boundary_point = isBoundaryPoint (*surface_, input_->points[(*indices_)[idx]], nn_indices, u, v, angle_threshold_);
+      output.points[idx].boundary_point = isBoundaryPoint (*surface_, input_->points[(*indices_)[idx]], nn_indices, u, v, angle_threshold_, angles);
     }
   }
   else
@@ -162,7 +196,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointClou
       getCoordinateSystemOnPlane (normals_->points[(*indices_)[idx]], u, v);
 
       // Estimate whether the point is lying on a boundary surface or not
-      output.points[idx].boundary_point = isBoundaryPoint (*surface_, input_->points[(*indices_)[idx]], nn_indices, u, v, angle_threshold_);
+      output.points[idx].boundary_point = isBoundaryPoint (*surface_, input_->points[(*indices_)[idx]], nn_indices, u, v, angle_threshold_, angles);
     }
   }
 }
@@ -177,6 +211,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen
   std::vector<float> nn_dists (k_);
 
   Eigen::Vector4f u = Eigen::Vector4f::Zero (), v = Eigen::Vector4f::Zero ();
+  std::vector<float> angles;
 
   output.is_dense = true;
   output.points.resize (indices_->size (), 1);
@@ -199,7 +234,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen
       this->getCoordinateSystemOnPlane (normals_->points[(*indices_)[idx]], u, v);
 
       // Estimate whether the point is lying on a boundary surface or not
-      output.points (idx, 0) = this->isBoundaryPoint (*surface_, input_->points[(*indices_)[idx]], nn_indices, u, v, angle_threshold_);
+      output.points (idx, 0) = this->isBoundaryPoint (*surface_, input_->points[(*indices_)[idx]], nn_indices, u, v, angle_threshold_, angles);
     }
   }
   else
@@ -221,7 +256,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen
       this->getCoordinateSystemOnPlane (normals_->points[(*indices_)[idx]], u, v);
 
       // Estimate whether the point is lying on a boundary surface or not
-      output.points (idx, 0) = this->isBoundaryPoint (*surface_, input_->points[(*indices_)[idx]], nn_indices, u, v, angle_threshold_);
+      output.points (idx, 0) = this->isBoundaryPoint (*surface_, input_->points[(*indices_)[idx]], nn_indices, u, v, angle_threshold_, angles);
     }
   }
 }
@@ -47,22 +47,18 @@
 template<typename PointInT, typename PointNT, typename PointOutT> void
 pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::extractEuclideanClustersSmooth (
     const pcl::PointCloud<pcl::PointNormal> &cloud,
-    const pcl::PointCloud<pcl::PointNormal> &normals,
+    const std::vector<int> &surface_indices,
+    const std::vector<int> &local_indices,
+    const pcl::search::Search<PointInT> &tree,
     float tolerance,
-    const pcl::search::Search<pcl::PointNormal>::Ptr &tree,
     std::vector<pcl::PointIndices> &clusters,
     double eps_angle,
     unsigned int min_pts_per_cluster,
-    unsigned int max_pts_per_cluster)
+    unsigned int max_pts_per_cluster) const
 {
-  if (tree->getInputCloud ()->points.size () != cloud.points.size ())
+  if (cloud.points.size () != surface_indices.size ())
   {
-    PCL_ERROR ("[pcl::extractEuclideanClusters] Tree built for a different point cloud dataset (%lu) than the input cloud (%lu)!\n", (unsigned long)tree->getInputCloud ()->points.size (), (unsigned long)cloud.points.size ());
-    return;
-  }
-  if (cloud.points.size () != normals.points.size ())
-  {
-    PCL_ERROR ("[pcl::extractEuclideanClusters] Number of points in the input point cloud (%lu) different than normals (%lu)!\n", (unsigned long)cloud.points.size (), (unsigned long)normals.points.size ());
+    PCL_ERROR ("[pcl::extractEuclideanClusters] Number of points in the input point cloud (%lu) different than indices (%lu)!\n", (unsigned long)cloud.points.size (), (unsigned long)surface_indices.size ());
     return;
   }
 
@@ -85,29 +81,28 @@ pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::extractEuclideanClustersSmoot
 
     while (sq_idx < (int)seed_queue.size ())
     {
-      // Search for sq_idx
-      if (!tree->radiusSearch (seed_queue[sq_idx], tolerance, nn_indices, nn_distances))
+      // Search for sq_idx in the whole surface, the neighbors outside of cloud are skipped below
+      if (!tree.radiusSearch (surface_indices[seed_queue[sq_idx]], tolerance, nn_indices, nn_distances))
       {
         sq_idx++;
         continue;
       }
 
-      for (size_t j = 1; j < nn_indices.size (); ++j) // nn_indices[0] should be sq_idx
+      for (size_t j = 0; j < nn_indices.size (); ++j)
       {
-        if (processed[nn_indices[j]]) // Has this point been processed before ?
+        int nn_index = local_indices[nn_indices[j]];
+        if (nn_index < 0 || processed[nn_index]) // Not in cloud or processed before ?
           continue;
 
-        //processed[nn_indices[j]] = true;
         // [-1;1]
-
-        double dot_p = normals.points[seed_queue[sq_idx]].normal[0] * normals.points[nn_indices[j]].normal[0]
-                     + normals.points[seed_queue[sq_idx]].normal[1] * normals.points[nn_indices[j]].normal[1]
-                     + normals.points[seed_queue[sq_idx]].normal[2] * normals.points[nn_indices[j]].normal[2];
+        double dot_p = cloud.points[seed_queue[sq_idx]].normal[0] * cloud.points[nn_index].normal[0]
+                     + cloud.points[seed_queue[sq_idx]].normal[1] * cloud.points[nn_index].normal[1]
+                     + cloud.points[seed_queue[sq_idx]].normal[2] * cloud.points[nn_index].normal[2];
 
         if (fabs (acos (dot_p)) < eps_angle)
         {
-          processed[nn_indices[j]] = true;
-          seed_queue.push_back (nn_indices[j]);
+          processed[nn_index] = true;
+          seed_queue.push_back (nn_index);
         }
       }
 
@@ -165,107 +160,71 @@ pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::filterNormalsWithHighCurvatur
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointNT, typename PointOutT> void
-pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeCVFH (const std::vector<int> &indices,
+                                                                const pcl::search::Search<PointInT> &tree,
+                                                                std::vector<int> &local_indices,
+                                                                PointCloudOut &output,
+                                                                std::vector<Eigen::Vector3f> &centroids,
+                                                                std::vector<Eigen::Vector3f> &normals) const
 {
-  // Check if input was set
-  if (!normals_)
-  {
-    PCL_ERROR ("[pcl::%s::computeFeature] No input dataset containing normals was given!\n", getClassName ().c_str ());
-    output.width = output.height = 0;
-    output.points.clear ();
-    return;
-  }
-  if (normals_->points.size () != surface_->points.size ())
-  {
-    PCL_ERROR ("[pcl::%s::computeFeature] The number of points in the input dataset differs from the number of points in the dataset containing the normals!\n", getClassName ().c_str ());
-    output.width = output.height = 0;
-    output.points.clear ();
-    return;
-  }
-
-  centroids_dominant_orientations_.clear ();
-
   // ---[ Step 0: remove normals with high curvature
-  float curv_threshold = curv_threshold_;
-  std::vector<int> indices_out;
   std::vector<int> indices_in;
-  filterNormalsWithHighCurvature (*normals_, indices_out, indices_in, curv_threshold);
+  indices_in.reserve (indices.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    if (!(normals_->points[indices[i]].curvature > curv_threshold_))
+      indices_in.push_back (indices[i]);
 
-  pcl::PointCloud<pcl::PointNormal>::Ptr filtered (new pcl::PointCloud<pcl::PointNormal> ());
+  // ---[ Step 1a : compute clustering
+  const std::vector<int> &region_indices = (indices_in.size () >= 100) ? indices_in : indices; //TODO: parameter
 
-  filtered->width = indices_in.size ();
-  filtered->height = 1;
-  filtered->points.resize (filtered->width);
+  pcl::PointCloud<pcl::PointNormal> normals_filtered_cloud;
+  normals_filtered_cloud.width = region_indices.size ();
+  normals_filtered_cloud.height = 1;
+  normals_filtered_cloud.points.resize (normals_filtered_cloud.width);
 
-  for (size_t i = 0; i < indices_in.size (); ++i)
+  for (size_t i = 0; i < region_indices.size (); ++i)
   {
-    filtered->points[i].x = surface_->points[indices_in[i]].x;
-    filtered->points[i].y = surface_->points[indices_in[i]].y;
-    filtered->points[i].z = surface_->points[indices_in[i]].z;
-
-    filtered->points[i].normal[0] = normals_->points[indices_in[i]].normal[0];
-    filtered->points[i].normal[1] = normals_->points[indices_in[i]].normal[1];
-    filtered->points[i].normal[2] = normals_->points[indices_in[i]].normal[2];
+    normals_filtered_cloud.points[i].x = surface_->points[region_indices[i]].x;
+    normals_filtered_cloud.points[i].y = surface_->points[region_indices[i]].y;
+    normals_filtered_cloud.points[i].z = surface_->points[region_indices[i]].z;
+    local_indices[region_indices[i]] = i;
   }
 
-  // ---[ Step 1a : compute clustering
-  pcl::PointCloud<pcl::PointNormal>::Ptr normals_filtered_cloud (new pcl::PointCloud<pcl::PointNormal> ());
-  if (indices_in.size () >= 100) //TODO: parameter
-  {
-    normals_filtered_cloud->width = indices_in.size ();
-    normals_filtered_cloud->height = 1;
-    normals_filtered_cloud->points.resize (normals_filtered_cloud->width);
-
-    for (size_t i = 0; i < indices_in.size (); ++i)
-    {
-      normals_filtered_cloud->points[i].x = surface_->points[indices_in[i]].x;
-      normals_filtered_cloud->points[i].y = surface_->points[indices_in[i]].y;
-      normals_filtered_cloud->points[i].z = surface_->points[indices_in[i]].z;
-
-      normals_filtered_cloud->points[i].normal[0] = normals_->points[indices_in[i]].normal[0];
-      normals_filtered_cloud->points[i].normal[1] = normals_->points[indices_in[i]].normal[1];
-      normals_filtered_cloud->points[i].normal[2] = normals_->points[indices_in[i]].normal[2];
-    }
-  }
-  else
+  //recompute normals normals and use them for clustering! The neighbors are searched in the whole surface and
+  //restricted to the points taking part in the clustering
+  std::vector<int> nn_indices, nn_local_indices;
+  std::vector<float> nn_dists;
+  Eigen::Vector4f plane_parameters;
+  for (size_t i = 0; i < region_indices.size (); ++i)
   {
-    normals_filtered_cloud->width = surface_->size ();
-    normals_filtered_cloud->height = 1;
-    normals_filtered_cloud->points.resize (normals_filtered_cloud->width);
-
-    for (size_t i = 0; i < surface_->size (); ++i)
+    pcl::PointNormal &point = normals_filtered_cloud.points[i];
+    tree.radiusSearch (region_indices[i], radius_normals_, nn_indices, nn_dists);
+    nn_local_indices.clear ();
+    for (size_t j = 0; j < nn_indices.size (); ++j)
+      if (local_indices[nn_indices[j]] >= 0)
+        nn_local_indices.push_back (local_indices[nn_indices[j]]);
+
+    if (nn_local_indices.empty ())
     {
-      normals_filtered_cloud->points[i].x = surface_->points[i].x;
-      normals_filtered_cloud->points[i].y = surface_->points[i].y;
-      normals_filtered_cloud->points[i].z = surface_->points[i].z;
-
-      normals_filtered_cloud->points[i].normal[0] = normals_->points[i].normal[0];
-      normals_filtered_cloud->points[i].normal[1] = normals_->points[i].normal[1];
-      normals_filtered_cloud->points[i].normal[2] = normals_->points[i].normal[2];
+      point.normal[0] = point.normal[1] = point.normal[2] = point.curvature = std::numeric_limits<float>::quiet_NaN ();
+      continue;
     }
+    computePointNormal (normals_filtered_cloud, nn_local_indices, plane_parameters, point.curvature);
+    point.normal[0] = plane_parameters[0];
+    point.normal[1] = plane_parameters[1];
+    point.normal[2] = plane_parameters[2];
+    flipNormalTowardsViewpoint (point, 0.0f, 0.0f, 0.0f, point.normal[0], point.normal[1], point.normal[2]);
   }
 
-  //recompute normals normals and use them for clustering!
-  KdTreePtr normals_tree_filtered (new pcl::search::KdTree<pcl::PointNormal> (false));
-  normals_tree_filtered->setInputCloud (normals_filtered_cloud);
-
-  NormalEstimator n3d;
-  n3d.setRadiusSearch (radius_normals_);
-  n3d.setSearchMethod (normals_tree_filtered);
-  n3d.setInputCloud (normals_filtered_cloud);
-  n3d.compute (*normals_filtered_cloud);
-
-  KdTreePtr normals_tree (new pcl::search::KdTree<pcl::PointNormal> (false));
-  normals_tree->setInputCloud (normals_filtered_cloud);
   std::vector<pcl::PointIndices> clusters;
-
-  extractEuclideanClustersSmooth (*normals_filtered_cloud, *normals_filtered_cloud, cluster_tolerance_, normals_tree,
+  extractEuclideanClustersSmooth (normals_filtered_cloud, region_indices, local_indices, tree, cluster_tolerance_,
                                   clusters, eps_angle_threshold_, min_points_);
 
+  // Leave the scratch buffer as we found it
+  for (size_t i = 0; i < region_indices.size (); ++i)
+    local_indices[region_indices[i]] = -1;
+
   VFHEstimator vfh;
-  vfh.setInputCloud (surface_);
-  vfh.setInputNormals (normals_);
-  vfh.setSearchMethod (this->tree_);
   vfh.setUseGivenNormal (true);
   vfh.setUseGivenCentroid (true);
   vfh.setNormalizeBins (normalize_bins_);
@@ -273,10 +232,14 @@ pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   vfh.setFillSizeComponent (true);
   output.height = 1;
 
+  pcl::VFHSignature308 vfh_signature;
   // ---[ Step 1b : check if any dominant cluster was found
   if (clusters.size () > 0)
   { // ---[ Step 1b.1 : If yes, compute CVFH using the cluster information
 
+    output.points.resize (clusters.size ());
+    output.width = clusters.size ();
+
     for (size_t i = 0; i < clusters.size (); ++i) //for each cluster
     {
       Eigen::Vector4f avg_normal = Eigen::Vector4f::Zero ();
@@ -284,60 +247,127 @@ pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
 
       for (size_t j = 0; j < clusters[i].indices.size (); j++)
       {
-        avg_normal += normals_filtered_cloud->points[clusters[i].indices[j]].getNormalVector4fMap ();
-        avg_centroid += normals_filtered_cloud->points[clusters[i].indices[j]].getVector4fMap ();
+        avg_normal += normals_filtered_cloud.points[clusters[i].indices[j]].getNormalVector4fMap ();
+        avg_centroid += normals_filtered_cloud.points[clusters[i].indices[j]].getVector4fMap ();
       }
 
       avg_normal /= clusters[i].indices.size ();
       avg_centroid /= clusters[i].indices.size ();
-
-      Eigen::Vector4f centroid_test;
-      pcl::compute3DCentroid (*normals_filtered_cloud, centroid_test);
       avg_normal.normalize ();
 
       Eigen::Vector3f avg_norm (avg_normal[0], avg_normal[1], avg_normal[2]);
       Eigen::Vector3f avg_dominant_centroid (avg_centroid[0], avg_centroid[1], avg_centroid[2]);
 
       //append normal and centroid for the clusters
-      dominant_normals_.push_back (avg_norm);
-      centroids_dominant_orientations_.push_back (avg_dominant_centroid);
-    }
-
-    //compute modified VFH for all dominant clusters and add them to the list!
-    output.points.resize (dominant_normals_.size ());
-    output.width = dominant_normals_.size ();
-
-    for (size_t i = 0; i < dominant_normals_.size (); ++i)
-    {
-      //configure VFH computation for CVFH
-      vfh.setNormalToUse (dominant_normals_[i]);
-      vfh.setCentroidToUse (centroids_dominant_orientations_[i]);
-      pcl::PointCloud<pcl::VFHSignature308> vfh_signature;
-      vfh.compute (vfh_signature);
-      output.points[i] = vfh_signature.points[0];
+      normals.push_back (avg_norm);
+      centroids.push_back (avg_dominant_centroid);
+
+      //compute modified VFH for the dominant cluster
+      vfh.computeSignature (Eigen::Vector4f (avg_dominant_centroid[0], avg_dominant_centroid[1], avg_dominant_centroid[2], 0),
+                            Eigen::Vector4f (avg_norm[0], avg_norm[1], avg_norm[2], 0),
+                            *surface_, *normals_, indices, vfh_signature);
+      output.points[i] = vfh_signature;
     }
   }
   else
   { // ---[ Step 1b.1 : If no, compute CVFH using all the object points
     Eigen::Vector4f avg_centroid;
-    pcl::compute3DCentroid (*surface_, avg_centroid);
+    pcl::compute3DCentroid (*surface_, indices, avg_centroid);
     Eigen::Vector3f cloud_centroid (avg_centroid[0], avg_centroid[1], avg_centroid[2]);
-    centroids_dominant_orientations_.push_back (cloud_centroid);
+    centroids.push_back (cloud_centroid);
 
     //configure VFH computation for CVFH using all object points
     vfh.setCentroidToUse (cloud_centroid);
     vfh.setUseGivenNormal (false);
-
-    pcl::PointCloud<pcl::VFHSignature308> vfh_signature;
-    vfh.compute (vfh_signature);
+    vfh.computeSignature (*surface_, *normals_, indices, vfh_signature);
 
     output.points.resize (1);
     output.width = 1;
 
-    output.points[0] = vfh_signature.points[0];
+    output.points[0] = vfh_signature;
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT> void
+pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  // Check if input was set
+  if (!normals_)
+  {
+    PCL_ERROR ("[pcl::%s::computeFeature] No input dataset containing normals was given!\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+  if (normals_->points.size () != surface_->points.size ())
+  {
+    PCL_ERROR ("[pcl::%s::computeFeature] The number of points in the input dataset differs from the number of points in the dataset containing the normals!\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
+  centroids_dominant_orientations_.clear ();
+  dominant_normals_.clear ();
+
+  // The whole surface makes up the object
+  std::vector<int> indices (surface_->points.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    indices[i] = (int) i;
+  std::vector<int> local_indices (surface_->points.size (), -1);
+
+  computeCVFH (indices, *this->tree_, local_indices, output, centroids_dominant_orientations_, dominant_normals_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT> void
+pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeClusters (const std::vector<pcl::PointIndices> &clusters,
+                                                                    std::vector<PointCloudOut> &output)
+{
+  // Set up the search surface and the spatial locator once for all clusters
+  if (!this->initCompute ())
+  {
+    output.clear ();
+    return;
+  }
+
+  centroids_dominant_orientations_.clear ();
+  dominant_normals_.clear ();
+  output.resize (clusters.size ());
+  std::vector<std::vector<Eigen::Vector3f> > centroids (clusters.size ()), normals (clusters.size ());
+
+#pragma omp parallel num_threads (threads_)
+  {
+    // Per thread map from the search surface to the points of the current cluster
+    std::vector<int> local_indices (surface_->points.size (), -1);
+
+#pragma omp for schedule (dynamic, 1)
+    for (int cluster_i = 0; cluster_i < (int) clusters.size (); ++cluster_i)
+    {
+      PointCloudOut &cluster_output = output[cluster_i];
+      cluster_output.header = this->input_->header;
+      if (clusters[cluster_i].indices.size () < 2)
+      {
+        cluster_output.width = cluster_output.height = 0;
+        cluster_output.points.clear ();
+        continue;
+      }
+      computeCVFH (clusters[cluster_i].indices, *this->tree_, local_indices, cluster_output,
+                   centroids[cluster_i], normals[cluster_i]);
+    }
+  }
+
+  for (size_t cluster_i = 0; cluster_i < clusters.size (); ++cluster_i)
+  {
+    centroids_dominant_orientations_.insert (centroids_dominant_orientations_.end (),
+                                             centroids[cluster_i].begin (), centroids[cluster_i].end ());
+    dominant_normals_.insert (dominant_normals_.end (), normals[cluster_i].begin (), normals[cluster_i].end ());
+  }
+
+  this->deinitCompute ();
+}
+
 #define PCL_INSTANTIATE_CVFHEstimation(T,NT,OutT) template class PCL_EXPORTS pcl::CVFHEstimation<T,NT,OutT>;
 
 #endif    // PCL_FEATURES_IMPL_VFH_H_ 
@@ -44,37 +44,93 @@
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeNeighborhoods (
+    std::vector<size_t> &nn_offsets, std::vector<int> &nn_indices, std::vector<float> &nn_dists)
 {
-  std::vector<int> spfh_indices_vec;
-  std::vector<int> spfh_hist_lookup (surface_->points.size ());
+  const int nr_points = static_cast<int> (indices_->size ());
 
-  // Build a list of (unique) indices for which we will need to compute SPFH signatures
-  // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
-  if (surface_ != input_ ||
-      indices_->size () != surface_->points.size ())
-  { 
-    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-
-    std::set<int> spfh_indices_set;
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+  // Split the queries in a few chunks per thread, each of which gathers its neighborhoods in its own buffers
+  const int nr_chunks = std::max (1, std::min (nr_points, static_cast<int> (threads_) * 4));
+  std::vector<std::vector<int> > chunk_indices (nr_chunks);
+  std::vector<std::vector<float> > chunk_dists (nr_chunks);
+  nn_offsets.assign (nr_points + 1, 0);
+
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads_)
+  for (int c = 0; c < nr_chunks; ++c)
+  {
+    std::vector<int> nn_idx (k_); // \note These resizes are irrelevant for a radiusSearch ().
+    std::vector<float> nn_d (k_);
+    const int begin = static_cast<int> (static_cast<size_t> (nr_points) * c / nr_chunks);
+    const int end = static_cast<int> (static_cast<size_t> (nr_points) * (c + 1) / nr_chunks);
+    for (int idx = begin; idx < end; ++idx)
     {
-      int p_idx = (*indices_)[idx];
-      if (this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_idx, nn_d) == 0)
         continue;
-      
-      spfh_indices_set.insert (nn_indices.begin (), nn_indices.end ());
+
+      nn_offsets[idx + 1] = nn_idx.size ();
+      chunk_indices[c].insert (chunk_indices[c].end (), nn_idx.begin (), nn_idx.end ());
+      chunk_dists[c].insert (chunk_dists[c].end (), nn_d.begin (), nn_d.end ());
     }
-    spfh_indices_vec.resize (spfh_indices_set.size ());
-    std::copy (spfh_indices_set.begin (), spfh_indices_set.end (), spfh_indices_vec.begin ());
   }
-  else
+
+  // Turn the neighborhood sizes into offsets, and move every chunk to its place
+  for (int idx = 0; idx < nr_points; ++idx)
+    nn_offsets[idx + 1] += nn_offsets[idx];
+  nn_indices.resize (nn_offsets[nr_points]);
+  nn_dists.resize (nn_offsets[nr_points]);
+
+#pragma omp parallel for schedule (static, 1) num_threads (threads_)
+  for (int c = 0; c < nr_chunks; ++c)
   {
-    // Special case: When a feature must be computed at every point, there is no need for a neighborhood search
-    spfh_indices_vec.resize (indices_->size ());
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
-      spfh_indices_vec[idx] = idx;
+    const size_t offset = nn_offsets[static_cast<size_t> (nr_points) * c / nr_chunks];
+    std::copy (chunk_indices[c].begin (), chunk_indices[c].end (), nn_indices.begin () + offset);
+    std::copy (chunk_dists[c].begin (), chunk_dists[c].end (), nn_dists.begin () + offset);
+    std::vector<int> ().swap (chunk_indices[c]);
+    std::vector<float> ().swap (chunk_dists[c]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const int nr_points = static_cast<int> (indices_->size ());
+  const int nr_surface = static_cast<int> (surface_->points.size ());
+
+  // Search every neighborhood once, they are used by both phases below
+  std::vector<size_t> nn_offsets;
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  computeNeighborhoods (nn_offsets, nn_indices, nn_dists);
+
+  // Mark the points for which we will need to compute SPFH signatures
+  // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
+  std::vector<unsigned char> spfh_required (nr_surface, 0);
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int idx = 0; idx < nr_points; ++idx)
+    for (size_t j = nn_offsets[idx]; j < nn_offsets[idx + 1]; ++j)
+      spfh_required[nn_indices[j]] = 1;
+
+  // Give the marked points consecutive rows in the spfh_hist_* matrices, in increasing point order
+  std::vector<int> spfh_indices_vec;
+  std::vector<int> spfh_hist_lookup (nr_surface, -1);
+  for (int p_idx = 0; p_idx < nr_surface; ++p_idx)
+  {
+    if (!spfh_required[p_idx])
+      continue;
+    spfh_hist_lookup[p_idx] = static_cast<int> (spfh_indices_vec.size ());
+    spfh_indices_vec.push_back (p_idx);
+  }
+
+  // If the input is the search surface, a marked point that is also a query already has its neighborhood
+  std::vector<int> query_lookup;
+  if (surface_ == input_)
+  {
+    query_lookup.assign (nr_surface, -1);
+    for (int idx = 0; idx < nr_points; ++idx)
+      if (nn_offsets[idx + 1] > nn_offsets[idx])
+        query_lookup[(*indices_)[idx]] = idx;
   }
 
   // Initialize the arrays that will store the SPFH signatures
@@ -84,61 +140,65 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
   hist_f3_.setZero (data_size, nr_bins_f3_);
 
   // Compute SPFH signatures for every point that needs them
-  
-#pragma omp parallel for schedule (dynamic, threads_)
-  for (int i = 0; i < (int) spfh_indices_vec.size (); ++i)
+#pragma omp parallel num_threads (threads_)
   {
-    // Get the next point index
-    int p_idx = spfh_indices_vec[i];
+    std::vector<int> spfh_nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
+    std::vector<float> spfh_nn_dists (k_);
 
-    // Find the neighborhood around p_idx
-    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-    if (this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-      continue;
+#pragma omp for schedule (dynamic, 64)
+    for (int i = 0; i < static_cast<int> (spfh_indices_vec.size ()); ++i)
+    {
+      int p_idx = spfh_indices_vec[i];
+      int query = query_lookup.empty () ? -1 : query_lookup[p_idx];
 
-    // Estimate the SPFH signature around p_idx
-    this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1_, hist_f2_, hist_f3_);
+      // Find the neighborhood around p_idx, unless it is already known
+      if (query >= 0)
+        spfh_nn_indices.assign (nn_indices.begin () + nn_offsets[query], nn_indices.begin () + nn_offsets[query + 1]);
+      else if (this->searchForNeighbors (*surface_, p_idx, search_parameter_, spfh_nn_indices, spfh_nn_dists) == 0)
+        continue;
 
-    // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
-    spfh_hist_lookup[p_idx] = i;
+      // Estimate the SPFH signature around p_idx
+      this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, spfh_nn_indices, hist_f1_, hist_f2_, hist_f3_);
+    }
   }
 
   // Intialize the array that will store the FPFH signature
   int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
 
   // Iterate over the entire index vector
-#pragma omp parallel for schedule (dynamic, threads_)
-  for (int idx = 0; idx < (int) indices_->size (); ++idx)
+#pragma omp parallel num_threads (threads_)
   {
-    // Find the indices of point idx's neighbors...
-    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+    std::vector<int> spfh_rows;
+    std::vector<float> dists;
+    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
+
+#pragma omp for schedule (dynamic, 64)
+    for (int idx = 0; idx < nr_points; ++idx)
     {
-      for (int d = 0; d < nr_bins; ++d)
-        output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
-  
-      output.is_dense = false;
-      continue;
-    }
+      if (nn_offsets[idx + 1] == nn_offsets[idx])
+      {
+        for (int d = 0; d < nr_bins; ++d)
+          output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
 
+        output.is_dense = false;
+        continue;
+      }
 
-    // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-    // instead of indices into surface_->points
-    for (size_t i = 0; i < nn_indices.size (); ++i)
-      nn_indices[i] = spfh_hist_lookup[nn_indices[i]];
+      // Remap the neighbor indices so that they represent row indices in the spfh_hist_* matrices
+      // instead of indices into surface_->points
+      spfh_rows.resize (nn_offsets[idx + 1] - nn_offsets[idx]);
+      for (size_t i = 0; i < spfh_rows.size (); ++i)
+        spfh_rows[i] = spfh_hist_lookup[nn_indices[nn_offsets[idx] + i]];
+      dists.assign (nn_dists.begin () + nn_offsets[idx], nn_dists.begin () + nn_offsets[idx + 1]);
 
-    // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
-    weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
+      // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
+      weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, spfh_rows, dists, fpfh_histogram);
 
-    // ...and copy it into the output cloud
-    for (int d = 0; d < nr_bins; ++d)
-      output.points[idx].histogram[d] = fpfh_histogram[d];
+      // ...and copy it into the output cloud
+      for (int d = 0; d < nr_bins; ++d)
+        output.points[idx].histogram[d] = fpfh_histogram[d];
+    }
   }
-
 }
 
 #define PCL_INSTANTIATE_FPFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::FPFHEstimationOMP<T,NT,OutT>;
@@ -40,6 +40,41 @@
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
 #include <cstddef>
+#include <algorithm>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Turn an array of row-wise prefix sums into an integral image by adding every row to the next one.
+      * A row is handled as a flat array of \a row_size scalars, so the inner loop vectorizes. The columns are split
+      * in blocks that are summed down the whole image by one thread each.
+      * \param[in,out] data the rows of prefix sums, the first one is left untouched
+      * \param[in] row_size the number of scalars in a row
+      * \param[in] nr_rows the number of rows
+      * \param[in] threads the number of threads to use
+      */
+    template <typename T> void
+    accumulateIntegralImageRows (T *data, unsigned row_size, unsigned nr_rows, unsigned threads)
+    {
+      const unsigned block_size = 512;
+      const int nr_blocks = static_cast<int> ((row_size + block_size - 1) / block_size);
+#pragma omp parallel for schedule (static) num_threads (threads)
+      for (int block = 0; block < nr_blocks; ++block)
+      {
+        const unsigned begin = block * block_size;
+        const unsigned end = (std::min) (begin + block_size, row_size);
+        for (unsigned row = 1; row < nr_rows; ++row)
+        {
+          T *current_row = data + row * row_size;
+          const T *previous_row = current_row - row_size;
+          for (unsigned idx = begin; idx < end; ++idx)
+            current_row[idx] += previous_row[idx];
+        }
+      }
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename DataType, unsigned Dimension> void
@@ -52,15 +87,13 @@ pcl::IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compu
 template <typename DataType, unsigned Dimension> void
 pcl::IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
-  {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-  }
+  width_  = width;
+  height_ = height;
+  // resize () keeps the capacity, so inputs of the same or a smaller size reuse the images
+  first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  if (compute_second_order_integral_images_)
+    second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   computeIntegralImages (data, row_stride, element_stride);
 }
 
@@ -111,60 +144,52 @@ template <typename DataType, unsigned Dimension> void
 pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
+  typedef typename IntegralImageTypeTraits<DataType>::IntegralType IntegralType;
+  const unsigned stride = width_ + 1;
 
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (compute_second_order_integral_images_)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
 
-  if (!compute_second_order_integral_images_)
+  // First pass: the prefix sums along every row, which are independent of each other
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const DataType *row_data = data + rowIdx * row_stride;
+    ElementType* current_row = &first_order_integral_image_[(rowIdx + 1) * stride];
+    unsigned* count_current_row = &finite_values_integral_image_[(rowIdx + 1) * stride];
+    current_row [0].setZero ();
+    count_current_row [0] = 0;
+
+    if (!compute_second_order_integral_images_)
     {
-      current_row [0].setZero ();
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
+        current_row [colIdx + 1] = current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
         if (pcl_isfinite (element->sum ()))
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+          current_row [colIdx + 1] += element->template cast<IntegralType>();
           ++(count_current_row [colIdx + 1]);
         }
       }
     }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    else
     {
-      current_row [0].setZero ();
+      SecondOrderType* so_current_row = &second_order_integral_image_[(rowIdx + 1) * stride];
       so_current_row [0].setZero ();
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+        current_row [colIdx + 1] = current_row [colIdx];
+        so_current_row [colIdx + 1] = so_current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
 
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
+        const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
         if (pcl_isfinite (element->sum ()))
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+          current_row [colIdx + 1] += element->template cast<IntegralType>();
           ++(count_current_row [colIdx + 1]);
           for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
             for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
@@ -173,6 +198,15 @@ pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
       }
     }
   }
+
+  // Second pass: sum the rows up. The elements are plain fixed size vectors of IntegralType, so a row can be
+  // handled as a flat array of scalars
+  detail::accumulateIntegralImageRows (reinterpret_cast<IntegralType*> (&first_order_integral_image_[0]),
+                                       stride * Dimension, height_ + 1, threads_);
+  detail::accumulateIntegralImageRows (&finite_values_integral_image_[0], stride, height_ + 1, threads_);
+  if (compute_second_order_integral_images_)
+    detail::accumulateIntegralImageRows (reinterpret_cast<IntegralType*> (&second_order_integral_image_[0]),
+                                         stride * second_order_size, height_ + 1, threads_);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -180,15 +214,13 @@ pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
 template <typename DataType> void
 pcl::IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
-  {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-  }
+  width_  = width;
+  height_ = height;
+  // resize () keeps the capacity, so inputs of the same or a smaller size reuse the images
+  first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  if (compute_second_order_integral_images_)
+    second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   computeIntegralImages (data, row_stride, element_stride);
 }
 
@@ -239,62 +271,60 @@ template <typename DataType> void
 pcl::IntegralImage2D<DataType, 1>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
+  const unsigned stride = width_ + 1;
 
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (compute_second_order_integral_images_)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
 
-  if (!compute_second_order_integral_images_)
+  // First pass: the prefix sums along every row, which are independent of each other
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const DataType *row_data = data + rowIdx * row_stride;
+    ElementType* current_row = &first_order_integral_image_[(rowIdx + 1) * stride];
+    unsigned* count_current_row = &finite_values_integral_image_[(rowIdx + 1) * stride];
+    current_row [0] = 0.0;
+    count_current_row [0] = 0;
+
+    if (!compute_second_order_integral_images_)
     {
-      current_row [0] = 0.0;
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (pcl_isfinite (data [valIdx]))
+        current_row [colIdx + 1] = current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        if (pcl_isfinite (row_data [valIdx]))
         {
-          current_row [colIdx + 1] += data [valIdx];
+          current_row [colIdx + 1] += row_data [valIdx];
           ++(count_current_row [colIdx + 1]);
         }
       }
     }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    else
     {
-      current_row [0] = 0.0;
+      SecondOrderType* so_current_row = &second_order_integral_image_[(rowIdx + 1) * stride];
       so_current_row [0] = 0.0;
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (pcl_isfinite (data[valIdx]))
+        current_row [colIdx + 1] = current_row [colIdx];
+        so_current_row [colIdx + 1] = so_current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        if (pcl_isfinite (row_data [valIdx]))
         {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
+          current_row [colIdx + 1] += row_data [valIdx];
+          so_current_row [colIdx + 1] += row_data [valIdx] * row_data [valIdx];
           ++(count_current_row [colIdx + 1]);
         }
       }
     }
   }
+
+  // Second pass: sum the rows up
+  detail::accumulateIntegralImageRows (&first_order_integral_image_[0], stride, height_ + 1, threads_);
+  detail::accumulateIntegralImageRows (&finite_values_integral_image_[0], stride, height_ + 1, threads_);
+  if (compute_second_order_integral_images_)
+    detail::accumulateIntegralImageRows (&second_order_integral_image_[0], stride, height_ + 1, threads_);
 }
 #endif    // PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
@@ -42,23 +42,12 @@
 template <typename PointInT, typename PointOutT>
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::~IntegralImageNormalEstimation ()
 {
-  if (diff_x_ != NULL) delete diff_x_;
-  if (diff_y_ != NULL) delete diff_y_;
-  if (depth_data_ != NULL) delete depth_data_;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData ()
 {
-  // compute derivatives
-  if (diff_x_ != NULL) delete diff_x_;
-  if (diff_y_ != NULL) delete diff_y_;
-  if (depth_data_ != NULL) delete depth_data_;
-  diff_x_ = NULL;
-  diff_y_ = NULL;
-  depth_data_ = NULL;
-
   if (normal_estimation_method_ == COVARIANCE_MATRIX)
     initCovarianceMatrixMethod ();
   else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT)
@@ -123,32 +112,28 @@ template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMethod ()
 {
   size_t data_size = (input_->points.size () << 2);
-  diff_x_ = new float[data_size];
-  diff_y_ = new float[data_size];
-
-  memset (diff_x_, 0, sizeof(float) * data_size);
-  memset (diff_y_, 0, sizeof(float) * data_size);
+  // Only the inner points are written below, so the borders stay zero as long as the frame size does not change
+  if (diff_x_.size () != data_size)
+  {
+    diff_x_.assign (data_size, 0.0f);
+    diff_y_.assign (data_size, 0.0f);
+  }
 
   // x u x
   // l x r
   // x d x
-  const PointInT* point_up = &(input_->points [1]);
-  const PointInT* point_dn = point_up + (input_->width << 1);//&(input_->points [1 + (input_->width << 1)]);
-  const PointInT* point_lf = &(input_->points [input_->width]);
-  const PointInT* point_rg = point_lf + 2; //&(input_->points [input_->width + 2]);
-  float* diff_x_ptr = diff_x_ + ((input_->width + 1) << 2);
-  float* diff_y_ptr = diff_y_ + ((input_->width + 1) << 2);
-  unsigned diff_skip = 8; // skip last element in row and the first in the next row
-
-  for (size_t ri = 1; ri < input_->height - 1; ++ri
-                                             , point_up += input_->width
-                                             , point_dn += input_->width
-                                             , point_lf += input_->width
-                                             , point_rg += input_->width
-                                             , diff_x_ptr += diff_skip
-                                             , diff_y_ptr += diff_skip)
+  const int width = input_->width;
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int ri = 1; ri < static_cast<int> (input_->height) - 1; ++ri)
   {
-    for (size_t ci = 0; ci < input_->width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
+    const PointInT* point_up = &(input_->points [(ri - 1) * width + 1]);
+    const PointInT* point_dn = point_up + (width << 1);
+    const PointInT* point_lf = &(input_->points [ri * width]);
+    const PointInT* point_rg = point_lf + 2;
+    float* diff_x_ptr = &diff_x_[(ri * width + 1) << 2];
+    float* diff_y_ptr = &diff_y_[(ri * width + 1) << 2];
+
+    for (int ci = 0; ci < width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
     {
       diff_x_ptr[0] = point_rg[ci].x - point_lf[ci].x;
       diff_x_ptr[1] = point_rg[ci].y - point_lf[ci].y;
@@ -161,8 +146,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMe
   }
 
   // Compute integral images
-  integral_image_DX_.setInput (diff_x_, input_->width, input_->height, 4, input_->width << 2);
-  integral_image_DY_.setInput (diff_y_, input_->width, input_->height, 4, input_->width << 2);
+  integral_image_DX_.setInput (&diff_x_[0], input_->width, input_->height, 4, input_->width << 2);
+  integral_image_DY_.setInput (&diff_y_[0], input_->width, input_->height, 4, input_->width << 2);
   init_covariance_matrix_ = init_depth_change_ = init_simple_3d_gradient_ = false;
   init_average_3d_gradient_ = true;
 }
@@ -188,15 +173,33 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverageDepthChangeM
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal)
+{
+  if (normal_estimation_method_ == COVARIANCE_MATRIX && !init_covariance_matrix_)
+    initCovarianceMatrixMethod ();
+  else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT && !init_average_3d_gradient_)
+    initAverage3DGradientMethod ();
+  else if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE && !init_depth_change_)
+    initAverageDepthChangeMethod ();
+  else if (normal_estimation_method_ == SIMPLE_3D_GRADIENT && !init_simple_3d_gradient_)
+    initSimple3DGradientMethod ();
+
+  computePointNormal (pos_x, pos_y, point_index, rect_width_, rect_height_, normal);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
+    const int pos_x, const int pos_y, const unsigned point_index,
+    const int rect_width, const int rect_height, PointOutT &normal) const
 {
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
+  const int rect_width_2 = rect_width >> 1, rect_width_4 = rect_width >> 2;
+  const int rect_height_2 = rect_height >> 1, rect_height_4 = rect_height >> 2;
 
   if (normal_estimation_method_ == COVARIANCE_MATRIX)
   {
-    if (!init_covariance_matrix_)
-      initCovarianceMatrixMethod ();
 
-    unsigned count = integral_image_XYZ_.getFiniteElementsCount (pos_x - (rect_width_2_), pos_y - (rect_height_2_), rect_width_, rect_height_);
+    unsigned count = integral_image_XYZ_.getFiniteElementsCount (pos_x - (rect_width_2), pos_y - (rect_height_2), rect_width, rect_height);
 
     // no valid points within the rectangular reagion?
     if (count == 0)
@@ -208,8 +211,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
     Eigen::Vector3f center;
     typename IntegralImage2D<float, 3>::SecondOrderType so_elements;
-    center = integral_image_XYZ_.getFirstOrderSum(pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_).cast<float> ();
-    so_elements = integral_image_XYZ_.getSecondOrderSum(pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    center = integral_image_XYZ_.getFirstOrderSum(pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height).cast<float> ();
+    so_elements = integral_image_XYZ_.getSecondOrderSum(pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
 
     covariance_matrix.coeffRef (0) = so_elements [0];
     covariance_matrix.coeffRef (1) = covariance_matrix.coeffRef (3) = so_elements [1];
@@ -236,18 +239,16 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
   }
   else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT)
   {
-    if (!init_average_3d_gradient_)
-      initAverage3DGradientMethod ();
 
-    unsigned count_x = integral_image_DX_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-    unsigned count_y = integral_image_DY_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    unsigned count_x = integral_image_DX_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    unsigned count_y = integral_image_DY_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
     if (count_x == 0 || count_y == 0)
     {
       normal.normal_x = normal.normal_y = normal.normal_z = normal.curvature = std::numeric_limits<float>::quiet_NaN ();
       return;
     }
-    Eigen::Vector3d gradient_x = integral_image_DX_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-    Eigen::Vector3d gradient_y = integral_image_DY_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    Eigen::Vector3d gradient_x = integral_image_DX_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    Eigen::Vector3d gradient_y = integral_image_DY_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
 
     Eigen::Vector3d normal_vector = gradient_y.cross (gradient_x);
     double normal_length = normal_vector.squaredNorm ();
@@ -267,8 +268,6 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
   }
   else if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE)
   {
-    if (!init_depth_change_)
-      initAverageDepthChangeMethod ();
 
 //    unsigned count = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
 //    if (count == 0)
@@ -282,10 +281,10 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
 //    const float mean_D_z = integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2_    , pos_y - rect_height_2_ + 1, rect_width_ - 1, rect_height_ - 1) / ((rect_width_-1)*(rect_height_-1));
 
     // width and height are at least 3 x 3
-    unsigned count_L_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_4_, rect_width_2_, rect_height_2_);
-    unsigned count_R_z = integral_image_depth_.getFiniteElementsCount (pos_x + 1            , pos_y - rect_height_4_, rect_width_2_, rect_height_2_);
-    unsigned count_U_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4_, pos_y - rect_height_2_, rect_width_2_, rect_height_2_);
-    unsigned count_D_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4_, pos_y + 1             , rect_width_2_, rect_height_2_);
+    unsigned count_L_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_4, rect_width_2, rect_height_2);
+    unsigned count_R_z = integral_image_depth_.getFiniteElementsCount (pos_x + 1            , pos_y - rect_height_4, rect_width_2, rect_height_2);
+    unsigned count_U_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4, pos_y - rect_height_2, rect_width_2, rect_height_2);
+    unsigned count_D_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4, pos_y + 1             , rect_width_2, rect_height_2);
 
     if (count_L_z == 0 || count_R_z == 0 || count_U_z == 0 || count_D_z == 0)
     {
@@ -293,15 +292,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
       return;
     }
 
-    float mean_L_z = integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_4_, rect_width_2_, rect_height_2_) / count_L_z;
-    float mean_R_z = integral_image_depth_.getFirstOrderSum (pos_x + 1            , pos_y - rect_height_4_, rect_width_2_, rect_height_2_) / count_R_z;
-    float mean_U_z = integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4_, pos_y - rect_height_2_, rect_width_2_, rect_height_2_) / count_U_z;
-    float mean_D_z = integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4_, pos_y + 1             , rect_width_2_, rect_height_2_) / count_D_z;
+    float mean_L_z = integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_4, rect_width_2, rect_height_2) / count_L_z;
+    float mean_R_z = integral_image_depth_.getFirstOrderSum (pos_x + 1            , pos_y - rect_height_4, rect_width_2, rect_height_2) / count_R_z;
+    float mean_U_z = integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4, pos_y - rect_height_2, rect_width_2, rect_height_2) / count_U_z;
+    float mean_D_z = integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4, pos_y + 1             , rect_width_2, rect_height_2) / count_D_z;
 
-    PointInT pointL = input_->points[point_index - rect_width_4_ - 1];
-    PointInT pointR = input_->points[point_index + rect_width_4_ + 1];
-    PointInT pointU = input_->points[point_index - rect_height_4_ * input_->width - 1];
-    PointInT pointD = input_->points[point_index + rect_height_4_ * input_->width + 1];
+    PointInT pointL = input_->points[point_index - rect_width_4 - 1];
+    PointInT pointR = input_->points[point_index + rect_width_4 + 1];
+    PointInT pointU = input_->points[point_index - rect_height_4 * input_->width - 1];
+    PointInT pointD = input_->points[point_index + rect_height_4 * input_->width + 1];
 
     const float mean_x_z = mean_R_z - mean_L_z;
     const float mean_y_z = mean_D_z - mean_U_z;
@@ -335,15 +334,13 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
   }
   else if (normal_estimation_method_ == SIMPLE_3D_GRADIENT)
   {
-    if (!init_simple_3d_gradient_)
-      initSimple3DGradientMethod ();
 
     // this method does not work if lots of NaNs are in the neighborhood of the point
-    Eigen::Vector3d gradient_x = integral_image_XYZ_.getFirstOrderSum (pos_x + rect_width_2_, pos_y - rect_height_2_, 1, rect_height_) -
-                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, 1, rect_height_);
+    Eigen::Vector3d gradient_x = integral_image_XYZ_.getFirstOrderSum (pos_x + rect_width_2, pos_y - rect_height_2, 1, rect_height) -
+                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, 1, rect_height);
 
-    Eigen::Vector3d gradient_y = integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y + rect_height_2_, rect_width_, 1) -
-                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, 1);
+    Eigen::Vector3d gradient_y = integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y + rect_height_2, rect_width, 1) -
+                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, 1);
     Eigen::Vector3d normal_vector = gradient_y.cross (gradient_x);
     double normal_length = normal_vector.squaredNorm ();
     if (normal_length == 0.0f)
@@ -372,8 +369,16 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
 {
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
+  // The normals below are computed in parallel, so the data of the chosen method has to be ready beforehand
+  if ((normal_estimation_method_ == COVARIANCE_MATRIX && !init_covariance_matrix_) ||
+      (normal_estimation_method_ == AVERAGE_3D_GRADIENT && !init_average_3d_gradient_) ||
+      (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE && !init_depth_change_) ||
+      (normal_estimation_method_ == SIMPLE_3D_GRADIENT && !init_simple_3d_gradient_))
+    initData ();
+
   // compute depth-change map
-  unsigned char * depthChangeMap = new unsigned char[input_->points.size ()];
+  depth_change_map_.resize (input_->points.size ());
+  unsigned char * depthChangeMap = &depth_change_map_[0];
   memset (depthChangeMap, 255, input_->points.size ());
 
   unsigned index = 0;
@@ -408,7 +413,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
   }
 
   // compute distance map
-  float *distanceMap = new float[input_->points.size ()];
+  distance_map_.resize (input_->points.size ());
+  float *distanceMap = &distance_map_[0];
   for (size_t index = 0; index < input_->points.size (); ++index)
   {
     if (depthChangeMap[index] == 0)
@@ -488,72 +494,41 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
     }
   }
 
-  if (use_depth_dependent_smoothing_)
+  // The rows are independent of each other, and the rectangle size is passed along instead of going through
+  // setRectSize () so that the threads do not share any state
+  const int width = input_->width;
+  const float smoothing_constant = normal_smoothing_size_ * 2.0f;
+#pragma omp parallel for schedule (dynamic, 8) num_threads (threads_)
+  for (int ri = border; ri < static_cast<int> (input_->height - border); ++ri)
   {
-    index = border + input_->width * border;
-    unsigned skip = (border << 1);
-    for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
+    for (int ci = border, index = ri * width + border; ci < static_cast<int> (width - border); ++ci, ++index)
     {
-      for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
+      const float depth = input_->points[index].z;
+      if (!pcl_isfinite (depth))
       {
-        const float depth = input_->points[index].z;
-        if (!pcl_isfinite (depth))
-        {
-          output[index].getNormalVector4fMap ().setConstant (bad_point);
-          output[index].curvature = bad_point;
-          continue;
-        }
-
-        float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-
-        if (smoothing > 2.0f)
-        {
-          setRectSize (smoothing, smoothing);
-          computePointNormal (ci, ri, index, output [index]);
-        }
-        else
-        {
-          output[index].getNormalVector4fMap ().setConstant (bad_point);
-          output[index].curvature = bad_point;
-        }
+        output [index].getNormalVector4fMap ().setConstant (bad_point);
+        output [index].curvature = bad_point;
+        continue;
       }
-    }
-  }
-  else
-  {
-    float smoothing_constant = normal_smoothing_size_ * 2.0f;
 
-    index = border + input_->width * border;
-    unsigned skip = (border << 1);
-    for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
-    {
-      for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
+      float smoothing;
+      if (use_depth_dependent_smoothing_)
+        smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+      else
+        smoothing = (std::min)(distanceMap[index], smoothing_constant);
+
+      if (smoothing > 2.0f)
       {
-        if (!pcl_isfinite (input_->points[index].z))
-        {
-          output [index].getNormalVector4fMap ().setConstant (bad_point);
-          output [index].curvature = bad_point;
-          continue;
-        }
-
-        float smoothing = (std::min)(distanceMap[index], smoothing_constant);
-
-        if (smoothing > 2.0f)
-        {
-          setRectSize (smoothing, smoothing);
-          computePointNormal (ci, ri, index, output [index]);
-        }
-        else
-        {
-          output [index].getNormalVector4fMap ().setConstant (bad_point);
-          output [index].curvature = bad_point;
-        }
+        const int rect_size = static_cast<int> (smoothing);
+        computePointNormal (ci, ri, index, rect_size, rect_size, output [index]);
+      }
+      else
+      {
+        output [index].getNormalVector4fMap ().setConstant (bad_point);
+        output [index].curvature = bad_point;
       }
     }
   }
-
-  delete[] depthChangeMap;
-  delete[] distanceMap;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
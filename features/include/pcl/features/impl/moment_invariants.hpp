@@ -46,10 +46,11 @@
 template <typename PointInT, typename PointOutT> void
 pcl::MomentInvariantsEstimation<PointInT, PointOutT>::computePointMomentInvariants (
       const pcl::PointCloud<PointInT> &cloud, const std::vector<int> &indices,
-      float &j1, float &j2, float &j3)
+      float &j1, float &j2, float &j3) const
 {
   // Estimate the XYZ centroid
-  compute3DCentroid (cloud, indices, xyz_centroid_);
+  Eigen::Vector4f xyz_centroid, temp_pt;
+  compute3DCentroid (cloud, indices, xyz_centroid);
 
   // Initalize the centralized moments
   float mu200 = 0, mu020 = 0, mu002 = 0, mu110 = 0, mu101 = 0, mu011  = 0;
@@ -58,16 +59,16 @@ pcl::MomentInvariantsEstimation<PointInT, PointOutT>::computePointMomentInvarian
   for (size_t nn_idx = 0; nn_idx < indices.size (); ++nn_idx)
   {
     // Demean the points
-    temp_pt_[0] = cloud.points[indices[nn_idx]].x - xyz_centroid_[0];
-    temp_pt_[1] = cloud.points[indices[nn_idx]].y - xyz_centroid_[1];
-    temp_pt_[2] = cloud.points[indices[nn_idx]].z - xyz_centroid_[2];
-
-    mu200 += temp_pt_[0] * temp_pt_[0];
-    mu020 += temp_pt_[1] * temp_pt_[1];
-    mu002 += temp_pt_[2] * temp_pt_[2];
-    mu110 += temp_pt_[0] * temp_pt_[1];
-    mu101 += temp_pt_[0] * temp_pt_[2];
-    mu011 += temp_pt_[1] * temp_pt_[2];
+    temp_pt[0] = cloud.points[indices[nn_idx]].x - xyz_centroid[0];
+    temp_pt[1] = cloud.points[indices[nn_idx]].y - xyz_centroid[1];
+    temp_pt[2] = cloud.points[indices[nn_idx]].z - xyz_centroid[2];
+
+    mu200 += temp_pt[0] * temp_pt[0];
+    mu020 += temp_pt[1] * temp_pt[1];
+    mu002 += temp_pt[2] * temp_pt[2];
+    mu110 += temp_pt[0] * temp_pt[1];
+    mu101 += temp_pt[0] * temp_pt[2];
+    mu011 += temp_pt[1] * temp_pt[2];
   }
 
   // Save the moment invariants
@@ -79,10 +80,11 @@ pcl::MomentInvariantsEstimation<PointInT, PointOutT>::computePointMomentInvarian
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::MomentInvariantsEstimation<PointInT, PointOutT>::computePointMomentInvariants (
-      const pcl::PointCloud<PointInT> &cloud, float &j1, float &j2, float &j3)
+      const pcl::PointCloud<PointInT> &cloud, float &j1, float &j2, float &j3) const
 {
   // Estimate the XYZ centroid
-  compute3DCentroid (cloud, xyz_centroid_);
+  Eigen::Vector4f xyz_centroid, temp_pt;
+  compute3DCentroid (cloud, xyz_centroid);
 
   // Initalize the centralized moments
   float mu200 = 0, mu020 = 0, mu002 = 0, mu110 = 0, mu101 = 0, mu011  = 0;
@@ -91,16 +93,16 @@ pcl::MomentInvariantsEstimation<PointInT, PointOutT>::computePointMomentInvarian
   for (size_t nn_idx = 0; nn_idx < cloud.points.size (); ++nn_idx )
   {
     // Demean the points
-    temp_pt_[0] = cloud.points[nn_idx].x - xyz_centroid_[0];
-    temp_pt_[1] = cloud.points[nn_idx].y - xyz_centroid_[1];
-    temp_pt_[2] = cloud.points[nn_idx].z - xyz_centroid_[2];
-
-    mu200 += temp_pt_[0] * temp_pt_[0];
-    mu020 += temp_pt_[1] * temp_pt_[1];
-    mu002 += temp_pt_[2] * temp_pt_[2];
-    mu110 += temp_pt_[0] * temp_pt_[1];
-    mu101 += temp_pt_[0] * temp_pt_[2];
-    mu011 += temp_pt_[1] * temp_pt_[2];
+    temp_pt[0] = cloud.points[nn_idx].x - xyz_centroid[0];
+    temp_pt[1] = cloud.points[nn_idx].y - xyz_centroid[1];
+    temp_pt[2] = cloud.points[nn_idx].z - xyz_centroid[2];
+
+    mu200 += temp_pt[0] * temp_pt[0];
+    mu020 += temp_pt[1] * temp_pt[1];
+    mu002 += temp_pt[2] * temp_pt[2];
+    mu110 += temp_pt[0] * temp_pt[1];
+    mu101 += temp_pt[0] * temp_pt[2];
+    mu011 += temp_pt[1] * temp_pt[2];
   }
 
   // Save the moment invariants
@@ -0,0 +1,77 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_MOMENT_INVARIANTS_OMP_HPP_
+#define PCL_FEATURES_IMPL_MOMENT_INVARIANTS_OMP_HPP_
+
+#include "pcl/features/moment_invariants_omp.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MomentInvariantsEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const int nr_points = static_cast<int> (indices_->size ());
+
+  bool is_dense = true;
+#pragma omp parallel num_threads (threads_) reduction (&& : is_dense)
+  {
+    // Scratch buffers, reused for all the points of this thread
+    // \note This resize is irrelevant for a radiusSearch ().
+    std::vector<int> nn_indices (k_);
+    std::vector<float> nn_dists (k_);
+
+#pragma omp for schedule (dynamic, 64)
+    for (int idx = 0; idx < nr_points; ++idx)
+    {
+      if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[idx]])) ||
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      {
+        output.points[idx].j1 = output.points[idx].j2 = output.points[idx].j3 = std::numeric_limits<float>::quiet_NaN ();
+        is_dense = false;
+        continue;
+      }
+
+      this->computePointMomentInvariants (*surface_, nn_indices,
+                                          output.points[idx].j1, output.points[idx].j2, output.points[idx].j3);
+    }
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_MomentInvariantsEstimationOMP(T,OutT) template class PCL_EXPORTS pcl::MomentInvariantsEstimationOMP<T,OutT>;
+
+#endif    // PCL_FEATURES_IMPL_MOMENT_INVARIANTS_OMP_HPP_
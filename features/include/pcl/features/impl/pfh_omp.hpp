@@ -0,0 +1,153 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_PFH_OMP_H_
+#define PCL_FEATURES_IMPL_PFH_OMP_H_
+
+#include "pcl/features/pfh_omp.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::computeSharedPFHSignature (
+      const std::vector<int> &indices, Eigen::VectorXf &pfh_histogram)
+{
+  Eigen::Vector4f pfh_tuple;
+  int f_index[3];
+  int h_index, h_p;
+
+  // Clear the resultant point histogram
+  pfh_histogram.setZero ();
+
+  // Factorization constant
+  float hist_incr = 100.0 / (indices.size () * (indices.size () - 1) / 2);
+
+  // Iterate over all the points in the neighborhood
+  for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
+  {
+    for (size_t j_idx = 0; j_idx < i_idx; ++j_idx)
+    {
+      // If the 3D points are invalid, don't bother estimating, just continue
+      if (!isFinite (surface_->points[indices[i_idx]]) || !isFinite (surface_->points[indices[j_idx]]))
+        continue;
+
+      // Reuse the pair if any thread already estimated it, otherwise compute the pair NNi to NNj and share it
+      if (!use_cache_ || !pair_cache_.find (indices[i_idx], indices[j_idx], pfh_tuple))
+      {
+        if (!this->computePairFeatures (*surface_, *normals_, indices[i_idx], indices[j_idx],
+                                        pfh_tuple[0], pfh_tuple[1], pfh_tuple[2], pfh_tuple[3]))
+          continue;
+        if (use_cache_)
+          pair_cache_.insert (indices[i_idx], indices[j_idx], pfh_tuple);
+      }
+
+      // Normalize the f1, f2, f3 features and push them in the histogram
+      f_index[0] = floor (nr_subdiv_ * ((pfh_tuple[0] + M_PI) * d_pi_));
+      if (f_index[0] < 0)           f_index[0] = 0;
+      if (f_index[0] >= nr_subdiv_) f_index[0] = nr_subdiv_ - 1;
+
+      f_index[1] = floor (nr_subdiv_ * ((pfh_tuple[1] + 1.0) * 0.5));
+      if (f_index[1] < 0)           f_index[1] = 0;
+      if (f_index[1] >= nr_subdiv_) f_index[1] = nr_subdiv_ - 1;
+
+      f_index[2] = floor (nr_subdiv_ * ((pfh_tuple[2] + 1.0) * 0.5));
+      if (f_index[2] < 0)           f_index[2] = 0;
+      if (f_index[2] >= nr_subdiv_) f_index[2] = nr_subdiv_ - 1;
+
+      // Copy into the histogram
+      h_index = 0;
+      h_p     = 1;
+      for (int d = 0; d < 3; ++d)
+      {
+        h_index += h_p * f_index[d];
+        h_p     *= nr_subdiv_;
+      }
+      pfh_histogram[h_index] += hist_incr;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  // Start from an empty cache. Besides the user given bound, there is no point in holding more than a few dozen
+  // pairs per point of the search surface
+  if (use_cache_)
+    pair_cache_.resize (std::min (static_cast<size_t> (max_cache_size_), surface_->points.size () * 64));
+
+  const int nr_bins = nr_subdiv_ * nr_subdiv_ * nr_subdiv_;
+  const int nr_points = static_cast<int> (indices_->size ());
+
+  output.is_dense = true;
+#pragma omp parallel num_threads (threads_)
+  {
+    // Allocate enough space to hold the results
+    // \note This resize is irrelevant for a radiusSearch ().
+    std::vector<int> nn_indices (k_);
+    std::vector<float> nn_dists (k_);
+    Eigen::VectorXf pfh_histogram (nr_bins);
+
+    // Small chunks keep the threads on nearby queries, whose neighborhoods share the most pairs
+#pragma omp for schedule (dynamic, 16)
+    for (int idx = 0; idx < nr_points; ++idx)
+    {
+      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      {
+        for (int d = 0; d < nr_bins; ++d)
+          output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
+
+        output.is_dense = false;
+        continue;
+      }
+
+      // Estimate the PFH signature at each patch
+      computeSharedPFHSignature (nn_indices, pfh_histogram);
+
+      // Copy into the resultant cloud
+      for (int d = 0; d < nr_bins; ++d)
+        output.points[idx].histogram[d] = pfh_histogram[d];
+    }
+  }
+
+  // Release the cache, it is only valid for this surface
+  pair_cache_.resize (0);
+}
+
+#define PCL_INSTANTIATE_PFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::PFHEstimationOMP<T,NT,OutT>;
+
+#endif    // PCL_FEATURES_IMPL_PFH_OMP_H_
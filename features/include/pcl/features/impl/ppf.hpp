@@ -45,7 +45,7 @@
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT>
 pcl::PPFEstimation<PointInT, PointNT, PointOutT>::PPFEstimation ()
-    : FeatureFromNormals <PointInT, PointNT, PointOutT> ()
+    : FeatureFromNormals <PointInT, PointNT, PointOutT> (), threads_ (1)
 {
   feature_name_ = "PPFEstimation";
   // Slight hack in order to pass the check for the presence of a search method in Feature::initCompute ()
@@ -62,12 +62,23 @@ pcl::PPFEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   output.points.resize (indices_->size () * input_->points.size ());
   output.height = 1;
   output.width = output.points.size ();
-  output.is_dense = true;
 
-  // Compute point pair features for every pair of points in the cloud
-  for (size_t index_i = 0; index_i < indices_->size (); ++index_i)
+  // Compute point pair features for every pair of points in the cloud. The pairs of each first point fill their
+  // own row of the output, so the rows can be computed in any order
+  const int nr_indices = static_cast<int> (indices_->size ());
+  bool is_dense = true;
+#pragma omp parallel for schedule (dynamic, 8) num_threads (threads_) reduction (&& : is_dense)
+  for (int index_i = 0; index_i < nr_indices; ++index_i)
   {
     size_t i = (*indices_)[index_i];
+
+    // The frame that brings the reference point to the origin and its normal onto the x axis
+    Eigen::Vector3f model_reference_point = input_->points[i].getVector3fMap (),
+                    model_reference_normal = normals_->points[i].getNormalVector3fMap ();
+    Eigen::AngleAxisf rotation_mg (acos (model_reference_normal.dot (Eigen::Vector3f::UnitX ())),
+                                   model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
+    Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
+
     for (size_t j = 0 ; j < input_->points.size (); ++j)
     {
       PointOutT p;
@@ -81,14 +92,7 @@ pcl::PPFEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
                                       p.f1, p.f2, p.f3, p.f4))
         {
           // Calculate alpha_m angle
-          Eigen::Vector3f model_reference_point = input_->points[i].getVector3fMap (),
-                          model_reference_normal = normals_->points[i].getNormalVector3fMap (),
-                          model_point = input_->points[j].getVector3fMap ();
-          Eigen::AngleAxisf rotation_mg (acos (model_reference_normal.dot (Eigen::Vector3f::UnitX ())),
-                                         model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
-          Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
-
-          Eigen::Vector3f model_point_transformed = transform_mg * model_point;
+          Eigen::Vector3f model_point_transformed = transform_mg * input_->points[j].getVector3fMap ();
           float angle = atan2f ( -model_point_transformed(2), model_point_transformed(1));
           if (sin (angle) * model_point_transformed(2) < 0.0f)
             angle *= (-1);
@@ -98,7 +102,7 @@ pcl::PPFEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
         {
           PCL_ERROR ("[pcl::%s::computeFeature] Computing pair feature vector between points %lu and %lu went wrong.\n", getClassName ().c_str (), (unsigned long) i, (unsigned long) j);
           p.f1 = p.f2 = p.f3 = p.f4 = p.alpha_m = std::numeric_limits<float>::quiet_NaN ();
-          output.is_dense = false;
+          is_dense = false;
         }
       }
       // Do not calculate the feature for identity pairs (i, i) as they are not used
@@ -106,12 +110,13 @@ pcl::PPFEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
       else
       {
         p.f1 = p.f2 = p.f3 = p.f4 = p.alpha_m = std::numeric_limits<float>::quiet_NaN ();
-        output.is_dense = false;
+        is_dense = false;
       }
 
       output.points[index_i*input_->points.size () + j] = p;
     }
   }
+  output.is_dense = is_dense;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -123,11 +128,21 @@ pcl::PPFEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
   output.height = 1;
   output.width = indices_->size () * input_->points.size ();
 
-  output.is_dense = true;
   // Compute point pair features for every pair of points in the cloud
-  for (size_t index_i = 0; index_i < indices_->size (); ++index_i)
+  const int nr_indices = static_cast<int> (indices_->size ());
+  bool is_dense = true;
+#pragma omp parallel for schedule (dynamic, 8) num_threads (threads_) reduction (&& : is_dense)
+  for (int index_i = 0; index_i < nr_indices; ++index_i)
   {
     size_t i = (*indices_)[index_i];
+
+    // The frame that brings the reference point to the origin and its normal onto the x axis
+    Eigen::Vector3f model_reference_point = input_->points[i].getVector3fMap (),
+                    model_reference_normal = normals_->points[i].getNormalVector3fMap ();
+    Eigen::AngleAxisf rotation_mg (acos (model_reference_normal.dot (Eigen::Vector3f::UnitX ())),
+                                   model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
+    Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
+
     for (size_t j = 0 ; j < input_->points.size (); ++j)
     {
       Eigen::VectorXf p (5);
@@ -141,14 +156,7 @@ pcl::PPFEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
                                       p (0), p (1), p (2), p (3)))
         {
           // Calculate alpha_m angle
-          Eigen::Vector3f model_reference_point = input_->points[i].getVector3fMap (),
-                          model_reference_normal = normals_->points[i].getNormalVector3fMap (),
-                          model_point = input_->points[j].getVector3fMap ();
-          Eigen::AngleAxisf rotation_mg (acos (model_reference_normal.dot (Eigen::Vector3f::UnitX ())),
-                                         model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
-          Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
-
-          Eigen::Vector3f model_point_transformed = transform_mg * model_point;
+          Eigen::Vector3f model_point_transformed = transform_mg * input_->points[j].getVector3fMap ();
           float angle = atan2f ( -model_point_transformed(2), model_point_transformed(1));
           if (sin (angle) * model_point_transformed(2) < 0.0f)
             angle *= (-1);
@@ -158,7 +166,7 @@ pcl::PPFEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
         {
           PCL_ERROR ("[pcl::%s::computeFeature] Computing pair feature vector between points %lu and %lu went wrong.\n", getClassName ().c_str (), (unsigned long) i, (unsigned long) j);
           p.setConstant (std::numeric_limits<float>::quiet_NaN ());
-          output.is_dense = false;
+          is_dense = false;
         }
       }
       // Do not calculate the feature for identity pairs (i, i) as they are not used
@@ -166,12 +174,13 @@ pcl::PPFEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
       else
       {
         p.setConstant (std::numeric_limits<float>::quiet_NaN ());
-        output.is_dense = false;
+        is_dense = false;
       }
 
       output.points.row (index_i*input_->points.size () + j) = p;
     }
   }
+  output.is_dense = is_dense;
 }
 
 
@@ -47,67 +47,77 @@ template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computePointPrincipalCurvatures (
       const pcl::PointCloud<PointNT> &normals, int p_idx, const std::vector<int> &indices,
       float &pcx, float &pcy, float &pcz, float &pc1, float &pc2)
+{
+  computePointPrincipalCurvatures (normals, p_idx, indices, projected_normals_, pcx, pcy, pcz, pc1, pc2);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computePointPrincipalCurvatures (
+      const pcl::PointCloud<PointNT> &normals, int p_idx, const std::vector<int> &indices,
+      std::vector<Eigen::Vector3f> &projected_normals,
+      float &pcx, float &pcy, float &pcz, float &pc1, float &pc2) const
 {
   EIGEN_ALIGN16 Eigen::Matrix3f I = Eigen::Matrix3f::Identity ();
   Eigen::Vector3f n_idx (normals.points[p_idx].normal[0], normals.points[p_idx].normal[1], normals.points[p_idx].normal[2]);
   EIGEN_ALIGN16 Eigen::Matrix3f M = I - n_idx * n_idx.transpose ();    // projection matrix (into tangent plane)
 
   // Project normals into the tangent plane
-  Eigen::Vector3f normal;
-  projected_normals_.resize (indices.size ());
-  xyz_centroid_.setZero ();
+  Eigen::Vector3f normal, xyz_centroid, demean;
+  projected_normals.resize (indices.size ());
+  xyz_centroid.setZero ();
   for (size_t idx = 0; idx < indices.size(); ++idx)
   {
     normal[0] = normals.points[indices[idx]].normal[0];
     normal[1] = normals.points[indices[idx]].normal[1];
     normal[2] = normals.points[indices[idx]].normal[2];
 
-    projected_normals_[idx] = M * normal;
-    xyz_centroid_ += projected_normals_[idx];
+    projected_normals[idx] = M * normal;
+    xyz_centroid += projected_normals[idx];
   }
 
   // Estimate the XYZ centroid
-  xyz_centroid_ /= indices.size ();
+  xyz_centroid /= indices.size ();
 
   // Initialize to 0
-  covariance_matrix_.setZero ();
+  EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix = Eigen::Matrix3f::Zero ();
 
   double demean_xy, demean_xz, demean_yz;
   // For each point in the cloud
   for (size_t idx = 0; idx < indices.size (); ++idx)
   {
-    demean_ = projected_normals_[idx] - xyz_centroid_;
+    demean = projected_normals[idx] - xyz_centroid;
 
-    demean_xy = demean_[0] * demean_[1];
-    demean_xz = demean_[0] * demean_[2];
-    demean_yz = demean_[1] * demean_[2];
+    demean_xy = demean[0] * demean[1];
+    demean_xz = demean[0] * demean[2];
+    demean_yz = demean[1] * demean[2];
 
-    covariance_matrix_(0, 0) += demean_[0] * demean_[0];
-    covariance_matrix_(0, 1) += demean_xy;
-    covariance_matrix_(0, 2) += demean_xz;
+    covariance_matrix(0, 0) += demean[0] * demean[0];
+    covariance_matrix(0, 1) += demean_xy;
+    covariance_matrix(0, 2) += demean_xz;
 
-    covariance_matrix_(1, 0) += demean_xy;
-    covariance_matrix_(1, 1) += demean_[1] * demean_[1];
-    covariance_matrix_(1, 2) += demean_yz;
+    covariance_matrix(1, 0) += demean_xy;
+    covariance_matrix(1, 1) += demean[1] * demean[1];
+    covariance_matrix(1, 2) += demean_yz;
 
-    covariance_matrix_(2, 0) += demean_xz;
-    covariance_matrix_(2, 1) += demean_yz;
-    covariance_matrix_(2, 2) += demean_[2] * demean_[2];
+    covariance_matrix(2, 0) += demean_xz;
+    covariance_matrix(2, 1) += demean_yz;
+    covariance_matrix(2, 2) += demean[2] * demean[2];
   }
 
   // Extract the eigenvalues and eigenvectors
-  pcl::eigen33 (covariance_matrix_, eigenvalues_);
-  pcl::computeCorrespondingEigenVector (covariance_matrix_, eigenvalues_ [2], eigenvector_);
+  Eigen::Vector3f eigenvalues, eigenvector;
+  pcl::eigen33 (covariance_matrix, eigenvalues);
+  pcl::computeCorrespondingEigenVector (covariance_matrix, eigenvalues [2], eigenvector);
 
-  pcx = eigenvector_ [0];
-  pcy = eigenvector_ [1];
-  pcz = eigenvector_ [2];
+  pcx = eigenvector [0];
+  pcy = eigenvector [1];
+  pcz = eigenvector [2];
   float indices_size = 1.0f / indices.size ();
-  pc1 = eigenvalues_ [2] * indices_size;
-  pc2 = eigenvalues_ [1] * indices_size;
+  pc1 = eigenvalues [2] * indices_size;
+  pc2 = eigenvalues [1] * indices_size;
 }
 
-
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -71,6 +71,288 @@ areEquals (float val1, float val2, float zeroFloatEps = zeroFloatEps8)
   return (fabs (val1 - val2)<zeroFloatEps);
 }
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief The number of neighbors processed at once by the vectorized SHOT interpolation, a multiple of 4. */
+    const int shot_block_size = 64;
+
+    /** \brief A batch of SHOT neighbors stored as a structure of arrays. The local coordinates and the distance are
+      * the input of computeSHOTVotes; the rest is its output. Besides its own volume, every neighbor votes for
+      * the adjacent volume along the radius, the inclination and the azimuth, each with its own weight.
+      */
+    struct SHOTBlock
+    {
+      /** \brief The index of the neighbor in the neighborhood. */
+      int index[shot_block_size];
+      float x[shot_block_size], y[shot_block_size], z[shot_block_size], distance[shot_block_size];
+      /** \brief The volume of the neighbor, and the weight of its vote summed over the three dimensions. */
+      float volume[shot_block_size], weight[shot_block_size];
+      float radius_volume[shot_block_size], radius_weight[shot_block_size];
+      float inclination_volume[shot_block_size], inclination_weight[shot_block_size];
+      float azimuth_volume[shot_block_size], azimuth_weight[shot_block_size];
+    };
+
+    /** \brief Approximate atan (t) on [0, 1] with the polynomial of Abramowitz and Stegun (4.4.49), whose absolute
+      * error is below 1e-5.
+      */
+    inline float
+    atanUnit (float t)
+    {
+      float t2 = t * t;
+      return (t * (0.9998660f + t2 * (-0.3302995f + t2 * (0.1801410f + t2 * (-0.0851330f + t2 * 0.0208351f)))));
+    }
+
+    /** \brief Approximate atan2 (y, x) by reducing it to atanUnit. +0 and -0 are both taken as positive. */
+    inline float
+    atan2Approx (float y, float x)
+    {
+      float ax = fabsf (x), ay = fabsf (y);
+      float mx = (std::max) (ax, ay);
+      float a = atanUnit (mx > 0 ? (std::min) (ax, ay) / mx : 0);
+      a = ay > ax ? static_cast<float> (PST_RAD_90) - a : a;
+      a = x < 0 ? static_cast<float> (PST_PI) - a : a;
+      return (y < 0 ? -a : a);
+    }
+
+#ifdef __SSE__
+    /** \brief Select a where the mask is set, and b elsewhere. */
+    inline __m128
+    selectSSE (__m128 mask, __m128 a, __m128 b)
+    {
+      return (_mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b)));
+    }
+
+    /** \brief Four lanes version of atan2Approx. */
+    inline __m128
+    atan2ApproxSSE (__m128 y, __m128 x)
+    {
+      const __m128 sign = _mm_set1_ps (-0.0f);
+      const __m128 zero = _mm_setzero_ps ();
+      __m128 ax = _mm_andnot_ps (sign, x), ay = _mm_andnot_ps (sign, y);
+      __m128 mx = _mm_max_ps (ax, ay);
+      // 0 / 0 gives a NaN that the mask drops
+      __m128 t = _mm_and_ps (_mm_cmpgt_ps (mx, zero), _mm_div_ps (_mm_min_ps (ax, ay), mx));
+      __m128 t2 = _mm_mul_ps (t, t);
+      __m128 p = _mm_add_ps (_mm_set1_ps (-0.0851330f), _mm_mul_ps (t2, _mm_set1_ps (0.0208351f)));
+      p = _mm_add_ps (_mm_set1_ps (0.1801410f), _mm_mul_ps (t2, p));
+      p = _mm_add_ps (_mm_set1_ps (-0.3302995f), _mm_mul_ps (t2, p));
+      p = _mm_add_ps (_mm_set1_ps (0.9998660f), _mm_mul_ps (t2, p));
+      __m128 a = _mm_mul_ps (t, p);
+      a = selectSSE (_mm_cmpgt_ps (ay, ax), _mm_sub_ps (_mm_set1_ps (static_cast<float> (PST_RAD_90)), a), a);
+      a = selectSSE (_mm_cmplt_ps (x, zero), _mm_sub_ps (_mm_set1_ps (static_cast<float> (PST_PI)), a), a);
+      return (selectSSE (_mm_cmplt_ps (y, zero), _mm_sub_ps (zero, a), a));
+    }
+#endif
+
+    /** \brief Compute the volumes and the interpolation weights of the first n neighbors of a block, as the
+      * reference SHOTEstimationBase::interpolateSingleChannel does, but without branches. The neighbors must have
+      * a non zero distance. With SSE the block is processed 4 lanes at a time, so the lanes from n up to the next
+      * multiple of 4 are computed too (and their output is meaningless).
+      * \param[in,out] b the block
+      * \param[in] n the number of neighbors in the block
+      * \param[in] radius1_4 1/4 of the search radius
+      * \param[in] radius1_2 1/2 of the search radius
+      * \param[in] radius3_4 3/4 of the search radius
+      * \param[in] max_angular_sectors the modulo of the azimuth volume indices
+      */
+    inline void
+    computeSHOTVotes (SHOTBlock &b, int n, float radius1_4, float radius1_2, float radius3_4, float max_angular_sectors)
+    {
+#ifdef __SSE__
+      const __m128 zero = _mm_setzero_ps ();
+      const __m128 one = _mm_set1_ps (1.0f);
+      const __m128 sign = _mm_set1_ps (-0.0f);
+      const __m128 tiny = _mm_set1_ps (1e-30f);
+      const __m128 half = _mm_set1_ps (0.5f);
+      const __m128 inv_radius1_2 = _mm_set1_ps (1.0f / radius1_2);
+      const __m128 inv_rad_45 = _mm_set1_ps (static_cast<float> (1.0 / PST_RAD_45));
+      const __m128 inv_rad_90 = _mm_set1_ps (static_cast<float> (1.0 / PST_RAD_90));
+      const __m128 sectors = _mm_set1_ps (max_angular_sectors);
+      for (int k = 0; k < n; k += 4)
+      {
+        __m128 x = _mm_loadu_ps (b.x + k);
+        __m128 y = _mm_loadu_ps (b.y + k);
+        __m128 z = _mm_loadu_ps (b.z + k);
+        __m128 d = _mm_loadu_ps (b.distance + k);
+
+        // To avoid numerical problems afterwards
+        x = _mm_and_ps (_mm_cmpnlt_ps (_mm_andnot_ps (sign, x), tiny), x);
+        y = _mm_and_ps (_mm_cmpnlt_ps (_mm_andnot_ps (sign, y), tiny), y);
+        z = _mm_and_ps (_mm_cmpnlt_ps (_mm_andnot_ps (sign, z), tiny), z);
+
+        // The azimuth sector, then the inclination and the radius bits of the volume
+        __m128 x_pos = _mm_cmpgt_ps (x, zero), x_neg = _mm_cmplt_ps (x, zero), x_zero = _mm_cmpeq_ps (x, zero);
+        __m128 y_pos = _mm_cmpgt_ps (y, zero), y_neg = _mm_cmplt_ps (y, zero), y_zero = _mm_cmpeq_ps (y, zero);
+        __m128 bit4 = _mm_or_ps (y_pos, _mm_and_ps (y_zero, x_neg));
+        __m128 bit3 = _mm_xor_ps (bit4, _mm_or_ps (x_pos, _mm_and_ps (x_zero, y_pos)));
+        __m128 same = _mm_or_ps (_mm_or_ps (_mm_and_ps (x_pos, y_pos), _mm_and_ps (x_neg, y_neg)), x_zero);
+        __m128 ax = _mm_andnot_ps (sign, x), ay = _mm_andnot_ps (sign, y);
+        __m128 bit2 = selectSSE (same, _mm_cmplt_ps (ax, ay), _mm_cmpgt_ps (ax, ay));
+        __m128 sel = _mm_add_ps (_mm_add_ps (_mm_and_ps (bit4, _mm_set1_ps (4.0f)), _mm_and_ps (bit3, _mm_set1_ps (2.0f))),
+                                 _mm_and_ps (bit2, one));
+        __m128 upper = _mm_cmpngt_ps (z, zero);
+        __m128 outer = _mm_cmpgt_ps (d, _mm_set1_ps (radius1_2));
+        __m128 volume = _mm_add_ps (_mm_mul_ps (sel, _mm_set1_ps (4.0f)),
+                                    _mm_add_ps (_mm_andnot_ps (upper, one), _mm_and_ps (outer, _mm_set1_ps (2.0f))));
+
+        // Interpolation on the distance (adjacent husks)
+        __m128 t = _mm_mul_ps (_mm_sub_ps (d, selectSSE (outer, _mm_set1_ps (radius3_4), _mm_set1_ps (radius1_4))),
+                               inv_radius1_2);
+        __m128 weight = _mm_sub_ps (one, _mm_andnot_ps (sign, t));
+        _mm_storeu_ps (b.radius_weight + k, _mm_max_ps (selectSSE (outer, _mm_sub_ps (zero, t), t), zero));
+        _mm_storeu_ps (b.radius_volume + k, _mm_add_ps (volume, selectSSE (outer, _mm_set1_ps (-2.0f), _mm_set1_ps (2.0f))));
+
+        // Interpolation on the inclination (adjacent vertical volumes), acos (c) being atan2 (sqrt (1 - c^2), c)
+        __m128 c = _mm_min_ps (_mm_max_ps (_mm_div_ps (z, d), _mm_set1_ps (-1.0f)), one);
+        __m128 s = _mm_sqrt_ps (_mm_max_ps (_mm_sub_ps (one, _mm_mul_ps (c, c)), zero));
+        __m128 inclination = atan2ApproxSSE (s, c);
+        t = _mm_mul_ps (_mm_sub_ps (inclination, selectSSE (upper, _mm_set1_ps (static_cast<float> (PST_RAD_135)),
+                                                                   _mm_set1_ps (static_cast<float> (PST_RAD_45)))),
+                        inv_rad_90);
+        weight = _mm_add_ps (weight, _mm_sub_ps (one, _mm_andnot_ps (sign, t)));
+        _mm_storeu_ps (b.inclination_weight + k, _mm_max_ps (selectSSE (upper, _mm_sub_ps (zero, t), t), zero));
+        _mm_storeu_ps (b.inclination_volume + k, _mm_add_ps (volume, selectSSE (upper, one, _mm_set1_ps (-1.0f))));
+
+        // Interpolation on the azimuth (adjacent horizontal volumes), skipped for neighbors on the z axis
+        __m128 valid = _mm_andnot_ps (_mm_and_ps (x_zero, y_zero), _mm_cmpeq_ps (zero, zero));
+        __m128 azimuth = atan2ApproxSSE (y, x);
+        t = _mm_mul_ps (_mm_sub_ps (azimuth, _mm_add_ps (_mm_set1_ps (static_cast<float> (-PST_RAD_PI_7_8)),
+                                                         _mm_mul_ps (sel, _mm_set1_ps (static_cast<float> (PST_RAD_45))))),
+                        inv_rad_45);
+        t = _mm_min_ps (_mm_max_ps (t, _mm_set1_ps (-0.5f)), half);
+        __m128 abs_t = _mm_andnot_ps (sign, t);
+        weight = _mm_add_ps (weight, _mm_and_ps (valid, _mm_sub_ps (one, abs_t)));
+        _mm_storeu_ps (b.azimuth_weight + k, _mm_and_ps (valid, abs_t));
+        __m128 next = _mm_add_ps (volume, selectSSE (_mm_cmpgt_ps (t, zero), _mm_set1_ps (4.0f),
+                                                     _mm_sub_ps (sectors, _mm_set1_ps (4.0f))));
+        _mm_storeu_ps (b.azimuth_volume + k, _mm_sub_ps (next, _mm_and_ps (_mm_cmpnlt_ps (next, sectors), sectors)));
+
+        _mm_storeu_ps (b.volume + k, volume);
+        _mm_storeu_ps (b.weight + k, weight);
+      }
+#else
+      for (int k = 0; k < n; ++k)
+      {
+        float x = fabsf (b.x[k]) < 1e-30f ? 0 : b.x[k];
+        float y = fabsf (b.y[k]) < 1e-30f ? 0 : b.y[k];
+        float z = fabsf (b.z[k]) < 1e-30f ? 0 : b.z[k];
+        float d = b.distance[k];
+
+        int bit4 = (y > 0) | ((y == 0) & (x < 0));
+        int bit3 = bit4 ^ ((x > 0) | ((x == 0) & (y > 0)));
+        int same = ((x > 0) & (y > 0)) | ((x < 0) & (y < 0)) | (x == 0);
+        int bit2 = same ? (fabsf (x) < fabsf (y)) : (fabsf (x) > fabsf (y));
+        float sel = static_cast<float> ((bit4 << 2) + (bit3 << 1) + bit2);
+        bool upper = !(z > 0);
+        bool outer = d > radius1_2;
+        float volume = sel * 4 + (upper ? 0.0f : 1.0f) + (outer ? 2.0f : 0.0f);
+
+        float t = (d - (outer ? radius3_4 : radius1_4)) / radius1_2;
+        float weight = 1 - fabsf (t);
+        b.radius_weight[k] = (std::max) (outer ? -t : t, 0.0f);
+        b.radius_volume[k] = volume + (outer ? -2.0f : 2.0f);
+
+        float c = (std::min) ((std::max) (z / d, -1.0f), 1.0f);
+        float inclination = atan2Approx (sqrtf ((std::max) (1 - c * c, 0.0f)), c);
+        t = (inclination - static_cast<float> (upper ? PST_RAD_135 : PST_RAD_45)) / static_cast<float> (PST_RAD_90);
+        weight += 1 - fabsf (t);
+        b.inclination_weight[k] = (std::max) (upper ? -t : t, 0.0f);
+        b.inclination_volume[k] = volume + (upper ? 1.0f : -1.0f);
+
+        bool valid = (x != 0) | (y != 0);
+        t = (atan2Approx (y, x) - static_cast<float> (-PST_RAD_PI_7_8 + PST_RAD_45 * sel)) / static_cast<float> (PST_RAD_45);
+        t = (std::min) ((std::max) (t, -0.5f), 0.5f);
+        weight += valid ? 1 - fabsf (t) : 0.0f;
+        b.azimuth_weight[k] = valid ? fabsf (t) : 0.0f;
+        float next = volume + (t > 0 ? 4.0f : max_angular_sectors - 4.0f);
+        b.azimuth_volume[k] = next >= max_angular_sectors ? next - max_angular_sectors : next;
+
+        b.volume[k] = volume;
+        b.weight[k] = weight;
+      }
+#endif
+    }
+
+    /** \brief Add the votes of the first n neighbors of a block to one channel (shape or color) of a SHOT histogram.
+      * \param[in] b the block, as filled by computeSHOTVotes
+      * \param[in] n the number of neighbors in the block
+      * \param[in] bin_distance the (fractional) histogram bin of every neighbor in the neighborhood
+      * \param[in] nr_bins the number of bins in the histogram of the channel
+      * \param[in] offset the index of the first bin of the channel in the histogram
+      * \param[in,out] shot the SHOT histogram
+      */
+    inline void
+    addSHOTVotes (const SHOTBlock &b, int n, const std::vector<double> &bin_distance, int nr_bins, int offset,
+                  Eigen::VectorXf &shot)
+    {
+      const int stride = nr_bins + 1;
+      for (int k = 0; k < n; ++k)
+      {
+        double bin = bin_distance[b.index[k]];
+        int step_index = static_cast<int> (floor (bin + 0.5));
+        float frac = static_cast<float> (bin - step_index);
+
+        //Interpolation on the cosine (adjacent bins in the histogram)
+        int volume_index = offset + static_cast<int> (b.volume[k]) * stride;
+        shot[volume_index + (frac > 0 ? (step_index + 1) % nr_bins : (step_index - 1 + nr_bins) % nr_bins)] += fabsf (frac);
+
+        shot[offset + static_cast<int> (b.radius_volume[k]) * stride + step_index] += b.radius_weight[k];
+        shot[offset + static_cast<int> (b.inclination_volume[k]) * stride + step_index] += b.inclination_weight[k];
+        shot[offset + static_cast<int> (b.azimuth_volume[k]) * stride + step_index] += b.azimuth_weight[k];
+        shot[volume_index + step_index] += 1 - fabsf (frac) + b.weight[k];
+      }
+    }
+
+    /** \brief Fill a block with the next neighbors of a neighborhood, expressed in the local reference frame,
+      * skipping the ones that coincide with the central point.
+      * \param[in] surface the search surface
+      * \param[in] indices the neighborhood point indices
+      * \param[in] sqr_dists the neighborhood point distances
+      * \param[in] central_point the central point
+      * \param[in] rf the local reference frame
+      * \param[in,out] i_idx the neighbor to start from; on output, the first neighbor not in the block
+      * \param[out] b the block
+      * \return the number of neighbors in the block
+      */
+    template <typename PointT> inline int
+    fillSHOTBlock (const pcl::PointCloud<PointT> &surface, const std::vector<int> &indices,
+                   const std::vector<float> &sqr_dists, const Eigen::Vector4f &central_point,
+                   const std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > &rf,
+                   size_t &i_idx, SHOTBlock &b)
+    {
+      int n = 0;
+      for (; i_idx < indices.size () && n < shot_block_size; ++i_idx)
+      {
+        double distance = sqrt (sqr_dists[i_idx]);
+        if (areEquals (distance, 0.0))
+          continue;
+
+        Eigen::Vector4f delta = surface.points[indices[i_idx]].getVector4fMap () - central_point;
+        delta[3] = 0;
+        b.index[n] = static_cast<int> (i_idx);
+        b.x[n] = delta.dot (rf[0]);
+        b.y[n] = delta.dot (rf[1]);
+        b.z[n] = delta.dot (rf[2]);
+        b.distance[n] = static_cast<float> (distance);
+        ++n;
+      }
+      // Keep the padding lanes of the last group of 4 finite
+      for (int k = n; k < shot_block_size && (k & 3) != 0; ++k)
+      {
+        b.x[k] = b.y[k] = b.z[k] = 0;
+        b.distance[k] = 1;
+      }
+      return (n);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT, typename PointOutT> float
 pcl::SHOTEstimation<pcl::PointXYZRGBA, PointNT, PointOutT>::sRGB_LUT[256] = {- 1};
@@ -206,6 +488,18 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT>::interpolateSingleChannel
     return;
   }
 
+  if (vectorized_interpolation_)
+  {
+    pcl::detail::SHOTBlock block;
+    for (size_t i_idx = 0; i_idx < indices.size (); )
+    {
+      int n = pcl::detail::fillSHOTBlock (*surface_, indices, sqr_dists, central_point, rf, i_idx, block);
+      pcl::detail::computeSHOTVotes (block, n, radius1_4_, radius1_2_, radius3_4_, maxAngularSectors_);
+      pcl::detail::addSHOTVotes (block, n, binDistance, nr_bins, 0, shot);
+    }
+    return;
+  }
+
   for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
     Eigen::Vector4f delta = surface_->points[indices[i_idx]].getVector4fMap () - central_point;
@@ -382,6 +676,20 @@ pcl::SHOTEstimation<pcl::PointXYZRGBA, PointNT, PointOutT>::interpolateDoubleCha
 
   int shapeToColorStride = nr_grid_sector_*(nr_bins_shape+1);
 
+  if (vectorized_interpolation_)
+  {
+    // The geometric part of the interpolation is shared by the two channels
+    pcl::detail::SHOTBlock block;
+    for (size_t i_idx = 0; i_idx < indices.size (); )
+    {
+      int n = pcl::detail::fillSHOTBlock (*surface_, indices, sqr_dists, central_point, rf, i_idx, block);
+      pcl::detail::computeSHOTVotes (block, n, radius1_4_, radius1_2_, radius3_4_, maxAngularSectors_);
+      pcl::detail::addSHOTVotes (block, n, binDistanceShape, nr_bins_shape, 0, shot);
+      pcl::detail::addSHOTVotes (block, n, binDistanceColor, nr_bins_color, shapeToColorStride, shot);
+    }
+    return;
+  }
+
   for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
     Eigen::Vector4f delta = surface_->points[indices[i_idx]].getVector4fMap () - central_point;
@@ -68,6 +68,16 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::SpinImageEstimation (
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> Eigen::ArrayXXd 
 pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int index) const
+{
+  Eigen::ArrayXXd m_matrix, m_averAngles;
+  computeSiForPoint (index, m_matrix, m_averAngles);
+  return (m_matrix);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (
+    int index, Eigen::ArrayXXd &m_matrix, Eigen::ArrayXXd &m_averAngles) const
 {
   assert (image_width_ > 0);
   assert (support_angle_cos_ <= 1.0 && support_angle_cos_ >= 0.0); // may be permit negative cosine?
@@ -86,8 +96,9 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
       rotation_axes_cloud_->points[index].getNormalVector3fMap () :
       origin_normal;  
 
-  Eigen::ArrayXXd m_matrix (Eigen::ArrayXXd::Zero (image_width_+1, 2*image_width_+1));
-  Eigen::ArrayXXd m_averAngles (Eigen::ArrayXXd::Zero (image_width_+1, 2*image_width_+1));
+  // setZero only reallocates when the size changes, so that the buffers can be reused from one point to the next
+  m_matrix.setZero (image_width_+1, 2*image_width_+1);
+  m_averAngles.setZero (image_width_+1, 2*image_width_+1);
 
   // OK, we are interested in the points of the cylinder of height 2*r and
   // base radius r, where r = m_dBinSize * in_iImageWidth
@@ -230,8 +241,6 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
     // normalization
     m_matrix /= m_matrix.sum();
   }
-
-  return m_matrix;
 }
 
 
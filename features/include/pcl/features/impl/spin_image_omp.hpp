@@ -0,0 +1,95 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_SPIN_IMAGE_OMP_HPP_
+#define PCL_FEATURES_IMPL_SPIN_IMAGE_OMP_HPP_
+
+#include "pcl/features/spin_image_omp.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void 
+pcl::SpinImageEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{ 
+  const int nr_points = static_cast<int> (indices_->size ());
+
+  // An exception must not leave the parallel region, so keep the first one and throw it after the loop
+  bool failed = false;
+  PCLException error ("");
+
+#pragma omp parallel num_threads (threads_)
+  {
+    // Scratch spin-images, reused for all the points of this thread
+    Eigen::ArrayXXd res, aver_angles;
+
+#pragma omp for schedule (dynamic, 32)
+    for (int i_input = 0; i_input < nr_points; ++i_input)
+    {
+      try
+      {
+        this->computeSiForPoint ((*indices_)[i_input], res, aver_angles);
+      }
+      catch (const PCLException &e)
+      {
+#pragma omp critical
+        {
+          if (!failed)
+          {
+            error = e;
+            failed = true;
+          }
+        }
+        continue;
+      }
+
+      // Copy into the resultant cloud
+      for (int iRow = 0; iRow < res.rows () ; iRow++)
+      {
+        for (int iCol = 0; iCol < res.cols () ; iCol++)
+        {
+          output.points[i_input].histogram[ iRow*res.cols () + iCol ] = (float)res(iRow, iCol);
+        }
+      }
+    }
+  }
+
+  if (failed)
+    throw error;
+}
+
+#define PCL_INSTANTIATE_SpinImageEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::SpinImageEstimationOMP<T,NT,OutT>;
+
+#endif    // PCL_FEATURES_IMPL_SPIN_IMAGE_OMP_HPP_
@@ -121,6 +121,13 @@ pcl::UniqueShapeContext<PointInT, PointOutT>::initCompute ()
         volume_lut_[(l*elevation_bins_*radius_bins_) + k*radius_bins_ + j] = 1.0 / pow (V, e);
     }
   }
+
+  // Bin look up tables, with a few cells per bin
+  radius_lut_.init (radii_interval_, 8 * radius_bins_);
+  theta_lut_.init (theta_divisions_, 4 * elevation_bins_);
+  phi_lut_.init (phi_divisions_, 4 * azimuth_bins_);
+
+  point_densities_.assign (surface_->points.size (), -1);
   return (true);
 }
 
@@ -191,43 +198,13 @@ pcl::UniqueShapeContext<PointInT, PointOutT>::computePointDescriptor (size_t ind
     float theta = normal.dot (no);
     theta = pcl::rad2deg (acos (std::min (1.0f, std::max (-1.0f, theta))));
 
-    /// Bin (j, k, l)
-    size_t j = 0;
-    size_t k = 0;
-    size_t l = 0;
-
     /// Compute the Bin(j, k, l) coordinates of current neighbour
-    for (size_t rad = 1; rad < radius_bins_ + 1; rad++) 
-    {
-      if (r <= radii_interval_[rad])
-      {
-        j = rad - 1;
-        break;
-      }
-    }
-
-    for (size_t ang = 1; ang < elevation_bins_ + 1; ang++) 
-    {
-      if (theta <= theta_divisions_[ang]) 
-      {
-        k = ang - 1;
-        break;
-      }
-    }
-
-    for (size_t ang = 1; ang < azimuth_bins_ + 1; ang++) 
-    {
-      if (phi <= phi_divisions_[ang]) 
-      {
-        l = ang - 1;
-        break;
-      }
-    }
+    size_t j = radius_lut_.find (r);
+    size_t k = theta_lut_.find (theta);
+    size_t l = phi_lut_.find (phi);
 
     /// Local point density = number of points in a sphere of radius "point_density_radius_" around the current neighbour
-    std::vector<int> neighbour_indices;
-    std::vector<float> neighbour_didtances;
-    float point_density = (float) searchForNeighbors (*surface_, nn_indices[ne], point_density_radius_, neighbour_indices, neighbour_didtances);
+    float point_density = (float) getPointDensity (nn_indices[ne]);
     /// point_density is always bigger than 0 because FindPointsWithinRadius returns at least the point itself
     float w = (1.0 / point_density) * volume_lut_[(l*elevation_bins_*radius_bins_) + 
                                                   (k*radius_bins_) + 
@@ -66,13 +66,28 @@ pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computePointSPFHSignature (con
                                                                              const pcl::PointCloud<PointNT> &normals,
                                                                              const std::vector<int> &indices)
 {
-  Eigen::Vector4f pfh_tuple;
   // Reset the whole thing
   hist_f1_.setZero (nr_bins_f1_);
   hist_f2_.setZero (nr_bins_f2_);
   hist_f3_.setZero (nr_bins_f3_);
   hist_f4_.setZero (nr_bins_f4_);
 
+  computePointSPFHSignature (centroid_p, centroid_n, cloud, normals, indices,
+                             hist_f1_.data (), hist_f2_.data (), hist_f3_.data (), hist_f4_.data ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT> void
+pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computePointSPFHSignature (const Eigen::Vector4f &centroid_p,
+                                                                             const Eigen::Vector4f &centroid_n,
+                                                                             const pcl::PointCloud<PointInT> &cloud,
+                                                                             const pcl::PointCloud<PointNT> &normals,
+                                                                             const std::vector<int> &indices,
+                                                                             float *hist_f1, float *hist_f2,
+                                                                             float *hist_f3, float *hist_f4) const
+{
+  Eigen::Vector4f pfh_tuple;
+
   // Get the bounding box of the current cluster
   //Eigen::Vector4f min_pt, max_pt;
   //pcl::getMinMax3D (cloud, indices, min_pt, max_pt);
@@ -119,21 +134,21 @@ pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computePointSPFHSignature (con
       h_index = 0;
     if (h_index >= nr_bins_f1_)
       h_index = nr_bins_f1_ - 1;
-    hist_f1_ (h_index) += hist_incr;
+    hist_f1[h_index] += hist_incr;
 
     h_index = floor (nr_bins_f2_ * ((pfh_tuple[1] + 1.0) * 0.5));
     if (h_index < 0)
       h_index = 0;
     if (h_index >= nr_bins_f2_)
       h_index = nr_bins_f2_ - 1;
-    hist_f2_ (h_index) += hist_incr;
+    hist_f2[h_index] += hist_incr;
 
     h_index = floor (nr_bins_f3_ * ((pfh_tuple[2] + 1.0) * 0.5));
     if (h_index < 0)
       h_index = 0;
     if (h_index >= nr_bins_f3_)
       h_index = nr_bins_f3_ - 1;
-    hist_f3_ (h_index) += hist_incr;
+    hist_f3[h_index] += hist_incr;
 
     if (normalize_distances_)
       h_index = floor (nr_bins_f4_ * (pfh_tuple[3] / distance_normalization_factor));
@@ -145,12 +160,65 @@ pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computePointSPFHSignature (con
     if (h_index >= nr_bins_f4_)
       h_index = nr_bins_f4_ - 1;
 
-    hist_f4_ (h_index) += hist_incr_size_component;
+    hist_f4[h_index] += hist_incr_size_component;
   }
 }
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computeSignature (const Eigen::Vector4f &xyz_centroid,
+                                                                    const Eigen::Vector4f &normal_centroid,
+                                                                    const pcl::PointCloud<PointInT> &cloud,
+                                                                    const pcl::PointCloud<PointNT> &normals,
+                                                                    const std::vector<int> &indices,
+                                                                    PointOutT &signature) const
+{
+  // The f1, f2, f3, f4 and viewpoint histograms follow each other in the signature
+  float *hist_f1 = signature.histogram;
+  float *hist_f2 = hist_f1 + nr_bins_f1_;
+  float *hist_f3 = hist_f2 + nr_bins_f2_;
+  float *hist_f4 = hist_f3 + nr_bins_f3_;
+  float *hist_vp = hist_f4 + nr_bins_f4_;
+  std::fill (hist_f1, hist_vp + nr_bins_vp_, 0.0f);
+
+  // Compute the direction of view from the viewpoint to the centroid
+  Eigen::Vector4f viewpoint (vpx_, vpy_, vpz_, 0);
+  Eigen::Vector4f d_vp_p = viewpoint - xyz_centroid;
+  d_vp_p.normalize ();
+
+  // ---[ Step 1 : estimate the SPFH between the centroid and all the points
+  computePointSPFHSignature (xyz_centroid, normal_centroid, cloud, normals, indices, hist_f1, hist_f2, hist_f3, hist_f4);
+
+  // ---[ Step 2 : obtain the viewpoint component
+  double hist_incr;
+  if (normalize_bins_)
+    hist_incr = 100.0 / (double)(indices.size ());
+  else
+    hist_incr = 1.0;
+
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    Eigen::Vector4f normal (normals.points[indices[i]].normal[0],
+                            normals.points[indices[i]].normal[1],
+                            normals.points[indices[i]].normal[2], 0);
+    // Normalize
+    double alpha = (normal.dot (d_vp_p) + 1.0) * 0.5;
+    int fi = floor (alpha * nr_bins_vp_);
+    if (fi < 0)
+      fi = 0;
+    if (fi > (nr_bins_vp_ - 1))
+      fi = nr_bins_vp_ - 1;
+    // Bin into the histogram
+    hist_vp[fi] += hist_incr;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computeSignature (const pcl::PointCloud<PointInT> &cloud,
+                                                                    const pcl::PointCloud<PointNT> &normals,
+                                                                    const std::vector<int> &indices,
+                                                                    PointOutT &signature) const
 {
   // ---[ Step 1a : compute the centroid in XYZ space
   Eigen::Vector4f xyz_centroid;
@@ -158,7 +226,7 @@ pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   if (use_given_centroid_) 
     xyz_centroid = centroid_to_use_;
   else
-    compute3DCentroid (*surface_, *indices_, xyz_centroid);          // Estimate the XYZ centroid
+    compute3DCentroid (cloud, indices, xyz_centroid);          // Estimate the XYZ centroid
 
   // ---[ Step 1b : compute the centroid in normal space
   Eigen::Vector4f normal_centroid = Eigen::Vector4f::Zero ();
@@ -169,89 +237,82 @@ pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     normal_centroid = normal_to_use_;
   else
   {
-    if (normals_->is_dense)
+    if (normals.is_dense)
     {
-      for (size_t i = 0; i < indices_->size (); ++i)
+      for (size_t i = 0; i < indices.size (); ++i)
       {
-        normal_centroid += normals_->points[(*indices_)[i]].getNormalVector4fMap ();
+        normal_centroid += normals.points[indices[i]].getNormalVector4fMap ();
         cp++;
       }
     }
     // NaN or Inf values could exist => check for them
     else
     {
-      for (size_t i = 0; i < indices_->size (); ++i)
+      for (size_t i = 0; i < indices.size (); ++i)
       {
-        if (!pcl_isfinite (normals_->points[(*indices_)[i]].normal[0])
+        if (!pcl_isfinite (normals.points[indices[i]].normal[0])
             ||
-            !pcl_isfinite (normals_->points[(*indices_)[i]].normal[1])
+            !pcl_isfinite (normals.points[indices[i]].normal[1])
             ||
-            !pcl_isfinite (normals_->points[(*indices_)[i]].normal[2]))
+            !pcl_isfinite (normals.points[indices[i]].normal[2]))
           continue;
-        normal_centroid += normals_->points[(*indices_)[i]].getNormalVector4fMap ();
+        normal_centroid += normals.points[indices[i]].getNormalVector4fMap ();
         cp++;
       }
     }
     normal_centroid /= cp;
   }
 
-  // Compute the direction of view from the viewpoint to the centroid
-  Eigen::Vector4f viewpoint (vpx_, vpy_, vpz_, 0);
-  Eigen::Vector4f d_vp_p = viewpoint - xyz_centroid;
-  d_vp_p.normalize ();
-
-  // Estimate the SPFH at nn_indices[0] using the entire cloud
-  computePointSPFHSignature (xyz_centroid, normal_centroid, *surface_, *normals_, *indices_);
+  computeSignature (xyz_centroid, normal_centroid, cloud, normals, indices, signature);
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
   // We only output _1_ signature
   output.points.resize (1);
   output.width = 1;
   output.height = 1;
 
-  // Estimate the FPFH at nn_indices[0] using the entire cloud and copy the resultant signature
-  for (int d = 0; d < hist_f1_.size (); ++d)
-    output.points[0].histogram[d + 0] = hist_f1_[d];
-
-  size_t data_size = hist_f1_.size ();
-  for (int d = 0; d < hist_f2_.size (); ++d)
-    output.points[0].histogram[d + data_size] = hist_f2_[d];
-
-  data_size += hist_f2_.size ();
-  for (int d = 0; d < hist_f3_.size (); ++d)
-    output.points[0].histogram[d + data_size] = hist_f3_[d];
-
-  data_size += hist_f3_.size ();
-  for (int d = 0; d < hist_f4_.size (); ++d)
-    output.points[0].histogram[d + data_size] = hist_f4_[d];
+  computeSignature (*surface_, *normals_, *indices_, output.points[0]);
+}
 
-  // ---[ Step 2 : obtain the viewpoint component
-  hist_vp_.setZero (nr_bins_vp_);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::VFHEstimation<PointInT, PointNT, PointOutT>::computeClusters (const std::vector<pcl::PointIndices> &clusters,
+                                                                   PointCloudOut &output)
+{
+  // Set up the search surface and the spatial locator once for all clusters
+  if (!initCompute ())
+  {
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
 
-  double hist_incr;
-  if (normalize_bins_)
-    hist_incr = 100.0 / (double)(indices_->size ());
-  else
-    hist_incr = 1.0;
+  output.header = input_->header;
+  output.points.resize (clusters.size ());
+  output.width = (uint32_t) clusters.size ();
+  output.height = 1;
 
-  for (size_t i = 0; i < indices_->size (); ++i)
+  bool is_dense = true;
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads_) reduction (&& : is_dense)
+  for (int cluster_i = 0; cluster_i < (int) clusters.size (); ++cluster_i)
   {
-    Eigen::Vector4f normal (normals_->points[(*indices_)[i]].normal[0],
-                            normals_->points[(*indices_)[i]].normal[1],
-                            normals_->points[(*indices_)[i]].normal[2], 0);
-    // Normalize
-    double alpha = (normal.dot (d_vp_p) + 1.0) * 0.5;
-    int fi = floor (alpha * hist_vp_.size ());
-    if (fi < 0)
-      fi = 0;
-    if (fi > ((int)hist_vp_.size () - 1))
-      fi = hist_vp_.size () - 1;
-    // Bin into the histogram
-    hist_vp_ [fi] += hist_incr;
+    const std::vector<int> &cluster = clusters[cluster_i].indices;
+    if (cluster.size () < 2)
+    {
+      for (int d = 0; d < nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_ + nr_bins_f4_ + nr_bins_vp_; ++d)
+        output.points[cluster_i].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
+      is_dense = false;
+      continue;
+    }
+    computeSignature (*surface_, *normals_, cluster, output.points[cluster_i]);
   }
-  data_size += hist_f4_.size ();
-  // Copy the resultant signature
-  for (int d = 0; d < hist_vp_.size (); ++d)
-    output.points[0].histogram[d + data_size] = hist_vp_[d];
+  output.is_dense = is_dense;
+
+  this->deinitCompute ();
 }
 
 #define PCL_INSTANTIATE_VFHEstimation(T,NT,OutT) template class PCL_EXPORTS pcl::VFHEstimation<T,NT,OutT>;
@@ -117,6 +117,7 @@ namespace pcl
         : width_ (1)
         , height_ (1)
         , compute_second_order_integral_images_ (compute_second_order_integral_images)
+        , threads_ (1)
       {
       }
 
@@ -130,7 +131,19 @@ namespace pcl
       void 
       setSecondOrderComputation (bool compute_second_order_integral_images);
 
-      /** \brief Set the input data to compute the integral image for
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Set the input data to compute the integral image for. The integral images are kept allocated
+        * between calls, so that consecutive inputs of the same size (e.g. video frames) do not reallocate them.
         * \param[in] data the input data
         * \param[in] width the width of the data
         * \param[in] height the height of the data
@@ -189,6 +202,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads the integral images are computed with. */
+      unsigned int threads_;
    };
 
    /**
@@ -207,6 +223,7 @@ namespace pcl
         */
       IntegralImage2D (bool compute_second_order_integral_images)
         : width_ (1), height_ (1), compute_second_order_integral_images_ (compute_second_order_integral_images)
+        , threads_ (1)
       {
       }
 
@@ -214,7 +231,19 @@ namespace pcl
       virtual
       ~IntegralImage2D () { }
 
-      /** \brief Set the input data to compute the integral image for
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Set the input data to compute the integral image for. The integral images are kept allocated
+        * between calls, so that consecutive inputs of the same size (e.g. video frames) do not reallocate them.
         * \param[in] data the input data
         * \param[in] width the width of the data
         * \param[in] height the height of the data
@@ -273,6 +302,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads the integral images are computed with. */
+      unsigned int threads_;
    };
  }
 
@@ -47,6 +47,10 @@ namespace pcl
 {
   /**
     * \brief Surface normal estimation on dense data using integral images.
+    *
+    * The integral images and the other per-frame buffers stay allocated between calls, so that a stream of frames of
+    * the same size (e.g. from an OpenNI device) does not reallocate them. The integral images and the normals can be
+    * computed on several threads, see \ref setNumberOfThreads.
     * \author Stefan Holzer
     */
   template <typename PointInT, typename PointOutT>
@@ -77,15 +81,16 @@ namespace pcl
       , integral_image_DY_(false)
       , integral_image_depth_ (false)
       , integral_image_XYZ_ (true)
-      , diff_x_(NULL)
-      , diff_y_(NULL)
-      , depth_data_(NULL)
+      , diff_x_()
+      , diff_y_()
       , use_depth_dependent_smoothing_(false)
       , max_depth_change_factor_(20.0f*0.001f)
       , normal_smoothing_size_(10.0f)
       , init_covariance_matrix_(false)
       , init_average_3d_gradient_(false)
+      , init_simple_3d_gradient_(false)
       , init_depth_change_(false)
+      , threads_(1)
       {
         feature_name_ = "IntegralImagesNormalEstimation";
         tree_.reset ();
@@ -112,6 +117,28 @@ namespace pcl
       void
       computePointNormal (const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal);
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+        integral_image_DX_.setNumberOfThreads (threads_);
+        integral_image_DY_.setNumberOfThreads (threads_);
+        integral_image_depth_.setNumberOfThreads (threads_);
+        integral_image_XYZ_.setNumberOfThreads (threads_);
+      }
+
+      /** \brief Get the number of threads the integral images and the normals are computed with. */
+      unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
       /** \brief The depth change threshold for computing object borders
         * \param[in] max_depth_change_factor the depth change threshold for computing object borders based on
         * depth changes
@@ -190,6 +217,20 @@ namespace pcl
       void
       initData ();
 
+      /** \brief Computes the normal at the specified position for a given rectangle size. Unlike the public
+        * computePointNormal (), this expects the data of the current method to be initialized and does not change
+        * any member, so that it can be called from several threads at once.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormal (const int pos_x, const int pos_y, const unsigned point_index,
+                          const int rect_width, const int rect_height, PointOutT &normal) const;
+
     private:
       /** \brief The normal estimation method to use. Currently, 3 implementations are provided:
         *
@@ -221,12 +262,14 @@ namespace pcl
       IntegralImage2D<float, 3> integral_image_XYZ_;
 
       /** derivatives in x-direction */
-      float *diff_x_;
+      std::vector<float> diff_x_;
       /** derivatives in y-direction */
-      float *diff_y_;
+      std::vector<float> diff_y_;
 
-      /** depth data */
-      float *depth_data_;
+      /** \brief Map of the points next to a depth discontinuity, kept between frames. */
+      std::vector<unsigned char> depth_change_map_;
+      /** \brief Distance of each point to the closest depth discontinuity, kept between frames. */
+      std::vector<float> distance_map_;
 
       /** \brief Smooth data based on depth (true/false). */
       bool use_depth_dependent_smoothing_;
@@ -249,6 +292,9 @@ namespace pcl
       /** \brief True when a dataset has been received and the depth change data has been initialized. */
       bool init_depth_change_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute ();
@@ -46,8 +46,7 @@ namespace pcl
 {
   /** \brief MomentInvariantsEstimation estimates the 3 moment invariants (j1, j2, j3) at each 3D point.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref NormalEstimationOMP for an example on how to extend this to parallel implementations.
+    * \note See \ref MomentInvariantsEstimationOMP for a parallel implementation.
     * \author Radu B. Rusu
     * \ingroup features
     */
@@ -81,7 +80,7 @@ namespace pcl
       void 
       computePointMomentInvariants (const pcl::PointCloud<PointInT> &cloud, 
                                     const std::vector<int> &indices, 
-                                    float &j1, float &j2, float &j3);
+                                    float &j1, float &j2, float &j3) const;
 
       /** \brief Compute the 3 moment invariants (j1, j2, j3) for a given set of points, using their indices.
         * \param[in] cloud the input point cloud
@@ -91,7 +90,7 @@ namespace pcl
         */
       void 
       computePointMomentInvariants (const pcl::PointCloud<PointInT> &cloud, 
-                                    float &j1, float &j2, float &j3);
+                                    float &j1, float &j2, float &j3) const;
 
     protected:
 
@@ -103,12 +102,6 @@ namespace pcl
       computeFeature (PointCloudOut &output);
 
     private:
-      /** \brief 16-bytes aligned placeholder for the XYZ centroid of a surface patch. */
-      Eigen::Vector4f xyz_centroid_;
-
-      /** \brief Internal data vector. */
-      Eigen::Vector4f temp_pt_;
-
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud 
         */
@@ -118,8 +111,7 @@ namespace pcl
 
   /** \brief MomentInvariantsEstimation estimates the 3 moment invariants (j1, j2, j3) at each 3D point.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref NormalEstimationOMP for an example on how to extend this to parallel implementations.
+    * \note See \ref MomentInvariantsEstimationOMP for a parallel implementation.
     * \author Radu B. Rusu
     * \ingroup features
     */
@@ -0,0 +1,102 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_MOMENT_INVARIANTS_OMP_H_
+#define PCL_MOMENT_INVARIANTS_OMP_H_
+
+#include <pcl/features/moment_invariants.h>
+
+namespace pcl
+{
+  /** \brief MomentInvariantsEstimationOMP estimates the 3 moment invariants (j1, j2, j3) at each 3D point, in
+    * parallel, using the OpenMP standard.
+    *
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointOutT>
+  class MomentInvariantsEstimationOMP: public MomentInvariantsEstimation<PointInT, PointOutT>
+  {
+    public:
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::k_;
+      using Feature<PointInT, PointOutT>::search_parameter_;
+      using Feature<PointInT, PointOutT>::surface_;
+
+      typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+
+      /** \brief Constructor.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      MomentInvariantsEstimationOMP (unsigned int nr_threads = 1) : threads_ (1)
+      {
+        feature_name_ = "MomentInvariantsEstimationOMP";
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+    protected:
+      /** \brief Estimate moment invariants for all points given in <setInputCloud (), setIndices ()> using the surface
+        * in setSearchSurface () and the spatial locator in setSearchMethod ()
+        * \param[out] output the resultant point cloud model dataset that contains the moment invariants
+        */
+      void
+      computeFeature (PointCloudOut &output);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+    private:
+      /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
+        * \param[out] output the output point cloud 
+        */
+      void 
+      computeFeatureEigen (pcl::PointCloud<Eigen::MatrixXf> &output) {}
+  };
+}
+
+#endif  //#ifndef PCL_MOMENT_INVARIANTS_OMP_H_
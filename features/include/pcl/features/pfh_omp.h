@@ -0,0 +1,223 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_PFH_OMP_H_
+#define PCL_PFH_OMP_H_
+
+#include <pcl/features/feature.h>
+#include <pcl/features/pfh.h>
+
+namespace pcl
+{
+  /** \brief PairFeatureCache is a fixed size table of point pair features (see \ref computePairFeatures) that
+    * can be read and written by several threads at once without locking.
+    *
+    * The table is 4-way set associative. Every entry is stored as three 64 bit words: the four features and the
+    * key XOR-ed with them. A reader accepts an entry only if the key it recovers from the three words is the one
+    * it looks for, so an entry that is torn by a concurrent writer is simply seen as a miss. Writers never wait
+    * either: they overwrite a slot of the set picked with the CLOCK policy, using one reference bit per slot.
+    * \ingroup features
+    */
+  class PCL_EXPORTS PairFeatureCache
+  {
+    public:
+      /** \brief Empty constructor. The cache holds nothing until \ref resize is called. */
+      PairFeatureCache () : slots_ (), referenced_ (), hands_ (), set_mask_ (0) {}
+
+      /** \brief Allocate room for at most \a max_entries pairs, and clear the cache. The number of entries is
+        * rounded down to a power of two, and is at least 4 (a single set) unless \a max_entries is 0.
+        * \param[in] max_entries the maximum number of pairs to hold
+        */
+      void
+      resize (size_t max_entries);
+
+      /** \brief Drop all the pairs held, keeping the memory. */
+      void
+      clear ();
+
+      /** \brief Get the number of pairs the cache can hold. */
+      inline size_t
+      capacity () const { return (slots_.size ()); }
+
+      /** \brief Look up the features of the pair (p_idx, q_idx).
+        * \param[in] p_idx the index of the first point of the pair
+        * \param[in] q_idx the index of the second point of the pair
+        * \param[out] features the four pair features, if found
+        * \return true if the pair was found
+        */
+      bool
+      find (int p_idx, int q_idx, Eigen::Vector4f &features);
+
+      /** \brief Store the features of the pair (p_idx, q_idx), evicting another pair of the same set if needed.
+        * \param[in] p_idx the index of the first point of the pair
+        * \param[in] q_idx the index of the second point of the pair
+        * \param[in] features the four pair features
+        */
+      void
+      insert (int p_idx, int q_idx, const Eigen::Vector4f &features);
+
+    private:
+      /** \brief The features packed in two words, and the key XOR-ed with both. */
+      struct Slot
+      {
+        uint64_t data[2];
+        uint64_t check;
+      };
+
+      /** \brief Get the key of a pair. The indices are shifted by one so that an empty slot never matches. */
+      static inline uint64_t
+      makeKey (int p_idx, int q_idx)
+      {
+        return ((static_cast<uint64_t> (static_cast<uint32_t> (p_idx) + 1) << 32) | 
+                 static_cast<uint64_t> (static_cast<uint32_t> (q_idx) + 1));
+      }
+
+      /** \brief Get the first slot of the set a key maps to. */
+      inline size_t
+      setOf (uint64_t key) const
+      {
+        return (static_cast<size_t> ((key * 0x9E3779B97F4A7C15ULL) >> 32) & set_mask_) * 4;
+      }
+
+      /** \brief The slots, 4 consecutive ones per set. */
+      std::vector<Slot> slots_;
+      /** \brief The CLOCK reference bit of every slot. */
+      std::vector<unsigned char> referenced_;
+      /** \brief The CLOCK hand of every set. */
+      std::vector<unsigned char> hands_;
+      /** \brief The number of sets minus one. */
+      size_t set_mask_;
+  };
+
+  /** \brief PFHEstimationOMP estimates the Point Feature Histogram (PFH) descriptor for a given point cloud
+    * dataset containing points and normals, in parallel, using the OpenMP standard.
+    *
+    * When the internal cache is enabled (see \ref setUseInternalCache), all threads share a single
+    * \ref PairFeatureCache, so a pair that shows up in the neighborhoods of several query points is only computed
+    * once, whichever thread meets it first. The cache never grows beyond \ref setMaximumCacheSize entries.
+    *
+    * \note If you use this code in any academic work, please cite:
+    *
+    *   - R.B. Rusu, N. Blodow, Z.C. Marton, M. Beetz.
+    *     Aligning Point Cloud Views using Persistent Feature Histograms.
+    *     In Proceedings of the 21st IEEE/RSJ International Conference on Intelligent Robots and Systems (IROS),
+    *     Nice, France, September 22-26 2008.
+    *   - R.B. Rusu, Z.C. Marton, N. Blodow, M. Beetz.
+    *     Learning Informative Point Classes for the Acquisition of Object Model Maps.
+    *     In Proceedings of the 10th International Conference on Control, Automation, Robotics and Vision (ICARCV),
+    *     Hanoi, Vietnam, December 17-20 2008.
+    *
+    * \attention 
+    * The convention for PFH features is:
+    *   - if a query point's nearest neighbors cannot be estimated, the PFH feature will be set to NaN 
+    *     (not a number)
+    *   - it is impossible to estimate a PFH descriptor for a point that
+    *     doesn't have finite 3D coordinates. Therefore, any point that contains
+    *     NaN data on x, y, or z, will have its PFH feature property set to NaN.
+    *
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointNT, typename PointOutT = pcl::PFHSignature125>
+  class PFHEstimationOMP : public PFHEstimation<PointInT, PointNT, PointOutT>
+  {
+    public:
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::k_;
+      using Feature<PointInT, PointOutT>::search_parameter_;
+      using Feature<PointInT, PointOutT>::surface_;
+      using Feature<PointInT, PointOutT>::input_;
+      using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::nr_subdiv_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::d_pi_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::max_cache_size_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::use_cache_;
+
+      typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      PFHEstimationOMP (unsigned int nr_threads = 1) : pair_cache_ (), threads_ (1)
+      {
+        feature_name_ = "PFHEstimationOMP";
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+    private:
+      /** \brief Estimate the PFH signature of a neighborhood like \ref computePointPFHSignature, without touching
+        * any member other than the shared pair cache, so that it can run on several threads at once.
+        * \param[in] indices the k-neighborhood point indices in the dataset
+        * \param[out] pfh_histogram the resultant (combinatorial) PFH histogram representing the feature at the query point
+        */
+      void
+      computeSharedPFHSignature (const std::vector<int> &indices, Eigen::VectorXf &pfh_histogram);
+
+      /** \brief Estimate the Point Feature Histograms (PFH) descriptors at a set of points given by
+        * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
+        * setSearchMethod ()
+        * \param[out] output the resultant point cloud model dataset that contains the PFH feature estimates
+        */
+      void 
+      computeFeature (PointCloudOut &output);
+
+      /** \brief The pair features shared by all threads. */
+      PairFeatureCache pair_cache_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
+        * \param[out] output the output point cloud 
+        */
+      void 
+      computeFeatureEigen (pcl::PointCloud<Eigen::MatrixXf> &output) {}
+  };
+}
+
+#endif  //#ifndef PCL_PFH_OMP_H_
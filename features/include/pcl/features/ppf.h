@@ -88,6 +88,29 @@ namespace pcl
       /** \brief Empty Constructor. */
       PPFEstimation ();
 
+      /** \brief Set the number of threads the pairs are computed with, each thread taking care of a subset of the
+        * first points of the pairs.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads the pairs are computed with. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
+    protected:
+      /** \brief The number of threads the pairs are computed with. */
+      unsigned int threads_;
+
 
     private:
       /** \brief The method called for actually doing the computations
@@ -126,6 +149,7 @@ namespace pcl
       using PPFEstimation<PointInT, PointNT, pcl::PPFSignature>::input_;
       using PPFEstimation<PointInT, PointNT, pcl::PPFSignature>::normals_;
       using PPFEstimation<PointInT, PointNT, pcl::PPFSignature>::indices_;
+      using PPFEstimation<PointInT, PointNT, pcl::PPFSignature>::threads_;
 
     private:
       /** \brief The method called for actually doing the computations
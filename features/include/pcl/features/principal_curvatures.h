@@ -52,7 +52,7 @@ namespace pcl
     * The recommended PointOutT is pcl::PrincipalCurvatures.
     *
     * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref NormalEstimationOMP for an example on how to extend this to parallel implementations.
+    * \ref PrincipalCurvaturesEstimationOMP for a parallel implementation.
     *
     * \author Radu B. Rusu, Jared Glover
     * \ingroup features
@@ -96,6 +96,26 @@ namespace pcl
                                        int p_idx, const std::vector<int> &indices,
                                        float &pcx, float &pcy, float &pcz, float &pc1, float &pc2);
 
+      /** \brief Perform Principal Components Analysis (PCA) on the point normals of a surface patch in the tangent
+       *  plane of the given point normal, and return the principal curvature (eigenvector of the max eigenvalue),
+       *  along with both the max (pc1) and min (pc2) eigenvalues. This version keeps no state in the class and can
+       *  be called from several threads as long as each of them passes its own \a projected_normals buffer.
+       * \param[in] normals the point cloud normals
+       * \param[in] p_idx the query point at which the least-squares plane was estimated
+       * \param[in] indices the point cloud indices that need to be used
+       * \param[out] projected_normals a scratch buffer for the normals projected into the tangent plane
+       * \param[out] pcx the principal curvature X direction
+       * \param[out] pcy the principal curvature Y direction
+       * \param[out] pcz the principal curvature Z direction
+       * \param[out] pc1 the max eigenvalue of curvature
+       * \param[out] pc2 the min eigenvalue of curvature
+       */
+      void
+      computePointPrincipalCurvatures (const pcl::PointCloud<PointNT> &normals,
+                                       int p_idx, const std::vector<int> &indices,
+                                       std::vector<Eigen::Vector3f> &projected_normals,
+                                       float &pcx, float &pcy, float &pcz, float &pc1, float &pc2) const;
+
     protected:
 
       /** \brief Estimate the principal curvature (eigenvector of the max eigenvalue), along with both the max (pc1)
@@ -107,23 +127,9 @@ namespace pcl
       computeFeature (PointCloudOut &output);
 
     private:
-      /** \brief A pointer to the input dataset that contains the point normals of the XYZ dataset. */
+      /** \brief The normals of a surface patch projected into its tangent plane. */
       std::vector<Eigen::Vector3f> projected_normals_;
 
-      /** \brief SSE aligned placeholder for the XYZ centroid of a surface patch. */
-      Eigen::Vector3f xyz_centroid_;
-
-      /** \brief Temporary point placeholder. */
-      Eigen::Vector3f demean_;
-
-      /** \brief Placeholder for the 3x3 covariance matrix at each surface patch. */
-      EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix_;
-
-      /** \brief SSE aligned eigenvectors placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvector_;
-      /** \brief eigenvalues placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvalues_;
-
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud
         */
@@ -135,7 +141,7 @@ namespace pcl
     * principal surface curvatures for a given point cloud dataset containing points and normals.
     *
     * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref NormalEstimationOMP for an example on how to extend this to parallel implementations.
+    * \ref PrincipalCurvaturesEstimationOMP for a parallel implementation.
     *
     * \author Radu B. Rusu, Jared Glover
     * \ingroup features
@@ -0,0 +1,114 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FEATURES_SHAPE_CONTEXT_COMMON_H_
+#define PCL_FEATURES_SHAPE_CONTEXT_COMMON_H_
+
+#include <vector>
+#include <cstddef>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief ShapeContextBinLUT finds the bin of a value among sorted bin divisions in (amortized) constant time,
+      * with the same result as the linear scan of ShapeContext3DEstimation and UniqueShapeContext: the first bin
+      * whose upper division is greater or equal to the value, and bin 0 if there is none.
+      *
+      * The range of the divisions is cut in uniform cells, each holding the first bin that a value falling in it can
+      * belong to, so that a query only steps over the few divisions inside its cell.
+      */
+    class ShapeContextBinLUT
+    {
+      public:
+        /** \brief Empty constructor. */
+        ShapeContextBinLUT () : divisions_ (), cells_ (), scale_ (0) {}
+
+        /** \brief Build the table.
+          * \param[in] divisions the bin divisions, in increasing order (the number of bins plus one)
+          * \param[in] nr_cells the number of uniform cells to cut the range of the divisions in
+          */
+        void
+        init (const std::vector<float> &divisions, size_t nr_cells)
+        {
+          divisions_ = divisions;
+          cells_.assign (nr_cells, 0);
+          scale_ = static_cast<float> (nr_cells) / (divisions_.back () - divisions_.front ());
+
+          // Start half a cell early, so that a value rounded into the next cell never gets a too large first bin
+          size_t bin = 0;
+          for (size_t c = 0; c < nr_cells; ++c)
+          {
+            float start = divisions_.front () + (static_cast<float> (c) - 0.5f) / scale_;
+            while (bin + 2 < divisions_.size () && start > divisions_[bin + 1])
+              ++bin;
+            cells_[c] = bin;
+          }
+        }
+
+        /** \brief Find the bin of a value.
+          * \param[in] value the value to look up
+          */
+        inline size_t
+        find (float value) const
+        {
+          // This also sends NaNs to bin 0
+          if (!(value > divisions_.front ()))
+            return (0);
+
+          size_t cell = static_cast<size_t> ((value - divisions_.front ()) * scale_);
+          size_t bin = cells_[cell < cells_.size () ? cell : cells_.size () - 1];
+          const size_t nr_bins = divisions_.size () - 1;
+          while (bin < nr_bins && value > divisions_[bin + 1])
+            ++bin;
+          return (bin < nr_bins ? bin : 0);
+        }
+
+      private:
+        /** \brief The bin divisions. */
+        std::vector<float> divisions_;
+
+        /** \brief The first bin of every cell. */
+        std::vector<size_t> cells_;
+
+        /** \brief The number of cells per unit. */
+        float scale_;
+    };
+  }
+}
+
+#endif  //#ifndef PCL_FEATURES_SHAPE_CONTEXT_COMMON_H_
@@ -88,12 +88,25 @@ namespace pcl
         rf_ (3),                    // Initialize the placeholder for the point's RF
         nr_grid_sector_ (32),
         maxAngularSectors_ (28),
-        descLength_ (0)
+        descLength_ (0),
+        vectorized_interpolation_ (false)
       {
         feature_name_ = "SHOTEstimation";
       };
 
     public:
+      /** \brief Set whether to use the vectorized interpolation kernel. It processes the neighbors in batches, with
+        * polynomial approximations of atan2 and acos (absolute error below 1e-5 rad) and without branches, so the
+        * descriptors differ slightly from the ones of the reference implementation.
+        * \param[in] use_vectorized set to true to use the vectorized kernel (false by default)
+        */
+      inline void
+      setUseVectorizedInterpolation (bool use_vectorized) { vectorized_interpolation_ = use_vectorized; }
+
+      /** \brief Get whether the vectorized interpolation kernel is used. */
+      inline bool
+      getUseVectorizedInterpolation () const { return (vectorized_interpolation_); }
+
        /** \brief Estimate the SHOT descriptor for a given point based on its spatial neighborhood of 3D points with normals
          * \param[in] index the index of the point in input_
          * \param[in] indices the k-neighborhood point indices in surface_
@@ -195,6 +208,9 @@ namespace pcl
       /** \brief One SHOT length. */
       int descLength_;
 
+      /** \brief Set to true to use the vectorized interpolation kernel. */
+      bool vectorized_interpolation_;
+
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud 
         */
@@ -442,6 +458,7 @@ namespace pcl
       using SHOTEstimationBase<pcl::PointXYZRGBA, PointNT, PointOutT>::radius1_2_;
       using SHOTEstimationBase<pcl::PointXYZRGBA, PointNT, PointOutT>::rf_;
       using SHOTEstimationBase<pcl::PointXYZRGBA, PointNT, PointOutT>::maxAngularSectors_;
+      using SHOTEstimationBase<pcl::PointXYZRGBA, PointNT, PointOutT>::vectorized_interpolation_;
       using SHOTEstimationBase<pcl::PointXYZRGBA, PointNT, PointOutT>::interpolateSingleChannel;
       using SHOTEstimationBase<pcl::PointXYZRGBA, PointNT, PointOutT>::shot_;
 
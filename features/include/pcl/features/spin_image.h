@@ -256,6 +256,15 @@ namespace pcl
       Eigen::ArrayXXd 
       computeSiForPoint (int index) const;
 
+      /** \brief Computes a spin-image for the point of the scan into the given buffers, so that they can be
+        * reused from one point to the next.
+        * \param[in] index the index of the reference point in the input cloud
+        * \param[out] m_matrix the estimated spin-image (or its variant)
+        * \param[out] m_averAngles scratch buffer for the angular spin-image, of the same size as \a m_matrix
+        */
+      void
+      computeSiForPoint (int index, Eigen::ArrayXXd &m_matrix, Eigen::ArrayXXd &m_averAngles) const;
+
     private:
       PointCloudNConstPtr input_normals_;
       PointCloudNConstPtr rotation_axes_cloud_;
@@ -42,6 +42,7 @@
 
 #include <pcl/point_types.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/shape_context_common.h>
 
 namespace pcl
 {
@@ -81,6 +82,7 @@ namespace pcl
        /** \brief Constructor. */
        UniqueShapeContext () :
          radii_interval_(0), theta_divisions_(0), phi_divisions_(0), volume_lut_(0),
+         radius_lut_ (), theta_lut_ (), phi_lut_ (), point_densities_ (),
          azimuth_bins_(12), elevation_bins_(11), radius_bins_(15), 
          min_radius_(0.1), point_density_radius_(0.2)
        {
@@ -161,7 +163,7 @@ namespace pcl
       void
       computePointDescriptor (size_t index, float rf[9], std::vector<float> &desc);
       
-      /** \brief Initialize computation by allocating all the intervals and the volume lookup table. */
+      /** \brief Initialize computation by allocating all the intervals, and the bin and volume lookup tables. */
       virtual bool 
       initCompute ();
 
@@ -179,6 +181,25 @@ namespace pcl
       bool
       computePointRF (size_t index, float rf[9]);
 
+      /** \brief Get the local point density around a point of the surface (the number of points within
+        * \ref point_density_radius_), searching for it only the first time it is needed.
+        * \note Several threads may search for the density of the same point at once; they all store the same value.
+        * \param[in] index the index of the point in surface_
+        */
+      inline int
+      getPointDensity (int index)
+      {
+        int density = point_densities_[index];
+        if (density < 0)
+        {
+          std::vector<int> neighbour_indices;
+          std::vector<float> neighbour_distances;
+          density = searchForNeighbors (*surface_, index, point_density_radius_, neighbour_indices, neighbour_distances);
+          point_densities_[index] = density;
+        }
+        return (density);
+      }
+
       /** \brief values of the radii interval. */
       std::vector<float> radii_interval_;
 
@@ -190,6 +211,18 @@ namespace pcl
 
       /** \brief Volumes look up table. */
       std::vector<float> volume_lut_;
+
+      /** \brief Radius bin look up table. */
+      pcl::detail::ShapeContextBinLUT radius_lut_;
+
+      /** \brief Elevation bin look up table. */
+      pcl::detail::ShapeContextBinLUT theta_lut_;
+
+      /** \brief Azimuth bin look up table. */
+      pcl::detail::ShapeContextBinLUT phi_lut_;
+
+      /** \brief The local point density of every point of the surface, or -1 if not computed yet. */
+      std::vector<int> point_densities_;
       
       /** \brief Bins along the azimuth dimension. */
       size_t azimuth_bins_;
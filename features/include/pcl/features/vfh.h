@@ -42,6 +42,7 @@
 
 #include <pcl/point_types.h>
 #include <pcl/features/feature.h>
+#include <pcl/PointIndices.h>
 
 namespace pcl
 {
@@ -60,8 +61,9 @@ namespace pcl
     *     In Proceedings of International Conference on Intelligent Robots and Systems (IROS)
     *     Taipei, Taiwan, October 18-22 2010.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref FPFHEstimationOMP for an example of a parallel implementation of the FPFH (Fast Point Feature Histogram).
+    * \note A single call to compute () is not parallelized. To describe many clusters of the same cloud at once,
+    * use \ref computeClusters, which shares the input cloud, normals and search surface between all clusters and
+    * processes them on \ref setNumberOfThreads threads.
     * \author Radu B. Rusu
     * \ingroup features
     */
@@ -83,7 +85,7 @@ namespace pcl
       /** \brief Empty constructor. */
       VFHEstimation () :
         nr_bins_f1_ (45), nr_bins_f2_ (45), nr_bins_f3_ (45), nr_bins_f4_ (45), nr_bins_vp_ (128), vpx_ (0), vpy_ (0),
-            vpz_ (0), d_pi_ (1.0 / (2.0 * M_PI))
+            vpz_ (0), d_pi_ (1.0 / (2.0 * M_PI)), threads_ (1)
       {
         hist_f1_.setZero (nr_bins_f1_);
         hist_f2_.setZero (nr_bins_f2_);
@@ -114,6 +116,60 @@ namespace pcl
                                  const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
                                  const std::vector<int> &indices);
 
+      /** \brief Estimate the VFH signature of a set of points around the given centroids. Unlike compute (), this
+        * does not touch any member state and can be called from several threads at once.
+        * \param[in] xyz_centroid the centroid of the points in XYZ space
+        * \param[in] normal_centroid the centroid of the points in normal space
+        * \param[in] cloud the dataset containing the XYZ Cartesian coordinates of the points
+        * \param[in] normals the dataset containing the surface normals at each point in \a cloud
+        * \param[in] indices the indices of the points to describe in \a cloud
+        * \param[out] signature the resultant VFH signature
+        */
+      void
+      computeSignature (const Eigen::Vector4f &xyz_centroid, const Eigen::Vector4f &normal_centroid,
+                        const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
+                        const std::vector<int> &indices, PointOutT &signature) const;
+
+      /** \brief Estimate the VFH signature of a set of points, using the given normal and centroid if requested
+        * through setUseGivenNormal () and setUseGivenCentroid (), and their averages otherwise. Unlike compute (),
+        * this does not touch any member state and can be called from several threads at once.
+        * \param[in] cloud the dataset containing the XYZ Cartesian coordinates of the points
+        * \param[in] normals the dataset containing the surface normals at each point in \a cloud
+        * \param[in] indices the indices of the points to describe in \a cloud
+        * \param[out] signature the resultant VFH signature
+        */
+      void
+      computeSignature (const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
+                        const std::vector<int> &indices, PointOutT &signature) const;
+
+      /** \brief Estimate one VFH signature for each of the given clusters of the input cloud. The search surface,
+        * the spatial locator and the normals are set up once for all clusters, and the clusters are described in
+        * parallel. Clusters with less than 2 points get a signature of NaN values.
+        * \param[in] clusters the indices of the points of each cluster in the search surface (the input cloud if
+        * no surface was given)
+        * \param[out] output the resultant VFH signatures, one for each cluster and in the same order
+        */
+      void
+      computeClusters (const std::vector<pcl::PointIndices> &clusters, PointCloudOut &output);
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads used by computeClusters (). */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
       /** \brief Set the viewpoint.
         * \param[in] vpx the X coordinate of the viewpoint
         * \param[in] vpy the Y coordinate of the viewpoint
@@ -221,6 +277,24 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output);
 
+      /** \brief Fill the f1, f2, f3 and f4 histograms of the SPFH signature of the given points. The histograms are
+        * expected to be zeroed by the caller.
+        * \param[in] centroid_p the centroid point
+        * \param[in] centroid_n the centroid normal
+        * \param[in] cloud the dataset containing the XYZ Cartesian coordinates of the two points
+        * \param[in] normals the dataset containing the surface normals at each point in \a cloud
+        * \param[in] indices the k-neighborhood point indices in the dataset
+        * \param[out] hist_f1 the f1 histogram, with nr_bins_f1_ bins
+        * \param[out] hist_f2 the f2 histogram, with nr_bins_f2_ bins
+        * \param[out] hist_f3 the f3 histogram, with nr_bins_f3_ bins
+        * \param[out] hist_f4 the f4 histogram, with nr_bins_f4_ bins
+        */
+      void
+      computePointSPFHSignature (const Eigen::Vector4f &centroid_p, const Eigen::Vector4f &centroid_n,
+                                 const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
+                                 const std::vector<int> &indices,
+                                 float *hist_f1, float *hist_f2, float *hist_f3, float *hist_f4) const;
+
     protected:
       /** \brief This method should get called before starting the actual computation. */
       bool
@@ -259,6 +333,9 @@ namespace pcl
       /** \brief Float constant = 1.0 / (2.0 * M_PI) */
       float d_pi_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud 
         */
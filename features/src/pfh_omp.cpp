@@ -0,0 +1,129 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include "pcl/point_types.h"
+#include "pcl/impl/instantiate.hpp"
+#include "pcl/features/pfh_omp.h"
+#include "pcl/features/impl/pfh_omp.hpp"
+#include <cstring>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PairFeatureCache::resize (size_t max_entries)
+{
+  // The largest power of two number of sets that fits, and at least one set unless the cache is disabled
+  size_t nr_sets = 0;
+  if (max_entries > 0)
+    for (nr_sets = 1; nr_sets * 8 <= max_entries; nr_sets *= 2) ;
+
+  // Swap in fresh vectors, so that resizing to 0 gives the memory back
+  std::vector<Slot> (nr_sets * 4).swap (slots_);
+  std::vector<unsigned char> (nr_sets * 4, 0).swap (referenced_);
+  std::vector<unsigned char> (nr_sets, 0).swap (hands_);
+  set_mask_ = nr_sets > 0 ? nr_sets - 1 : 0;
+  clear ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PairFeatureCache::clear ()
+{
+  // An all-zero slot recovers the key 0, which makeKey never produces
+  for (size_t s = 0; s < slots_.size (); ++s)
+    slots_[s].data[0] = slots_[s].data[1] = slots_[s].check = 0;
+  std::fill (referenced_.begin (), referenced_.end (), 0);
+  std::fill (hands_.begin (), hands_.end (), 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PairFeatureCache::find (int p_idx, int q_idx, Eigen::Vector4f &features)
+{
+  if (slots_.empty ())
+    return (false);
+
+  const uint64_t key = makeKey (p_idx, q_idx);
+  const size_t first = setOf (key);
+  for (size_t s = first; s < first + 4; ++s)
+  {
+    // Read every word exactly once; a slot torn by a concurrent insert does not give back the key
+    const volatile Slot &slot = slots_[s];
+    uint64_t data[2] = {slot.data[0], slot.data[1]};
+    uint64_t check = slot.check;
+    if ((check ^ data[0] ^ data[1]) != key)
+      continue;
+
+    memcpy (features.data (), data, sizeof (data));
+    referenced_[s] = 1;
+    return (true);
+  }
+  return (false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PairFeatureCache::insert (int p_idx, int q_idx, const Eigen::Vector4f &features)
+{
+  if (slots_.empty ())
+    return;
+
+  const uint64_t key = makeKey (p_idx, q_idx);
+  const size_t first = setOf (key);
+  const size_t set = first / 4;
+
+  // CLOCK: give a second chance to the slots referenced since the hand last passed them. The hand and the
+  // reference bits may be updated concurrently; that only makes the choice of the victim less accurate
+  unsigned char hand = hands_[set];
+  size_t s = first + (hand & 3);
+  for (int step = 0; step < 4 && referenced_[s]; ++step)
+  {
+    referenced_[s] = 0;
+    s = first + (++hand & 3);
+  }
+  hands_[set] = static_cast<unsigned char> ((hand + 1) & 3);
+
+  uint64_t data[2];
+  memcpy (data, features.data (), sizeof (data));
+  volatile Slot &slot = slots_[s];
+  slot.data[0] = data[0];
+  slot.data[1] = data[1];
+  slot.check = key ^ data[0] ^ data[1];
+  referenced_[s] = 1;
+}
+
+// Instantiations of specific point types
+PCL_INSTANTIATE_PRODUCT(PFHEstimationOMP, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::PFHSignature125)))
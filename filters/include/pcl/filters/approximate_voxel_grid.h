@@ -99,6 +99,17 @@ namespace pcl
   };
 
   /** \brief ApproximateVoxelGrid assembles a local 3D grid over a given PointCloud, and downsamples + filters the data.
+    *
+    * The points are accumulated in a small hash table (history) of voxel
+    * centroids. When a point falls into a slot occupied by another voxel,
+    * the centroid of that voxel is written out, so that a voxel may appear
+    * several times in the output.
+    *
+    * With several threads, each thread processes a contiguous chunk of the
+    * input with its own history, and the partial centroids left in the
+    * histories are merged at the end. The size of the history can either
+    * be fixed, or chosen from the collision rate measured on the first
+    * points of the input (see \a setAdaptiveHistorySize).
     *
     * \author James Bowman, Radu B. Rusu
     * \ingroup filters
@@ -117,11 +128,10 @@ namespace pcl
 
     public:
       /** \brief Empty constructor. */
-      ApproximateVoxelGrid () : downsample_all_data_ (true), histsize_ (512)
+      ApproximateVoxelGrid () : downsample_all_data_ (true), histsize_ (512), adaptive_histsize_ (false), threads_ (1)
       {
         setLeafSize (1, 1, 1);
         filter_name_ = "ApproximateVoxelGrid";
-        history_ = new he[histsize_];
       }
 
       /** \brief Destructor. */
@@ -166,6 +176,43 @@ namespace pcl
       inline bool 
       getDownsampleAllData () { return (downsample_all_data_); }
 
+      /** \brief Set the number of slots of the history, rounded up to a power of 2. When the size is adaptive, 
+        * this is the minimum size.
+        * \param[in] size the number of slots (default: 512)
+        */
+      inline void
+      setHistorySize (size_t size)
+      {
+        histsize_ = 1;
+        while (histsize_ < size)
+          histsize_ <<= 1;
+      }
+
+      /** \brief Get the number of slots of the history. */
+      inline size_t
+      getHistorySize () const { return (histsize_); }
+
+      /** \brief Set whether the size of the history is chosen from the collision rate measured on the input,
+        * between \a getHistorySize () and the largest size that fits in the L2 cache.
+        * \param[in] adaptive true to choose the size of the history for each input (default: false)
+        */
+      inline void
+      setAdaptiveHistorySize (bool adaptive) { adaptive_histsize_ = adaptive; }
+
+      /** \brief Get whether the size of the history is chosen from the collision rate measured on the input. */
+      inline bool
+      getAdaptiveHistorySize () const { return (adaptive_histsize_); }
+
+      /** \brief Set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The size of a leaf. */
       Eigen::Vector3f leaf_size_;
@@ -179,8 +226,11 @@ namespace pcl
       /** \brief history buffer size, power of 2 */
       size_t histsize_;
 
-      /** \brief history buffer */
-      struct he *history_;
+      /** \brief True if the history size is chosen from the measured collision rate. */
+      bool adaptive_histsize_;
+
+      /** \brief The number of threads to use. */
+      unsigned int threads_;
 
       typedef typename pcl::traits::fieldList<PointT>::type FieldList;
 
@@ -191,8 +241,21 @@ namespace pcl
       applyFilter (PointCloud &output);
 
       /** \brief Write a single point from the hash to the output cloud
+        * \param[in] sum the sum of the (unpacked) points of the voxel
+        * \param[in] count the number of points of the voxel
+        * \param[in] rgba_index the offset of the rgb field, or -1
+        * \param[in] centroid_size the size of the unpacked points
+        * \param[out] centroid scratch space for the centroid
+        * \param[out] point the output point
+        */
+      void 
+      flush (const float *sum, int count, int rgba_index, int centroid_size, Eigen::VectorXf &centroid, PointT &point);
+
+      /** \brief Choose the size of the history from the collision rate measured on the first points of the input.
+        * \param[in] centroid_size the size of the unpacked points
         */
-      void flush(PointCloud &output, size_t op, he *hhe, int rgba_index, int centroid_size);
+      size_t
+      chooseHistorySize (int centroid_size) const;
   };
 }
 
@@ -44,6 +44,14 @@
 namespace pcl
 {
   /** \brief A bilateral filter implementation for point cloud data. Uses the intensity data channel.
+    *
+    * Besides the exact filter, which performs a radius search per point, two
+    * faster methods are available (see \a setMethod):
+    *  - ORGANIZED_WINDOW, for organized clouds, averages the points of an image
+    *    window, with a spatial kernel precomputed over pixel offsets;
+    *  - BILATERAL_GRID splats the points into a sparse grid over (x, y, z,
+    *    intensity), blurs it and interpolates the result back, in linear time.
+    *
     * \note For more information please see 
     * <b>C. Tomasi and R. Manduchi. Bilateral Filtering for Gray and Color Images.
     * In Proceedings of the IEEE International Conference on Computer Vision,
@@ -60,11 +68,23 @@ namespace pcl
     typedef typename pcl::search::Search<PointT>::Ptr KdTreePtr;
 
     public:
+      /** \brief The methods used to compute the filter response. */
+      enum Method
+      {
+        /** \brief exact weights of the neighbors found by a radius search of 2 * sigma_s */
+        EXACT,
+        /** \brief image window of radius 2 * sigma_s pixels, for organized clouds. sigma_s is expressed in pixels. */
+        ORGANIZED_WINDOW,
+        /** \brief linear time approximation on a bilateral grid with cells of sigma_s x sigma_s x sigma_s x sigma_r */
+        BILATERAL_GRID
+      };
+
       /** \brief Constructor. 
         * Sets sigma_s_ to 0 and sigma_r_ to MAXDBL
         */
       BilateralFilter () : sigma_s_ (0), 
-                           sigma_r_ (std::numeric_limits<double>::max ())
+                           sigma_r_ (std::numeric_limits<double>::max ()),
+                           method_ (EXACT), threads_ (1)
       {
       }
 
@@ -125,7 +145,51 @@ namespace pcl
         tree_ = tree;
       }
 
+      /** \brief Set the method used to compute the filter response.
+        * \param[in] method EXACT (default), ORGANIZED_WINDOW or BILATERAL_GRID
+        */
+      inline void
+      setMethod (Method method)
+      {
+        method_ = method;
+      }
+
+      /** \brief Get the method used to compute the filter response. */
+      inline Method
+      getMethod () const
+      {
+        return (method_);
+      }
+
+      /** \brief Set the number of threads used by the ORGANIZED_WINDOW and BILATERAL_GRID methods.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads used by the ORGANIZED_WINDOW and BILATERAL_GRID methods. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
     private:
+      /** \brief Filter an organized cloud with image windows (ORGANIZED_WINDOW).
+        * \param[out] output the resultant point cloud, initialized with the input
+        */
+      void
+      applyOrganizedWindow (PointCloud &output);
+
+      /** \brief Filter a cloud on a bilateral grid (BILATERAL_GRID).
+        * \param[out] output the resultant point cloud, initialized with the input
+        * \return false if the grid would be too large, in which case the output is left untouched
+        */
+      bool
+      applyBilateralGrid (PointCloud &output);
 
       /** \brief The bilateral filter Gaussian distance kernel.
         * \param[in] x the spatial distance (distance or intensity)
@@ -144,6 +208,12 @@ namespace pcl
 
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
+
+      /** \brief The method used to compute the filter response. */
+      Method method_;
+
+      /** \brief The number of threads used by the ORGANIZED_WINDOW and BILATERAL_GRID methods. */
+      unsigned int threads_;
   };
 }
 
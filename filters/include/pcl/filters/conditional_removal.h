@@ -38,7 +38,7 @@
 #ifndef PCL_FILTER_FIELD_VAL_CONDITION_H_
 #define PCL_FILTER_FIELD_VAL_CONDITION_H_
 
-#include <pcl/filters/filter.h>
+#include <pcl/filters/filter_indices.h>
 
 namespace pcl
 {
@@ -54,6 +54,11 @@ namespace pcl
     } CompareOp;
   }
 
+  namespace detail
+  {
+    template<typename PointT> class ConditionProgram;
+  }
+
   //////////////////////////////////////////////////////////////////////////////////////////
   /** \brief A datatype that enables type-correct comparisons. */
   template<typename PointT>
@@ -72,6 +77,20 @@ namespace pcl
         */
       int
       compare (const PointT& p, const double& val);
+
+      /** \brief Get the type of data. */
+      inline uint8_t
+      getDatatype () const
+      {
+        return (datatype_);
+      }
+
+      /** \brief Get the data offset. */
+      inline uint32_t
+      getOffset () const
+      {
+        return (offset_);
+      }
     protected:
       /** \brief The type of data. */
       uint8_t datatype_;
@@ -104,6 +123,16 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const = 0;
 
+      /** \brief Append this comparison to a compiled condition program.
+        * \return false if the comparison cannot be compiled, in which case the
+        * condition is evaluated point by point
+        */
+      virtual bool
+      compile (detail::ConditionProgram<PointT> &) const
+      {
+        return (false);
+      }
+
     protected:
       /** \brief True if capable. */
       bool capable_;
@@ -148,6 +177,12 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const;
 
+      /** \brief Append this comparison to a compiled condition program.
+        * \param[out] program the program to append the comparison to
+        */
+      virtual bool
+      compile (detail::ConditionProgram<PointT> &program) const;
+
     protected:
       /** \brief All types (that we care about) can be represented as a double. */
       double compare_val_;
@@ -184,6 +219,12 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const;
 
+      /** \brief Append this comparison to a compiled condition program.
+        * \param[out] program the program to append the comparison to
+        */
+      virtual bool
+      compile (detail::ConditionProgram<PointT> &program) const;
+
     protected:
       /** \brief The name of the component. */
       std::string component_name_;
@@ -224,6 +265,12 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const;
 
+      /** \brief Append this comparison to a compiled condition program.
+        * \param[out] program the program to append the comparison to
+        */
+      virtual bool
+      compile (detail::ConditionProgram<PointT> &program) const;
+
       typedef enum
       {
         H, // -128 to 127 corresponds to -pi to pi
@@ -303,7 +350,23 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const = 0;
 
+      /** \brief Append this condition to a compiled condition program.
+        * \return false if the condition cannot be compiled, in which case it
+        * is evaluated point by point
+        */
+      virtual bool
+      compile (detail::ConditionProgram<PointT> &) const
+      {
+        return (false);
+      }
+
     protected:
+      /** \brief Append all the comparisons and nested conditions to a compiled condition program.
+        * \param[out] program the program to append the operands to
+        */
+      bool
+      compileOperands (detail::ConditionProgram<PointT> &program) const;
+
       /** \brief True if capable. */
       bool capable_;
 
@@ -340,6 +403,12 @@ namespace pcl
         */
       virtual bool
       evaluate (const PointT &point) const;
+
+      /** \brief Append this condition and its operands to a compiled condition program.
+        * \param[out] program the program to append the condition to
+        */
+      virtual bool
+      compile (detail::ConditionProgram<PointT> &program) const;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////
@@ -368,8 +437,140 @@ namespace pcl
         */
       virtual bool
       evaluate (const PointT &point) const;
+
+      /** \brief Append this condition and its operands to a compiled condition program.
+        * \param[out] program the program to append the condition to
+        */
+      virtual bool
+      compile (detail::ConditionProgram<PointT> &program) const;
   };
 
+  namespace detail
+  {
+    //////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief A condition tree lowered to a flat program over columns of point values.
+      *
+      * The points are processed in blocks of \a block_size. For each block,
+      * the values used by the comparisons are first gathered into float
+      * columns (structure of arrays). The instructions are then run in
+      * postfix order: a comparison pushes the mask of the block on a stack,
+      * an AND or OR pops its operands and pushes the combined mask. With SSE,
+      * 4 points are compared and combined at a time.
+      *
+      * Comparisons follow the semantics of PointDataAtOffset::compare, i.e. a
+      * NaN value satisfies GE, LE and EQ.
+      */
+    template<typename PointT>
+    class ConditionProgram
+    {
+      public:
+        typedef pcl::PointCloud<PointT> PointCloud;
+
+        /** \brief Number of points evaluated together. */
+        static const int block_size = 256;
+
+        /** \brief How the values of a column are read from a point. */
+        typedef enum
+        {
+          INT8, UINT8, INT16, UINT16, FLOAT32, // field of the given type
+          HUE, SATURATION, INTENSITY           // HSI component of a packed rgb field
+        } ColumnType;
+
+        ConditionProgram () : max_depth_ (0), depth_ (0)
+        {
+        }
+
+        /** \brief Remove all the instructions. */
+        void
+        clear ();
+
+        /** \brief Return true if no instruction has been added. */
+        inline bool
+        empty () const
+        {
+          return (instructions_.empty ());
+        }
+
+        /** \brief Get the column for the values of a given type at a given offset, adding it if needed.
+          * \param[in] type the type of the values
+          * \param[in] offset the offset of the field in the point
+          * \return the index of the column
+          */
+        int
+        addColumn (ColumnType type, uint32_t offset);
+
+        /** \brief Add the comparison of the values of a column with a constant.
+          * \param[in] column the index of the column
+          * \param[in] op the comparison operator
+          * \param[in] value the constant to compare to, in the type of the column
+          */
+        void
+        addComparison (int column, ComparisonOps::CompareOp op, float value);
+
+        /** \brief Add the comparison of the integer values of a column with an arbitrary constant. The
+          * constant is rounded so that the comparison can be done exactly in float.
+          * \param[in] column the index of the column
+          * \param[in] op the comparison operator
+          * \param[in] value the constant to compare to
+          */
+        void
+        addIntegerComparison (int column, ComparisonOps::CompareOp op, double value);
+
+        /** \brief Combine the masks of the last operands.
+          * \param[in] conjunction true for AND, false for OR
+          * \param[in] operands the number of operands. Without operands, the mask is true.
+          */
+        void
+        addCombination (bool conjunction, int operands);
+
+        /** \brief Evaluate the program for all the points of a cloud.
+          * \param[in] cloud the input cloud
+          * \param[in] indices the indices of the points to evaluate, or NULL for the whole cloud
+          * \param[in] threads the number of threads to use
+          * \param[out] result for each point (or index), 1 if the condition holds, 0 otherwise
+          */
+        void
+        evaluate (const PointCloud &cloud, const std::vector<int> *indices, int threads, 
+                  std::vector<char> &result) const;
+
+      protected:
+        /** \brief A column of values. */
+        struct Column
+        {
+          ColumnType type;
+          uint32_t offset;
+        };
+
+        /** \brief A single instruction: either a comparison or a combination of masks. */
+        struct Instruction
+        {
+          /** \brief The column to compare, or -1 for a combination. */
+          int column;
+          ComparisonOps::CompareOp op;
+          float value;
+          /** \brief For combinations, true for AND, false for OR. */
+          bool conjunction;
+          int operands;
+        };
+
+        /** \brief Evaluate the program for one block of points.
+          * \param[in] points pointers to the points of the block
+          * \param[in] n the number of points in the block
+          * \param[out] columns scratch space for the columns
+          * \param[out] stack scratch space for the mask stack
+          * \param[out] result the result for each point
+          */
+        void
+        evaluateBlock (const PointT **points, int n, float *columns, float *stack, char *result) const;
+
+        std::vector<Column> columns_;
+        std::vector<Instruction> instructions_;
+
+        /** \brief The maximum and current size of the mask stack. */
+        int max_depth_, depth_;
+    };
+  }
+
   //////////////////////////////////////////////////////////////////////////////////////////
   /** \brief @b ConditionalRemoval filters data that satisfies certain conditions.
     *
@@ -402,9 +603,10 @@ namespace pcl
     * \ingroup filters
     */
   template<typename PointT>
-  class ConditionalRemoval : public Filter<PointT>
+  class ConditionalRemoval : public FilterIndices<PointT>
   {
     using Filter<PointT>::input_;
+    using Filter<PointT>::indices_;
     using Filter<PointT>::filter_name_;
     using Filter<PointT>::getClassName;
 
@@ -427,8 +629,9 @@ namespace pcl
         * \param extract_removed_indices extract filtered indices from indices vector
         */
       ConditionalRemoval (int extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), keep_organized_ (false), condition_ (),
-        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ())
+        FilterIndices<PointT>::FilterIndices (extract_removed_indices), capable_ (false),
+        keep_organized_ (false), condition_ (),
+        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ()), threads_ (1)
       {
         filter_name_ = "ConditionalRemoval";
       }
@@ -439,8 +642,9 @@ namespace pcl
         * \param extract_removed_indices extract filtered indices from indices vector
         */
       ConditionalRemoval (ConditionBasePtr condition, bool extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), keep_organized_ (false), condition_ (),
-        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ())
+        FilterIndices<PointT>::FilterIndices (extract_removed_indices), capable_ (false),
+        keep_organized_ (false), condition_ (),
+        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ()), threads_ (1)
       {
         filter_name_ = "ConditionalRemoval";
         setCondition (condition);
@@ -477,6 +681,22 @@ namespace pcl
         user_filter_value_ = val;
       }
 
+      /** \brief Set the number of threads used to evaluate the condition.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads used to evaluate the condition. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Set the condition that the filter will use.  
         * \param condition each point must satisfy this condition to avoid
         * being removed by the filter
@@ -486,6 +706,16 @@ namespace pcl
       void
       setCondition (ConditionBasePtr condition);
 
+      /** \brief Check that a valid condition has been set, for \ref testPoint. */
+      bool
+      initPointTest ();
+
+      /** \brief Test whether a single point is valid and satisfies the condition.
+        * \param[in] point the point to test
+        */
+      bool
+      testPoint (const PointT &point) const;
+
     protected:
       /** \brief Filter a Point Cloud.
         * \param output the resultant point cloud message
@@ -493,6 +723,21 @@ namespace pcl
       void
       applyFilter (PointCloud &output);
 
+      /** \brief Filter a Point Cloud, returning the indices of the points that satisfy the condition. The 
+        * organized structure is not kept.
+        * \param[out] indices the resultant point cloud indices
+        */
+      void
+      applyFilter (std::vector<int> &indices);
+
+      /** \brief Evaluate the condition on all the input points (or indices). The condition
+        * is compiled to a ConditionProgram when possible, and evaluated point by point otherwise.
+        * \param[in] indices the indices of the points to evaluate, or NULL for the whole cloud
+        * \param[out] passed for each point (or index), 1 if the condition holds, 0 otherwise
+        */
+      void
+      evaluateCondition (const std::vector<int> *indices, std::vector<char> &passed);
+
       typedef typename pcl::traits::fieldList<PointT>::type FieldList;
 
       /** \brief True if capable. */
@@ -510,6 +755,9 @@ namespace pcl
         * the correct field type. 
         */
       float user_filter_value_;
+
+      /** \brief The number of threads used to evaluate the condition. */
+      unsigned int threads_;
   };
 }
 
@@ -70,7 +70,9 @@ namespace pcl
       CropBox () :
         min_pt_ (Eigen::Vector4f (-1, -1, -1, 1)),
         max_pt_ (Eigen::Vector4f (1, 1, 1, 1)),
-        transform_ (Eigen::Affine3f::Identity ())
+        transform_ (Eigen::Affine3f::Identity ()),
+        inverse_transform_ (Eigen::Affine3f::Identity ()),
+        apply_transform_ (false), apply_inverse_transform_ (false), check_finite_ (true)
       {
         filter_name_ = "CropBox";
         rotation_ = Eigen::Vector3f::Zero ();
@@ -161,6 +163,16 @@ namespace pcl
         return (transform_);
       }
 
+      /** \brief Precompute the box rotation used by \ref testPoint. */
+      bool
+      initPointTest ();
+
+      /** \brief Test whether a single point lies inside the box.
+        * \param[in] point the point to test
+        */
+      bool
+      testPoint (const PointT &point) const;
+
     protected:
       /** \brief Sample of point indices into a separate PointCloud
         * \param[out] output the resultant point cloud
@@ -185,6 +197,14 @@ namespace pcl
       Eigen::Vector3f rotation_;
       /** \brief The affine transform applied to the cloud. */
       Eigen::Affine3f transform_;
+      /** \brief The inverse of the box rotation, computed by initPointTest. */
+      Eigen::Affine3f inverse_transform_;
+      /** \brief True if transform_ is not the identity. */
+      bool apply_transform_;
+      /** \brief True if inverse_transform_ is not the identity. */
+      bool apply_inverse_transform_;
+      /** \brief True if the input cloud may contain invalid points. */
+      bool check_finite_;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
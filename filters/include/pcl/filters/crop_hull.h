@@ -44,8 +44,50 @@
 
 namespace pcl
 {
+  namespace detail
+  {
+    /** \brief A triangle of a 3D CropHull, with the quantities used by the ray crossing test precomputed. */
+    struct CropHullTriangle
+    {
+      /** \brief The first vertex, and the two edges from it. */
+      Eigen::Vector3f a, u, v;
+      /** \brief The (unnormalized) normal. */
+      Eigen::Vector3f n;
+      float uu, uv, vv, denominator;
+    };
+
+    /** \brief A node of the bounding volume hierarchy over the triangles of a 3D CropHull. The first child of an 
+      * inner node directly follows it.
+      */
+    struct CropHullBVHNode
+    {
+      Eigen::Vector3f min_pt, max_pt;
+      /** \brief The range of triangles under this node. */
+      int begin, end;
+      /** \brief The index of the second child, or -1 for leaves. */
+      int second_child;
+    };
+
+    /** \brief An edge of a 2D CropHull, in the projection plane: its end points in polygon order (xold, xnew)
+      * and sorted along the first dimension ((x1, y1), (x2, y2)).
+      */
+    struct CropHullEdge
+    {
+      double xold, xnew;
+      double x1, y1, x2, y2;
+      /** \brief The polygon the edge belongs to. */
+      int polygon;
+    };
+  }
+
   /** \brief Filter points that lie inside or outside a 3D closed surface or 2D
     * closed polygon, as generated by the ConvexHull or ConcaveHull classes.
+    *
+    * The hull is indexed on first use after \a setHullIndices or \a setHullCloud:
+    * 3D hulls with a bounding volume hierarchy over their triangles, and 2D hulls
+    * with a grid of slabs holding the edges that overlap them. Modifying the
+    * hull cloud in place requires calling \a setHullCloud again.
+    *
     * \author James Crosby
     * \ingroup filters
     */
@@ -66,7 +108,10 @@ namespace pcl
         hull_polygons_(),
         hull_cloud_(),
         dim_(3),
-        crop_outside_(true)
+        crop_outside_(true),
+        threads_ (1),
+        slab_min_ (0), slab_inverse_size_ (0),
+        edge_grid_dims_ (-1, -1)
       {
         filter_name_ = "CropHull";
       }
@@ -79,6 +124,7 @@ namespace pcl
       setHullIndices (const std::vector<Vertices>& polygons)
       {
         hull_polygons_ = polygons;
+        clearHullIndex ();
       }
 
       /** \brief Get the vertices of the hull used to filter points.
@@ -96,6 +142,7 @@ namespace pcl
       setHullCloud (PointCloudPtr points)
       {
         hull_cloud_ = points;
+        clearHullIndex ();
       }
 
       /** \brief Get the point cloud that the hull indices refer to. */
@@ -127,6 +174,22 @@ namespace pcl
         crop_outside_ = crop_outside;
       }
 
+      /** \brief Set the number of threads used to test the points.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads used to test the points. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
     protected:
       /** \brief Filter the input points using the 2D or 3D polygon hull.
         * \param[out] output The set of points that passed the filter
@@ -189,30 +252,59 @@ namespace pcl
       void
       applyFilter3D (std::vector<int> &indices);
 
-      /** \brief Test an individual point against a 2D polygon.
-        * PlaneDim1 and PlaneDim2 specify the x/y/z coordinate axes to use.
-        * \param[in] point Point to test against the polygon.
-        * \param[in] verts Vertex indices of polygon.
-        * \param[in] cloud Cloud from which the vertex indices are drawn.
+      /** \brief Test whether the input points are inside the 2D hull.
+        * \param[out] inside for each index, 1 if the point is inside one of the polygons, 0 otherwise
+        */
+      template<unsigned PlaneDim1, unsigned PlaneDim2> void
+      testPoints2D (std::vector<char> &inside);
+
+      /** \brief Test whether the input points are inside the 3D hull.
+        * \param[out] inside for each index, 1 if the point is inside the hull, 0 otherwise
+        */
+      void
+      testPoints3D (std::vector<char> &inside);
+
+      /** \brief Discard the acceleration structures built for the current hull. */
+      inline void
+      clearHullIndex ()
+      {
+        triangles_.clear ();
+        bvh_.clear ();
+        edges_.clear ();
+        slab_begin_.clear ();
+        slab_edges_.clear ();
+        edge_grid_dims_ = std::make_pair (-1, -1);
+      }
+
+      /** \brief Build the bounding volume hierarchy over the triangles of the hull. */
+      void
+      buildBVH ();
+
+      /** \brief Build the grid of slabs along PlaneDim1 holding the edges of the 2D hull. */
+      template<unsigned PlaneDim1, unsigned PlaneDim2> void
+      buildEdgeGrid ();
+
+      /** \brief Count the triangles of the hull crossed by a ray.
+        * \param[in] point Point from which the ray is cast.
+        * \param[in] ray   Vector in direction of ray.
+        * \param[in] inverse_ray The component-wise inverse of ray.
         */
-      template<unsigned PlaneDim1, unsigned PlaneDim2> inline static bool
-      isPointIn2DPolyWithVertIndices (const PointT& point,
-                                      const Vertices& verts,
-                                      const PointCloud& cloud);
+      int
+      countCrossings (const Eigen::Vector3f& point,
+                      const Eigen::Vector3f& ray,
+                      const Eigen::Vector3f& inverse_ray) const;
 
       /** \brief Does a ray cast from a point intersect with an arbitrary
         * triangle in 3D?
         * See: http://softsurfer.com/Archive/algorithm_0105/algorithm_0105.htm#intersect_RayTriangle()
         * \param[in] point Point from which the ray is cast.
         * \param[in] ray   Vector in direction of ray.
-        * \param[in] verts Indices of vertices making the polygon.
-        * \param[in] cloud Cloud from which the vertex indices are drawn.
+        * \param[in] triangle The triangle, with its precomputed quantities.
         */
       inline static bool
-      rayTriangleIntersect (const PointT& point,
+      rayTriangleIntersect (const Eigen::Vector3f& point,
                             const Eigen::Vector3f& ray,
-                            const Vertices& verts,
-                            const PointCloud& cloud);
+                            const detail::CropHullTriangle& triangle);
 
 
       /** \brief The vertices of the hull used to filter points. */
@@ -228,6 +320,29 @@ namespace pcl
        * false, those inside will be removed.
        */
       bool crop_outside_;
+
+      /** \brief The number of threads used to test the points. */
+      unsigned int threads_;
+
+      /** \brief The triangles of the 3D hull, in the order of the leaves of bvh_. */
+      std::vector<detail::CropHullTriangle> triangles_;
+
+      /** \brief The bounding volume hierarchy over triangles_. */
+      std::vector<detail::CropHullBVHNode> bvh_;
+
+      /** \brief The edges of the 2D hull. */
+      std::vector<detail::CropHullEdge> edges_;
+
+      /** \brief The slabs of the 2D edge grid: the edges overlapping slab i are 
+        * slab_edges_[slab_begin_[i]] to slab_edges_[slab_begin_[i+1] - 1], sorted by polygon.
+        */
+      std::vector<int> slab_begin_, slab_edges_;
+
+      /** \brief The extent of the 2D edge grid along PlaneDim1, and the inverse size of its slabs. */
+      double slab_min_, slab_inverse_size_;
+
+      /** \brief The projection (PlaneDim1, PlaneDim2) used to build the edge grid, or (-1, -1). */
+      std::pair<int, int> edge_grid_dims_;
   };
 
 } // namespace pcl
@@ -69,6 +69,17 @@ namespace pcl
 
       typedef pcl::PointCloud<PointT> PointCloud;
 
+      typedef boost::shared_ptr< FilterIndices<PointT> > Ptr;
+      typedef boost::shared_ptr< const FilterIndices<PointT> > ConstPtr;
+
+      /** \brief Empty constructor.
+        * \param[in] extract_removed_indices set to true if the filtered data indices should be saved in a 
+        * separate list. Default: false.
+        */
+      FilterIndices (bool extract_removed_indices = false) : Filter<PointT> (extract_removed_indices)
+      {
+      }
+
       virtual void
       filter (PointCloud &output)
       {
@@ -91,6 +102,27 @@ namespace pcl
         deinitCompute ();
       }
 
+      /** \brief Prepare the filter for testing single points with \ref testPoint, e.g. when it is fused with
+        * other filters in a \ref FilterPipeline. The input cloud must have been set.
+        * \return true if the filter decides on each point independently of the others, false if it must be
+        * applied to a whole set of indices (e.g., sampling filters)
+        */
+      virtual bool
+      initPointTest ()
+      {
+        return (false);
+      }
+
+      /** \brief Test whether a single point passes the filter. Only valid after \ref initPointTest returned true.
+        * \param[in] point the point to test
+        * \return true if the point is kept by the filter
+        */
+      virtual bool
+      testPoint (const PointT &) const
+      {
+        return (true);
+      }
+
     protected:
 
       /** \brief Abstract filter method for point cloud indices.
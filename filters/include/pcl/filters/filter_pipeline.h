@@ -0,0 +1,170 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_FILTER_PIPELINE_H_
+#define PCL_FILTERS_FILTER_PIPELINE_H_
+
+#include "pcl/filters/filter_indices.h"
+
+namespace pcl
+{
+  ////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief @b FilterPipeline applies a chain of filters to a point cloud without creating the intermediate
+    * point clouds.
+    *
+    * The stages of the pipeline are \ref FilterIndices filters. Consecutive stages which decide on each point
+    * independently of the others (see \ref FilterIndices::initPointTest, e.g., PassThrough, CropBox and
+    * ConditionalRemoval) are fused into a single pass over the input, in which every point is tested against
+    * each of them in turn. The other stages (e.g., RandomSample) are applied to the indices of the points that
+    * survived the previous stages. The surviving indices are finally given to an optional reducer, such as a
+    * VoxelGrid, which reads the points directly from the input cloud.
+    *
+    * \code
+    * pcl::FilterPipeline<pcl::PointXYZ> pipeline;
+    * pipeline.addFilter (pass);
+    * pipeline.addFilter (crop_box);
+    * pipeline.setReducer (voxel_grid);
+    * pipeline.setInputCloud (cloud);
+    * pipeline.filter (output);
+    * \endcode
+    *
+    * \note The input cloud and indices of the stages and of the reducer are overwritten by the pipeline.
+    * \ingroup filters
+    */
+  template<typename PointT>
+  class FilterPipeline : public FilterIndices<PointT>
+  {
+    using Filter<PointT>::input_;
+    using Filter<PointT>::indices_;
+    using Filter<PointT>::filter_name_;
+    using Filter<PointT>::getClassName;
+
+    using Filter<PointT>::removed_indices_;
+    using Filter<PointT>::extract_removed_indices_;
+
+    typedef typename Filter<PointT>::PointCloud PointCloud;
+    typedef typename PointCloud::Ptr PointCloudPtr;
+    typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+
+    public:
+      typedef typename FilterIndices<PointT>::Ptr FilterIndicesPtr;
+      typedef typename Filter<PointT>::Ptr FilterPtr;
+
+      /** \brief Empty constructor.
+        * \param[in] extract_removed_indices set to true if the indices of the points removed by any of the
+        * stages should be saved in a separate list. Default: false.
+        */
+      FilterPipeline (bool extract_removed_indices = false) :
+        FilterIndices<PointT>::FilterIndices (extract_removed_indices), filters_ (), reducer_ ()
+      {
+        filter_name_ = "FilterPipeline";
+      }
+
+      /** \brief Append a stage to the pipeline.
+        * \param[in] filter the filter, applied after all the stages added before
+        */
+      inline void
+      addFilter (const FilterIndicesPtr &filter)
+      {
+        filters_.push_back (filter);
+      }
+
+      /** \brief Remove all the stages of the pipeline. */
+      inline void
+      clearFilters ()
+      {
+        filters_.clear ();
+      }
+
+      /** \brief Get the number of stages of the pipeline. */
+      inline size_t
+      getNumberOfFilters () const
+      {
+        return (filters_.size ());
+      }
+
+      /** \brief Set the filter applied to the surviving points to produce the output cloud, e.g., a VoxelGrid.
+        * If none is set (default), the surviving points are copied to the output.
+        * \param[in] reducer the filter applied to the input cloud, restricted to the surviving indices
+        */
+      inline void
+      setReducer (const FilterPtr &reducer)
+      {
+        reducer_ = reducer;
+      }
+
+      /** \brief Get the filter applied to the surviving points. */
+      inline FilterPtr
+      getReducer ()
+      {
+        return (reducer_);
+      }
+
+      /** \brief Prepare all the stages for testing single points. The reducer is not used in this mode.
+        * \return true if all the stages support testing single points
+        */
+      bool
+      initPointTest ();
+
+      /** \brief Test whether a single point passes all the stages.
+        * \param[in] point the point to test
+        */
+      bool
+      testPoint (const PointT &point) const;
+
+    protected:
+      /** \brief Filter the input cloud through all the stages, and apply the reducer to the result.
+        * \param[out] output the resultant point cloud
+        */
+      void
+      applyFilter (PointCloud &output);
+
+      /** \brief Filter the input cloud through all the stages.
+        * \param[out] indices the indices of the points which passed all the stages
+        */
+      void
+      applyFilter (std::vector<int> &indices);
+
+      /** \brief The stages of the pipeline, in order. */
+      std::vector<FilterIndicesPtr> filters_;
+
+      /** \brief The filter applied to the surviving points. */
+      FilterPtr reducer_;
+  };
+}
+
+#endif  //#ifndef PCL_FILTERS_FILTER_PIPELINE_H_
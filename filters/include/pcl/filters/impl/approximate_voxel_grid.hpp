@@ -40,23 +40,105 @@
 
 #include "pcl/common/common.h"
 #include "pcl/filters/approximate_voxel_grid.h"
+#include <algorithm>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Cache size targeted by the adaptive history size of ApproximateVoxelGrid, per thread. */
+    const size_t approximate_voxel_cache_size = 256 * 1024;
+
+    /** \brief Number of points on which the collision rate is measured. */
+    const size_t approximate_voxel_nr_samples = 65536;
+
+    /** \brief Collision rate (evicted voxels per point) below which the history is large enough. */
+    const float approximate_voxel_max_collision_rate = 0.05f;
+
+    /** \brief The history of ApproximateVoxelGrid: a hash table holding, in each slot, the running sum of the
+      * points of a single voxel, stored in flat arrays.
+      */
+    struct ApproximateVoxelHistory
+    {
+      ApproximateVoxelHistory (size_t size, int centroid_size) :
+        keys (size * 3), counts (size, 0), sums (size * centroid_size, 0.0f)
+      {
+      }
+
+      /** \brief The voxel (ix, iy, iz) of each slot. */
+      std::vector<int> keys;
+      /** \brief The number of points accumulated in each slot, 0 for empty slots. */
+      std::vector<int> counts;
+      /** \brief The sum of the unpacked points of each slot. */
+      std::vector<float> sums;
+    };
+
+    /** \brief The slot of a voxel in a history of a given size (a power of 2). */
+    inline size_t
+    approximateVoxelSlot (int ix, int iy, int iz, size_t size)
+    {
+      return ((ix * 7171 + iy * 3079 + iz * 4231) & (size - 1));
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::ApproximateVoxelGrid<PointT>::flush (PointCloud &output, size_t op, he *hhe, int rgba_index, int centroid_size)
+pcl::ApproximateVoxelGrid<PointT>::flush (const float *sum, int count, int rgba_index, int centroid_size, 
+                                          Eigen::VectorXf &centroid, PointT &point)
 {
-  hhe->centroid /= hhe->count;
-  pcl::for_each_type <FieldList> (pcl::xNdCopyEigenPointFunctor <PointT> (hhe->centroid, output.points[op]));
+  centroid = Eigen::Map<const Eigen::VectorXf> (sum, centroid_size) / static_cast<float> (count);
+  pcl::for_each_type <FieldList> (pcl::xNdCopyEigenPointFunctor <PointT> (centroid, point));
   // ---[ RGB special case
   if (rgba_index >= 0)
   {
     // pack r/g/b into rgb
-    float r = hhe->centroid[centroid_size-3], 
-          g = hhe->centroid[centroid_size-2], 
-          b = hhe->centroid[centroid_size-1];
+    float r = centroid[centroid_size-3], 
+          g = centroid[centroid_size-2], 
+          b = centroid[centroid_size-1];
     int rgb = ((int)r) << 16 | ((int)g) << 8 | ((int)b);
-    memcpy (((char *)&output.points[op]) + rgba_index, &rgb, sizeof (float));
+    memcpy (((char *)&point) + rgba_index, &rgb, sizeof (float));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> size_t
+pcl::ApproximateVoxelGrid<PointT>::chooseHistorySize (int centroid_size) const
+{
+  // Largest history that fits in the cache
+  const size_t slot_size = 4 * sizeof (int) + centroid_size * sizeof (float);
+  size_t max_size = histsize_;
+  while (2 * max_size * slot_size <= detail::approximate_voxel_cache_size)
+    max_size *= 2;
+
+  // Double the size until the voxels of the first points rarely collide
+  const size_t nr_samples = std::min (input_->points.size (), detail::approximate_voxel_nr_samples);
+  std::vector<int> keys;
+  std::vector<char> used;
+  size_t size = histsize_;
+  for (; size < max_size; size *= 2)
+  {
+    keys.assign (size * 3, 0);
+    used.assign (size, 0);
+    size_t nr_collisions = 0;
+    for (size_t cp = 0; cp < nr_samples; ++cp)
+    {
+      int ix = (int)floor (input_->points[cp].x * inverse_leaf_size_[0]);
+      int iy = (int)floor (input_->points[cp].y * inverse_leaf_size_[1]);
+      int iz = (int)floor (input_->points[cp].z * inverse_leaf_size_[2]);
+      size_t slot = detail::approximateVoxelSlot (ix, iy, iz, size);
+      int *key = &keys[slot * 3];
+      if (used[slot] && ((ix != key[0]) || (iy != key[1]) || (iz != key[2])))
+        ++nr_collisions;
+      key[0] = ix;
+      key[1] = iy;
+      key[2] = iz;
+      used[slot] = 1;
+    }
+    if (nr_collisions <= detail::approximate_voxel_max_collision_rate * nr_samples)
+      break;
   }
+  return (size);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -79,54 +161,101 @@ pcl::ApproximateVoxelGrid<PointT>::applyFilter (PointCloud &output)
     centroid_size += 3;
   }
 
-  for (size_t i = 0; i < histsize_; i++) 
-  {
-    history_[i].count = 0;
-    history_[i].centroid = Eigen::VectorXf::Zero (centroid_size);
-  }
-  Eigen::VectorXf scratch = Eigen::VectorXf::Zero (centroid_size);
+  const size_t histsize = adaptive_histsize_ ? chooseHistorySize (centroid_size) : histsize_;
+
+  // Each thread should process at least as many points as there are slots in its history
+  const int nr_points = static_cast<int> (input_->points.size ());
+  const int nr_threads = std::max (1, std::min (static_cast<int> (threads_), nr_points / static_cast<int> (histsize)));
 
-  output.points.resize (input_->points.size ());   // size output for worst case
-  size_t op = 0;    // output pointer
-  for (size_t cp = 0; cp < input_->points.size (); ++cp) 
+  std::vector<detail::ApproximateVoxelHistory> histories (nr_threads, detail::ApproximateVoxelHistory (histsize, centroid_size));
+  std::vector<std::vector<PointT, Eigen::aligned_allocator<PointT> > > flushed (nr_threads);
+
+#pragma omp parallel for schedule (static, 1) num_threads (nr_threads)
+  for (int t = 0; t < nr_threads; ++t)
   {
-    int ix = (int)floor (input_->points[cp].x * inverse_leaf_size_[0]);
-    int iy = (int)floor (input_->points[cp].y * inverse_leaf_size_[1]);
-    int iz = (int)floor (input_->points[cp].z * inverse_leaf_size_[2]);
-    unsigned int hash = (ix * 7171 + iy * 3079 + iz * 4231) & (histsize_ - 1);
-    he *hhe = &history_[hash];
-    if (hhe->count && ((ix != hhe->ix) || (iy != hhe->iy) || (iz != hhe->iz))) 
-    {
-      flush (output, op++, hhe, rgba_index, centroid_size);
-      hhe->count = 0;
-      hhe->centroid.setZero ();// = Eigen::VectorXf::Zero (centroid_size);
-    }
-    hhe->ix = ix;
-    hhe->iy = iy;
-    hhe->iz = iz;
-    hhe->count++;
-
-    // Unpack the point into scratch, then accumulate
-    // ---[ RGB special case
-    if (rgba_index >= 0)
+    detail::ApproximateVoxelHistory &history = histories[t];
+    std::vector<PointT, Eigen::aligned_allocator<PointT> > &points = flushed[t];
+    Eigen::VectorXf scratch = Eigen::VectorXf::Zero (centroid_size);
+    Eigen::VectorXf centroid (centroid_size);
+
+    const int begin = static_cast<int> (static_cast<int64_t> (nr_points) * t / nr_threads);
+    const int end = static_cast<int> (static_cast<int64_t> (nr_points) * (t + 1) / nr_threads);
+    for (int cp = begin; cp < end; ++cp) 
     {
-      // fill r/g/b data
-      pcl::RGB rgb;
-      memcpy (&rgb, ((char *)&(input_->points[cp])) + rgba_index, sizeof (RGB));
-      scratch[centroid_size-3] = rgb.r;
-      scratch[centroid_size-2] = rgb.g;
-      scratch[centroid_size-1] = rgb.b;
+      int ix = (int)floor (input_->points[cp].x * inverse_leaf_size_[0]);
+      int iy = (int)floor (input_->points[cp].y * inverse_leaf_size_[1]);
+      int iz = (int)floor (input_->points[cp].z * inverse_leaf_size_[2]);
+      size_t slot = detail::approximateVoxelSlot (ix, iy, iz, histsize);
+      int *key = &history.keys[slot * 3];
+      float *sum = &history.sums[slot * centroid_size];
+      if (history.counts[slot] && ((ix != key[0]) || (iy != key[1]) || (iz != key[2]))) 
+      {
+        points.push_back (PointT ());
+        flush (sum, history.counts[slot], rgba_index, centroid_size, centroid, points.back ());
+        history.counts[slot] = 0;
+        std::fill (sum, sum + centroid_size, 0.0f);
+      }
+      key[0] = ix;
+      key[1] = iy;
+      key[2] = iz;
+      history.counts[slot]++;
+
+      // Unpack the point into scratch, then accumulate
+      // ---[ RGB special case
+      if (rgba_index >= 0)
+      {
+        // fill r/g/b data
+        pcl::RGB rgb;
+        memcpy (&rgb, ((char *)&(input_->points[cp])) + rgba_index, sizeof (RGB));
+        scratch[centroid_size-3] = rgb.r;
+        scratch[centroid_size-2] = rgb.g;
+        scratch[centroid_size-1] = rgb.b;
+      }
+      pcl::for_each_type <FieldList> (xNdCopyPointEigenFunctor <PointT> (input_->points[cp], scratch));
+      Eigen::Map<Eigen::VectorXf> (sum, centroid_size) += scratch;
     }
-    pcl::for_each_type <FieldList> (xNdCopyPointEigenFunctor <PointT> (input_->points[cp], scratch));
-    hhe->centroid += scratch;
   }
-  for (size_t i = 0; i < histsize_; i++) 
+
+  size_t nr_flushed = 0;
+  for (int t = 0; t < nr_threads; ++t)
+    nr_flushed += flushed[t].size ();
+  output.points.clear ();
+  output.points.reserve (nr_flushed + histsize);
+  for (int t = 0; t < nr_threads; ++t)
   {
-    he *hhe = &history_[i];
-    if (hhe->count)
-      flush (output, op++, hhe, rgba_index, centroid_size);
+    output.points.insert (output.points.end (), flushed[t].begin (), flushed[t].end ());
+    std::vector<PointT, Eigen::aligned_allocator<PointT> > ().swap (flushed[t]);
+  }
+
+  // Write out the voxels left in the histories. A voxel is always hashed to the same slot, so that the 
+  // partial centroids of a voxel accumulated by different threads are merged here.
+  Eigen::VectorXf centroid (centroid_size);
+  for (size_t slot = 0; slot < histsize; ++slot) 
+  {
+    for (int t = 0; t < nr_threads; ++t)
+    {
+      detail::ApproximateVoxelHistory &history = histories[t];
+      if (!history.counts[slot])
+        continue;
+      const int *key = &history.keys[slot * 3];
+      float *sum = &history.sums[slot * centroid_size];
+      int count = history.counts[slot];
+      for (int u = t + 1; u < nr_threads; ++u)
+      {
+        detail::ApproximateVoxelHistory &other = histories[u];
+        const int *other_key = &other.keys[slot * 3];
+        if (other.counts[slot] && other_key[0] == key[0] && other_key[1] == key[1] && other_key[2] == key[2])
+        {
+          Eigen::Map<Eigen::VectorXf> (sum, centroid_size) += 
+            Eigen::Map<const Eigen::VectorXf> (&other.sums[slot * centroid_size], centroid_size);
+          count += other.counts[slot];
+          other.counts[slot] = 0;
+        }
+      }
+      output.points.push_back (PointT ());
+      flush (sum, count, rgba_index, centroid_size, centroid, output.points.back ());
+    }
   }
-  output.points.resize (op);
   output.width = output.points.size ();
   output.height       = 1;                    // downsampling breaks the organized structure
   output.is_dense     = false;                 // we filter out invalid points
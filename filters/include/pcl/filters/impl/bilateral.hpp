@@ -39,6 +39,27 @@
 #define PCL_FILTERS_BILATERAL_IMPL_H_
 
 #include <pcl/filters/bilateral.h>
+#include <boost/unordered_map.hpp>
+#include <cfloat>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Maximum number of cells of the bilateral grid along each dimension, so that the 4 coordinates
+      * of a cell can be packed into 64 bits (with a margin for the corners and the blur).
+      */
+    const int bilateral_grid_max_cells = 65532;
+
+    /** \brief Pack the coordinates of a cell of the bilateral grid into a single key. */
+    inline uint64_t
+    packBilateralGridCell (const int *c)
+    {
+      return ((static_cast<uint64_t> (c[0]) << 48) | (static_cast<uint64_t> (c[1]) << 32) | 
+              (static_cast<uint64_t> (c[2]) << 16) | static_cast<uint64_t> (c[3]));
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> double
@@ -66,6 +87,180 @@ pcl::BilateralFilter<PointT>::computePointWeight (const int pid,
   return (BF / W);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::BilateralFilter<PointT>::applyOrganizedWindow (PointCloud &output)
+{
+  const int width = static_cast<int> (input_->width), height = static_cast<int> (input_->height);
+
+  // Precompute the spatial kernel over the pixel offsets of the window, limited to a radius of 2 * sigma_s
+  const int radius = static_cast<int> (floor (2 * sigma_s_));
+  const int size = 2 * radius + 1;
+  std::vector<double> spatial_kernel (size * size, 0.0);
+  for (int dv = -radius; dv <= radius; ++dv)
+    for (int du = -radius; du <= radius; ++du)
+      if (du * du + dv * dv <= 4 * sigma_s_ * sigma_s_)
+        spatial_kernel[(dv + radius) * size + du + radius] = kernel (sqrt (static_cast<double> (du * du + dv * dv)), sigma_s_);
+
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int i = 0; i < static_cast<int> (indices_->size ()); ++i)
+  {
+    const int idx = (*indices_)[i];
+    const PointT &point = input_->points[idx];
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+      continue;
+
+    const int u = idx % width, v = idx / width;
+    double BF = 0, W = 0;
+    for (int dv = std::max (-radius, -v); dv <= std::min (radius, height - 1 - v); ++dv)
+    {
+      const double *weights = &spatial_kernel[(dv + radius) * size + radius];
+      const PointT *row = &input_->points[(v + dv) * width + u];
+      for (int du = std::max (-radius, -u); du <= std::min (radius, width - 1 - u); ++du)
+      {
+        const PointT &neighbor = row[du];
+        if (weights[du] == 0 || 
+            !pcl_isfinite (neighbor.x) || !pcl_isfinite (neighbor.y) || !pcl_isfinite (neighbor.z))
+          continue;
+
+        double weight = weights[du] * kernel (neighbor.intensity - point.intensity, sigma_r_);
+        BF += weight * neighbor.intensity;
+        W += weight;
+      }
+    }
+    output.points[idx].intensity = static_cast<float> (BF / W);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::BilateralFilter<PointT>::applyBilateralGrid (PointCloud &output)
+{
+  // Bounds of the valid points, in (x, y, z, intensity) space
+  Eigen::Array4f min_p = Eigen::Array4f::Constant (FLT_MAX), max_p = Eigen::Array4f::Constant (-FLT_MAX);
+  for (size_t i = 0; i < input_->points.size (); ++i)
+  {
+    const PointT &point = input_->points[i];
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+      continue;
+    Eigen::Array4f p (point.x, point.y, point.z, point.intensity);
+    min_p = min_p.min (p);
+    max_p = max_p.max (p);
+  }
+  if (min_p[0] > max_p[0])
+    return (true);
+
+  const Eigen::Array4f inverse_cell_size (static_cast<float> (1.0 / sigma_s_), static_cast<float> (1.0 / sigma_s_), 
+                                          static_cast<float> (1.0 / sigma_s_), static_cast<float> (1.0 / sigma_r_));
+  const Eigen::Array4f extents = (max_p - min_p) * inverse_cell_size;
+  if (!(extents < static_cast<float> (detail::bilateral_grid_max_cells)).all ())
+  {
+    PCL_WARN ("[pcl::BilateralFilter::applyFilter] The bilateral grid would be too large, using the exact method.\n");
+    return (false);
+  }
+
+  // Splat each point on the 16 corners of its grid cell, with multilinear weights. The coordinates are 
+  // offset by 1, so that the neighbors of all the cells have non negative coordinates.
+  boost::unordered_map<uint64_t, int> cell_indices;
+  std::vector<uint64_t> cells;
+  std::vector<float> cell_weights, cell_values;
+  for (size_t i = 0; i < input_->points.size (); ++i)
+  {
+    const PointT &point = input_->points[i];
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+      continue;
+    Eigen::Array4f g = (Eigen::Array4f (point.x, point.y, point.z, point.intensity) - min_p) * inverse_cell_size + 1.0f;
+    Eigen::Array4f base = g.floor ();
+    Eigen::Array4f frac = g - base;
+    for (int corner = 0; corner < 16; ++corner)
+    {
+      int c[4];
+      float weight = 1.0f;
+      for (int d = 0; d < 4; ++d)
+      {
+        bool upper = ((corner >> d) & 1) != 0;
+        c[d] = static_cast<int> (base[d]) + upper;
+        weight *= upper ? frac[d] : 1.0f - frac[d];
+      }
+      if (weight == 0)
+        continue;
+
+      std::pair<boost::unordered_map<uint64_t, int>::iterator, bool> it = 
+        cell_indices.insert (std::make_pair (detail::packBilateralGridCell (c), static_cast<int> (cells.size ())));
+      if (it.second)
+      {
+        cells.push_back (it.first->first);
+        cell_weights.push_back (0.0f);
+        cell_values.push_back (0.0f);
+      }
+      cell_weights[it.first->second] += weight;
+      cell_values[it.first->second] += weight * point.intensity;
+    }
+  }
+
+  // Blur the grid with a [1 2 1] kernel along each dimension
+  const int nr_cells = static_cast<int> (cells.size ());
+  std::vector<float> blurred_weights (nr_cells), blurred_values (nr_cells);
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int j = 0; j < nr_cells; ++j)
+  {
+    const int c[4] = { static_cast<int> (cells[j] >> 48), static_cast<int> ((cells[j] >> 32) & 0xFFFF), 
+                       static_cast<int> ((cells[j] >> 16) & 0xFFFF), static_cast<int> (cells[j] & 0xFFFF) };
+    float weight_sum = 0, value_sum = 0;
+    for (int offset = 0; offset < 81; ++offset)
+    {
+      int n[4];
+      float weight = 1.0f;
+      for (int d = 0, o = offset; d < 4; ++d, o /= 3)
+      {
+        n[d] = c[d] + o % 3 - 1;
+        weight *= (o % 3 == 1) ? 2.0f : 1.0f;
+      }
+      boost::unordered_map<uint64_t, int>::const_iterator it = cell_indices.find (detail::packBilateralGridCell (n));
+      if (it == cell_indices.end ())
+        continue;
+      weight_sum += weight * cell_weights[it->second];
+      value_sum += weight * cell_values[it->second];
+    }
+    blurred_weights[j] = weight_sum;
+    blurred_values[j] = value_sum;
+  }
+
+  // Interpolate the blurred grid at each point
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int i = 0; i < static_cast<int> (indices_->size ()); ++i)
+  {
+    const PointT &point = input_->points[(*indices_)[i]];
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+      continue;
+    Eigen::Array4f g = (Eigen::Array4f (point.x, point.y, point.z, point.intensity) - min_p) * inverse_cell_size + 1.0f;
+    Eigen::Array4f base = g.floor ();
+    Eigen::Array4f frac = g - base;
+    float weight_sum = 0, value_sum = 0;
+    for (int corner = 0; corner < 16; ++corner)
+    {
+      int c[4];
+      float weight = 1.0f;
+      for (int d = 0; d < 4; ++d)
+      {
+        bool upper = ((corner >> d) & 1) != 0;
+        c[d] = static_cast<int> (base[d]) + upper;
+        weight *= upper ? frac[d] : 1.0f - frac[d];
+      }
+      if (weight == 0)
+        continue;
+      boost::unordered_map<uint64_t, int>::const_iterator it = cell_indices.find (detail::packBilateralGridCell (c));
+      if (it == cell_indices.end ())
+        continue;
+      weight_sum += weight * blurred_weights[it->second];
+      value_sum += weight * blurred_values[it->second];
+    }
+    if (weight_sum > 0)
+      output.points[(*indices_)[i]].intensity = value_sum / weight_sum;
+  }
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::BilateralFilter<PointT>::applyFilter (PointCloud &output)
@@ -76,6 +271,23 @@ pcl::BilateralFilter<PointT>::applyFilter (PointCloud &output)
     PCL_ERROR ("[pcl::BilateralFilter::applyFilter] Need a sigma_s value given before continuing.\n");
     return;
   }
+
+  if (method_ == ORGANIZED_WINDOW)
+  {
+    if (input_->isOrganized ())
+    {
+      output = *input_;
+      applyOrganizedWindow (output);
+      return;
+    }
+    PCL_WARN ("[pcl::BilateralFilter::applyFilter] The input is not organized, using the exact method.\n");
+  }
+  else if (method_ == BILATERAL_GRID)
+  {
+    output = *input_;
+    if (applyBilateralGrid (output))
+      return;
+  }
   // In case a search method has not been given, initialize it using some defaults
   if (!tree_)
   {
@@ -41,6 +41,147 @@
 #include <pcl/common/io.h>
 #include <boost/shared_ptr.hpp>
 #include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Convert a packed rgb value to the HSI components used by PackedHSIComparison. */
+    inline void
+    packedRGBToHSI (uint32_t rgb, int8_t &h, uint8_t &s, uint8_t &i)
+    {
+      // extract r,g,b
+      uint8_t r = (uint8_t)(rgb >> 16);
+      uint8_t g = (uint8_t)(rgb >> 8);
+      uint8_t b = (uint8_t)(rgb);
+
+      // definitions taken from http://en.wikipedia.org/wiki/HSL_and_HSI
+      float hx = (2*r - g - b)/4.0;  // hue x component -127 to 127
+      float hy = (g - b) * 111.0 / 255.0; // hue y component -111 to 111
+      h = (int8_t) (atan2(hy, hx) * 128.0 / M_PI);
+
+      int32_t intensity = (r+g+b)/3; // 0 to 255
+      i = intensity;
+
+      int32_t m;  // min(r,g,b)
+      m = (r < g) ? r : g;
+      m = (m < b) ? m : b;
+
+      s = (intensity == 0) ? 0 : 255 - (m*255)/intensity; // saturation 0 to 255
+    }
+
+    /** \brief Read a field of type T of each point of a block, as floats. */
+    template <typename T, typename PointT> inline void
+    gatherFieldValues (const PointT **points, int n, uint32_t offset, float *values)
+    {
+      for (int k = 0; k < n; ++k)
+      {
+        T value;
+        memcpy (&value, reinterpret_cast<const uint8_t*> (points[k]) + offset, sizeof (T));
+        values[k] = static_cast<float> (value);
+      }
+    }
+
+    /** \brief Compare a block of values with a constant. As in PointDataAtOffset::compare, GE, LE and EQ
+      * are computed as "not less", "not greater" and "neither", so that NaN values satisfy them.
+      * \param[in] values the values to compare, padded to a multiple of 4
+      * \param[in] n the number of values, a multiple of 4
+      * \param[in] op the comparison operator
+      * \param[in] constant the constant to compare to
+      * \param[out] mask the resultant mask: all bits set (or 1 without SSE) where the comparison holds, 0 otherwise
+      */
+    inline void
+    compareBlock (const float *values, int n, ComparisonOps::CompareOp op, float constant, float *mask)
+    {
+#ifdef __SSE__
+      const __m128 c = _mm_set1_ps (constant);
+      switch (op)
+      {
+        case ComparisonOps::GT :
+          for (int k = 0; k < n; k += 4)
+            _mm_storeu_ps (mask + k, _mm_cmpgt_ps (_mm_loadu_ps (values + k), c));
+          break;
+        case ComparisonOps::GE :
+          for (int k = 0; k < n; k += 4)
+            _mm_storeu_ps (mask + k, _mm_cmpnlt_ps (_mm_loadu_ps (values + k), c));
+          break;
+        case ComparisonOps::LT :
+          for (int k = 0; k < n; k += 4)
+            _mm_storeu_ps (mask + k, _mm_cmplt_ps (_mm_loadu_ps (values + k), c));
+          break;
+        case ComparisonOps::LE :
+          for (int k = 0; k < n; k += 4)
+            _mm_storeu_ps (mask + k, _mm_cmpngt_ps (_mm_loadu_ps (values + k), c));
+          break;
+        case ComparisonOps::EQ :
+          for (int k = 0; k < n; k += 4)
+          {
+            __m128 v = _mm_loadu_ps (values + k);
+            _mm_storeu_ps (mask + k, _mm_and_ps (_mm_cmpnlt_ps (v, c), _mm_cmpngt_ps (v, c)));
+          }
+          break;
+        default:
+          for (int k = 0; k < n; k += 4)
+            _mm_storeu_ps (mask + k, _mm_setzero_ps ());
+      }
+#else
+      for (int k = 0; k < n; ++k)
+      {
+        int compare_result = (values[k] > constant) - (values[k] < constant);
+        bool result = false;
+        switch (op)
+        {
+          case ComparisonOps::GT : result = (values[k] > constant); break;
+          case ComparisonOps::GE : result = (compare_result >= 0); break;
+          case ComparisonOps::LT : result = (values[k] < constant); break;
+          case ComparisonOps::LE : result = (compare_result <= 0); break;
+          case ComparisonOps::EQ : result = (compare_result == 0); break;
+          default: break;
+        }
+        mask[k] = result ? 1.0f : 0.0f;
+      }
+#endif
+    }
+
+    /** \brief Combine a block mask into another one, with AND (conjunction) or OR. */
+    inline void
+    combineBlock (float *mask, const float *other, int n, bool conjunction)
+    {
+#ifdef __SSE__
+      if (conjunction)
+        for (int k = 0; k < n; k += 4)
+          _mm_storeu_ps (mask + k, _mm_and_ps (_mm_loadu_ps (mask + k), _mm_loadu_ps (other + k)));
+      else
+        for (int k = 0; k < n; k += 4)
+          _mm_storeu_ps (mask + k, _mm_or_ps (_mm_loadu_ps (mask + k), _mm_loadu_ps (other + k)));
+#else
+      for (int k = 0; k < n; ++k)
+        mask[k] = (conjunction ? (mask[k] != 0.0f && other[k] != 0.0f) : (mask[k] != 0.0f || other[k] != 0.0f)) ? 1.0f : 0.0f;
+#endif
+    }
+
+    /** \brief Set all the entries of a block mask. */
+    inline void
+    fillBlock (float *mask, int n)
+    {
+#ifdef __SSE__
+      const __m128 all = _mm_cmpeq_ps (_mm_setzero_ps (), _mm_setzero_ps ());
+      for (int k = 0; k < n; k += 4)
+        _mm_storeu_ps (mask + k, all);
+#else
+      for (int k = 0; k < n; ++k)
+        mask[k] = 1.0f;
+#endif
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -132,6 +273,38 @@ pcl::FieldComparison<PointT>::evaluate (const PointT &point) const
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::FieldComparison<PointT>::compile (detail::ConditionProgram<PointT> &program) const
+{
+  if (!capable_)
+    return (false);
+
+  // Only the types whose values are exactly representable as floats are compiled
+  typedef detail::ConditionProgram<PointT> Program;
+  uint32_t offset = point_data_->getOffset ();
+  switch (point_data_->getDatatype ())
+  {
+    case sensor_msgs::PointField::INT8 :
+      program.addComparison (program.addColumn (Program::INT8, offset), op_, (float)(int8_t)compare_val_);
+      return (true);
+    case sensor_msgs::PointField::UINT8 :
+      program.addComparison (program.addColumn (Program::UINT8, offset), op_, (float)(uint8_t)compare_val_);
+      return (true);
+    case sensor_msgs::PointField::INT16 :
+      program.addComparison (program.addColumn (Program::INT16, offset), op_, (float)(int16_t)compare_val_);
+      return (true);
+    case sensor_msgs::PointField::UINT16 :
+      program.addComparison (program.addColumn (Program::UINT16, offset), op_, (float)(uint16_t)compare_val_);
+      return (true);
+    case sensor_msgs::PointField::FLOAT32 :
+      program.addComparison (program.addColumn (Program::FLOAT32, offset), op_, (float)compare_val_);
+      return (true);
+    default:
+      return (false);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -225,6 +398,17 @@ pcl::PackedRGBComparison<PointT>::evaluate (const PointT &point) const
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PackedRGBComparison<PointT>::compile (detail::ConditionProgram<PointT> &program) const
+{
+  if (!capable_)
+    return (false);
+  int column = program.addColumn (detail::ConditionProgram<PointT>::UINT8, component_offset_);
+  program.addIntegerComparison (column, op_, compare_val_);
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -304,9 +488,6 @@ pcl::PackedHSIComparison<PointT>::evaluate (const PointT &point) const
 {
   // Since this is a const function, we can't make these data members because we change them here
   static uint32_t rgb_val_ = 0;
-  static uint8_t r_ = 0;
-  static uint8_t g_ = 0;
-  static uint8_t b_ = 0;
   static int8_t h_ = 0;
   static uint8_t s_ = 0;
   static uint8_t i_ = 0;
@@ -319,24 +500,7 @@ pcl::PackedHSIComparison<PointT>::evaluate (const PointT &point) const
   if (rgb_val_ != new_rgb_val) 
   { // avoid having to redo this calc, if possible
     rgb_val_ = new_rgb_val;
-    // extract r,g,b
-    r_ = (uint8_t)(rgb_val_ >> 16); 
-    g_ = (uint8_t)(rgb_val_ >> 8);
-    b_ = (uint8_t)(rgb_val_);
-
-    // definitions taken from http://en.wikipedia.org/wiki/HSL_and_HSI
-    float hx = (2*r_ - g_ - b_)/4.0;  // hue x component -127 to 127
-    float hy = (g_ - b_) * 111.0 / 255.0; // hue y component -111 to 111
-    h_ = (int8_t) (atan2(hy, hx) * 128.0 / M_PI);
-
-    int32_t i = (r_+g_+b_)/3; // 0 to 255
-    i_ = i;
-
-    int32_t m;  // min(r,g,b)
-    m = (r_ < g_) ? r_ : g_;
-    m = (m < b_) ? m : b_;
-
-    s_ = (i == 0) ? 0 : 255 - (m*255)/i; // saturation 0 to 255
+    detail::packedRGBToHSI (rgb_val_, h_, s_, i_);
   }
 
   float my_val = 0;
@@ -376,6 +540,23 @@ pcl::PackedHSIComparison<PointT>::evaluate (const PointT &point) const
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PackedHSIComparison<PointT>::compile (detail::ConditionProgram<PointT> &program) const
+{
+  if (!capable_)
+    return (false);
+
+  typedef detail::ConditionProgram<PointT> Program;
+  typename Program::ColumnType type = Program::INTENSITY;
+  if (component_id_ == H)
+    type = Program::HUE;
+  else if (component_id_ == S)
+    type = Program::SATURATION;
+  program.addIntegerComparison (program.addColumn (type, rgb_offset_), op_, compare_val_);
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -464,6 +645,24 @@ pcl::ConditionBase<PointT>::addCondition (Ptr condition)
   conditions_.push_back (condition);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::ConditionBase<PointT>::compileOperands (detail::ConditionProgram<PointT> &program) const
+{
+  if (!capable_)
+    return (false);
+
+  for (size_t i = 0; i < comparisons_.size (); ++i)
+    if (!comparisons_[i]->compile (program))
+      return (false);
+
+  for (size_t i = 0; i < conditions_.size (); ++i)
+    if (!conditions_[i]->compile (program))
+      return (false);
+
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -481,6 +680,16 @@ pcl::ConditionAnd<PointT>::evaluate (const PointT &point) const
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::ConditionAnd<PointT>::compile (detail::ConditionProgram<PointT> &program) const
+{
+  if (!this->compileOperands (program))
+    return (false);
+  program.addCombination (true, static_cast<int> (comparisons_.size () + conditions_.size ()));
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -500,6 +709,233 @@ pcl::ConditionOr<PointT>::evaluate (const PointT &point) const
   return (false);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::ConditionOr<PointT>::compile (detail::ConditionProgram<PointT> &program) const
+{
+  if (!this->compileOperands (program))
+    return (false);
+  program.addCombination (false, static_cast<int> (comparisons_.size () + conditions_.size ()));
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::detail::ConditionProgram<PointT>::clear ()
+{
+  columns_.clear ();
+  instructions_.clear ();
+  max_depth_ = depth_ = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::detail::ConditionProgram<PointT>::addColumn (ColumnType type, uint32_t offset)
+{
+  for (size_t c = 0; c < columns_.size (); ++c)
+    if (columns_[c].type == type && columns_[c].offset == offset)
+      return (static_cast<int> (c));
+
+  Column column;
+  column.type = type;
+  column.offset = offset;
+  columns_.push_back (column);
+  return (static_cast<int> (columns_.size ()) - 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::detail::ConditionProgram<PointT>::addComparison (int column, ComparisonOps::CompareOp op, float value)
+{
+  Instruction instruction;
+  instruction.column = column;
+  instruction.op = op;
+  instruction.value = value;
+  instruction.conjunction = false;
+  instruction.operands = 0;
+  instructions_.push_back (instruction);
+
+  max_depth_ = std::max (max_depth_, ++depth_);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::detail::ConditionProgram<PointT>::addIntegerComparison (int column, ComparisonOps::CompareOp op, double value)
+{
+  const float never = std::numeric_limits<float>::infinity ();
+  // Comparisons with NaN never hold: compare with "greater than infinity" instead
+  if (value != value)
+  {
+    addComparison (column, ComparisonOps::GT, never);
+    return;
+  }
+
+  // The values of the column are integers within [-128, 255], so that x > v <=> x > floor (v),
+  // x >= v <=> x >= ceil (v), x < v <=> x < ceil (v) and x <= v <=> x <= floor (v)
+  value = std::max (-1e6, std::min (1e6, value));
+  switch (op)
+  {
+    case ComparisonOps::GT :
+    case ComparisonOps::LE :
+      value = floor (value);
+      break;
+    case ComparisonOps::GE :
+    case ComparisonOps::LT :
+      value = ceil (value);
+      break;
+    case ComparisonOps::EQ :
+      if (value != floor (value))
+      {
+        addComparison (column, ComparisonOps::GT, never);
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+  addComparison (column, op, static_cast<float> (value));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::detail::ConditionProgram<PointT>::addCombination (bool conjunction, int operands)
+{
+  Instruction instruction;
+  instruction.column = -1;
+  instruction.op = ComparisonOps::EQ;
+  instruction.value = 0;
+  instruction.conjunction = conjunction;
+  instruction.operands = operands;
+  instructions_.push_back (instruction);
+
+  depth_ += 1 - operands;
+  max_depth_ = std::max (max_depth_, depth_);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::detail::ConditionProgram<PointT>::evaluate (
+    const PointCloud &cloud, const std::vector<int> *indices, int threads, std::vector<char> &result) const
+{
+  const int nr_points = static_cast<int> (indices ? indices->size () : cloud.points.size ());
+  const int nr_blocks = (nr_points + block_size - 1) / block_size;
+  result.resize (nr_points);
+
+#pragma omp parallel num_threads (threads)
+  {
+    // Scratch space, private to each thread
+    std::vector<float> columns ((columns_.size () + 1) * block_size);
+    std::vector<float> stack ((max_depth_ + 1) * block_size);
+    const PointT *points[block_size];
+
+#pragma omp for schedule (static)
+    for (int b = 0; b < nr_blocks; ++b)
+    {
+      const int begin = b * block_size;
+      const int n = std::min (nr_points - begin, static_cast<int> (block_size));
+      if (indices)
+        for (int k = 0; k < n; ++k)
+          points[k] = &cloud.points[(*indices)[begin + k]];
+      else
+        for (int k = 0; k < n; ++k)
+          points[k] = &cloud.points[begin + k];
+
+      evaluateBlock (points, n, &columns[0], &stack[0], &result[begin]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::detail::ConditionProgram<PointT>::evaluateBlock (
+    const PointT **points, int n, float *columns, float *stack, char *result) const
+{
+  // Gather the values of all the columns
+  for (size_t c = 0; c < columns_.size (); ++c)
+  {
+    float *values = columns + c * block_size;
+    const uint32_t offset = columns_[c].offset;
+    switch (columns_[c].type)
+    {
+      case INT8:
+        gatherFieldValues<int8_t> (points, n, offset, values);
+        break;
+      case UINT8:
+        gatherFieldValues<uint8_t> (points, n, offset, values);
+        break;
+      case INT16:
+        gatherFieldValues<int16_t> (points, n, offset, values);
+        break;
+      case UINT16:
+        gatherFieldValues<uint16_t> (points, n, offset, values);
+        break;
+      case FLOAT32:
+        gatherFieldValues<float> (points, n, offset, values);
+        break;
+      default:
+        for (int k = 0; k < n; ++k)
+        {
+          uint32_t rgb;
+          memcpy (&rgb, reinterpret_cast<const uint8_t*> (points[k]) + offset, sizeof (uint32_t));
+          int8_t h;
+          uint8_t s, i;
+          packedRGBToHSI (rgb, h, s, i);
+          values[k] = (columns_[c].type == HUE) ? h : (columns_[c].type == SATURATION) ? s : i;
+        }
+    }
+    // Pad the last lanes
+    for (int k = n; k < block_size; ++k)
+      values[k] = 0;
+  }
+
+  // Run the instructions on whole vectors of 4 values
+  const int padded_n = (n + 3) & ~3;
+  int top = 0;
+  for (size_t j = 0; j < instructions_.size (); ++j)
+  {
+    const Instruction &instruction = instructions_[j];
+    if (instruction.column >= 0)
+    {
+      compareBlock (columns + instruction.column * block_size, padded_n, instruction.op, instruction.value, 
+                    stack + top * block_size);
+      ++top;
+    }
+    else if (instruction.operands == 0)
+    {
+      fillBlock (stack + top * block_size, padded_n);
+      ++top;
+    }
+    else
+    {
+      top -= instruction.operands;
+      float *mask = stack + top * block_size;
+      for (int o = 1; o < instruction.operands; ++o)
+        combineBlock (mask, mask + o * block_size, padded_n, instruction.conjunction);
+      ++top;
+    }
+  }
+
+  // A well formed program leaves exactly one mask on the stack
+  if (top != 1)
+  {
+    memset (result, 0, n);
+    return;
+  }
+#ifdef __SSE__
+  for (int k = 0; k < n; k += 4)
+  {
+    int bits = _mm_movemask_ps (_mm_loadu_ps (stack + k));
+    for (int l = 0; l < 4 && k + l < n; ++l)
+      result[k + l] = static_cast<char> ((bits >> l) & 1);
+  }
+#else
+  for (int k = 0; k < n; ++k)
+    result[k] = (stack[k] != 0.0f);
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -551,6 +987,9 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
   int nr_p = 0;
   int nr_removed_p = 0;
 
+  std::vector<char> passed;
+  evaluateCondition (NULL, passed);
+
   if (!keep_organized_)
   {
     for (size_t cp = 0; cp < input_->points.size (); ++cp)
@@ -568,7 +1007,7 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
         continue;
       } 
 
-      if (condition_->evaluate (input_->points[cp]))
+      if (passed[cp])
       {
         pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointT, PointT> (input_->points[cp], output.points[nr_p]));
         nr_p++;
@@ -592,7 +1031,7 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
     {
       // copy all the fields
       pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointT, PointT> (input_->points[cp], output.points[cp]));
-      if (!condition_->evaluate (input_->points[cp]))
+      if (!passed[cp])
       {
         output.points[cp].getVector4fMap ().setConstant (user_filter_value_);
 
@@ -607,6 +1046,75 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
   removed_indices_->resize (nr_removed_p);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::ConditionalRemoval<PointT>::initPointTest ()
+{
+  if (!capable_)
+    PCL_WARN ("[pcl::%s::initPointTest] not capable!\n", getClassName ().c_str ());
+  else if (condition_.get () == NULL)
+    PCL_WARN ("[pcl::%s::initPointTest] No filtering condition given!\n", getClassName ().c_str ());
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::ConditionalRemoval<PointT>::testPoint (const PointT &point) const
+{
+  if (!capable_ || condition_.get () == NULL)
+    return (false);
+
+  // Check if the point is invalid
+  if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+    return (false);
+
+  return (condition_->evaluate (point));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionalRemoval<PointT>::applyFilter (std::vector<int> &indices)
+{
+  indices.resize (indices_->size ());
+  removed_indices_->resize (indices_->size ());
+  int nr_p = 0;
+  int nr_removed_p = 0;
+
+  initPointTest ();
+  std::vector<char> passed (indices_->size (), 0);
+  if (capable_ && condition_.get () != NULL)
+    evaluateCondition (indices_.get (), passed);
+
+  for (size_t cp = 0; cp < indices_->size (); ++cp)
+  {
+    const PointT &point = input_->points[(*indices_)[cp]];
+    if (passed[cp] && pcl_isfinite (point.x) && pcl_isfinite (point.y) && pcl_isfinite (point.z))
+      indices[nr_p++] = (*indices_)[cp];
+    else if (extract_removed_indices_)
+      (*removed_indices_)[nr_removed_p++] = (*indices_)[cp];
+  }
+  indices.resize (nr_p);
+  removed_indices_->resize (nr_removed_p);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionalRemoval<PointT>::evaluateCondition (const std::vector<int> *indices, std::vector<char> &passed)
+{
+  detail::ConditionProgram<PointT> program;
+  if (condition_->compile (program))
+  {
+    program.evaluate (*input_, indices, threads_, passed);
+    return;
+  }
+
+  // The condition cannot be compiled (e.g. user defined comparisons): evaluate it point by point
+  size_t nr_points = indices ? indices->size () : input_->points.size ();
+  passed.resize (nr_points);
+  for (size_t cp = 0; cp < nr_points; ++cp)
+    passed[cp] = condition_->evaluate (input_->points[indices ? (*indices)[cp] : cp]);
+}
+
 #define PCL_INSTANTIATE_PointDataAtOffset(T) template class PCL_EXPORTS pcl::PointDataAtOffset<T>;
 #define PCL_INSTANTIATE_ComparisonBase(T) template class PCL_EXPORTS pcl::ComparisonBase<T>;
 #define PCL_INSTANTIATE_FieldComparison(T) template class PCL_EXPORTS pcl::FieldComparison<T>;
@@ -43,6 +43,58 @@
 #include "pcl/filters/crop_box.h"
 
 
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::CropBox<PointT>::initPointTest ()
+{
+  inverse_transform_ = Eigen::Affine3f::Identity ();
+  if (rotation_ != Eigen::Vector3f::Zero ())
+  {
+    Eigen::Affine3f transform;
+    pcl::getTransformation (0, 0, 0,
+                            rotation_ (0), rotation_ (1), rotation_ (2),
+                            transform);
+    inverse_transform_ = transform.inverse ();
+  }
+  apply_transform_ = !(transform_.matrix ().isIdentity ());
+  apply_inverse_transform_ = !(inverse_transform_.matrix ().isIdentity ());
+  check_finite_ = !input_->is_dense;
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::CropBox<PointT>::testPoint (const PointT &point) const
+{
+  // Check if the point is invalid
+  if (check_finite_ && !isFinite (point))
+    return (false);
+
+  // Get local point
+  PointT local_pt = point;
+
+  // Transform point to world space
+  if (apply_transform_)
+    local_pt = pcl::transformPoint<PointT> (local_pt, transform_);
+
+  if (translation_ != Eigen::Vector3f::Zero ())
+  {
+    local_pt.x -= translation_ (0);
+    local_pt.y -= translation_ (1);
+    local_pt.z -= translation_ (2);
+  }
+
+  // Transform point to local space of crop box
+  if (apply_inverse_transform_)
+    local_pt = pcl::transformPoint<PointT> (local_pt, inverse_transform_);
+
+  if (local_pt.x < min_pt_[0] || local_pt.y < min_pt_[1] || local_pt.z < min_pt_[2])
+    return (false);
+  if (local_pt.x > max_pt_[0] || local_pt.y > max_pt_[1] || local_pt.z > max_pt_[2])
+    return (false);
+  return (true);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT>
 void
@@ -54,45 +106,10 @@ pcl::CropBox<PointT>::applyFilter (PointCloud &output)
   // We filter out invalid points
   output.is_dense = true;
 
-  Eigen::Affine3f transform = Eigen::Affine3f::Identity();
-  Eigen::Affine3f inverse_transform = Eigen::Affine3f::Identity();
-
-  if (rotation_ != Eigen::Vector3f::Zero ())
-  {
-    pcl::getTransformation (0, 0, 0,
-                            rotation_ (0), rotation_ (1), rotation_ (2),
-                            transform);
-    inverse_transform = transform.inverse ();
-  }
-
+  initPointTest ();
   for (size_t index = 0; index < indices_->size (); ++index)
   {
-    if (!input_->is_dense)
-      // Check if the point is invalid
-      if (!isFinite (input_->points[index]))
-        continue;
-
-    // Get local point
-    PointT local_pt = input_->points[(*indices_)[index]];
-
-    // Transform point to world space
-    if (!(transform_.matrix ().isIdentity ()))
-      local_pt = pcl::transformPoint<PointT> (local_pt, transform_);
-
-    if (translation_ != Eigen::Vector3f::Zero ())
-    {
-      local_pt.x -= translation_ (0);
-      local_pt.y -= translation_ (1);
-      local_pt.z -= translation_ (2);
-    }
-
-    // Transform point to local space of crop box
-    if (!(inverse_transform.matrix ().isIdentity ()))
-      local_pt = pcl::transformPoint<PointT> (local_pt, inverse_transform);
-
-    if (local_pt.x < min_pt_[0] || local_pt.y < min_pt_[1] || local_pt.z < min_pt_[2])
-      continue;
-    if (local_pt.x > max_pt_[0] || local_pt.y > max_pt_[1] || local_pt.z > max_pt_[2])
+    if (!testPoint (input_->points[(*indices_)[index]]))
       continue;
 
     output.points[indice_count++] = input_->points[(*indices_)[index]];
@@ -106,48 +123,13 @@ pcl::CropBox<PointT>::applyFilter (PointCloud &output)
 template<typename PointT> void
 pcl::CropBox<PointT>::applyFilter (std::vector<int> &indices)
 {
-  indices.resize (input_->points.size ());
+  indices.resize (indices_->size ());
   int indice_count = 0;
 
-  Eigen::Affine3f transform = Eigen::Affine3f::Identity ();
-  Eigen::Affine3f inverse_transform = Eigen::Affine3f::Identity ();
-
-  if (rotation_ != Eigen::Vector3f::Zero ())
-  {
-    pcl::getTransformation (0, 0, 0,
-                            rotation_ (0), rotation_ (1), rotation_ (2),
-                            transform);
-    inverse_transform = transform.inverse ();
-  }
-
+  initPointTest ();
   for (size_t index = 0; index < indices_->size (); ++index)
   {
-    if (!input_->is_dense)
-      // Check if the point is invalid
-      if (!isFinite (input_->points[index]))
-        continue;
-
-    // Get local point
-    PointT local_pt = input_->points[(*indices_)[index]];
-
-    // Transform point to world space
-    if (!(transform_.matrix ().isIdentity ()))
-      local_pt = pcl::transformPoint<PointT> (local_pt, transform_);
-
-    if (translation_ != Eigen::Vector3f::Zero ())
-    {
-      local_pt.x -= translation_ (0);
-      local_pt.y -= translation_ (1);
-      local_pt.z -= translation_ (2);
-    }
-
-    // Transform point to local space of crop box
-    if (!(inverse_transform.matrix ().isIdentity ()))
-      local_pt = pcl::transformPoint<PointT> (local_pt, inverse_transform);
-
-    if (local_pt.x < min_pt_[0] || local_pt.y < min_pt_[1] || local_pt.z < min_pt_[2])
-      continue;
-    if (local_pt.x > max_pt_[0] || local_pt.y > max_pt_[1] || local_pt.z > max_pt_[2])
+    if (!testPoint (input_->points[(*indices_)[index]]))
       continue;
 
     indices[indice_count++] = (*indices_)[index];
@@ -39,6 +39,8 @@
 #define PCL_FILTERS_IMPL_CROP_HULL_H_
 
 #include "pcl/filters/crop_hull.h"
+#include <algorithm>
+#include <limits>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
@@ -121,29 +123,14 @@ pcl::CropHull<PointT>::getHullCloudRange ()
 template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void 
 pcl::CropHull<PointT>::applyFilter2D (PointCloud &output)
 {
+  std::vector<char> inside;
+  testPoints2D<PlaneDim1,PlaneDim2> (inside);
+
+  // If we're removing points *inside* the hull, only keep points that
+  // haven't been found inside any polygons
   for (size_t index = 0; index < indices_->size (); index++)
-  {
-    // iterate over polygons faster than points because we expect this data
-    // to be, in general, more cache-local - the point cloud might be huge
-    size_t poly;
-    for (poly = 0; poly < hull_polygons_.size (); poly++)
-    {
-      if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (
-              input_->points[(*indices_)[index]], hull_polygons_[poly], *hull_cloud_
-         ))
-      {
-        if (crop_outside_)
-          output.push_back (input_->points[(*indices_)[index]]);
-        // once a point has tested +ve for being inside one polygon, we can
-        // stop checking the others:
-        break;
-      }
-    }
-    // If we're removing points *inside* the hull, only remove points that
-    // haven't been found inside any polygons
-    if (poly == hull_polygons_.size () && !crop_outside_)
+    if ((inside[index] != 0) == crop_outside_)
       output.push_back (input_->points[(*indices_)[index]]);
-  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -151,59 +138,24 @@ template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void
 pcl::CropHull<PointT>::applyFilter2D (std::vector<int> &indices)
 {
   // see comments in (PointCloud& output) overload
+  std::vector<char> inside;
+  testPoints2D<PlaneDim1,PlaneDim2> (inside);
+
   for (size_t index = 0; index < indices_->size (); index++)
-  {
-    size_t poly;
-    for (poly = 0; poly < hull_polygons_.size (); poly++)
-    {
-      if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (
-              input_->points[(*indices_)[index]], hull_polygons_[poly], *hull_cloud_
-         ))
-      {
-        if (crop_outside_)      
-          indices.push_back ((*indices_)[index]);
-        break;
-      }
-    }
-    if (poly == hull_polygons_.size () && !crop_outside_)
+    if ((inside[index] != 0) == crop_outside_)
       indices.push_back ((*indices_)[index]);
-  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void 
 pcl::CropHull<PointT>::applyFilter3D (PointCloud &output)
 {
-  // This algorithm could definitely be sped up using kdtree/octree
-  // information, if that is available!
+  std::vector<char> inside;
+  testPoints3D (inside);
 
   for (size_t index = 0; index < indices_->size (); index++)
-  {
-    // test ray-crossings for three random rays, and take vote of crossings
-    // counts to determine if each point is inside the hull: the vote avoids
-    // tricky edge and corner cases when rays might fluke through the edge
-    // between two polygons
-    // 'random' rays are arbitrary - basically anything that is less likely to
-    // hit the edge between polygons than coordinate-axis aligned rays would
-    // be.
-    size_t crossings[3] = {0,0,0};
-    Eigen::Vector3f rays[3] = 
-    {
-      Eigen::Vector3f (0.264882,  0.688399, 0.675237),
-      Eigen::Vector3f (0.0145419, 0.732901, 0.68018),
-      Eigen::Vector3f (0.856514,  0.508771, 0.0868081)
-    };
-
-    for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
-      for (size_t ray = 0; ray < 3; ray++)
-        crossings[ray] += rayTriangleIntersect
-          (input_->points[(*indices_)[index]], rays[ray], hull_polygons_[poly], *hull_cloud_);
-
-    if (crop_outside_ && (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1)
+    if ((inside[index] != 0) == crop_outside_)
       output.push_back (input_->points[(*indices_)[index]]);
-    else if (!crop_outside_)
-      output.push_back (input_->points[(*indices_)[index]]);
-  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -211,76 +163,326 @@ template<typename PointT> void
 pcl::CropHull<PointT>::applyFilter3D (std::vector<int> &indices)
 {
   // see comments in applyFilter3D (PointCloud& output)
+  std::vector<char> inside;
+  testPoints3D (inside);
+
   for (size_t index = 0; index < indices_->size (); index++)
+    if ((inside[index] != 0) == crop_outside_)
+      indices.push_back ((*indices_)[index]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void
+pcl::CropHull<PointT>::buildEdgeGrid ()
+{
+  const PointCloud &cloud = *hull_cloud_;
+  edges_.clear ();
+  double x_min = std::numeric_limits<double>::max (), x_max = -std::numeric_limits<double>::max ();
+  for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
+  {
+    const std::vector<uint32_t> &vertices = hull_polygons_[poly].vertices;
+    const int nr_poly_points = static_cast<int> (vertices.size ());
+    if (nr_poly_points == 0)
+      continue;
+
+    double xold = cloud[vertices[nr_poly_points - 1]].getVector3fMap ()[PlaneDim1];
+    double yold = cloud[vertices[nr_poly_points - 1]].getVector3fMap ()[PlaneDim2];
+    for (int i = 0; i < nr_poly_points; i++)
+    {
+      const double xnew = cloud[vertices[i]].getVector3fMap ()[PlaneDim1];
+      const double ynew = cloud[vertices[i]].getVector3fMap ()[PlaneDim2];
+      detail::CropHullEdge edge;
+      edge.xold = xold;
+      edge.xnew = xnew;
+      if (xnew > xold)
+      {
+        edge.x1 = xold;
+        edge.x2 = xnew;
+        edge.y1 = yold;
+        edge.y2 = ynew;
+      }
+      else
+      {
+        edge.x1 = xnew;
+        edge.x2 = xold;
+        edge.y1 = ynew;
+        edge.y2 = yold;
+      }
+      edge.polygon = static_cast<int> (poly);
+      edges_.push_back (edge);
+      x_min = std::min (x_min, edge.x1);
+      x_max = std::max (x_max, edge.x2);
+      xold = xnew;
+      yold = ynew;
+    }
+  }
+
+  // Slabs along PlaneDim1, about one per edge
+  const int nr_slabs = static_cast<int> (std::max<size_t> (1, std::min<size_t> (edges_.size (), 65536)));
+  slab_min_ = edges_.empty () ? 0.0 : x_min;
+  slab_inverse_size_ = (x_max > x_min) ? nr_slabs / (x_max - x_min) : 0.0;
+
+  // Register each edge in all the slabs it overlaps, in polygon order (counting sort)
+  std::vector<std::pair<int, int> > slab_ranges (edges_.size ());
+  slab_begin_.assign (nr_slabs + 1, 0);
+  for (size_t e = 0; e < edges_.size (); ++e)
+  {
+    slab_ranges[e].first = std::min (static_cast<int> (floor ((edges_[e].x1 - slab_min_) * slab_inverse_size_)), nr_slabs - 1);
+    slab_ranges[e].second = std::min (static_cast<int> (floor ((edges_[e].x2 - slab_min_) * slab_inverse_size_)), nr_slabs - 1);
+    for (int slab = slab_ranges[e].first; slab <= slab_ranges[e].second; ++slab)
+      slab_begin_[slab + 1]++;
+  }
+  for (int slab = 0; slab < nr_slabs; ++slab)
+    slab_begin_[slab + 1] += slab_begin_[slab];
+  slab_edges_.resize (slab_begin_[nr_slabs]);
+  std::vector<int> slab_fill (slab_begin_.begin (), slab_begin_.end () - 1);
+  for (size_t e = 0; e < edges_.size (); ++e)
+    for (int slab = slab_ranges[e].first; slab <= slab_ranges[e].second; ++slab)
+      slab_edges_[slab_fill[slab]++] = static_cast<int> (e);
+
+  edge_grid_dims_ = std::make_pair (static_cast<int> (PlaneDim1), static_cast<int> (PlaneDim2));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void
+pcl::CropHull<PointT>::testPoints2D (std::vector<char> &inside)
+{
+  if (edge_grid_dims_ != std::make_pair (static_cast<int> (PlaneDim1), static_cast<int> (PlaneDim2)))
+    buildEdgeGrid<PlaneDim1,PlaneDim2> ();
+
+  const int nr_slabs = static_cast<int> (slab_begin_.size ()) - 1;
+  inside.resize (indices_->size ());
+
+#pragma omp parallel for schedule (dynamic, 1024) num_threads (threads_)
+  for (int index = 0; index < static_cast<int> (indices_->size ()); index++)
   {
-    size_t crossings[3] = {0,0,0};
-    Eigen::Vector3f rays[3] = 
+    inside[index] = 0;
+    const float px = input_->points[(*indices_)[index]].getVector3fMap ()[PlaneDim1];
+    const float py = input_->points[(*indices_)[index]].getVector3fMap ()[PlaneDim2];
+
+    // Only the edges of the slab of the point can cross the ray cast along PlaneDim2
+    const double slab_position = floor ((px - slab_min_) * slab_inverse_size_);
+    if (!(slab_position >= 0 && slab_position <= nr_slabs))
+      continue;
+    const int slab = std::min (static_cast<int> (slab_position), nr_slabs - 1);
+
+    // The edges are sorted by polygon: count the crossings of each polygon in turn, until one contains the point
+    bool in_poly = false;
+    int polygon = -1;
+    for (int e = slab_begin_[slab]; e < slab_begin_[slab + 1]; ++e)
     {
-      Eigen::Vector3f(0.264882,  0.688399, 0.675237),
-      Eigen::Vector3f(0.0145419, 0.732901, 0.68018),
-      Eigen::Vector3f(0.856514,  0.508771, 0.0868081)
+      const detail::CropHullEdge &edge = edges_[slab_edges_[e]];
+      if (edge.polygon != polygon)
+      {
+        if (in_poly)
+          break;
+        polygon = edge.polygon;
+      }
+      if ((edge.xnew < px) == (px <= edge.xold) &&
+          (py - edge.y1) * (edge.x2 - edge.x1) < (edge.y2 - edge.y1) * (px - edge.x1))
+      {
+        in_poly = !in_poly;
+      }
+    }
+    inside[index] = in_poly;
+  }
+}
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Compare the centroids of two triangles along an axis. */
+    struct CropHullTriangleCompare
+    {
+      CropHullTriangleCompare (int axis) : axis_ (axis) {}
+
+      inline bool
+      operator () (const CropHullTriangle &t1, const CropHullTriangle &t2) const
+      {
+        return (3 * t1.a[axis_] + t1.u[axis_] + t1.v[axis_] < 3 * t2.a[axis_] + t2.u[axis_] + t2.v[axis_]);
+      }
+
+      int axis_;
     };
 
-    for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
-      for (size_t ray = 0; ray < 3; ray++)
-        crossings[ray] += rayTriangleIntersect
-          (input_->points[(*indices_)[index]], rays[ray], hull_polygons_[poly], *hull_cloud_);
+    /** \brief Build the node of a bounding volume hierarchy over a range of triangles, and its children.
+      * \param[in,out] triangles the triangles, reordered so that each node covers a contiguous range
+      * \param[in] begin the first triangle of the node
+      * \param[in] end the triangle after the last one of the node
+      * \param[in] padding the margin added to the bounding boxes, to absorb rounding errors
+      * \param[out] nodes the nodes of the hierarchy
+      * \return the index of the node
+      */
+    inline int
+    buildCropHullBVH (std::vector<CropHullTriangle> &triangles, int begin, int end, float padding, 
+                      std::vector<CropHullBVHNode> &nodes)
+    {
+      const int index = static_cast<int> (nodes.size ());
+      nodes.push_back (CropHullBVHNode ());
 
-    if (crop_outside_ && (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1)
-      indices.push_back ((*indices_)[index]);
-    else if (!crop_outside_)
-      indices.push_back ((*indices_)[index]);
+      Eigen::Vector3f min_pt = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+      Eigen::Vector3f max_pt = -min_pt;
+      Eigen::Vector3f centroid_min = min_pt, centroid_max = max_pt;
+      for (int t = begin; t < end; ++t)
+      {
+        const Eigen::Vector3f b = triangles[t].a + triangles[t].u, c = triangles[t].a + triangles[t].v;
+        min_pt = min_pt.cwiseMin (triangles[t].a).cwiseMin (b).cwiseMin (c);
+        max_pt = max_pt.cwiseMax (triangles[t].a).cwiseMax (b).cwiseMax (c);
+        const Eigen::Vector3f centroid = 3 * triangles[t].a + triangles[t].u + triangles[t].v;
+        centroid_min = centroid_min.cwiseMin (centroid);
+        centroid_max = centroid_max.cwiseMax (centroid);
+      }
+      nodes[index].min_pt = min_pt - Eigen::Vector3f::Constant (padding);
+      nodes[index].max_pt = max_pt + Eigen::Vector3f::Constant (padding);
+      nodes[index].begin = begin;
+      nodes[index].end = end;
+      nodes[index].second_child = -1;
+      if (end - begin <= 4)
+        return (index);
+
+      // Split at the median centroid along the axis of largest spread
+      Eigen::Vector3f::Index axis;
+      (centroid_max - centroid_min).maxCoeff (&axis);
+      const int middle = (begin + end) / 2;
+      std::nth_element (triangles.begin () + begin, triangles.begin () + middle, triangles.begin () + end, 
+                        CropHullTriangleCompare (static_cast<int> (axis)));
+      buildCropHullBVH (triangles, begin, middle, padding, nodes);
+      const int second_child = buildCropHullBVH (triangles, middle, end, padding, nodes);
+      nodes[index].second_child = second_child;
+      return (index);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::CropHull<PointT>::buildBVH ()
+{
+  const PointCloud &cloud = *hull_cloud_;
+  triangles_.clear ();
+  bvh_.clear ();
+  float scale = 0;
+  for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
+  {
+    const std::vector<uint32_t> &vertices = hull_polygons_[poly].vertices;
+    if (vertices.size () != 3)
+    {
+      PCL_WARN ("[pcl::%s::buildBVH] Polygon %d is not a triangle, ignoring it.\n", filter_name_.c_str (), static_cast<int> (poly));
+      continue;
+    }
+    detail::CropHullTriangle triangle;
+    triangle.a = cloud[vertices[0]].getVector3fMap ();
+    triangle.u = cloud[vertices[1]].getVector3fMap () - triangle.a;
+    triangle.v = cloud[vertices[2]].getVector3fMap () - triangle.a;
+    triangle.n = triangle.u.cross (triangle.v);
+    triangle.uu = triangle.u.dot (triangle.u);
+    triangle.uv = triangle.u.dot (triangle.v);
+    triangle.vv = triangle.v.dot (triangle.v);
+    triangle.denominator = triangle.uv * triangle.uv - triangle.uu * triangle.vv;
+    triangles_.push_back (triangle);
+    scale = std::max (scale, triangle.a.cwiseAbs ().maxCoeff ());
   }
+  if (triangles_.empty ())
+    return;
+
+  bvh_.reserve (2 * triangles_.size ());
+  detail::buildCropHullBVH (triangles_, 0, static_cast<int> (triangles_.size ()), 1e-4f * scale + 1e-6f, bvh_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> bool
-pcl::CropHull<PointT>::isPointIn2DPolyWithVertIndices (
-  const PointT& point, const Vertices& verts, const PointCloud& cloud)
+template<typename PointT> int
+pcl::CropHull<PointT>::countCrossings (const Eigen::Vector3f& point,
+                                       const Eigen::Vector3f& ray,
+                                       const Eigen::Vector3f& inverse_ray) const
 {
-  bool in_poly = false;
-  double x1, x2, y1, y2;
+  if (bvh_.empty ())
+    return (0);
 
-  const int nr_poly_points = verts.vertices.size ();
-  double xold = cloud[verts.vertices[nr_poly_points - 1]].getVector3fMap ()[PlaneDim1];
-  double yold = cloud[verts.vertices[nr_poly_points - 1]].getVector3fMap ()[PlaneDim2];
-  for (int i = 0; i < nr_poly_points; i++)
+  int crossings = 0;
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0)
   {
-    const double xnew = cloud[verts.vertices[i]].getVector3fMap ()[PlaneDim1];
-    const double ynew = cloud[verts.vertices[i]].getVector3fMap ()[PlaneDim2];
-    if (xnew > xold)
+    const int index = stack[--top];
+    const detail::CropHullBVHNode &node = bvh_[index];
+
+    // Does the ray hit the bounding box of the node?
+    float t_min = 0, t_max = std::numeric_limits<float>::max ();
+    for (int d = 0; d < 3 && t_min <= t_max; ++d)
+    {
+      float t1 = (node.min_pt[d] - point[d]) * inverse_ray[d];
+      float t2 = (node.max_pt[d] - point[d]) * inverse_ray[d];
+      if (t1 > t2)
+        std::swap (t1, t2);
+      t_min = std::max (t_min, t1);
+      t_max = std::min (t_max, t2);
+    }
+    if (t_min > t_max)
+      continue;
+
+    if (node.second_child < 0)
     {
-      x1 = xold;
-      x2 = xnew;
-      y1 = yold;
-      y2 = ynew;
+      for (int t = node.begin; t < node.end; ++t)
+        crossings += rayTriangleIntersect (point, ray, triangles_[t]);
     }
     else
     {
-      x1 = xnew;
-      x2 = xold;
-      y1 = ynew;
-      y2 = yold;
+      stack[top++] = node.second_child;
+      stack[top++] = index + 1;
     }
+  }
+  return (crossings);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::CropHull<PointT>::testPoints3D (std::vector<char> &inside)
+{
+  if (bvh_.empty ())
+    buildBVH ();
 
-    if ((xnew < point.getVector3fMap ()[PlaneDim1]) == (point.getVector3fMap ()[PlaneDim1] <= xold) &&
-        (point.getVector3fMap ()[PlaneDim2] - y1) * (x2 - x1) < (y2 - y1) * (point.getVector3fMap ()[PlaneDim1] - x1))
+  // test ray-crossings for three random rays, and take vote of crossings
+  // counts to determine if each point is inside the hull: the vote avoids
+  // tricky edge and corner cases when rays might fluke through the edge
+  // between two polygons
+  // 'random' rays are arbitrary - basically anything that is less likely to
+  // hit the edge between polygons than coordinate-axis aligned rays would
+  // be.
+  const Eigen::Vector3f rays[3] = 
+  {
+    Eigen::Vector3f (0.264882,  0.688399, 0.675237),
+    Eigen::Vector3f (0.0145419, 0.732901, 0.68018),
+    Eigen::Vector3f (0.856514,  0.508771, 0.0868081)
+  };
+  const Eigen::Vector3f inverse_rays[3] = 
+  {
+    rays[0].cwiseInverse (), rays[1].cwiseInverse (), rays[2].cwiseInverse ()
+  };
+
+  inside.resize (indices_->size ());
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int index = 0; index < static_cast<int> (indices_->size ()); index++)
+  {
+    const Eigen::Vector3f point = input_->points[(*indices_)[index]].getVector3fMap ();
+    if (!pcl_isfinite (point[0]) || !pcl_isfinite (point[1]) || !pcl_isfinite (point[2]))
     {
-      in_poly = !in_poly;
+      inside[index] = 0;
+      continue;
     }
-    xold = xnew;
-    yold = ynew;
+    int votes = 0;
+    for (int ray = 0; ray < 3; ray++)
+      votes += countCrossings (point, rays[ray], inverse_rays[ray]) & 1;
+    inside[index] = (votes > 1);
   }
-
-  return (in_poly);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> bool
-pcl::CropHull<PointT>::rayTriangleIntersect (const PointT& point,
+pcl::CropHull<PointT>::rayTriangleIntersect (const Eigen::Vector3f& point,
                                              const Eigen::Vector3f& ray,
-                                             const Vertices& verts,
-                                             const PointCloud& cloud)
+                                             const detail::CropHullTriangle& triangle)
 {
   // Algorithm here is adapted from:
   // http://softsurfer.com/Archive/algorithm_0105/algorithm_0105.htm#intersect_RayTriangle()
@@ -290,34 +492,24 @@ pcl::CropHull<PointT>::rayTriangleIntersect (const PointT& point,
   // This code may be freely used and modified for any purpose
   // providing that this copyright notice is included with it.
   //
-  assert (verts.vertices.size () == 3);
-
-  const Eigen::Vector3f p = point.getVector3fMap ();
-  const Eigen::Vector3f a = cloud[verts.vertices[0]].getVector3fMap ();
-  const Eigen::Vector3f b = cloud[verts.vertices[1]].getVector3fMap ();
-  const Eigen::Vector3f c = cloud[verts.vertices[2]].getVector3fMap ();
-  const Eigen::Vector3f u = b - a;
-  const Eigen::Vector3f v = c - a;
-  const Eigen::Vector3f n = u.cross (v);
-  const float n_dot_ray = n.dot (ray);
+  const float n_dot_ray = triangle.n.dot (ray);
 
   if (std::fabs (n_dot_ray) < 1e-9)
     return (false);
 
-  const float r = n.dot (a - p) / n_dot_ray;
+  const float r = triangle.n.dot (triangle.a - point) / n_dot_ray;
 
   if (r < 0)
     return (false);
 
-  const Eigen::Vector3f w = p + r * ray - a;
-  const float denominator = u.dot (v) * u.dot (v) - u.dot (u) * v.dot (v);
-  const float s_numerator = u.dot (v) * w.dot (v) - v.dot (v) * w.dot (u);
-  const float s = s_numerator / denominator;
+  const Eigen::Vector3f w = point + r * ray - triangle.a;
+  const float s_numerator = triangle.uv * w.dot (triangle.v) - triangle.vv * w.dot (triangle.u);
+  const float s = s_numerator / triangle.denominator;
   if (s < 0 || s > 1)
     return (false);
 
-  const float t_numerator = u.dot (v) * w.dot (u) - u.dot (u) * w.dot (v);
-  const float t = t_numerator / denominator;
+  const float t_numerator = triangle.uv * w.dot (triangle.u) - triangle.uu * w.dot (triangle.v);
+  const float t = t_numerator / triangle.denominator;
   if (t < 0 || s+t > 1)
     return (false);
   
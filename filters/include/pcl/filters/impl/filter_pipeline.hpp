@@ -0,0 +1,145 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_FILTER_PIPELINE_H_
+#define PCL_FILTERS_IMPL_FILTER_PIPELINE_H_
+
+#include "pcl/filters/filter_pipeline.h"
+#include "pcl/common/io.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::FilterPipeline<PointT>::initPointTest ()
+{
+  for (size_t f = 0; f < filters_.size (); ++f)
+  {
+    filters_[f]->setInputCloud (input_);
+    if (!filters_[f]->initPointTest ())
+      return (false);
+  }
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::FilterPipeline<PointT>::testPoint (const PointT &point) const
+{
+  for (size_t f = 0; f < filters_.size (); ++f)
+    if (!filters_[f]->testPoint (point))
+      return (false);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FilterPipeline<PointT>::applyFilter (std::vector<int> &indices)
+{
+  indices = *indices_;
+
+  size_t first = 0;
+  while (first < filters_.size ())
+  {
+    // Find the consecutive stages which can be fused with this one
+    size_t last = first;
+    for (; last < filters_.size (); ++last)
+    {
+      filters_[last]->setInputCloud (input_);
+      if (!filters_[last]->initPointTest ())
+        break;
+    }
+
+    if (last > first)
+    {
+      // Single pass over the surviving points, compacting the indices in place
+      size_t nr_p = 0;
+      for (size_t i = 0; i < indices.size (); ++i)
+      {
+        const PointT &point = input_->points[indices[i]];
+        size_t f = first;
+        while (f < last && filters_[f]->testPoint (point))
+          ++f;
+        if (f == last)
+          indices[nr_p++] = indices[i];
+      }
+      indices.resize (nr_p);
+      first = last;
+    }
+    else
+    {
+      // The stage needs the whole set of surviving points
+      IndicesPtr survivors (new std::vector<int>);
+      survivors->swap (indices);
+      filters_[first]->setIndices (survivors);
+      filters_[first]->filter (indices);
+      ++first;
+    }
+  }
+
+  if (extract_removed_indices_)
+  {
+    std::vector<bool> kept (input_->points.size (), false);
+    for (size_t i = 0; i < indices.size (); ++i)
+      kept[indices[i]] = true;
+    removed_indices_->clear ();
+    for (size_t i = 0; i < indices_->size (); ++i)
+      if (!kept[(*indices_)[i]])
+        removed_indices_->push_back ((*indices_)[i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FilterPipeline<PointT>::applyFilter (PointCloud &output)
+{
+  IndicesPtr survivors (new std::vector<int>);
+  applyFilter (*survivors);
+
+  if (!reducer_)
+  {
+    pcl::copyPointCloud (*input_, *survivors, output);
+    return;
+  }
+
+  // The reducer reads the surviving points straight from the input
+  reducer_->setInputCloud (input_);
+  reducer_->setIndices (survivors);
+  reducer_->filter (output);
+}
+
+#define PCL_INSTANTIATE_FilterPipeline(T) template class PCL_EXPORTS pcl::FilterPipeline<T>;
+
+#endif    // PCL_FILTERS_IMPL_FILTER_PIPELINE_H_
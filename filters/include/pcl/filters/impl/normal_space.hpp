@@ -41,7 +41,6 @@
 #include "pcl/filters/normal_space.h"
 
 #include <vector>
-#include <list>
 
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename NormalT> void
@@ -49,171 +48,40 @@ pcl::NormalSpaceSampling<PointT, NormalT>::applyFilter (PointCloud &output)
 {
   // If sample size is 0 or if the sample size is greater then input cloud size
   //   then return entire copy of cloud
-  if (sample_ >= input_->size ())
+  if (sample_ >= indices_->size ())
   {
     output = *input_;
     return;
   }
 
+  std::vector<int> indices;
+  applyFilter (indices);
+
   // Resize output cloud to sample size
-  output.points.resize (sample_);
-  output.width = sample_;
+  output.points.resize (indices.size ());
+  output.width = static_cast<uint32_t> (indices.size ());
   output.height = 1;
-  
-  // allocate memory for the histogram of normals.. Normals will then be sampled from each bin..
-  unsigned int n_bins = binsx_ * binsy_ * binsz_;
-  // list<int> holds the indices of points in that bin.. Using list to avoid repeated resizing of vectors.. Helps when the point cloud is
-  // large..
-  std::vector< std::list <int> > normals_hg;
-  normals_hg.reserve (n_bins);
-  for (unsigned int i = 0; i < n_bins; i++) 
-    normals_hg.push_back (std::list<int> ());
-  
-  for (unsigned int i = 0; i < input_normals_->points.size (); i++)
-  {
-    unsigned int bin_number = findBin (input_normals_->points[i].normal, n_bins);
-    normals_hg[bin_number].push_back (i);
-  }
-
-  // Setting up random access for the list created above.. Maintaining the iterators to individual elements of the list in a vector.. Using
-  // vector now as the size of the list is known..
-  std::vector< std::vector <std::list<int>::iterator> > random_access (normals_hg.size ());
-  for (unsigned int i = 0; i < normals_hg.size (); i++)
-  {
-    random_access.push_back (std::vector< std::list<int>::iterator> ());
-    random_access[i].resize (normals_hg[i].size ());
-
-    unsigned int j=0;
-    for (std::list<int>::iterator itr = normals_hg[i].begin (); itr != normals_hg[i].end (); itr++, j++)
-    {
-      random_access[i][j] = itr;
-    }
-  }
-  unsigned int* start_index = new unsigned int[normals_hg.size ()];
-  start_index[0] = 0;
-  unsigned int prev_index = start_index[0];
-  for (unsigned int i = 1; i < normals_hg.size (); i++)
-  {
-    start_index[i] = prev_index + normals_hg[i-1].size ();
-    prev_index = start_index[i];
-  }
-
-  // maintaining flags to check if a point is sampled
-  boost::dynamic_bitset<> is_sampled_flag (input_normals_->points.size ());
-  // maintaining flags to check if all points in the bin are sampled 
-  boost::dynamic_bitset<> bin_empty_flag (normals_hg.size ());
-  unsigned int i = 0;
-  while (i < sample_)
-  {
-    // iterating through every bin and picking one point at random, until the required number of points are sampled..
-    for (unsigned int j = 0; j < normals_hg.size (); j++)
-    {
-      unsigned int M = normals_hg[j].size ();
-      if (M == 0 || bin_empty_flag.test (j))// bin_empty_flag(i) is set if all points in that bin are sampled..
-      {
-        continue;
-      }
-  
-      unsigned int pos = 0;
-      unsigned int random_index = 0;
-      //picking up a sample at random from jth bin
-      do
-      {
-        random_index = std::rand () % M;
-        pos = start_index[j] + random_index;
-      } while (is_sampled_flag.test (pos));
-
-      is_sampled_flag.flip (start_index[j] + random_index);
-
-      // checking if all points in bin j are sampled..
-      if (isEntireBinSampled (is_sampled_flag, start_index[j], normals_hg[j].size ()))
-      {
-        bin_empty_flag.flip (j);
-      }
-
-      unsigned int index = *(random_access[j][random_index]);
-      output.points[i] = input_->points[index];
-      i++;
-      if (i == sample_)
-      {
-        break;
-      }
-    }
-  }
-  delete[] start_index;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename NormalT> bool 
-pcl::NormalSpaceSampling<PointT, NormalT>::isEntireBinSampled (boost::dynamic_bitset<> &array, unsigned int start_index, unsigned int length)
-{
-  bool status = true;
-  for (unsigned int i = start_index; i < start_index + length; i++)
-  {
-    status = status & array.test (i);
-  }
-  return status;
+  for (size_t i = 0; i < indices.size (); ++i)
+    output.points[i] = input_->points[indices[i]];
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename NormalT> unsigned int 
-pcl::NormalSpaceSampling<PointT, NormalT>::findBin (float *normal, unsigned int nbins)
+pcl::NormalSpaceSampling<PointT, NormalT>::findBin (const float *normal) const
 {
-  unsigned int bin_number = 0;
-  // holds the bin numbers for direction cosines in x,y,z directions
-  unsigned int t[3] = {0,0,0};
-  
-  // dcos is the direction cosine.
-  float dcos = 0.0;
-  float bin_size = 0.0;
-  // max_cos and min_cos are the maximum and minimum values of cos(theta) respectively
-  float max_cos = 1.0;
-  float min_cos = -1.0;
-
-  dcos = cos(normal[0]);
-  bin_size = (max_cos - min_cos) / binsx_;
-
-  // finding bin number for direction cosine in x direction
-  unsigned int k = 0;
-  for (float i = min_cos; (i + bin_size) < (max_cos - bin_size); i += bin_size , k++)
-  {
-    if (dcos >= i && dcos <= (i+bin_size))
-    {
-      break;
-    }
-  }
-  t[0] = k;
-
-  dcos = cos(normal[1]);
-  bin_size = (max_cos - min_cos) / binsy_;
-
-  // finding bin number for direction cosine in y direction
-  k = 0;
-  for (float i = min_cos; (i + bin_size) < (max_cos - bin_size); i += bin_size , k++)
-  {
-    if (dcos >= i && dcos <= (i+bin_size))
-    {
-      break;
-    }
-  }
-  t[1] = k;
-    
-  dcos = cos(normal[2]);
-  bin_size = (max_cos - min_cos) / binsz_;
-
-  // finding bin number for direction cosine in z direction
-  k = 0;
-  for (float i = min_cos; (i + bin_size) < (max_cos - bin_size); i += bin_size , k++)
+  // The components of a unit normal are its direction cosines, so each of them is split uniformly over [-1, 1].
+  // Values on or beyond the upper edge go to the last bin, values below the lower edge (and NaN) to the first one
+  const unsigned int bins[3] = {binsx_, binsy_, binsz_};
+  unsigned int t[3] = {0, 0, 0};
+  for (int d = 0; d < 3; ++d)
   {
-    if (dcos >= i && dcos <= (i+bin_size))
-    {
-      break;
-    }
+    float pos = (normal[d] + 1.0f) * 0.5f * static_cast<float> (bins[d]);
+    if (pos >= static_cast<float> (bins[d]))
+      t[d] = bins[d] - 1;
+    else if (pos > 0.0f)
+      t[d] = static_cast<unsigned int> (pos);
   }
-  t[2] = k;
-
-  bin_number = t[0] * (binsy_*binsz_) + t[1] * binsz_ + t[2];
-  return bin_number;
+  return (t[0] * (binsy_ * binsz_) + t[1] * binsz_ + t[2]);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -223,97 +91,80 @@ pcl::NormalSpaceSampling<PointT, NormalT>::applyFilter (std::vector<int> &indice
 {
   // If sample size is 0 or if the sample size is greater then input cloud size
   //   then return all indices
-  if (sample_ >= input_->width * input_->height)
+  if (sample_ >= indices_->size ())
   {
     indices = *indices_;
     return;
   }
 
-  // Resize output indices to sample size
-  indices.resize (sample_);
-  
-  // allocate memory for the histogram of normals.. Normals will then be sampled from each bin..
+  indices.clear ();
   unsigned int n_bins = binsx_ * binsy_ * binsz_;
-  // list<int> holds the indices of points in that bin.. Using list to avoid repeated resizing of vectors.. Helps when the point cloud is
-  // large..
-  std::vector< std::list <int> > normals_hg;
-  normals_hg.reserve (n_bins);
-  for (unsigned int i = 0; i < n_bins; i++)
-    normals_hg.push_back (std::list<int> ());
-  
-  for (unsigned int i=0; i < input_normals_->points.size (); i++)
+  if (n_bins == 0)
   {
-    unsigned int bin_number = findBin (input_normals_->points[i].normal, n_bins);
-    normals_hg[bin_number].push_back (i);
+    PCL_ERROR ("[pcl::%s::applyFilter] The number of bins must be set to a non-zero value in every direction!\n", getClassName ().c_str ());
+    return;
   }
-
-  // Setting up random access for the list created above.. Maintaining the iterators to individual elements of the list in a vector.. Using
-  // vector now as the size of the list is known..
-  std::vector< std::vector <std::list<int>::iterator> > random_access (normals_hg.size ());
-  for (unsigned int i = 0; i < normals_hg.size (); i++)
+  if (!input_normals_ || input_normals_->points.size () != input_->points.size ())
   {
-    random_access.push_back (std::vector<std::list<int>::iterator> ());
-    random_access[i].resize (normals_hg[i].size ());
-
-    unsigned int j = 0;
-    for (std::list<int>::iterator itr = normals_hg[i].begin (); itr != normals_hg[i].end (); itr++, j++)
-    {
-      random_access[i][j] = itr;
-    }
+    PCL_ERROR ("[pcl::%s::applyFilter] The normals given do not match the input cloud!\n", getClassName ().c_str ());
+    return;
   }
-  unsigned int* start_index = new unsigned int[normals_hg.size ()];
-  start_index[0] = 0;
-  unsigned int prev_index = start_index[0];
-  for (unsigned int i = 1; i < normals_hg.size (); i++)
+
+  // Bin every index. This is the only part that touches the normals, so it is the one that runs in parallel
+  int nr_indices = static_cast<int> (indices_->size ());
+  std::vector<unsigned int> bin_of (nr_indices);
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int i = 0; i < nr_indices; ++i)
+    bin_of[i] = findBin (input_normals_->points[(*indices_)[i]].normal);
+
+  // Counting sort of the indices by bin, so that bin j occupies [start[j], start[j + 1]) of sorted
+  std::vector<unsigned int> start (n_bins + 1, 0);
+  for (int i = 0; i < nr_indices; ++i)
+    ++start[bin_of[i] + 1];
+  for (unsigned int j = 0; j < n_bins; ++j)
+    start[j + 1] += start[j];
+  std::vector<int> sorted (nr_indices);
+  std::vector<unsigned int> fill (start.begin (), start.end () - 1);
+  for (int i = 0; i < nr_indices; ++i)
+    sorted[fill[bin_of[i]]++] = (*indices_)[i];
+
+  // Only the non-empty bins take part in the draw; remaining[j] counts the points of bin j not yet sampled
+  std::vector<unsigned int> active;
+  std::vector<unsigned int> remaining (n_bins);
+  for (unsigned int j = 0; j < n_bins; ++j)
   {
-    start_index[i] = prev_index + normals_hg[i-1].size ();
-    prev_index = start_index[i];
+    remaining[j] = start[j + 1] - start[j];
+    if (remaining[j] > 0)
+      active.push_back (j);
   }
 
-  // maintaining flags to check if a point is sampled
-  boost::dynamic_bitset<> is_sampled_flag (input_normals_->points.size ());
-  // maintaining flags to check if all points in the bin are sampled 
-  boost::dynamic_bitset<> bin_empty_flag (normals_hg.size ());
-  unsigned int i=0;
+  // Set random seed so derived indices are the same each time the filter runs
+  std::srand (seed_);
+
+  // Pick one point at random from every bin in turn until the required number of points is sampled. The picked
+  // point is swapped behind the unsampled part of its bin, and bins are dropped from the rotation once exhausted
+  indices.resize (sample_);
+  unsigned int i = 0;
   while (i < sample_)
   {
-    // iterating through every bin and picking one point at random, until the required number of points are sampled..
-    for (unsigned int j = 0; j < normals_hg.size (); j++)
+    size_t kept = 0;
+    for (size_t a = 0; a < active.size (); ++a)
     {
-      unsigned int M = normals_hg[j].size();
-      if (M==0 || bin_empty_flag.test (j)) // bin_empty_flag(i) is set if all points in that bin are sampled..
-      {
-        continue;
-      }
-
-      unsigned int pos = 0;
-      unsigned int random_index = 0;
-
-      //picking up a sample at random from jth bin
-      do
-      {
-        random_index = std::rand () % M;
-        pos = start_index[j] + random_index;
-      } while (is_sampled_flag.test (pos));
-
-      is_sampled_flag.flip (start_index[j] + random_index);
-
-      // checking if all points in bin j are sampled..
-      if (isEntireBinSampled (is_sampled_flag, start_index[j], normals_hg[j].size ())) 
-      {
-	bin_empty_flag.flip (j);
-      }
-
-      unsigned int index = *(random_access[j][random_index]);
-      indices[i] = index;
-      i++;
-      if (i == sample_)
+      unsigned int j = active[a];
+      if (i < sample_)
       {
-        break;
+        unsigned int first = start[j];
+        unsigned int last = first + remaining[j] - 1;
+        unsigned int pick = first + std::rand () % remaining[j];
+        indices[i++] = sorted[pick];
+        std::swap (sorted[pick], sorted[last]);
+        --remaining[j];
       }
+      if (remaining[j] > 0)
+        active[kept++] = j;
     }
+    active.resize (kept);
   }
-  delete[] start_index;
 }
 
 #define PCL_INSTANTIATE_NormalSpaceSampling(T,NT) template class PCL_EXPORTS pcl::NormalSpaceSampling<T,NT>;
@@ -238,6 +238,72 @@ pcl::PassThrough<PointT>::applyFilter (PointCloud &output)
   removed_indices_->resize(nr_removed_p);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PassThrough<PointT>::initPointTest ()
+{
+  distance_offset_ = -1;
+  if (!filter_field_name_.empty ())
+  {
+    // Get the distance field index
+    std::vector<sensor_msgs::PointField> fields;
+    int distance_idx = pcl::getFieldIndex (*input_, filter_field_name_, fields);
+    if (distance_idx == -1)
+    {
+      PCL_WARN ("[pcl::%s::initPointTest] Invalid filter field name. Index is %d.\n", getClassName ().c_str (), distance_idx);
+      distance_offset_ = -2;
+    }
+    else
+      distance_offset_ = fields[distance_idx].offset;
+  }
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PassThrough<PointT>::testPoint (const PointT &point) const
+{
+  // Check if the point is invalid
+  if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+    return (false);
+
+  if (distance_offset_ == -1)
+    return (true);
+  if (distance_offset_ == -2)
+    return (false);
+
+  // Get the distance value
+  float distance_value = 0;
+  memcpy (&distance_value, (const uint8_t*)&point + distance_offset_, sizeof (float));
+
+  if (filter_limit_negative_)
+    // Use a threshold for cutting out points which inside the interval
+    return (!(distance_value < filter_limit_max_ && distance_value > filter_limit_min_));
+  // Use a threshold for cutting out points which are too close/far away
+  return (!(distance_value > filter_limit_max_ || distance_value < filter_limit_min_));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PassThrough<PointT>::applyFilter (std::vector<int> &indices)
+{
+  indices.resize (indices_->size ());
+  removed_indices_->resize (indices_->size ());
+  int nr_p = 0;
+  int nr_removed_p = 0;
+
+  initPointTest ();
+  for (size_t cp = 0; cp < indices_->size (); ++cp)
+  {
+    if (testPoint (input_->points[(*indices_)[cp]]))
+      indices[nr_p++] = (*indices_)[cp];
+    else if (extract_removed_indices_)
+      (*removed_indices_)[nr_removed_p++] = (*indices_)[cp];
+  }
+  indices.resize (nr_p);
+  removed_indices_->resize (nr_removed_p);
+}
+
 #define PCL_INSTANTIATE_PassThrough(T) template class PCL_EXPORTS pcl::PassThrough<T>;
 
 #endif    // PCL_FILTERS_IMPL_PASSTHROUGH_H_
@@ -39,6 +39,114 @@
 #define PCL_FILTERS_IMPL_RADIUS_OUTLIER_REMOVAL_H_
 
 #include "pcl/filters/radius_outlier_removal.h"
+#include <algorithm>
+#include <limits>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Cell of the grid used to accept dense regions of a cloud without a neighbor search. */
+    struct RadiusOutlierCell
+    {
+      int ijk[3];
+      int cp;
+
+      inline bool
+      operator < (const RadiusOutlierCell &rhs) const
+      {
+        if (ijk[0] != rhs.ijk[0]) return (ijk[0] < rhs.ijk[0]);
+        if (ijk[1] != rhs.ijk[1]) return (ijk[1] < rhs.ijk[1]);
+        return (ijk[2] < rhs.ijk[2]);
+      }
+
+      inline bool
+      sameCell (const RadiusOutlierCell &rhs) const
+      {
+        return (ijk[0] == rhs.ijk[0] && ijk[1] == rhs.ijk[1] && ijk[2] == rhs.ijk[2]);
+      }
+    };
+
+    /** \brief Mark the points which have at least \a min_pts neighbors (themselves included) within \a radius.
+      *
+      * The points are first binned into cubic cells whose diagonal is shorter than \a radius, so that any two
+      * points of a cell are neighbors. Cells holding at least \a min_pts points are accepted as a whole. The
+      * remaining points are checked with a counting radius search that stops as soon as \a min_pts neighbors
+      * have been found.
+      * \param[in] cloud the input cloud, which must be the input cloud of \a tree
+      * \param[in] indices the indices of the points to check
+      * \param[in] tree the spatial search object
+      * \param[in] radius the search radius
+      * \param[in] min_pts the minimum number of neighbors of an inlier
+      * \param[in] threads the number of threads to use
+      * \param[out] inliers 1 for the points in \a indices which are inliers, 0 otherwise
+      */
+    template <typename PointT> void
+    markRadiusInliers (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices,
+                       const pcl::search::Search<PointT> &tree, double radius, int min_pts,
+                       unsigned int threads, std::vector<char> &inliers)
+    {
+      const int nr_points = static_cast<int> (indices.size ());
+      inliers.assign (nr_points, 0);
+
+      // Invalid points have no neighbors
+      if (min_pts <= 0)
+      {
+        inliers.assign (nr_points, 1);
+        return;
+      }
+
+      // Slightly shrunk so that rounding in the search can never reject two points of the same cell
+      const double inverse_cell_size = sqrt (3.0) / radius * 1.001;
+      const double max_cell_index = static_cast<double> (std::numeric_limits<int>::max () / 2);
+      std::vector<RadiusOutlierCell> cells;
+      cells.reserve (nr_points);
+      for (int cp = 0; cp < nr_points; ++cp)
+      {
+        const PointT &point = cloud.points[indices[cp]];
+        if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+          continue;
+        double i = floor (point.x * inverse_cell_size);
+        double j = floor (point.y * inverse_cell_size);
+        double k = floor (point.z * inverse_cell_size);
+        // Points too far away for the grid are left to the search
+        if (fabs (i) > max_cell_index || fabs (j) > max_cell_index || fabs (k) > max_cell_index)
+          continue;
+        RadiusOutlierCell cell;
+        cell.ijk[0] = static_cast<int> (i);
+        cell.ijk[1] = static_cast<int> (j);
+        cell.ijk[2] = static_cast<int> (k);
+        cell.cp = cp;
+        cells.push_back (cell);
+      }
+      std::sort (cells.begin (), cells.end ());
+
+      // Accept all the points of the dense cells
+      for (size_t begin = 0, end = 0; begin < cells.size (); begin = end)
+      {
+        end = begin + 1;
+        while (end < cells.size () && cells[end].sameCell (cells[begin]))
+          ++end;
+        if (static_cast<int> (end - begin) >= min_pts)
+          for (size_t c = begin; c < end; ++c)
+            inliers[cells[c].cp] = 1;
+      }
+
+      // Count the neighbors of the remaining points, up to the threshold
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads)
+      for (int cp = 0; cp < nr_points; ++cp)
+      {
+        if (inliers[cp])
+          continue;
+        const PointT &point = cloud.points[indices[cp]];
+        if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+          continue;
+        if (tree.radiusCount (indices[cp], radius, min_pts) >= min_pts)
+          inliers[cp] = 1;
+      }
+    }
+  } // namespace detail
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -63,10 +171,9 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilter (PointCloud &output)
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_);
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
-
+  // Check which points have enough neighbors
+  std::vector<char> inliers;
+  detail::markRadiusInliers (*input_, *indices_, *tree_, search_radius_, min_pts_radius_, threads_, inliers);
 
   output.points.resize (input_->points.size ());      // reserve enough space
   removed_indices_->resize (input_->points.size ());
@@ -74,12 +181,10 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilter (PointCloud &output)
   int nr_p = 0;
   int nr_removed_p = 0;
   
-  // Go over all the points and check which doesn't have enough neighbors
+  // Go over all the points and copy the ones with enough neighbors
   for (size_t cp = 0; cp < indices_->size (); ++cp)
   {
-    int k = tree_->radiusSearch ((*indices_)[cp], search_radius_, nn_indices, nn_dists);
-    // Check if the number of neighbors is larger than the user imposed limit
-    if (k < min_pts_radius_)
+    if (!inliers[cp])
     {
       if (extract_removed_indices_)
       {
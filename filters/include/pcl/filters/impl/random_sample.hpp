@@ -39,7 +39,8 @@
 #define PCL_FILTERS_IMPL_RANDOM_SAMPLE_H_
 
 #include "pcl/filters/random_sample.h"
-
+#include <algorithm>
+#include <cmath>
 
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
@@ -71,7 +72,7 @@ pcl::RandomSample<PointT>::applyFilter (PointCloud &output)
     // Algorithm A
     for (size_t n = sample_; n >= 2; n--)
     {
-      unsigned int V = unifRand ();
+      float V = unifRand ();
       unsigned S = 0;
       float quot = float (top) * one_over_N;
       while (quot > V)
@@ -120,7 +121,7 @@ pcl::RandomSample<PointT>::applyFilter (std::vector<int> &indices)
 
     for (size_t n = sample_; n >= 2; n--)
     {
-      unsigned int V = unifRand ();
+      float V = unifRand ();
       unsigned S = 0;
       float quot = float (top) * one_over_N;
       while (quot > V)
@@ -140,6 +141,95 @@ pcl::RandomSample<PointT>::applyFilter (std::vector<int> &indices)
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::RandomSample<PointT>::initReservoir ()
+{
+  reservoir_.points.clear ();
+  reservoir_.width = reservoir_.height = 0;
+  reservoir_.is_dense = true;
+  reservoir_positions_.clear ();
+  stream_size_ = 0;
+  next_replacement_ = 0;
+  skip_weight_ = 0;
+  reservoir_rng_.seed (seed_);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::RandomSample<PointT>::drawNextReplacement ()
+{
+  // Algorithm L: the gap to the next replacement is geometric with parameter W
+  next_replacement_ += std::floor (std::log (reservoirRand ()) / std::log (1.0 - skip_weight_)) + 1.0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::RandomSample<PointT>::addToReservoir (const PointCloud &chunk)
+{
+  size_t base = stream_size_;
+  size_t end = base + chunk.points.size ();
+  stream_size_ = end;
+  if (sample_ == 0 || chunk.points.empty ())
+    return;
+
+  reservoir_.header = chunk.header;
+  reservoir_.is_dense = reservoir_.is_dense && chunk.is_dense;
+
+  // Fill the reservoir with the first sample_ points of the stream
+  size_t pos = base;
+  for (; pos < end && reservoir_.points.size () < sample_; ++pos)
+  {
+    reservoir_.points.push_back (chunk.points[pos - base]);
+    reservoir_positions_.push_back (static_cast<int> (pos));
+    if (reservoir_.points.size () == sample_)
+    {
+      skip_weight_ = std::exp (std::log (reservoirRand ()) / sample_);
+      next_replacement_ = static_cast<double> (pos);
+      drawNextReplacement ();
+    }
+  }
+  if (reservoir_.points.size () < sample_)
+    return;
+
+  // Jump straight to the points that replace one in the reservoir, the ones in between are never looked at
+  while (next_replacement_ < static_cast<double> (end))
+  {
+    pos = static_cast<size_t> (next_replacement_);
+    unsigned int slot = reservoir_rng_ () % sample_;
+    reservoir_.points[slot] = chunk.points[pos - base];
+    reservoir_positions_[slot] = static_cast<int> (pos);
+    skip_weight_ *= std::exp (std::log (reservoirRand ()) / sample_);
+    drawNextReplacement ();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::RandomSample<PointT>::getReservoir (PointCloud &output) const
+{
+  std::vector<std::pair<int, size_t> > order (reservoir_positions_.size ());
+  for (size_t i = 0; i < order.size (); ++i)
+    order[i] = std::make_pair (reservoir_positions_[i], i);
+  std::sort (order.begin (), order.end ());
+
+  output.header = reservoir_.header;
+  output.points.resize (order.size ());
+  for (size_t i = 0; i < order.size (); ++i)
+    output.points[i] = reservoir_.points[order[i].second];
+  output.width = static_cast<uint32_t> (order.size ());
+  output.height = 1;
+  output.is_dense = reservoir_.is_dense;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::RandomSample<PointT>::getReservoirIndices (std::vector<int> &positions) const
+{
+  positions = reservoir_positions_;
+  std::sort (positions.begin (), positions.end ());
+}
+
 #define PCL_INSTANTIATE_RandomSample(T) template class PCL_EXPORTS pcl::RandomSample<T>;
 
 #endif    // PCL_FILTERS_IMPL_RANDOM_SAMPLE_H_
@@ -39,7 +39,60 @@
 #define PCL_FILTERS_IMPL_STATISTICAL_OUTLIER_REMOVAL_H_
 
 #include "pcl/filters/statistical_outlier_removal.h"
+#include <algorithm>
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Compute the mean and the sample standard deviation of a set of values. The values are split into 
+      * fixed size blocks which are accumulated in parallel with Welford's update, and the blocks are merged in 
+      * order with the pairwise update of Chan et al. This is numerically stable, and the result does not depend 
+      * on the number of threads.
+      * \param[in] values the values
+      * \param[out] mean the mean of the values
+      * \param[out] stddev the sample standard deviation of the values
+      * \param[in] threads the number of threads to use
+      */
+    inline void
+    getMeanStdBlocked (const std::vector<float> &values, double &mean, double &stddev, unsigned int threads)
+    {
+      const int block_size = 4096;
+      const int nr_values = static_cast<int> (values.size ());
+      const int nr_blocks = (nr_values + block_size - 1) / block_size;
+      std::vector<double> block_mean (nr_blocks, 0.0), block_m2 (nr_blocks, 0.0);
+
+#pragma omp parallel for schedule (static) num_threads (threads)
+      for (int b = 0; b < nr_blocks; ++b)
+      {
+        const int begin = b * block_size;
+        const int end = std::min (begin + block_size, nr_values);
+        double m = 0.0, m2 = 0.0;
+        for (int i = begin; i < end; ++i)
+        {
+          double delta = values[i] - m;
+          m += delta / (i - begin + 1);
+          m2 += delta * (values[i] - m);
+        }
+        block_mean[b] = m;
+        block_m2[b] = m2;
+      }
+
+      double n = 0.0, m2 = 0.0;
+      mean = 0.0;
+      for (int b = 0; b < nr_blocks; ++b)
+      {
+        double n_b = std::min (block_size, nr_values - b * block_size);
+        double delta = block_mean[b] - mean;
+        double n_ab = n + n_b;
+        mean += delta * n_b / n_ab;
+        m2 += block_m2[b] + delta * delta * n * n_b / n_ab;
+        n = n_ab;
+      }
+      stddev = (n > 1.0) ? sqrt (m2 / (n - 1.0)) : 0.0;
+    }
+  } // namespace detail
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -60,51 +113,16 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilter (PointCloud &output)
     return;
   }
 
-  // Initialize the spatial locator
-  if (!tree_)
-  {
-    if (input_->isOrganized ())
-      tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
-    else
-      tree_.reset (new pcl::search::KdTree<PointT> (false));
-  }
-
-  // Send the input dataset to the spatial locator
-  tree_->setInputCloud (input_);
-
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (mean_k_);
-  std::vector<float> nn_dists (mean_k_);
-
   std::vector<float> distances (indices_->size ());
   // Go over all the points and calculate the mean or smallest distance
-  for (size_t cp = 0; cp < indices_->size (); ++cp)
-  {
-    if (!pcl_isfinite (input_->points[(*indices_)[cp]].x) ||
-        !pcl_isfinite (input_->points[(*indices_)[cp]].y) ||
-        !pcl_isfinite (input_->points[(*indices_)[cp]].z))
-    {
-      distances[cp] = 0;
-      continue;
-    }
-
-    if (tree_->nearestKSearch ((*indices_)[cp], mean_k_, nn_indices, nn_dists) == 0)
-    {
-      distances[cp] = 0;
-      PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
-      continue;
-    }
-
-    // Minimum distance (if mean_k_ == 2) or mean distance
-    double dist_sum = 0;
-    for (int j = 1; j < mean_k_; ++j)
-      dist_sum += sqrt (nn_dists[j]);
-    distances[cp] = dist_sum / (mean_k_-1);
-  }
+  if (use_image_neighborhood_ && input_->isOrganized ())
+    computeImageMeanDistances (distances);
+  else
+    computeMeanDistances (distances);
 
   // Estimate the mean and the standard deviation of the distance vector
   double mean, stddev;
-  getMeanStd (distances, mean, stddev);
+  detail::getMeanStdBlocked (distances, mean, stddev, threads_);
   double distance_threshold = mean + std_mul_ * stddev; // a distance that is bigger than this signals an outlier
 
   output.points.resize (input_->points.size ());      // reserve enough space
@@ -152,6 +170,126 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilter (PointCloud &output)
   removed_indices_->resize (nr_removed_p);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalOutlierRemoval<PointT>::computeMeanDistances (std::vector<float> &distances)
+{
+  // Initialize the spatial locator
+  if (!tree_)
+  {
+    if (input_->isOrganized ())
+      tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+    else
+      tree_.reset (new pcl::search::KdTree<PointT> (false));
+  }
+
+  // Send the input dataset to the spatial locator, unless it already holds it
+  if (tree_->getInputCloud () != input_)
+    tree_->setInputCloud (input_);
+
+  const int nr_points = static_cast<int> (indices_->size ());
+  int nr_failed = 0;
+
+#pragma omp parallel num_threads (threads_) reduction (+:nr_failed)
+  {
+    // Allocate enough space to hold the results of each thread
+    std::vector<int> nn_indices (mean_k_);
+    std::vector<float> nn_dists (mean_k_);
+
+#pragma omp for schedule (dynamic, 256)
+    for (int cp = 0; cp < nr_points; ++cp)
+    {
+      const PointT &point = input_->points[(*indices_)[cp]];
+      if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+      {
+        distances[cp] = 0;
+        continue;
+      }
+
+      if (tree_->nearestKSearch ((*indices_)[cp], mean_k_, nn_indices, nn_dists) == 0)
+      {
+        distances[cp] = 0;
+        ++nr_failed;
+        continue;
+      }
+
+      // Minimum distance (if mean_k_ == 2) or mean distance
+      double dist_sum = 0;
+      for (int j = 1; j < mean_k_; ++j)
+        dist_sum += sqrt (nn_dists[j]);
+      distances[cp] = static_cast<float> (dist_sum / (mean_k_ - 1));
+    }
+  }
+
+  if (nr_failed > 0)
+    PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed for %d points.\n", 
+              getClassName ().c_str (), mean_k_, nr_failed);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalOutlierRemoval<PointT>::computeImageMeanDistances (std::vector<float> &distances)
+{
+  const int width = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+  const int nr_neighbors = mean_k_ - 1;
+
+  // Smallest window holding twice the neighbors needed, to leave room for invalid points
+  int radius = image_neighborhood_radius_;
+  if (radius <= 0)
+  {
+    radius = 1;
+    while ((2 * radius + 1) * (2 * radius + 1) - 1 < 2 * nr_neighbors)
+      ++radius;
+  }
+
+  const int nr_points = static_cast<int> (indices_->size ());
+
+#pragma omp parallel num_threads (threads_)
+  {
+    std::vector<float> sqr_dists;
+    sqr_dists.reserve ((2 * radius + 1) * (2 * radius + 1));
+
+#pragma omp for schedule (dynamic, 256)
+    for (int cp = 0; cp < nr_points; ++cp)
+    {
+      const int index = (*indices_)[cp];
+      const PointT &point = input_->points[index];
+      distances[cp] = 0;
+      if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+        continue;
+
+      const int u = index % width, v = index / width;
+      const int u_begin = std::max (u - radius, 0), u_end = std::min (u + radius + 1, width);
+      const int v_begin = std::max (v - radius, 0), v_end = std::min (v + radius + 1, height);
+
+      sqr_dists.clear ();
+      for (int nv = v_begin; nv < v_end; ++nv)
+      {
+        for (int nu = u_begin; nu < u_end; ++nu)
+        {
+          const int n_index = nv * width + nu;
+          const PointT &neighbor = input_->points[n_index];
+          if (n_index == index || !pcl_isfinite (neighbor.x) || !pcl_isfinite (neighbor.y) || !pcl_isfinite (neighbor.z))
+            continue;
+          float dx = neighbor.x - point.x, dy = neighbor.y - point.y, dz = neighbor.z - point.z;
+          sqr_dists.push_back (dx * dx + dy * dy + dz * dz);
+        }
+      }
+      if (sqr_dists.empty () || nr_neighbors < 1)
+        continue;
+
+      // Mean distance to the nearest neighbors found in the window
+      int k = std::min (nr_neighbors, static_cast<int> (sqr_dists.size ()));
+      std::nth_element (sqr_dists.begin (), sqr_dists.begin () + (k - 1), sqr_dists.end ());
+      double dist_sum = 0;
+      for (int j = 0; j < k; ++j)
+        dist_sum += sqrt (sqr_dists[j]);
+      distances[cp] = static_cast<float> (dist_sum / k);
+    }
+  }
+}
+
 #define PCL_INSTANTIATE_StatisticalOutlierRemoval(T) template class PCL_EXPORTS pcl::StatisticalOutlierRemoval<T>;
 
 #endif    // PCL_FILTERS_IMPL_STATISTICAL_OUTLIER_REMOVAL_H_
@@ -119,6 +119,55 @@ pcl::getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
   max_pt = max_p;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud, const std::vector<int> &indices,
+                  const std::string &distance_field_name, float min_distance, float max_distance,
+                  Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, bool limit_negative)
+{
+  Eigen::Array4f min_p, max_p;
+  min_p.setConstant (FLT_MAX);
+  max_p.setConstant (-FLT_MAX);
+
+  // Get the fields list and the distance field index
+  std::vector<sensor_msgs::PointField> fields;
+  int distance_idx = pcl::getFieldIndex (*cloud, distance_field_name, fields);
+
+  float distance_value;
+  for (std::vector<int>::const_iterator it = indices.begin (); it != indices.end (); ++it)
+  {
+    // Get the distance value
+    uint8_t* pt_data = (uint8_t*)&cloud->points[*it];
+    memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
+
+    if (limit_negative)
+    {
+      // Use a threshold for cutting out points which inside the interval
+      if ((distance_value < max_distance) && (distance_value > min_distance))
+        continue;
+    }
+    else
+    {
+      // Use a threshold for cutting out points which are too close/far away
+      if ((distance_value > max_distance) || (distance_value < min_distance))
+        continue;
+    }
+
+    // Check if the point is invalid
+    if (!cloud->is_dense &&
+        (!pcl_isfinite (cloud->points[*it].x) || 
+         !pcl_isfinite (cloud->points[*it].y) || 
+         !pcl_isfinite (cloud->points[*it].z)))
+      continue;
+    // Create the point structure and get the min/max
+    pcl::Array4fMapConst pt = cloud->points[*it].getArray4fMap ();
+    min_p = min_p.min (pt);
+    max_p = max_p.max (pt);
+  }
+  min_pt = min_p;
+  max_pt = max_p;
+}
+
 struct cloud_point_index_idx 
 {
   unsigned int idx;
@@ -148,9 +197,9 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   Eigen::Vector4f min_p, max_p;
   // Get the minimum and maximum dimensions
   if (!filter_field_name_.empty ()) // If we don't want to process the entire cloud...
-    getMinMax3D<PointT>(input_, filter_field_name_, filter_limit_min_, filter_limit_max_, min_p, max_p, filter_limit_negative_);
+    getMinMax3D<PointT> (input_, *indices_, filter_field_name_, filter_limit_min_, filter_limit_max_, min_p, max_p, filter_limit_negative_);
   else
-    getMinMax3D<PointT>(*input_, min_p, max_p);
+    getMinMax3D<PointT> (*input_, *indices_, min_p, max_p);
 
   // Compute the minimum and maximum bounding box values
   min_b_[0] = (int)(floor (min_p[0] * inverse_leaf_size_[0]));
@@ -184,7 +233,7 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   }
 
   std::vector<cloud_point_index_idx> index_vector;
-  index_vector.reserve(input_->points.size());
+  index_vector.reserve (indices_->size ());
 
   // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
   if (!filter_field_name_.empty ())
@@ -198,17 +247,17 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
     // First pass: go over all points and insert them into the index_vector vector
     // with calculated idx. Points with the same idx value will contribute to the
     // same point of resulting CloudPoint
-    for (size_t cp = 0; cp < input_->points.size (); ++cp)
+    for (std::vector<int>::const_iterator it = indices_->begin (); it != indices_->end (); ++it)
     {
       if (!input_->is_dense)
         // Check if the point is invalid
-        if (!pcl_isfinite (input_->points[cp].x) || 
-            !pcl_isfinite (input_->points[cp].y) || 
-            !pcl_isfinite (input_->points[cp].z))
+        if (!pcl_isfinite (input_->points[*it].x) || 
+            !pcl_isfinite (input_->points[*it].y) || 
+            !pcl_isfinite (input_->points[*it].z))
           continue;
 
       // Get the distance value
-      uint8_t* pt_data = (uint8_t*)&input_->points[cp];
+      uint8_t* pt_data = (uint8_t*)&input_->points[*it];
       float distance_value = 0;
       memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
 
@@ -225,13 +274,13 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
           continue;
       }
       
-      int ijk0 = (int)(floor (input_->points[cp].x * inverse_leaf_size_[0])) - min_b_[0];
-      int ijk1 = (int)(floor (input_->points[cp].y * inverse_leaf_size_[1])) - min_b_[1];
-      int ijk2 = (int)(floor (input_->points[cp].z * inverse_leaf_size_[2])) - min_b_[2];
+      int ijk0 = (int)(floor (input_->points[*it].x * inverse_leaf_size_[0])) - min_b_[0];
+      int ijk1 = (int)(floor (input_->points[*it].y * inverse_leaf_size_[1])) - min_b_[1];
+      int ijk2 = (int)(floor (input_->points[*it].z * inverse_leaf_size_[2])) - min_b_[2];
 
       // Compute the centroid leaf index
       int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.push_back (cloud_point_index_idx (idx, cp));
+      index_vector.push_back (cloud_point_index_idx (idx, *it));
     }
   }
   // No distance filtering, process all data
@@ -240,22 +289,22 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
     // First pass: go over all points and insert them into the index_vector vector
     // with calculated idx. Points with the same idx value will contribute to the
     // same point of resulting CloudPoint
-    for (size_t cp = 0; cp < input_->points.size (); ++cp)
+    for (std::vector<int>::const_iterator it = indices_->begin (); it != indices_->end (); ++it)
     {
       if (!input_->is_dense)
         // Check if the point is invalid
-        if (!pcl_isfinite (input_->points[cp].x) || 
-            !pcl_isfinite (input_->points[cp].y) || 
-            !pcl_isfinite (input_->points[cp].z))
+        if (!pcl_isfinite (input_->points[*it].x) || 
+            !pcl_isfinite (input_->points[*it].y) || 
+            !pcl_isfinite (input_->points[*it].z))
           continue;
 
-      int ijk0 = (int)(floor (input_->points[cp].x * inverse_leaf_size_[0])) - min_b_[0];
-      int ijk1 = (int)(floor (input_->points[cp].y * inverse_leaf_size_[1])) - min_b_[1];
-      int ijk2 = (int)(floor (input_->points[cp].z * inverse_leaf_size_[2])) - min_b_[2];
+      int ijk0 = (int)(floor (input_->points[*it].x * inverse_leaf_size_[0])) - min_b_[0];
+      int ijk1 = (int)(floor (input_->points[*it].y * inverse_leaf_size_[1])) - min_b_[1];
+      int ijk2 = (int)(floor (input_->points[*it].z * inverse_leaf_size_[2])) - min_b_[2];
 
       // Compute the centroid leaf index
       int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.push_back (cloud_point_index_idx (idx, cp));
+      index_vector.push_back (cloud_point_index_idx (idx, *it));
     }
   }
 
@@ -379,7 +428,8 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
 }
 
 #define PCL_INSTANTIATE_VoxelGrid(T) template class PCL_EXPORTS pcl::VoxelGrid<T>;
-#define PCL_INSTANTIATE_getMinMax3D(T) template PCL_EXPORTS void pcl::getMinMax3D<T> (const pcl::PointCloud<T>::ConstPtr &, const std::string &, float, float, Eigen::Vector4f &, Eigen::Vector4f &, bool);
+#define PCL_INSTANTIATE_getMinMax3D(T) template PCL_EXPORTS void pcl::getMinMax3D<T> (const pcl::PointCloud<T>::ConstPtr &, const std::string &, float, float, Eigen::Vector4f &, Eigen::Vector4f &, bool); \
+  template PCL_EXPORTS void pcl::getMinMax3D<T> (const pcl::PointCloud<T>::ConstPtr &, const std::vector<int> &, const std::string &, float, float, Eigen::Vector4f &, Eigen::Vector4f &, bool);
 
 #endif    // PCL_FILTERS_IMPL_VOXEL_GRID_H_
 
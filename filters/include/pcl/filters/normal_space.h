@@ -42,11 +42,14 @@
 #include <time.h>
 #include <limits.h>
 
-#include <boost/dynamic_bitset.hpp>
-
 namespace pcl
 {
   /** \brief @b NormalSpaceSampling samples the input point cloud in the space of normal directions computed at every point.
+    *
+    * The indices are binned by the direction cosines of their normals with a counting sort, and the sample is
+    * drawn round-robin over the non-empty bins. Each bin is consumed by a partial Fisher-Yates shuffle, so the
+    * whole filter runs in O(N + bins) regardless of how full the bins are. The binning phase can be run on
+    * several threads with \ref setNumberOfThreads.
     * \ingroup filters
     */
   template<typename PointT, typename NormalT>
@@ -64,7 +67,7 @@ namespace pcl
 
     public:
       /** \brief Empty constructor. */
-      NormalSpaceSampling () : sample_ (UINT_MAX), seed_(time(NULL))
+      NormalSpaceSampling () : sample_ (UINT_MAX), seed_(time(NULL)), binsx_ (0), binsy_ (0), binsz_ (0), threads_ (1)
       {
         filter_name_ = "NormalSpaceSampling";
       }
@@ -140,6 +143,16 @@ namespace pcl
       inline NormalsPtr
       getNormals () { return input_normals_; }
 
+      /** \brief Set the number of threads to use for binning the normals.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       
       /** \brief Number of indices that will be returned. */
@@ -157,6 +170,9 @@ namespace pcl
       /** \brief The normals computed at each point in the input cloud */
       NormalsPtr input_normals_; 
 
+      /** \brief The number of threads the binning phase should use. */
+      unsigned int threads_;
+
       /** \brief Sample of point indices into a separate PointCloud
         * \param output the resultant point cloud
         */
@@ -172,18 +188,9 @@ namespace pcl
     private:
       /** \brief Finds the bin number of the input normal, returns the bin number
         * \param normal the input normal 
-        * \param nbins total number of bins
         */
       unsigned int 
-      findBin (float *normal, unsigned int nbins);
-
-      /** \brief Checks of the entire bin is sampled, returns true or false
-        * \param array flag which says whether a point is sampled or not
-        * \param start_index the index to the first point of the bin in array.
-        * \param length number of points in the bin
-        */
-      bool
-      isEntireBinSampled (boost::dynamic_bitset<> &array, unsigned int start_index, unsigned int length);
+      findBin (const float *normal) const;
 
   };
 }
@@ -40,7 +40,7 @@
 #ifndef PCL_FILTERS_PASSTHROUGH_H_
 #define PCL_FILTERS_PASSTHROUGH_H_
 
-#include "pcl/filters/filter.h"
+#include "pcl/filters/filter_indices.h"
 
 namespace pcl
 {
@@ -51,9 +51,10 @@ namespace pcl
     * \ingroup filters
     */
   template<typename PointT>
-  class PassThrough : public Filter<PointT>
+  class PassThrough : public FilterIndices<PointT>
   {
     using Filter<PointT>::input_;
+    using Filter<PointT>::indices_;
     using Filter<PointT>::filter_name_;
     using Filter<PointT>::getClassName;
 
@@ -67,11 +68,11 @@ namespace pcl
     public:
       /** \brief Constructor. */
       PassThrough (bool extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), keep_organized_ (false), 
+        FilterIndices<PointT>::FilterIndices (extract_removed_indices), keep_organized_ (false), 
         user_filter_value_ (std::numeric_limits<float>::quiet_NaN ()),
         filter_field_name_ (""), 
         filter_limit_min_ (-FLT_MAX), filter_limit_max_ (FLT_MAX),
-        filter_limit_negative_ (false)
+        filter_limit_negative_ (false), distance_offset_ (-1)
       {
         filter_name_ = "PassThrough";
       }
@@ -175,6 +176,16 @@ namespace pcl
         return (filter_limit_negative_);
       }
 
+      /** \brief Look up the filter field used by \ref testPoint. */
+      bool
+      initPointTest ();
+
+      /** \brief Test whether a single point is valid and its filter field value passes the filter limits.
+        * \param[in] point the point to test
+        */
+      bool
+      testPoint (const PointT &point) const;
+
     protected:
       /** \brief Filter a Point Cloud.
         * \param[out] output the resultant point cloud message
@@ -182,6 +193,13 @@ namespace pcl
       void
       applyFilter (PointCloud &output);
 
+      /** \brief Filter a Point Cloud, returning the indices of the points that pass. The organized structure
+        * is not kept.
+        * \param[out] indices the resultant point cloud indices
+        */
+      void
+      applyFilter (std::vector<int> &indices);
+
       typedef typename pcl::traits::fieldList<PointT>::type FieldList;
 
     private:
@@ -206,6 +224,11 @@ namespace pcl
 
       /** \brief Set to true if we want to return the data outside (\a filter_limit_min_;\a filter_limit_max_). Default: false. */
       bool filter_limit_negative_;
+
+      /** \brief Byte offset of the filter field in a point, computed by initPointTest. -1 if no field is used, 
+        * -2 if the field name is invalid. 
+        */
+      int distance_offset_;
   };
 
   ////////////////////////////////////////////////////////////////////////////////////////////
@@ -72,7 +72,8 @@ namespace pcl
     public:
       /** \brief Empty constructor. */
       RadiusOutlierRemoval (bool extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), search_radius_ (0.0), min_pts_radius_ (1), tree_ ()
+        Filter<PointT>::Filter (extract_removed_indices), search_radius_ (0.0), min_pts_radius_ (1), tree_ (),
+        threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -113,6 +114,24 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Set the number of threads used to check the points for enough neighbors.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads used to check the points for enough neighbors. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
     protected:
       /** \brief The nearest neighbors search radius for each point. */
       double search_radius_;
@@ -125,6 +144,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Apply the filter
         * \param output the resultant point cloud message
         */
@@ -159,7 +181,7 @@ namespace pcl
       /** \brief Empty constructor. */
       RadiusOutlierRemoval (bool extract_removed_indices = false) :
         Filter<sensor_msgs::PointCloud2>::Filter (extract_removed_indices), 
-        search_radius_ (0.0), min_pts_radius_ (1), tree_ ()
+        search_radius_ (0.0), min_pts_radius_ (1), tree_ (), threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -199,6 +221,24 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Set the number of threads used to check the points for enough neighbors.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads used to check the points for enough neighbors. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
     protected:
       /** \brief The nearest neighbors search radius for each point. */
       double search_radius_;
@@ -211,6 +251,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       void
       applyFilter (PointCloud2 &output);
   };
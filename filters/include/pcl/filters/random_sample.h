@@ -41,6 +41,7 @@
 #include "pcl/filters/filter_indices.h"
 #include <time.h>
 #include <limits.h>
+#include <boost/random/mersenne_twister.hpp>
 
 namespace pcl
 {
@@ -49,6 +50,12 @@ namespace pcl
     * by Jeffrey Scott Vitter. The algorithm runs in O(N) and results in sorted
     * indices
     * http://www.ittc.ku.edu/~jsv/Papers/Vit84.sampling.pdf
+    *
+    * Clouds that arrive in chunks can be sampled without holding the whole
+    * stream through the reservoir interface (\ref initReservoir,
+    * \ref addToReservoir, \ref getReservoir). It keeps only \a sample points
+    * and skips ahead between replacements as in Algorithm L from "Reservoir-
+    * Sampling Algorithms of Time Complexity O(n(1 + log(N/n)))" by Kim-Hung Li.
     * \author Justin Rosen
     * \ingroup filters
     */
@@ -66,7 +73,8 @@ namespace pcl
 
     public:
       /** \brief Empty constructor. */
-      RandomSample () : sample_ (UINT_MAX), seed_ (time (NULL))
+      RandomSample () : sample_ (UINT_MAX), seed_ (time (NULL)), reservoir_ (), reservoir_positions_ (),
+                        stream_size_ (0), next_replacement_ (0), skip_weight_ (0), reservoir_rng_ ()
       {
         filter_name_ = "RandomSample";
       }
@@ -105,6 +113,35 @@ namespace pcl
         return (seed_);
       }
 
+      /** \brief Start a new streaming sample, dropping the content of the reservoir. The stream is sampled
+        * with the current \a sample and \a seed parameters.
+        */
+      void
+      initReservoir ();
+
+      /** \brief Offer the next chunk of the stream to the reservoir. The points of the chunk take the stream
+        * positions that follow the ones of the previous chunks.
+        * \param[in] chunk the next points of the stream
+        */
+      void
+      addToReservoir (const PointCloud &chunk);
+
+      /** \brief Get the number of points offered to the reservoir since the last \ref initReservoir. */
+      inline size_t
+      getStreamSize () const { return (stream_size_); }
+
+      /** \brief Get the points sampled from the stream so far, in the order they appeared in the stream.
+        * \param[out] output the sampled points
+        */
+      void
+      getReservoir (PointCloud &output) const;
+
+      /** \brief Get the stream positions of the points sampled so far, in increasing order.
+        * \param[out] positions the positions of the sampled points in the stream
+        */
+      void
+      getReservoirIndices (std::vector<int> &positions) const;
+
     protected:
 
       /** \brief Number of indices that will be returned. */
@@ -112,6 +149,21 @@ namespace pcl
       /** \brief Random number seed. */
       unsigned int seed_;
 
+      /** \brief The points held in the reservoir. */
+      PointCloud reservoir_;
+      /** \brief The stream position of every point in the reservoir. */
+      std::vector<int> reservoir_positions_;
+      /** \brief The number of points offered to the reservoir so far. */
+      size_t stream_size_;
+      /** \brief The stream position of the next point that replaces one in the reservoir. Kept as a double
+        * since the skips drawn for long streams can overflow any integer type.
+        */
+      double next_replacement_;
+      /** \brief The running weight W of Algorithm L. */
+      double skip_weight_;
+      /** \brief The random number generator used by the reservoir. */
+      boost::mt19937 reservoir_rng_;
+
       /** \brief Sample of point indices into a separate PointCloud
         * \param output the resultant point cloud
         */
@@ -133,6 +185,17 @@ namespace pcl
         return (rand () / double (RAND_MAX));
         //return (((214013 * seed_ + 2531011) >> 16) & 0x7FFF);
       }
+
+      /** \brief Draw a uniform number in (0, 1] from the reservoir generator. */
+      inline double
+      reservoirRand ()
+      {
+        return ((static_cast<double> (reservoir_rng_ ()) + 1.0) / 4294967296.0);
+      }
+
+      /** \brief Draw the stream position of the next replacement once the reservoir is full. */
+      void
+      drawNextReplacement ();
   };
 
   /** \brief @b RandomSample applies a random sampling with uniform probability.
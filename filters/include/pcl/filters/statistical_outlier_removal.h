@@ -76,11 +76,82 @@ namespace pcl
     public:
       /** \brief Empty constructor. */
       StatisticalOutlierRemoval (bool extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), mean_k_ (2), std_mul_ (0.0), tree_ (), negative_ (false)
+        Filter<PointT>::Filter (extract_removed_indices), mean_k_ (2), std_mul_ (0.0), tree_ (), negative_ (false),
+        threads_ (1), use_image_neighborhood_ (false), image_neighborhood_radius_ (0)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
 
+      /** \brief Provide a pointer to the search object. If the search object already holds the input cloud, 
+        * it is reused as is instead of being rebuilt.
+        * \param[in] tree a pointer to the spatial search object.
+        */
+      inline void
+      setSearchMethod (const KdTreePtr &tree)
+      {
+        tree_ = tree;
+      }
+
+      /** \brief Get a pointer to the search method used. */
+      inline KdTreePtr
+      getSearchMethod ()
+      {
+        return (tree_);
+      }
+
+      /** \brief Set the number of threads used to compute the mean distances and their statistics.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads used to compute the mean distances and their statistics. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
+      /** \brief Set whether the mean distances of organized clouds are computed from the k nearest points in 
+        * an image window around each point, instead of a 3D nearest neighbor search. This is much faster, but 
+        * points which are close in 3D and far in the image are not considered.
+        * \param[in] use_image_neighborhood true to use image windows for organized input clouds
+        */
+      inline void
+      setUseImageNeighborhood (bool use_image_neighborhood)
+      {
+        use_image_neighborhood_ = use_image_neighborhood;
+      }
+
+      /** \brief Get whether the mean distances of organized clouds are computed in image windows. */
+      inline bool
+      getUseImageNeighborhood ()
+      {
+        return (use_image_neighborhood_);
+      }
+
+      /** \brief Set the half size of the image window used for organized clouds.
+        * \param[in] radius the window spans [u - radius, u + radius] x [v - radius, v + radius]. If 0 (default), 
+        * the smallest window holding twice the number of points for mean distance estimation is used.
+        */
+      inline void
+      setImageNeighborhoodRadius (int radius)
+      {
+        image_neighborhood_radius_ = radius;
+      }
+
+      /** \brief Get the half size of the image window used for organized clouds. */
+      inline int
+      getImageNeighborhoodRadius ()
+      {
+        return (image_neighborhood_radius_);
+      }
+
       /** \brief Set the number of points (k) to use for mean distance estimation
         * \param nr_k the number of points to use for mean distance estimation
         */
@@ -148,11 +219,34 @@ namespace pcl
       /** \brief If true, the outliers will be returned instead of the inliers (default: false). */
       bool negative_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief If true, the mean distances of organized clouds are computed in image windows. */
+      bool use_image_neighborhood_;
+
+      /** \brief The half size of the image window, 0 to derive it from mean_k_. */
+      int image_neighborhood_radius_;
+
       /** \brief Apply the filter
         * \param output the resultant point cloud message
         */
       void
       applyFilter (PointCloud &output);
+
+      /** \brief Compute the mean distance of every point in indices_ to its mean_k_ - 1 nearest neighbors 
+        * with the spatial search object.
+        * \param[out] distances the mean distances, 0 for invalid points or failed searches
+        */
+      void
+      computeMeanDistances (std::vector<float> &distances);
+
+      /** \brief Compute the mean distance of every point in indices_ to its mean_k_ - 1 nearest neighbors 
+        * within an image window of the organized input cloud.
+        * \param[out] distances the mean distances, 0 for invalid points or points without valid neighbors
+        */
+      void
+      computeImageMeanDistances (std::vector<float> &distances);
   };
 
   /** \brief @b StatisticalOutlierRemoval uses point neighborhood statistics to filter outlier data. For more
@@ -185,11 +279,29 @@ namespace pcl
       /** \brief Empty constructor. */
       StatisticalOutlierRemoval (bool extract_removed_indices = false) :
         Filter<sensor_msgs::PointCloud2>::Filter (extract_removed_indices), mean_k_ (2), 
-        std_mul_ (0.0), tree_ (), negative_ (false)
+        std_mul_ (0.0), tree_ (), negative_ (false), threads_ (1)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
 
+      /** \brief Set the number of threads used to compute the mean distances and their statistics.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads used to compute the mean distances and their statistics. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
       /** \brief Set the number of points (k) to use for mean distance estimation
         * \param nr_k the number of points to use for mean distance estimation
         */
@@ -259,6 +371,9 @@ namespace pcl
       /** \brief If true, the outliers will be returned instead of the inliers (default: false). */
       bool negative_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       void
       applyFilter (PointCloud2 &output);
   };
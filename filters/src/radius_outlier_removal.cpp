@@ -76,9 +76,9 @@ pcl::RadiusOutlierRemoval<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &o
   }
   tree_->setInputCloud (cloud);
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
+  // Check which points have enough neighbors
+  std::vector<char> inliers;
+  detail::markRadiusInliers (*cloud, *indices_, *tree_, search_radius_, min_pts_radius_, threads_, inliers);
 
   // Copy the common fields
   output.is_bigendian = input_->is_bigendian;
@@ -90,12 +90,10 @@ pcl::RadiusOutlierRemoval<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &o
 
   int nr_p = 0;
   int nr_removed_p = 0;
-  // Go over all the points and check which doesn't have enough neighbors
+  // Go over all the points and copy the ones with enough neighbors
   for (size_t cp = 0; cp < indices_->size (); ++cp)
   {
-    int k = tree_->radiusSearch ((*indices_)[cp], search_radius_, nn_indices, nn_dists);
-    // Check if the number of neighbors is larger than the user imposed limit
-    if (k < min_pts_radius_)
+    if (!inliers[cp])
     {
       if (extract_removed_indices_)
       {
@@ -66,6 +66,13 @@ namespace pcl
       MANUAL_CONFIGURATION
     };
 
+    // entropy coder backend
+    enum entropyCoder_e
+    {
+      RANGE_CODER,
+      RANS_CODER
+    };
+
     // compression configuration profile
     struct configurationProfile_t
     {
@@ -75,6 +82,7 @@ namespace pcl
       unsigned int iFrameRate;
       const unsigned char colorBitResolution;
       bool doColorEncoding;
+      entropyCoder_e entropyCoder;
     };
 
     // predefined configuration parameters
@@ -86,7 +94,8 @@ namespace pcl
        true, /* doVoxelGridDownDownSampling = */
        50, /* iFrameRate = */
        4, /* colorBitResolution = */
-       false /* doColorEncoding = */
+       false, /* doColorEncoding = */
+       RANS_CODER /* entropyCoder = */
     }, {
     // PROFILE: LOW_RES_ONLINE_COMPRESSION_WITH_COLOR
         0.01, /* pointResolution = */
@@ -94,7 +103,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         50, /* iFrameRate = */
         4, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        RANS_CODER /* entropyCoder = */
     }, {
     // PROFILE: MED_RES_ONLINE_COMPRESSION_WITHOUT_COLOR
         0.005, /* pointResolution = */
@@ -102,7 +112,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         40, /* iFrameRate = */
         5, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        RANS_CODER /* entropyCoder = */
     }, {
     // PROFILE: MED_RES_ONLINE_COMPRESSION_WITH_COLOR
         0.005, /* pointResolution = */
@@ -110,7 +121,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         40, /* iFrameRate = */
         5, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        RANS_CODER /* entropyCoder = */
     }, {
     // PROFILE: HIGH_RES_ONLINE_COMPRESSION_WITHOUT_COLOR
         0.0001, /* pointResolution = */
@@ -118,7 +130,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         30, /* iFrameRate = */
         7, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        RANS_CODER /* entropyCoder = */
     }, {
     // PROFILE: HIGH_RES_ONLINE_COMPRESSION_WITH_COLOR
         0.0001, /* pointResolution = */
@@ -126,7 +139,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         30, /* iFrameRate = */
         7, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        RANS_CODER /* entropyCoder = */
     }, {
     // PROFILE: LOW_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR
         0.01, /* pointResolution = */
@@ -134,7 +148,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         4, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        RANGE_CODER /* entropyCoder = */
     }, {
     // PROFILE: LOW_RES_OFFLINE_COMPRESSION_WITH_COLOR
         0.01, /* pointResolution = */
@@ -142,7 +157,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         4, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        RANGE_CODER /* entropyCoder = */
     }, {
     // PROFILE: MED_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR
         0.005, /* pointResolution = */
@@ -150,7 +166,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         5, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        RANGE_CODER /* entropyCoder = */
     }, {
     // PROFILE: MED_RES_OFFLINE_COMPRESSION_WITH_COLOR
         0.005, /* pointResolution = */
@@ -158,7 +175,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         5, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        RANGE_CODER /* entropyCoder = */
     }, {
     // PROFILE: HIGH_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR
         0.0001, /* pointResolution = */
@@ -166,7 +184,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         8, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        RANGE_CODER /* entropyCoder = */
     }, {
     // PROFILE: HIGH_RES_OFFLINE_COMPRESSION_WITH_COLOR
         0.0001, /* pointResolution = */
@@ -174,7 +193,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         8, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        RANGE_CODER /* entropyCoder = */
     }};
 
   }
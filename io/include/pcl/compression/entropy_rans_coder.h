@@ -0,0 +1,160 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __PCL_IO_RANSCODING__
+#define __PCL_IO_RANSCODING__
+
+#include <iostream>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+namespace pcl
+{
+
+  using boost::uint8_t;
+  using boost::uint16_t;
+  using boost::uint32_t;
+  using boost::uint64_t;
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief @b StaticRANSCoder compression class
+   *  \note This class provides static, table-driven rANS (range asymmetric numeral systems) coding functionality.
+   *  \note It is a drop-in alternative to StaticRangeCoder with the same interface: the byte frequency table is
+   *  \note precomputed, normalized to a power of two and encoded to the output stream.
+   *  \note
+   *  \note Encoding replaces the per-symbol range division by a multiplication with a precomputed reciprocal,
+   *  \note decoding looks symbols up in a slot table instead of searching the cumulative frequency table. Four
+   *  \note rANS states are interleaved so that consecutive symbols do not depend on each other.
+   *  \note Integer vectors are coded as variable length byte sequences (7 bits per byte).
+   *  \note
+   *  \note Stream layout: uint16 symbol count | symbol count x (uint8 symbol, uint16 frequency) |
+   *  \note                uint32 payload size | payload
+   */
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  class StaticRANSCoder
+  {
+
+  public:
+
+    /** \brief Constructor. */
+    StaticRANSCoder () :
+      outputCharVector_ (), inputCharVector_ ()
+    {
+    }
+
+    /** \brief Empty deconstructor. */
+    virtual
+    ~StaticRANSCoder ()
+    {
+    }
+
+    /** \brief Encode integer vector to output stream
+     * \param inputIntVector_arg input vector
+     * \param outputByteStream_arg output stream containing compressed data
+     * \return amount of bytes written to output stream
+     */
+    unsigned long
+    encodeIntVectorToStream (std::vector<unsigned int>& inputIntVector_arg, std::ostream& outputByteStream_arg);
+
+    /** \brief Decode stream to output integer vector
+     * \param inputByteStream_arg input stream of compressed data
+     * \param outputIntVector_arg decompressed output vector, its size defines the number of decoded symbols
+     * \return amount of bytes read from input stream
+     */
+    unsigned long
+    decodeStreamToIntVector (std::istream& inputByteStream_arg, std::vector<unsigned int>& outputIntVector_arg);
+
+    /** \brief Encode char vector to output stream
+     * \param inputByteVector_arg input vector
+     * \param outputByteStream_arg output stream containing compressed data
+     * \return amount of bytes written to output stream
+     */
+    unsigned long
+    encodeCharVectorToStream (const std::vector<char>& inputByteVector_arg, std::ostream& outputByteStream_arg);
+
+    /** \brief Decode char stream to output vector
+     * \param inputByteStream_arg input stream of compressed data
+     * \param outputByteVector_arg decompressed output vector, its size defines the number of decoded symbols
+     * \return amount of bytes read from input stream
+     */
+    unsigned long
+    decodeStreamToCharVector (std::istream& inputByteStream_arg, std::vector<char>& outputByteVector_arg);
+
+  protected:
+
+    /** \brief Precision of the normalized frequency table in bits */
+    static const uint32_t scaleBits_ = 14;
+
+    /** \brief Lower bound of the normalized rANS state interval */
+    static const uint32_t stateLowerBound_ = 1u << 23;
+
+    /** \brief Number of interleaved rANS states */
+    static const unsigned int interleave_ = 4;
+
+    /** \brief Precomputed encoding parameters of a symbol */
+    struct EncSymbol
+    {
+      uint32_t xMax;     // renormalization threshold
+      uint32_t rcpFreq;  // fixed point reciprocal of the frequency
+      uint32_t bias;     // start of the symbol slot range (plus correction for frequency 1)
+      uint16_t cmplFreq; // (1 << scaleBits_) - frequency
+      uint16_t rcpShift; // shift applied after the reciprocal multiplication
+    };
+
+    /** \brief Normalize a byte histogram so that the frequencies sum up to (1 << scaleBits_) and every
+     *  \brief occurring symbol keeps a non-zero frequency
+     * \param hist_arg byte histogram
+     * \param freq_arg normalized frequencies
+     */
+    void
+    normalizeFrequencies (const uint64_t hist_arg[256], uint32_t freq_arg[256]);
+
+  private:
+    /** vector containing compressed data
+     */
+    std::vector<uint8_t> outputCharVector_;
+
+    /** vector containing data read from the input stream
+     */
+    std::vector<uint8_t> inputCharVector_;
+
+  };
+}
+
+#endif
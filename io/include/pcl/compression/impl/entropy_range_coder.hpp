@@ -331,8 +331,8 @@ namespace pcl
       }
     }
 
-    // calculate amount of bytes per frequency table entry
-    frequencyTableByteSize = (uint8_t)ceil (Log2 ((double) cFreqTable_[frequencyTableSize - 1]) / 8.0);
+    // calculate amount of bytes per frequency table entry, the largest entry is the symbol count itself
+    frequencyTableByteSize = (uint8_t)ceil (Log2 ((double) cFreqTable_[frequencyTableSize - 1] + 1.0) / 8.0);
 
     // write size of frequency table to output stream
     outputByteStream_arg.write ((const char *)&frequencyTableSize, sizeof(frequencyTableSize));
@@ -0,0 +1,359 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __PCL_IO_RANSCODING__HPP
+#define __PCL_IO_RANSCODING__HPP
+
+#include "pcl/compression/entropy_rans_coder.h"
+
+#include <vector>
+#include <string.h>
+
+namespace pcl
+{
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  void
+  StaticRANSCoder::normalizeFrequencies (const uint64_t hist_arg[256], uint32_t freq_arg[256])
+  {
+    const uint32_t scale = 1u << scaleBits_;
+    uint64_t total = 0;
+    int f;
+
+    for (f = 0; f < 256; f++)
+      total += hist_arg[f];
+
+    // scale frequencies, keeping every occurring symbol representable
+    uint32_t sum = 0;
+    for (f = 0; f < 256; f++)
+    {
+      freq_arg[f] = 0;
+      if (hist_arg[f])
+      {
+        freq_arg[f] = (uint32_t)((hist_arg[f] * scale) / total);
+        if (freq_arg[f] == 0)
+          freq_arg[f] = 1;
+      }
+      sum += freq_arg[f];
+    }
+
+    // correct rounding errors on the most frequent symbols
+    while (sum != scale)
+    {
+      int maxSymbol = 0;
+      for (f = 1; f < 256; f++)
+        if (freq_arg[f] > freq_arg[maxSymbol])
+          maxSymbol = f;
+
+      if (sum < scale)
+      {
+        freq_arg[maxSymbol] += scale - sum;
+        sum = scale;
+      }
+      else
+      {
+        uint32_t excess = sum - scale;
+        uint32_t reduce = freq_arg[maxSymbol] - 1;
+        if (reduce > excess)
+          reduce = excess;
+        if (reduce == 0)
+          reduce = 1; // can't happen for more than scale symbols, kept for safety
+        freq_arg[maxSymbol] -= reduce;
+        sum -= reduce;
+      }
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  unsigned long
+  StaticRANSCoder::encodeCharVectorToStream (const std::vector<char>& inputByteVector_arg,
+                                             std::ostream& outputByteStream_arg)
+  {
+    const uint32_t scale = 1u << scaleBits_;
+    const size_t input_size = inputByteVector_arg.size ();
+    const uint8_t* input = (const uint8_t*)(input_size ? &inputByteVector_arg[0] : 0);
+
+    uint64_t hist[256];
+    uint32_t freq[256];
+    EncSymbol symbols[256];
+    unsigned long streamByteCount = 0;
+    size_t i;
+    int f;
+
+    // calculate frequency table
+    memset (hist, 0, sizeof(hist));
+    for (i = 0; i < input_size; i++)
+      hist[input[i]]++;
+
+    uint16_t symbolCount = 0;
+    if (input_size)
+    {
+      normalizeFrequencies (hist, freq);
+      for (f = 0; f < 256; f++)
+        if (freq[f])
+          symbolCount++;
+    }
+
+    // write sparse frequency table to output stream
+    outputByteStream_arg.write ((const char*)&symbolCount, sizeof(symbolCount));
+    streamByteCount += sizeof(symbolCount);
+
+    uint32_t start = 0;
+    for (f = 0; (f < 256) && symbolCount; f++)
+    {
+      if (!freq[f])
+        continue;
+
+      uint8_t symbol = (uint8_t)f;
+      uint16_t symbolFreq = (uint16_t)freq[f];
+      outputByteStream_arg.write ((const char*)&symbol, sizeof(symbol));
+      outputByteStream_arg.write ((const char*)&symbolFreq, sizeof(symbolFreq));
+      streamByteCount += sizeof(symbol) + sizeof(symbolFreq);
+
+      // precompute encoder parameters (reciprocal instead of division)
+      EncSymbol& s = symbols[f];
+      s.xMax = ((stateLowerBound_ >> scaleBits_) << 8) * freq[f];
+      s.cmplFreq = (uint16_t)(scale - freq[f]);
+      if (freq[f] < 2)
+      {
+        s.rcpFreq = ~0u;
+        s.rcpShift = 0;
+        s.bias = start + scale - 1;
+      }
+      else
+      {
+        uint32_t shift = 0;
+        while (freq[f] > (1u << shift))
+          shift++;
+        s.rcpFreq = (uint32_t)((((uint64_t)1 << (shift + 31)) + freq[f] - 1) / freq[f]);
+        s.rcpShift = (uint16_t)(shift - 1);
+        s.bias = start;
+      }
+      start += freq[f];
+    }
+
+    // encode backwards into the output buffer (a symbol costs at most scaleBits_ bits, plus state flush)
+    outputCharVector_.resize (2 * input_size + 2 * interleave_ * sizeof(uint32_t));
+    uint8_t* outEnd = &outputCharVector_[0] + outputCharVector_.size ();
+    uint8_t* ptr = outEnd;
+
+    uint32_t states[interleave_];
+    for (i = 0; i < interleave_; i++)
+      states[i] = stateLowerBound_;
+
+    for (i = input_size; i > 0; i--)
+    {
+      const EncSymbol& s = symbols[input[i - 1]];
+      uint32_t& x = states[(i - 1) & (interleave_ - 1)];
+
+      // renormalize
+      while (x >= s.xMax)
+      {
+        *--ptr = (uint8_t)(x & 0xff);
+        x >>= 8;
+      }
+
+      // x = (x / freq) * scale + (x % freq) + start
+      uint32_t q = (uint32_t)(((uint64_t)x * s.rcpFreq) >> 32) >> s.rcpShift;
+      x = x + s.bias + q * s.cmplFreq;
+    }
+
+    // flush states, state 0 ends up first
+    for (i = interleave_; i > 0; i--)
+    {
+      uint32_t x = states[i - 1];
+      ptr -= 4;
+      ptr[0] = (uint8_t)(x >> 0);
+      ptr[1] = (uint8_t)(x >> 8);
+      ptr[2] = (uint8_t)(x >> 16);
+      ptr[3] = (uint8_t)(x >> 24);
+    }
+
+    // write encoded data to stream
+    uint32_t payloadSize = (uint32_t)(outEnd - ptr);
+    outputByteStream_arg.write ((const char*)&payloadSize, sizeof(payloadSize));
+    outputByteStream_arg.write ((const char*)ptr, payloadSize);
+    streamByteCount += sizeof(payloadSize) + payloadSize;
+
+    return streamByteCount;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  unsigned long
+  StaticRANSCoder::decodeStreamToCharVector (std::istream& inputByteStream_arg,
+                                             std::vector<char>& outputByteVector_arg)
+  {
+    const uint32_t scale = 1u << scaleBits_;
+    uint32_t freq[256];
+    uint32_t start[256];
+    unsigned long streamByteCount = 0;
+    size_t i;
+
+    // read sparse frequency table
+    uint16_t symbolCount;
+    inputByteStream_arg.read ((char*)&symbolCount, sizeof(symbolCount));
+    streamByteCount += sizeof(symbolCount);
+
+    // slot to symbol lookup table
+    std::vector<uint8_t> slotTable (scale);
+    uint32_t cumFreq = 0;
+    memset (freq, 0, sizeof(freq));
+    for (i = 0; i < symbolCount; i++)
+    {
+      uint8_t symbol;
+      uint16_t symbolFreq;
+      inputByteStream_arg.read ((char*)&symbol, sizeof(symbol));
+      inputByteStream_arg.read ((char*)&symbolFreq, sizeof(symbolFreq));
+      streamByteCount += sizeof(symbol) + sizeof(symbolFreq);
+
+      freq[symbol] = symbolFreq;
+      start[symbol] = cumFreq;
+      if (!freq[symbol] || (cumFreq + freq[symbol] > scale))
+        return (streamByteCount);
+      memset (&slotTable[cumFreq], symbol, freq[symbol]);
+      cumFreq += freq[symbol];
+    }
+
+    // read encoded data
+    uint32_t payloadSize;
+    inputByteStream_arg.read ((char*)&payloadSize, sizeof(payloadSize));
+    streamByteCount += sizeof(payloadSize);
+
+    inputCharVector_.resize (payloadSize + sizeof(uint32_t));
+    if (payloadSize)
+      inputByteStream_arg.read ((char*)&inputCharVector_[0], payloadSize);
+    streamByteCount += payloadSize;
+
+    const size_t output_size = outputByteVector_arg.size ();
+    if (!output_size || (payloadSize < interleave_ * sizeof(uint32_t)))
+      return (streamByteCount);
+
+    // guard against corrupt streams reading past the payload
+    memset (&inputCharVector_[payloadSize], 0, sizeof(uint32_t));
+    const uint8_t* ptr = &inputCharVector_[0];
+    const uint8_t* ptrEnd = ptr + payloadSize;
+
+    // init states
+    uint32_t states[interleave_];
+    for (i = 0; i < interleave_; i++)
+    {
+      states[i] = (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) | ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+      ptr += 4;
+    }
+
+    // decoding
+    char* output = &outputByteVector_arg[0];
+    for (i = 0; i < output_size; i++)
+    {
+      uint32_t& x = states[i & (interleave_ - 1)];
+
+      // symbol lookup in slot table
+      uint32_t slot = x & (scale - 1);
+      uint8_t symbol = slotTable[slot];
+      output[i] = (char)symbol;
+
+      x = freq[symbol] * (x >> scaleBits_) + slot - start[symbol];
+
+      // renormalize
+      while ((x < stateLowerBound_) && (ptr < ptrEnd))
+        x = (x << 8) | *ptr++;
+    }
+
+    return streamByteCount;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  unsigned long
+  StaticRANSCoder::encodeIntVectorToStream (std::vector<unsigned int>& inputIntVector_arg,
+                                            std::ostream& outputByteStream_arg)
+  {
+    // variable length byte code, 7 data bits per byte, high bit marks continuation
+    std::vector<char> byteVector;
+    byteVector.reserve (inputIntVector_arg.size () + inputIntVector_arg.size () / 4);
+    for (size_t i = 0; i < inputIntVector_arg.size (); i++)
+    {
+      unsigned int value = inputIntVector_arg[i];
+      while (value >= 0x80)
+      {
+        byteVector.push_back ((char)((value & 0x7f) | 0x80));
+        value >>= 7;
+      }
+      byteVector.push_back ((char)value);
+    }
+
+    uint64_t byteVectorSize = byteVector.size ();
+    outputByteStream_arg.write ((const char*)&byteVectorSize, sizeof(byteVectorSize));
+
+    return (sizeof(byteVectorSize) + encodeCharVectorToStream (byteVector, outputByteStream_arg));
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  unsigned long
+  StaticRANSCoder::decodeStreamToIntVector (std::istream& inputByteStream_arg,
+                                            std::vector<unsigned int>& outputIntVector_arg)
+  {
+    uint64_t byteVectorSize;
+    inputByteStream_arg.read ((char*)&byteVectorSize, sizeof(byteVectorSize));
+
+    std::vector<char> byteVector ((size_t)byteVectorSize);
+    unsigned long streamByteCount = sizeof(byteVectorSize)
+        + decodeStreamToCharVector (inputByteStream_arg, byteVector);
+
+    size_t readPos = 0;
+    for (size_t i = 0; i < outputIntVector_arg.size (); i++)
+    {
+      unsigned int value = 0;
+      unsigned int shift = 0;
+      while (readPos < byteVector.size ())
+      {
+        uint8_t ch = (uint8_t)byteVector[readPos++];
+        value |= (unsigned int)(ch & 0x7f) << shift;
+        shift += 7;
+        if (!(ch & 0x80))
+          break;
+      }
+      outputIntVector_arg[i] = value;
+    }
+
+    return streamByteCount;
+  }
+
+}
+
+#endif
@@ -39,9 +39,14 @@
 
 #include "pcl/octree/octree_pointcloud.h"
 #include "pcl/compression/entropy_range_coder.h"
+#include "pcl/compression/entropy_rans_coder.h"
 
+#include "pcl/console/print.h"
+
+#include <algorithm>
 #include <iterator>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string.h>
 #include <iostream>
@@ -116,6 +121,13 @@ namespace pcl
         pointCoder_.initializeEncoding ();
         pointCoder_.setPointCount (cloud_arg->points.size ());
 
+        // the subtree split depth is part of the I-frame configuration
+        if (iFrame_)
+          subtreeDepth_ = (unsigned char)std::min<unsigned int> (subtreeDepthArg_, this->getTreeDepth ());
+
+        leafKeys_.clear ();
+        leafIdxVectors_.clear ();
+
         // serialize octree
         if (iFrame_) {
           // i-frame encoding - encode tree structure without referencing previous buffer
@@ -125,6 +137,10 @@ namespace pcl
           this->serializeTree (binaryTreeDataVector_, true);
         }
 
+        // encode leaf data of independent subtrees
+        if (subtreeDepth_ > 0)
+          this->encodeSubtrees ();
+
         // write frame header information to stream
         this->writeFrameHeader (compressedTreeDataOut_arg);
 
@@ -208,7 +224,10 @@ namespace pcl
 
         // initialize output cloud
         output_->points.clear ();
-        output_->points.reserve (pointCount_);
+        leafKeys_.clear ();
+
+        if (subtreeDepth_ == 0)
+          output_->points.reserve (pointCount_);
 
         if (iFrame_)
           // i-frame decoding - decode tree structure without referencing previous buffer
@@ -217,6 +236,13 @@ namespace pcl
           // p-frame decoding - decode XOR encoded tree structure
           this->deserializeTree (binaryTreeDataVector_, true);
 
+        // decode leaf data of independent subtrees
+        if ((subtreeDepth_ > 0) && !this->decodeSubtrees ())
+        {
+          PCL_ERROR ("[pcl::octree::PointCloudCompression::decodePointCloud] Subtree table does not match the octree structure!\n");
+          output_->points.clear ();
+        }
+
         // assign point cloud properties
         output_->height = 1;
         output_->width = cloud_arg->points.size ();
@@ -262,59 +288,122 @@ namespace pcl
       void
       PointCloudCompression<PointT, LeafT, OctreeT>::entropyEncoding (std::ostream& compressedTreeDataOut_arg)
       {
-        uint64_t binaryTreeDataVector_size;
-        uint64_t pointAvgColorDataVector_size;
+        if (entropyCoderType_ == RANS_CODER)
+          entropyEncodingT<StaticRANSCoder> (compressedTreeDataOut_arg);
+        else
+          entropyEncodingT<StaticRangeCoder> (compressedTreeDataOut_arg);
+      }
 
-        compressedPointDataLen_ = 0;
-        compressedColorDataLen_ = 0;
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::entropyDecoding (std::istream& compressedTreeDataIn_arg)
+      {
+        if (entropyCoderType_ == RANS_CODER)
+          entropyDecodingT<StaticRANSCoder> (compressedTreeDataIn_arg);
+        else
+          entropyDecodingT<StaticRangeCoder> (compressedTreeDataIn_arg);
+      }
 
-        // encode binary octree structure
-        binaryTreeDataVector_size = binaryTreeDataVector_.size ();
-        compressedTreeDataOut_arg.write ((const char*)&binaryTreeDataVector_size, sizeof(binaryTreeDataVector_size));
-        compressedPointDataLen_ += entropyCoder_.encodeCharVectorToStream (binaryTreeDataVector_,
-                                                                           compressedTreeDataOut_arg);
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT> template<typename EntropyCoderT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::entropyEncodingT (std::ostream& compressedTreeDataOut_arg)
+      {
+        // leaf data sub-streams in stream order: averaged voxel colors, points per voxel, differential points,
+        // differential colors. They are written once for the whole octree or once per subtree.
+        const int leafSubStreamCount = 4;
+        const bool encodeLeafSubStream[leafSubStreamCount] = { cloudWithColor_, !doVoxelGridEnDecoding_,
+                                                               !doVoxelGridEnDecoding_,
+                                                               !doVoxelGridEnDecoding_ && cloudWithColor_ };
+        const bool colorLeafSubStream[leafSubStreamCount] = { true, false, false, true };
+
+        // collect all independent sub-streams, starting with the octree structure
+        std::vector<std::vector<char>*> charSubStreams (1, &binaryTreeDataVector_);
+        std::vector<std::vector<unsigned int>*> intSubStreams (1, static_cast<std::vector<unsigned int>*> (0));
+        std::vector<bool> colorSubStreams (1, false);
+
+        const std::size_t leafDataCount = (subtreeDepth_ > 0) ? subtrees_.size () : 1;
+        for (std::size_t s = 0; s < leafDataCount; ++s)
+        {
+          PointCoding<PointT>& pointCoder = (subtreeDepth_ > 0) ? subtrees_[s].pointCoder : pointCoder_;
+          ColorCoding<PointT>& colorCoder = (subtreeDepth_ > 0) ? subtrees_[s].colorCoder : colorCoder_;
+          std::vector<unsigned int>& pointCountDataVector = (subtreeDepth_ > 0) ? subtrees_[s].pointCountDataVector
+                                                                                : pointCountDataVector_;
+          std::vector<char>* charLeafSubStream[leafSubStreamCount] = { &colorCoder.getAverageDataVector (),
+                                                                       0,
+                                                                       &pointCoder.getDifferentialDataVector (),
+                                                                       &colorCoder.getDifferentialDataVector () };
+          for (int i = 0; i < leafSubStreamCount; ++i)
+          {
+            if (!encodeLeafSubStream[i])
+              continue;
+            charSubStreams.push_back (charLeafSubStream[i]);
+            intSubStreams.push_back (charLeafSubStream[i] ? 0 : &pointCountDataVector);
+            colorSubStreams.push_back (colorLeafSubStream[i]);
+          }
+        }
 
-        if (cloudWithColor_)
+        const int subStreamCount = (int)charSubStreams.size ();
+        std::vector<std::string> subStreamData (subStreamCount);
+        std::vector<unsigned long> compressedLen (subStreamCount);
+
+#pragma omp parallel for schedule (dynamic, 1)
+        for (int i = 0; i < subStreamCount; ++i)
         {
-          // encode averaged voxel color information
-          std::vector<char>& pointAvgColorDataVector = colorCoder_.getAverageDataVector ();
-          pointAvgColorDataVector_size = pointAvgColorDataVector.size ();
-          compressedTreeDataOut_arg.write ((const char*)&pointAvgColorDataVector_size,
-                                           sizeof(pointAvgColorDataVector_size));
-          compressedColorDataLen_ += entropyCoder_.encodeCharVectorToStream (pointAvgColorDataVector,
-                                                                             compressedTreeDataOut_arg);
+          // every sub-stream uses its own coder instance
+          EntropyCoderT entropyCoder;
+          std::stringstream subStream;
+          uint64_t vectorSize;
+          if (charSubStreams[i])
+          {
+            vectorSize = charSubStreams[i]->size ();
+            subStream.write ((const char*)&vectorSize, sizeof(vectorSize));
+            compressedLen[i] = entropyCoder.encodeCharVectorToStream (*charSubStreams[i], subStream);
+          }
+          else
+          {
+            vectorSize = intSubStreams[i]->size ();
+            subStream.write ((const char*)&vectorSize, sizeof(vectorSize));
+            compressedLen[i] = entropyCoder.encodeIntVectorToStream (*intSubStreams[i], subStream);
+          }
+          subStreamData[i] = subStream.str ();
         }
 
+        // write octree structure
+        compressedTreeDataOut_arg.write (subStreamData[0].data (), subStreamData[0].size ());
 
-        if (!doVoxelGridEnDecoding_)
+        if (subtreeDepth_ > 0)
         {
-          uint64_t pointCountDataVector_size;
-          uint64_t pointDiffDataVector_size;
-          uint64_t pointDiffColorDataVector_size;
+          // write subtree table: amount of decoded points and compressed size of every subtree
+          const int subStreamsPerSubtree = std::count (encodeLeafSubStream, encodeLeafSubStream + leafSubStreamCount,
+                                                       true);
+          uint32_t subtreeCount = (uint32_t)subtrees_.size ();
+          compressedTreeDataOut_arg.write ((const char*)&subtreeCount, sizeof(subtreeCount));
 
-          // encode amount of points per voxel
-          pointCountDataVector_size = pointCountDataVector_.size ();
-          compressedTreeDataOut_arg.write ((const char*)&pointCountDataVector_size, sizeof(pointCountDataVector_size));
-          compressedPointDataLen_ += entropyCoder_.encodeIntVectorToStream (pointCountDataVector_,
-                                                                            compressedTreeDataOut_arg);
-
-          // encode differential point information
-          std::vector<char>& pointDiffDataVector = pointCoder_.getDifferentialDataVector ();
-          pointDiffDataVector_size = pointDiffDataVector.size ();
-          compressedTreeDataOut_arg.write ((const char*)&pointDiffDataVector_size, sizeof(pointDiffDataVector_size));
-          compressedPointDataLen_ += entropyCoder_.encodeCharVectorToStream (pointDiffDataVector,
-                                                                             compressedTreeDataOut_arg);
-          if (cloudWithColor_)
+          for (std::size_t s = 0; s < subtrees_.size (); ++s)
           {
-            // encode differential color information
-            std::vector<char>& pointDiffColorDataVector = colorCoder_.getDifferentialDataVector ();
-            pointDiffColorDataVector_size = pointDiffColorDataVector.size ();
-            compressedTreeDataOut_arg.write ((const char*)&pointDiffColorDataVector_size,
-                                             sizeof(pointDiffColorDataVector_size));
-            compressedColorDataLen_ += entropyCoder_.encodeCharVectorToStream (pointDiffColorDataVector,
-                                                                               compressedTreeDataOut_arg);
+            uint64_t subtreeSize = 0;
+            for (int i = 0; i < subStreamsPerSubtree; ++i)
+              subtreeSize += subStreamData[1 + s * subStreamsPerSubtree + i].size ();
+
+            compressedTreeDataOut_arg.write ((const char*)&subtrees_[s].pointCount, sizeof(subtrees_[s].pointCount));
+            compressedTreeDataOut_arg.write ((const char*)&subtreeSize, sizeof(subtreeSize));
           }
+        }
 
+        compressedPointDataLen_ = compressedLen[0];
+        compressedColorDataLen_ = 0;
+
+        // write leaf data
+        for (int i = 1; i < subStreamCount; ++i)
+        {
+          compressedTreeDataOut_arg.write (subStreamData[i].data (), subStreamData[i].size ());
+
+          if (colorSubStreams[i])
+            compressedColorDataLen_ += compressedLen[i];
+          else
+            compressedPointDataLen_ += compressedLen[i];
         }
 
         // flush output stream
@@ -322,12 +411,12 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename PointT, typename LeafT, typename OctreeT>
+    template<typename PointT, typename LeafT, typename OctreeT> template<typename EntropyCoderT>
       void
-      PointCloudCompression<PointT, LeafT, OctreeT>::entropyDecoding (std::istream& compressedTreeDataIn_arg)
+      PointCloudCompression<PointT, LeafT, OctreeT>::entropyDecodingT (std::istream& compressedTreeDataIn_arg)
       {
+        EntropyCoderT entropyCoder;
         uint64_t binaryTreeDataVector_size;
-        uint64_t pointAvgColorDataVector_size;
 
         compressedPointDataLen_ = 0;
         compressedColorDataLen_ = 0;
@@ -335,17 +424,85 @@ namespace pcl
         // decode binary octree structure
         compressedTreeDataIn_arg.read ((char*)&binaryTreeDataVector_size, sizeof(binaryTreeDataVector_size));
         binaryTreeDataVector_.resize (binaryTreeDataVector_size);
-        compressedPointDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
+        compressedPointDataLen_ += entropyCoder.decodeStreamToCharVector (compressedTreeDataIn_arg,
                                                                            binaryTreeDataVector_);
 
+        if (subtreeDepth_ == 0)
+        {
+          // decode leaf data of the whole octree
+          this->entropyDecodingLeafData (entropyCoder, compressedTreeDataIn_arg, pointCountDataVector_,
+                                         pointCoder_, colorCoder_, compressedPointDataLen_, compressedColorDataLen_);
+          pointCountDataVectorIterator_ = pointCountDataVector_.begin ();
+          return;
+        }
+
+        // read subtree table
+        uint32_t subtreeCount = 0;
+        compressedTreeDataIn_arg.read ((char*)&subtreeCount, sizeof(subtreeCount));
+        if (!compressedTreeDataIn_arg)
+          subtreeCount = 0;
+
+        subtrees_.resize (subtreeCount);
+        std::vector<uint64_t> subtreeSize (subtreeCount);
+        for (uint32_t s = 0; s < subtreeCount; ++s)
+        {
+          compressedTreeDataIn_arg.read ((char*)&subtrees_[s].pointCount, sizeof(subtrees_[s].pointCount));
+          compressedTreeDataIn_arg.read ((char*)&subtreeSize[s], sizeof(subtreeSize[s]));
+        }
+
+        // read the leaf data of all subtrees, they are decoded in parallel
+        for (uint32_t s = 0; s < subtreeCount; ++s)
+        {
+          subtrees_[s].compressedData.resize (subtreeSize[s]);
+          if (subtreeSize[s] > 0)
+            compressedTreeDataIn_arg.read (&subtrees_[s].compressedData[0], subtreeSize[s]);
+        }
+
+#pragma omp parallel for schedule (dynamic, 1)
+        for (int s = 0; s < (int)subtreeCount; ++s)
+        {
+          SubtreeCoding& subtree = subtrees_[s];
+
+          // configure subtree coders like the frame coders
+          subtree.pointCoder.setPrecision (pointCoder_.getPrecision ());
+          subtree.colorCoder.setBitDepth (colorCoder_.getBitDepth ());
+          subtree.compressedPointDataLen = 0;
+          subtree.compressedColorDataLen = 0;
+
+          EntropyCoderT subtreeEntropyCoder;
+          std::istringstream subtreeStream (subtree.compressedData);
+          this->entropyDecodingLeafData (subtreeEntropyCoder, subtreeStream, subtree.pointCountDataVector,
+                                         subtree.pointCoder, subtree.colorCoder,
+                                         subtree.compressedPointDataLen, subtree.compressedColorDataLen);
+          subtree.compressedData.clear ();
+        }
+
+        for (uint32_t s = 0; s < subtreeCount; ++s)
+        {
+          compressedPointDataLen_ += subtrees_[s].compressedPointDataLen;
+          compressedColorDataLen_ += subtrees_[s].compressedColorDataLen;
+        }
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT> template<typename EntropyCoderT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::entropyDecodingLeafData (
+          EntropyCoderT& entropyCoder_arg, std::istream& compressedTreeDataIn_arg,
+          std::vector<unsigned int>& pointCountDataVector_arg,
+          PointCoding<PointT>& pointCoder_arg, ColorCoding<PointT>& colorCoder_arg,
+          uint64_t& compressedPointDataLen_arg, uint64_t& compressedColorDataLen_arg)
+      {
+        uint64_t pointAvgColorDataVector_size;
+
         if (dataWithColor_)
         {
           // decode averaged voxel color information
-          std::vector<char>& pointAvgColorDataVector = colorCoder_.getAverageDataVector ();
+          std::vector<char>& pointAvgColorDataVector = colorCoder_arg.getAverageDataVector ();
           compressedTreeDataIn_arg.read ((char*)&pointAvgColorDataVector_size, sizeof(pointAvgColorDataVector_size));
           pointAvgColorDataVector.resize (pointAvgColorDataVector_size);
-          compressedColorDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                             pointAvgColorDataVector);
+          compressedColorDataLen_arg += entropyCoder_arg.decodeStreamToCharVector (compressedTreeDataIn_arg,
+                                                                                   pointAvgColorDataVector);
         }
 
         if (!doVoxelGridEnDecoding_)
@@ -356,29 +513,27 @@ namespace pcl
 
           // decode amount of points per voxel
           compressedTreeDataIn_arg.read ((char*)&pointCountDataVector_size, sizeof(pointCountDataVector_size));
-          pointCountDataVector_.resize (pointCountDataVector_size);
-          compressedPointDataLen_ += entropyCoder_.decodeStreamToIntVector (compressedTreeDataIn_arg, pointCountDataVector_);
-          pointCountDataVectorIterator_ = pointCountDataVector_.begin ();
+          pointCountDataVector_arg.resize (pointCountDataVector_size);
+          compressedPointDataLen_arg += entropyCoder_arg.decodeStreamToIntVector (compressedTreeDataIn_arg,
+                                                                                  pointCountDataVector_arg);
 
           // decode differential point information
-          std::vector<char>& pointDiffDataVector = pointCoder_.getDifferentialDataVector ();
+          std::vector<char>& pointDiffDataVector = pointCoder_arg.getDifferentialDataVector ();
           compressedTreeDataIn_arg.read ((char*)&pointDiffDataVector_size, sizeof(pointDiffDataVector_size));
           pointDiffDataVector.resize (pointDiffDataVector_size);
-          compressedPointDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                             pointDiffDataVector);
+          compressedPointDataLen_arg += entropyCoder_arg.decodeStreamToCharVector (compressedTreeDataIn_arg,
+                                                                                   pointDiffDataVector);
 
           if (dataWithColor_)
           {
             // decode differential color information
-            std::vector<char>& pointDiffColorDataVector = colorCoder_.getDifferentialDataVector ();
+            std::vector<char>& pointDiffColorDataVector = colorCoder_arg.getDifferentialDataVector ();
             compressedTreeDataIn_arg.read ((char*)&pointDiffColorDataVector_size, sizeof(pointDiffColorDataVector_size));
             pointDiffColorDataVector.resize (pointDiffColorDataVector_size);
-            compressedColorDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                               pointDiffColorDataVector);
+            compressedColorDataLen_arg += entropyCoder_arg.decodeStreamToCharVector (compressedTreeDataIn_arg,
+                                                                                     pointDiffColorDataVector);
           }
-
         }
-
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
@@ -432,6 +587,13 @@ namespace pcl
           compressedTreeDataOut_arg.write ((const char*)&maxY, sizeof(maxY));
           compressedTreeDataOut_arg.write ((const char*)&maxZ, sizeof(maxZ));
 
+          // encode entropy coder backend
+          unsigned char entropyCoderType = (unsigned char)entropyCoderType_;
+          compressedTreeDataOut_arg.write ((const char*)&entropyCoderType, sizeof(entropyCoderType));
+
+          // encode subtree split depth
+          compressedTreeDataOut_arg.write ((const char*)&subtreeDepth_, sizeof(subtreeDepth_));
+
         }
       }
 
@@ -480,6 +642,14 @@ namespace pcl
           compressedTreeDataIn_arg.read ((char*)&maxY, sizeof(maxY));
           compressedTreeDataIn_arg.read ((char*)&maxZ, sizeof(maxZ));
 
+          // read entropy coder backend
+          unsigned char entropyCoderType;
+          compressedTreeDataIn_arg.read ((char*)&entropyCoderType, sizeof(entropyCoderType));
+          entropyCoderType_ = (entropyCoderType == RANS_CODER) ? RANS_CODER : RANGE_CODER;
+
+          // read subtree split depth
+          compressedTreeDataIn_arg.read ((char*)&subtreeDepth_, sizeof(subtreeDepth_));
+
           // reset octree and assign new bounding box & resolution
           this->deleteTree ();
           this->setResolution (octreeResolution);
@@ -496,18 +666,18 @@ namespace pcl
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename OctreeT>
       void
-      PointCloudCompression<PointT, LeafT, OctreeT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      PointCloudCompression<PointT, LeafT, OctreeT>::encodeLeaf (const std::vector<int>& leafIdx_arg,
+                                                                 const OctreeKey& key_arg,
+                                                                 std::vector<unsigned int>& pointCountDataVector_arg,
+                                                                 PointCoding<PointT>& pointCoder_arg,
+                                                                 ColorCoding<PointT>& colorCoder_arg)
       {
-
-      // reference to point indices vector stored within octree leaf
-      const std::vector<int>& leafIdx = leaf_arg.getIdxVector ();
-
         if (!doVoxelGridEnDecoding_)
         {
           double lowerVoxelCorner[3];
 
           // encode amount of points within voxel
-          pointCountDataVector_.push_back ((int)leafIdx.size ());
+          pointCountDataVector_arg.push_back ((int)leafIdx_arg.size ());
 
           // calculate lower voxel corner based on octree key
           lowerVoxelCorner[0] = ((double)key_arg.x) * this->resolution_ + this->minX_;
@@ -515,12 +685,12 @@ namespace pcl
           lowerVoxelCorner[2] = ((double)key_arg.z) * this->resolution_ + this->minZ_;
 
           // differentially encode points to lower voxel corner
-          pointCoder_.encodePoints (leafIdx, lowerVoxelCorner, this->input_);
+          pointCoder_arg.encodePoints (leafIdx_arg, lowerVoxelCorner, this->input_);
 
           if (cloudWithColor_)
           {
             // encode color of points
-            colorCoder_.encodePoints (leafIdx, pointColorOffset_, this->input_);
+            colorCoder_arg.encodePoints (leafIdx_arg, pointColorOffset_, this->input_);
           }
 
         }
@@ -529,7 +699,7 @@ namespace pcl
           if (cloudWithColor_)
           {
             // encode average color of all points within voxel
-            colorCoder_.encodeAverageOfPoints (leafIdx, pointColorOffset_, this->input_);
+            colorCoder_arg.encodeAverageOfPoints (leafIdx_arg, pointColorOffset_, this->input_);
           }
         }
 
@@ -538,28 +708,14 @@ namespace pcl
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename OctreeT>
       void
-      PointCloudCompression<PointT, LeafT, OctreeT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      PointCloudCompression<PointT, LeafT, OctreeT>::decodeLeaf (const OctreeKey& key_arg, std::size_t pointBegin_arg,
+                                                                 std::size_t pointCount_arg,
+                                                                 PointCoding<PointT>& pointCoder_arg,
+                                                                 ColorCoding<PointT>& colorCoder_arg)
       {
-        double lowerVoxelCorner[3];
-        std::size_t pointCount, i, cloudSize;
-        PointT newPoint;
-
-        pointCount = 1;
-
         if (!doVoxelGridEnDecoding_)
         {
-          // get current cloud size
-          cloudSize = this->output_->points.size ();
-
-          // get amount of point to be decoded
-          pointCount = *pointCountDataVectorIterator_;
-          pointCountDataVectorIterator_++;
-
-          // increase point cloud by amount of voxel points
-          for (i = 0; i < pointCount; i++)
-          {
-            this->output_->points.push_back (newPoint);
-          }
+          double lowerVoxelCorner[3];
 
           // calculcate position of lower voxel corner
           lowerVoxelCorner[0] = ((double)key_arg.x) * this->resolution_ + this->minX_;
@@ -567,19 +723,18 @@ namespace pcl
           lowerVoxelCorner[2] = ((double)key_arg.z) * this->resolution_ + this->minZ_;
 
           // decode differentially encoded points
-          pointCoder_.decodePoints (this->output_, lowerVoxelCorner, cloudSize, cloudSize + pointCount);
+          pointCoder_arg.decodePoints (this->output_, lowerVoxelCorner, pointBegin_arg, pointBegin_arg + pointCount_arg);
 
         }
         else
         {
+          PointT& newPoint = this->output_->points[pointBegin_arg];
+
           // calculcate center of lower voxel corner
           newPoint.x = ((double)key_arg.x + 0.5) * this->resolution_ + this->minX_;
           newPoint.y = ((double)key_arg.y + 0.5) * this->resolution_ + this->minY_;
           newPoint.z = ((double)key_arg.z + 0.5) * this->resolution_ + this->minZ_;
 
-          // add point to point cloud
-          this->output_->points.push_back (newPoint);
-
         }
 
         if (cloudWithColor_)
@@ -587,18 +742,182 @@ namespace pcl
           if (dataWithColor_)
           {
             // decode color information
-            colorCoder_.decodePoints (this->output_, this->output_->points.size () - pointCount,
-                                      this->output_->points.size (), pointColorOffset_);
+            colorCoder_arg.decodePoints (this->output_, pointBegin_arg, pointBegin_arg + pointCount_arg,
+                                         pointColorOffset_);
           }
           else
           {
             // set default color information
-            colorCoder_.setDefaultColor (this->output_, this->output_->points.size () - pointCount,
-                                         this->output_->points.size (), pointColorOffset_);
+            colorCoder_arg.setDefaultColor (this->output_, pointBegin_arg, pointBegin_arg + pointCount_arg,
+                                            pointColorOffset_);
           }
         }
 
       }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::computeSubtreeBoundaries (
+          std::vector<std::size_t>& leafBoundaries_arg) const
+      {
+        // subtrees are identified by the upper key bits
+        const unsigned int shift = this->getTreeDepth () - std::min<unsigned int> (subtreeDepth_, this->getTreeDepth ());
+
+        leafBoundaries_arg.clear ();
+        for (std::size_t i = 0; i < leafKeys_.size (); ++i)
+        {
+          // depth-first serialization keeps the leaves of a subtree contiguous
+          if ((i == 0) || ((leafKeys_[i].x >> shift) != (leafKeys_[i - 1].x >> shift))
+                       || ((leafKeys_[i].y >> shift) != (leafKeys_[i - 1].y >> shift))
+                       || ((leafKeys_[i].z >> shift) != (leafKeys_[i - 1].z >> shift)))
+          {
+            leafBoundaries_arg.push_back (i);
+          }
+        }
+        leafBoundaries_arg.push_back (leafKeys_.size ());
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::encodeSubtrees ()
+      {
+        std::vector<std::size_t> leafBoundaries;
+        this->computeSubtreeBoundaries (leafBoundaries);
+
+        const int subtreeCount = (int)leafBoundaries.size () - 1;
+        subtrees_.resize (subtreeCount);
+
+#pragma omp parallel for schedule (dynamic, 1)
+        for (int s = 0; s < subtreeCount; ++s)
+        {
+          SubtreeCoding& subtree = subtrees_[s];
+          subtree.leafBegin = leafBoundaries[s];
+          subtree.leafEnd = leafBoundaries[s + 1];
+          subtree.pointCount = 0;
+
+          // configure subtree coders like the frame coders
+          subtree.pointCoder.setPrecision (pointCoder_.getPrecision ());
+          subtree.colorCoder.setBitDepth (colorCoder_.getBitDepth ());
+          subtree.pointCoder.initializeEncoding ();
+          subtree.colorCoder.initializeEncoding ();
+          subtree.pointCountDataVector.clear ();
+
+          for (std::size_t l = subtree.leafBegin; l < subtree.leafEnd; ++l)
+          {
+            const std::vector<int>& leafIdx = *leafIdxVectors_[l];
+            this->encodeLeaf (leafIdx, leafKeys_[l], subtree.pointCountDataVector,
+                              subtree.pointCoder, subtree.colorCoder);
+
+            // amount of points reconstructed by the decoder
+            subtree.pointCount += doVoxelGridEnDecoding_ ? 1 : leafIdx.size ();
+          }
+        }
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      bool
+      PointCloudCompression<PointT, LeafT, OctreeT>::decodeSubtrees ()
+      {
+        std::vector<std::size_t> leafBoundaries;
+        this->computeSubtreeBoundaries (leafBoundaries);
+
+        const int subtreeCount = (int)leafBoundaries.size () - 1;
+        if (subtreeCount != (int)subtrees_.size ())
+          return (false);
+
+        // assign leaf and output point ranges, check them against the decoded point counts
+        uint64_t cloudSize = 0;
+        for (int s = 0; s < subtreeCount; ++s)
+        {
+          SubtreeCoding& subtree = subtrees_[s];
+          subtree.leafBegin = leafBoundaries[s];
+          subtree.leafEnd = leafBoundaries[s + 1];
+          subtree.pointBegin = cloudSize;
+          cloudSize += subtree.pointCount;
+
+          uint64_t pointCount = subtree.leafEnd - subtree.leafBegin;
+          if (!doVoxelGridEnDecoding_)
+          {
+            if (subtree.pointCountDataVector.size () != subtree.leafEnd - subtree.leafBegin)
+              return (false);
+            pointCount = 0;
+            for (std::size_t i = 0; i < subtree.pointCountDataVector.size (); ++i)
+              pointCount += subtree.pointCountDataVector[i];
+          }
+          if (pointCount != subtree.pointCount)
+            return (false);
+        }
+
+        this->output_->points.resize (cloudSize);
+
+#pragma omp parallel for schedule (dynamic, 1)
+        for (int s = 0; s < subtreeCount; ++s)
+        {
+          SubtreeCoding& subtree = subtrees_[s];
+          subtree.pointCoder.initializeDecoding ();
+          subtree.colorCoder.initializeDecoding ();
+
+          std::vector<unsigned int>::const_iterator pointCountIterator = subtree.pointCountDataVector.begin ();
+          std::size_t pointBegin = subtree.pointBegin;
+
+          for (std::size_t l = subtree.leafBegin; l < subtree.leafEnd; ++l)
+          {
+            std::size_t pointCount = doVoxelGridEnDecoding_ ? 1 : *(pointCountIterator++);
+            this->decodeLeaf (leafKeys_[l], pointBegin, pointCount, subtree.pointCoder, subtree.colorCoder);
+            pointBegin += pointCount;
+          }
+        }
+
+        return (true);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      {
+        if (subtreeDepth_ > 0)
+        {
+          // leaf data is encoded per subtree once the octree structure is serialized
+          leafKeys_.push_back (key_arg);
+          leafIdxVectors_.push_back (&leaf_arg.getIdxVector ());
+        }
+        else
+        {
+          this->encodeLeaf (leaf_arg.getIdxVector (), key_arg, pointCountDataVector_, pointCoder_, colorCoder_);
+        }
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::deserializeLeafCallback (OctreeLeaf&, const OctreeKey& key_arg)
+      {
+        if (subtreeDepth_ > 0)
+        {
+          // leaf data is decoded per subtree once the octree structure is deserialized
+          leafKeys_.push_back (key_arg);
+          return;
+        }
+
+        std::size_t pointCount = 1;
+        std::size_t cloudSize = this->output_->points.size ();
+
+        if (!doVoxelGridEnDecoding_)
+        {
+          // get amount of point to be decoded
+          pointCount = *pointCountDataVectorIterator_;
+          pointCountDataVectorIterator_++;
+        }
+
+        // increase point cloud by amount of voxel points
+        this->output_->points.resize (cloudSize + pointCount);
+
+        this->decodeLeaf (key_arg, cloudSize, pointCount, pointCoder_, colorCoder_);
+      }
   }
 }
 
@@ -0,0 +1,309 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef OCTREE_COMPRESSION_STREAM_HPP
+#define OCTREE_COMPRESSION_STREAM_HPP
+
+#include <algorithm>
+#include <string.h>
+
+namespace pcl
+{
+  namespace octree
+  {
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      bool
+      CompressedStreamWriter<PointT>::open (const std::string& fileName_arg)
+      {
+        close ();
+        index_.clear ();
+
+        file_.open (fileName_arg.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file_.is_open ())
+          return (false);
+
+        // write container header
+        uint32_t version = compressedStreamVersion;
+        file_.write (compressedStreamIdentifier, strlen (compressedStreamIdentifier));
+        file_.write ((const char*)&version, sizeof(version));
+
+        return (file_.good ());
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      bool
+      CompressedStreamWriter<PointT>::encodePointCloud (const PointCloudConstPtr &cloud_arg)
+      {
+        if (!file_.is_open ())
+          return (false);
+
+        CompressedStreamIndexEntry entry;
+        entry.offset = (uint64_t)file_.tellp ();
+
+        // frames are appended as produced by the encoder, the index only records where they are
+        encoder_.encodePointCloud (cloud_arg, file_);
+
+        entry.size = (uint64_t)file_.tellp () - entry.offset;
+        entry.iFrame = encoder_.isIFrame ();
+        index_.push_back (entry);
+
+        return (file_.good ());
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      void
+      CompressedStreamWriter<PointT>::close ()
+      {
+        if (!file_.is_open ())
+          return;
+
+        uint64_t indexOffset = (uint64_t)file_.tellp ();
+
+        // frame index
+        uint64_t frameCount = index_.size ();
+        file_.write ((const char*)&frameCount, sizeof(frameCount));
+        std::vector<uint64_t> keyFrames;
+        for (size_t i = 0; i < index_.size (); ++i)
+        {
+          unsigned char iFrame = index_[i].iFrame ? 1 : 0;
+          file_.write ((const char*)&index_[i].offset, sizeof(index_[i].offset));
+          file_.write ((const char*)&index_[i].size, sizeof(index_[i].size));
+          file_.write ((const char*)&iFrame, sizeof(iFrame));
+          if (iFrame)
+            keyFrames.push_back (i);
+        }
+
+        // key frame table
+        uint64_t keyFrameCount = keyFrames.size ();
+        file_.write ((const char*)&keyFrameCount, sizeof(keyFrameCount));
+        for (size_t i = 0; i < keyFrames.size (); ++i)
+          file_.write ((const char*)&keyFrames[i], sizeof(keyFrames[i]));
+
+        // trailer
+        file_.write ((const char*)&indexOffset, sizeof(indexOffset));
+        file_.write (compressedStreamIdentifier, strlen (compressedStreamIdentifier));
+
+        file_.close ();
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      bool
+      CompressedStreamReader<PointT>::open (const std::string& fileName_arg)
+      {
+        const size_t identifierLen = strlen (compressedStreamIdentifier);
+        char identifier[sizeof(compressedStreamIdentifier)];
+        uint32_t version;
+
+        if (file_.is_open ())
+          file_.close ();
+        file_.clear ();
+        index_.clear ();
+        keyFrames_.clear ();
+        decoder_.reset ();
+        lastDecodedFrame_ = -1;
+
+        file_.open (fileName_arg.c_str (), std::ios::in | std::ios::binary);
+        if (!file_.is_open ())
+          return (false);
+        fileName_ = fileName_arg;
+
+        // check container header
+        file_.read (identifier, identifierLen);
+        file_.read ((char*)&version, sizeof(version));
+        if (!file_.good () || strncmp (identifier, compressedStreamIdentifier, identifierLen) != 0
+            || version != compressedStreamVersion)
+          return (false);
+
+        // read trailer
+        uint64_t indexOffset;
+        file_.seekg (-(std::streamoff)(identifierLen + sizeof(indexOffset)), std::ios::end);
+        file_.read ((char*)&indexOffset, sizeof(indexOffset));
+        file_.read (identifier, identifierLen);
+        if (!file_.good () || strncmp (identifier, compressedStreamIdentifier, identifierLen) != 0)
+          return (false);
+
+        // read frame index
+        uint64_t frameCount;
+        file_.seekg (indexOffset, std::ios::beg);
+        file_.read ((char*)&frameCount, sizeof(frameCount));
+        if (!file_.good ())
+          return (false);
+        index_.resize (frameCount);
+        for (size_t i = 0; i < index_.size (); ++i)
+        {
+          unsigned char iFrame;
+          file_.read ((char*)&index_[i].offset, sizeof(index_[i].offset));
+          file_.read ((char*)&index_[i].size, sizeof(index_[i].size));
+          file_.read ((char*)&iFrame, sizeof(iFrame));
+          index_[i].iFrame = (iFrame != 0);
+        }
+
+        // read key frame table
+        uint64_t keyFrameCount;
+        file_.read ((char*)&keyFrameCount, sizeof(keyFrameCount));
+        if (!file_.good ())
+          return (false);
+        keyFrames_.resize (keyFrameCount);
+        for (size_t i = 0; i < keyFrames_.size (); ++i)
+          file_.read ((char*)&keyFrames_[i], sizeof(keyFrames_[i]));
+
+        // a decodable stream starts with an I-frame
+        if (!file_.good () || (!index_.empty () && (keyFrames_.empty () || keyFrames_[0] != 0)))
+        {
+          index_.clear ();
+          keyFrames_.clear ();
+          return (false);
+        }
+
+        return (true);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      size_t
+      CompressedStreamReader<PointT>::getKeyFrame (size_t frame_arg) const
+      {
+        std::vector<uint64_t>::const_iterator it = std::upper_bound (keyFrames_.begin (), keyFrames_.end (),
+                                                                     (uint64_t)frame_arg);
+        if (it == keyFrames_.begin ())
+          return (0);
+        return ((size_t)*(--it));
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      bool
+      CompressedStreamReader<PointT>::decodeIndexedFrame (std::ifstream& file_arg, Decoder& decoder_arg,
+                                                          size_t frame_arg, PointCloudPtr &cloud_arg)
+      {
+        file_arg.clear ();
+        file_arg.seekg (index_[frame_arg].offset, std::ios::beg);
+        if (!file_arg.good ())
+          return (false);
+
+        cloud_arg.reset (new PointCloud);
+        decoder_arg.decodePointCloud (file_arg, cloud_arg);
+
+        return (file_arg.good () && decoder_arg.isIFrame () == index_[frame_arg].iFrame);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      bool
+      CompressedStreamReader<PointT>::decodeFrame (size_t frame_arg, PointCloudPtr &cloud_arg)
+      {
+        if (frame_arg >= index_.size ())
+          return (false);
+
+        // continue decoding from the last frame if it belongs to the same GOP, otherwise seek to the I-frame
+        size_t startFrame = getKeyFrame (frame_arg);
+        if (decoder_ && lastDecodedFrame_ >= (int64_t)startFrame && lastDecodedFrame_ < (int64_t)frame_arg)
+        {
+          startFrame = (size_t)lastDecodedFrame_ + 1;
+        }
+        else
+        {
+          decoder_.reset (new Decoder ());
+        }
+
+        for (size_t frame = startFrame; frame <= frame_arg; ++frame)
+        {
+          if (!decodeIndexedFrame (file_, *decoder_, frame, cloud_arg))
+          {
+            decoder_.reset ();
+            lastDecodedFrame_ = -1;
+            return (false);
+          }
+          lastDecodedFrame_ = frame;
+        }
+
+        return (true);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      bool
+      CompressedStreamReader<PointT>::decodeFrames (size_t firstFrame_arg, size_t lastFrame_arg,
+                                                    std::vector<PointCloudPtr> &clouds_arg)
+      {
+        if (firstFrame_arg > lastFrame_arg || lastFrame_arg >= index_.size ())
+          return (false);
+
+        // GOPs overlapping the requested range
+        std::vector<size_t> gopStart;
+        gopStart.push_back (getKeyFrame (firstFrame_arg));
+        for (size_t i = 0; i < keyFrames_.size (); ++i)
+          if (keyFrames_[i] > firstFrame_arg && keyFrames_[i] <= lastFrame_arg)
+            gopStart.push_back ((size_t)keyFrames_[i]);
+        gopStart.push_back (lastFrame_arg + 1);
+
+        clouds_arg.clear ();
+        clouds_arg.resize (lastFrame_arg - firstFrame_arg + 1);
+
+        int failures = 0;
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads_)
+        for (int gop = 0; gop < (int)gopStart.size () - 1; ++gop)
+        {
+          std::ifstream file (fileName_.c_str (), std::ios::in | std::ios::binary);
+          Decoder decoder;
+          PointCloudPtr cloud;
+
+          for (size_t frame = gopStart[gop]; frame < gopStart[gop + 1]; ++frame)
+          {
+            if (!decodeIndexedFrame (file, decoder, frame, cloud))
+            {
+#pragma omp atomic
+              ++failures;
+              break;
+            }
+            if (frame >= firstFrame_arg)
+              clouds_arg[frame - firstFrame_arg] = cloud;
+          }
+        }
+
+        return (failures == 0);
+      }
+  }
+}
+
+#endif
@@ -41,6 +41,7 @@
 #include "pcl/common/io.h"
 #include "pcl/octree/octree_pointcloud.h"
 #include "entropy_range_coder.h"
+#include "entropy_rans_coder.h"
 #include "color_coding.h"
 #include "point_coding.h"
 
@@ -49,6 +50,7 @@
 #include <iterator>
 #include <iostream>
 #include <vector>
+#include <string>
 #include <string.h>
 #include <iostream>
 #include <stdio.h>
@@ -110,7 +112,8 @@ namespace pcl
               doVoxelGridEnDecoding_ (doVoxelGridDownDownSampling_arg), iFrameRate_ (iFrameRate_arg),
               iFrameCounter_ (0), frameID_ (0), pointCount_ (0), iFrame_ (true),
               doColorEncoding_ (doColorEncoding_arg), cloudWithColor_ (false), dataWithColor_ (false),
-              pointColorOffset_ (0), bShowStatistics (showStatistics_arg)
+              pointColorOffset_ (0), entropyCoderType_ (RANGE_CODER), subtreeDepth_ (0), subtreeDepthArg_ (0),
+              bShowStatistics (showStatistics_arg)
 
         {
           output_ = PointCloudPtr ();
@@ -129,6 +132,7 @@ namespace pcl
             pointCoder_.setPrecision (selectedProfile.pointResolution);
             doColorEncoding_ = selectedProfile.doColorEncoding;
             colorCoder_.setBitDepth (selectedProfile.colorBitResolution);
+            entropyCoderType_ = selectedProfile.entropyCoder;
 
           } else {
             // configure point & color coder
@@ -185,6 +189,51 @@ namespace pcl
         void
         decodePointCloud (std::istream& compressedTreeDataIn_arg, PointCloudPtr &cloud_arg);
 
+        /** \brief Select the entropy coder backend used for encoding. The decoder reads it from the stream.
+         *  \param entropyCoder_arg: RANGE_CODER (StaticRangeCoder) or RANS_CODER (StaticRANSCoder)
+         * */
+        inline void
+        setEntropyCoder (entropyCoder_e entropyCoder_arg)
+        {
+          entropyCoderType_ = entropyCoder_arg;
+        }
+
+        /** \brief Get the entropy coder backend of the current stream */
+        inline entropyCoder_e
+        getEntropyCoder () const
+        {
+          return (entropyCoderType_);
+        }
+
+        /** \brief Split the octree at a given depth into independent subtrees. The leaf data (point counts,
+         *  \brief point details and colors) of every subtree is encoded and decoded in parallel into its own
+         *  \brief buffer. The octree structure itself is still coded in one pass. A value of 0 disables the
+         *  \brief splitting. The setting takes effect with the next I-frame.
+         *  \note Every subtree carries its own entropy coder tables, deep splits trade compression for speed.
+         *  \param subtreeDepth_arg: octree depth of the subtree roots, clamped to the octree depth
+         * */
+        inline void
+        setSubtreeDepth (unsigned char subtreeDepth_arg)
+        {
+          subtreeDepthArg_ = subtreeDepth_arg;
+        }
+
+        /** \brief Get the subtree split depth of the current stream */
+        inline unsigned char
+        getSubtreeDepth () const
+        {
+          return (subtreeDepth_);
+        }
+
+        /** \brief Check whether the last encoded or decoded frame is an I-frame
+         *  \return true if the frame was intra coded, false if it was predicted from the previous frame
+         * */
+        inline bool
+        isIFrame () const
+        {
+          return (iFrame_);
+        }
+
       protected:
 
         /** \brief Write frame information to output stream
@@ -211,6 +260,73 @@ namespace pcl
         void
         entropyDecoding (std::istream& compressedTreeDataIn_arg);
 
+        /** \brief Entropy encode all data vectors with a given coder. The vectors are independent sub-streams,
+         *  \brief they are encoded in parallel and written to the output stream in order.
+         *  \param compressedTreeDataOut_arg: binary output stream
+         * */
+        template<typename EntropyCoderT> void
+        entropyEncodingT (std::ostream& compressedTreeDataOut_arg);
+
+        /** \brief Entropy decode all data vectors with a given coder
+         *  \param compressedTreeDataIn_arg: binary input stream
+         * */
+        template<typename EntropyCoderT> void
+        entropyDecodingT (std::istream& compressedTreeDataIn_arg);
+
+        /** \brief Entropy decode the leaf data vectors of the whole octree or of a single subtree
+         *  \param entropyCoder_arg: entropy coder instance
+         *  \param compressedTreeDataIn_arg: binary input stream
+         *  \param pointCountDataVector_arg: output vector of points per voxel
+         *  \param pointCoder_arg: point coder receiving the differential point data
+         *  \param colorCoder_arg: color coder receiving the average and differential color data
+         *  \param compressedPointDataLen_arg: compressed size of the point data is added to this counter
+         *  \param compressedColorDataLen_arg: compressed size of the color data is added to this counter
+         * */
+        template<typename EntropyCoderT> void
+        entropyDecodingLeafData (EntropyCoderT& entropyCoder_arg, std::istream& compressedTreeDataIn_arg,
+                                 std::vector<unsigned int>& pointCountDataVector_arg,
+                                 PointCoding<PointT>& pointCoder_arg, ColorCoding<PointT>& colorCoder_arg,
+                                 uint64_t& compressedPointDataLen_arg, uint64_t& compressedColorDataLen_arg);
+
+        /** \brief Encode the data of a single leaf node
+         *  \param leafIdx_arg: indices of the points within the leaf voxel
+         *  \param key_arg: octree key of the leaf node
+         *  \param pointCountDataVector_arg: output vector of points per voxel
+         *  \param pointCoder_arg: point coder to be used
+         *  \param colorCoder_arg: color coder to be used
+         **/
+        void
+        encodeLeaf (const std::vector<int>& leafIdx_arg, const OctreeKey& key_arg,
+                    std::vector<unsigned int>& pointCountDataVector_arg,
+                    PointCoding<PointT>& pointCoder_arg, ColorCoding<PointT>& colorCoder_arg);
+
+        /** \brief Decode the data of a single leaf node into the already allocated output cloud
+         *  \param key_arg: octree key of the leaf node
+         *  \param pointBegin_arg: index of the first output point of the leaf
+         *  \param pointCount_arg: amount of points within the leaf
+         *  \param pointCoder_arg: point coder to be used
+         *  \param colorCoder_arg: color coder to be used
+         **/
+        void
+        decodeLeaf (const OctreeKey& key_arg, std::size_t pointBegin_arg, std::size_t pointCount_arg,
+                    PointCoding<PointT>& pointCoder_arg, ColorCoding<PointT>& colorCoder_arg);
+
+        /** \brief Split the recorded leaf keys into ranges of leaves sharing the same subtree
+         *  \param leafBoundaries_arg: output vector of the first leaf of each subtree, terminated by the leaf count
+         **/
+        void
+        computeSubtreeBoundaries (std::vector<std::size_t>& leafBoundaries_arg) const;
+
+        /** \brief Encode the recorded leaves of all subtrees in parallel */
+        void
+        encodeSubtrees ();
+
+        /** \brief Decode the recorded leaves of all subtrees in parallel
+         *  \return true on success, false if the subtree table does not match the octree structure
+         **/
+        bool
+        decodeSubtrees ();
+
         /** \brief Encode leaf node information during serialization
          *  \param leaf_arg: reference to new leaf node
          *  \param key_arg: octree key of new leaf node
@@ -246,8 +362,35 @@ namespace pcl
         /** \brief Point coding instance */
         PointCoding<PointT> pointCoder_;
 
-        /** \brief Static range coder instance */
-        StaticRangeCoder entropyCoder_;
+        /** \brief Leaf data of an octree subtree that is en-/decoded independently */
+        struct SubtreeCoding
+        {
+          /** \brief Range of the subtree leaves in leafKeys_ */
+          std::size_t leafBegin;
+          std::size_t leafEnd;
+
+          /** \brief Range of the decoded subtree points in the output cloud */
+          uint64_t pointBegin;
+          uint64_t pointCount;
+
+          std::vector<unsigned int> pointCountDataVector;
+          PointCoding<PointT> pointCoder;
+          ColorCoding<PointT> colorCoder;
+
+          /** \brief Entropy coded sub-streams of the subtree (decoding only) */
+          std::string compressedData;
+          uint64_t compressedPointDataLen;
+          uint64_t compressedColorDataLen;
+        };
+
+        /** \brief Keys of all leaf nodes in serialization order (subtree mode only) */
+        std::vector<OctreeKey> leafKeys_;
+
+        /** \brief Point indices of all leaf nodes in serialization order (subtree encoding only) */
+        std::vector<const std::vector<int>*> leafIdxVectors_;
+
+        /** \brief Independently coded subtrees of the current frame */
+        std::vector<SubtreeCoding> subtrees_;
 
         bool doVoxelGridEnDecoding_;
         uint32_t iFrameRate_;
@@ -261,6 +404,13 @@ namespace pcl
         bool dataWithColor_;
         unsigned char pointColorOffset_;
 
+        /** \brief Entropy coder backend */
+        entropyCoder_e entropyCoderType_;
+
+        /** \brief Subtree split depth of the current stream, and the one requested for the next I-frame */
+        unsigned char subtreeDepth_;
+        unsigned char subtreeDepthArg_;
+
         //bool activating statistics
         bool bShowStatistics;
         uint64_t compressedPointDataLen_;
@@ -0,0 +1,283 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef OCTREE_COMPRESSION_STREAM_H
+#define OCTREE_COMPRESSION_STREAM_H
+
+#include "octree_pointcloud_compression.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace pcl
+{
+  namespace octree
+  {
+    /** \brief Identifier at the beginning and the end of a compressed stream container */
+    static const char compressedStreamIdentifier[] = "PCLSTRM1";
+
+    /** \brief Compressed stream container format version */
+    static const uint32_t compressedStreamVersion = 1;
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Index entry of a single frame in a multi-frame container for octree compressed point cloud streams
+     *  \note The container stores the output of PointCloudCompression::encodePointCloud, one frame after the other,
+     *  \note followed by an index with the byte offset, byte size and type (I/P-frame) of every frame and a table of
+     *  \note all I-frames (key frames). A fixed size trailer at the end of the file points to the index, so a reader
+     *  \note can seek to any I-frame and decode groups of pictures (GOPs) independently.
+     *  \note
+     *  \note File layout:
+     *  \note   "PCLSTRM1" | uint32 version | frame 0 | frame 1 | ... | index | uint64 index offset | "PCLSTRM1"
+     *  \note   index: uint64 frame count | frame count x (uint64 offset, uint64 size, uint8 I-frame flag) |
+     *  \note          uint64 key frame count | key frame count x uint64 frame number
+     */
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct CompressedStreamIndexEntry
+    {
+      /** \brief Byte offset of the frame from the beginning of the file. */
+      uint64_t offset;
+      /** \brief Size of the encoded frame in bytes. */
+      uint64_t size;
+      /** \brief True if the frame is intra coded and can be decoded without its predecessors. */
+      bool iFrame;
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Writer for seekable, multi-frame octree point cloud compression containers
+     *  \note The writer encodes every frame with the given PointCloudCompression instance, so all compression
+     *  \note profiles and I-frame rates are supported. The I-frame rate bounds the decoding cost of a random seek.
+     *  \note
+     *  \note typename: PointT: type of point used in pointcloud
+     */
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      class CompressedStreamWriter
+      {
+      public:
+
+        typedef PointCloudCompression<PointT> Encoder;
+        typedef typename Encoder::PointCloudConstPtr PointCloudConstPtr;
+
+        /** \brief Constructor
+         *  \param encoder_arg:  configured encoder instance used for all frames
+         * */
+        CompressedStreamWriter (Encoder& encoder_arg) :
+          encoder_ (encoder_arg), file_ (), index_ ()
+        {
+        }
+
+        /** \brief Deconstructor. Finalizes the container if it is still open. */
+        virtual
+        ~CompressedStreamWriter ()
+        {
+          close ();
+        }
+
+        /** \brief Create a new container file and write the file header
+         *  \param fileName_arg:  name of the container file
+         *  \return true on success
+         * */
+        bool
+        open (const std::string& fileName_arg);
+
+        /** \brief Encode a point cloud and append it to the container
+         *  \param cloud_arg:  point cloud to be compressed
+         *  \return true on success
+         * */
+        bool
+        encodePointCloud (const PointCloudConstPtr &cloud_arg);
+
+        /** \brief Write frame index and trailer, and close the container file */
+        void
+        close ();
+
+        /** \brief Get the number of frames written so far */
+        inline size_t
+        getFrameCount () const
+        {
+          return (index_.size ());
+        }
+
+        /** \brief Get the index entries of the frames written so far */
+        inline const std::vector<CompressedStreamIndexEntry>&
+        getIndex () const
+        {
+          return (index_);
+        }
+
+      protected:
+
+        /** \brief Encoder instance */
+        Encoder& encoder_;
+
+        /** \brief Output container file */
+        std::ofstream file_;
+
+        /** \brief Frame index */
+        std::vector<CompressedStreamIndexEntry> index_;
+      };
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Reader for seekable, multi-frame octree point cloud compression containers
+     *  \note Random access decodes from the nearest preceding I-frame. Sequential access (frame n after frame n-1)
+     *  \note continues decoding without seeking. Ranges of frames are decoded in parallel, one GOP per thread.
+     *  \note
+     *  \note typename: PointT: type of point used in pointcloud
+     */
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+      class CompressedStreamReader
+      {
+      public:
+
+        typedef PointCloudCompression<PointT> Decoder;
+        typedef typename Decoder::PointCloud PointCloud;
+        typedef typename Decoder::PointCloudPtr PointCloudPtr;
+
+        /** \brief Constructor
+         *  \param nrThreads_arg:  number of threads used by decodeFrames
+         * */
+        CompressedStreamReader (unsigned int nrThreads_arg = 1) :
+          file_ (), fileName_ (), index_ (), keyFrames_ (), decoder_ (), lastDecodedFrame_ (-1),
+          threads_ (nrThreads_arg == 0 ? 1 : nrThreads_arg)
+        {
+        }
+
+        /** \brief Empty deconstructor. */
+        virtual
+        ~CompressedStreamReader ()
+        {
+        }
+
+        /** \brief Open a container file and read its frame index
+         *  \param fileName_arg:  name of the container file
+         *  \return true on success
+         * */
+        bool
+        open (const std::string& fileName_arg);
+
+        /** \brief Set the number of threads used by decodeFrames */
+        inline void
+        setNumberOfThreads (unsigned int nrThreads_arg)
+        {
+          threads_ = nrThreads_arg == 0 ? 1 : nrThreads_arg;
+        }
+
+        /** \brief Get the number of frames in the container */
+        inline size_t
+        getFrameCount () const
+        {
+          return (index_.size ());
+        }
+
+        /** \brief Get the frame numbers of all I-frames in the container */
+        inline const std::vector<uint64_t>&
+        getKeyFrames () const
+        {
+          return (keyFrames_);
+        }
+
+        /** \brief Get the index entries of all frames in the container */
+        inline const std::vector<CompressedStreamIndexEntry>&
+        getIndex () const
+        {
+          return (index_);
+        }
+
+        /** \brief Get the frame number of the nearest I-frame at or before a given frame
+         *  \param frame_arg:  frame number
+         * */
+        size_t
+        getKeyFrame (size_t frame_arg) const;
+
+        /** \brief Decode a single frame, seeking to the nearest I-frame if required
+         *  \param frame_arg:  frame number
+         *  \param cloud_arg:  decoded point cloud
+         *  \return true on success
+         * */
+        bool
+        decodeFrame (size_t frame_arg, PointCloudPtr &cloud_arg);
+
+        /** \brief Decode a range of frames in parallel. Every GOP overlapping the range is decoded by its own
+         *  \brief decoder instance.
+         *  \param firstFrame_arg:  first frame number
+         *  \param lastFrame_arg:  last frame number (inclusive)
+         *  \param clouds_arg:  decoded point clouds, one per frame in the range
+         *  \return true on success
+         * */
+        bool
+        decodeFrames (size_t firstFrame_arg, size_t lastFrame_arg, std::vector<PointCloudPtr> &clouds_arg);
+
+      protected:
+
+        /** \brief Decode a frame with the given decoder, reading it at its indexed offset
+         *  \param file_arg:  open container file
+         *  \param decoder_arg:  decoder holding the state of the previous frame
+         *  \param frame_arg:  frame number
+         *  \param cloud_arg:  decoded point cloud
+         * */
+        bool
+        decodeIndexedFrame (std::ifstream& file_arg, Decoder& decoder_arg, size_t frame_arg, PointCloudPtr &cloud_arg);
+
+        /** \brief Input container file used by decodeFrame */
+        std::ifstream file_;
+
+        /** \brief Name of the container file, decodeFrames opens it once per GOP */
+        std::string fileName_;
+
+        /** \brief Frame index */
+        std::vector<CompressedStreamIndexEntry> index_;
+
+        /** \brief I-frame table */
+        std::vector<uint64_t> keyFrames_;
+
+        /** \brief Decoder instance used by decodeFrame */
+        boost::shared_ptr<Decoder> decoder_;
+
+        /** \brief Frame last decoded by decoder_, -1 if none */
+        int64_t lastDecodedFrame_;
+
+        /** \brief Number of threads used by decodeFrames */
+        unsigned int threads_;
+      };
+  }
+}
+
+#endif
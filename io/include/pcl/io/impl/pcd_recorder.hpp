@@ -0,0 +1,363 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_IO_PCD_RECORDER_IMPL_H_
+#define PCL_IO_PCD_RECORDER_IMPL_H_
+
+#include <sstream>
+#include <iomanip>
+#include <boost/bind.hpp>
+#include <pcl/common/time.h>
+#include <pcl/console/print.h>
+#include <pcl/exceptions.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::PCDRecorder<PointT>::PCDRecorder (const std::string &file_prefix, 
+                                       unsigned int nr_threads,
+                                       size_t max_queue_size)
+  : file_prefix_ (file_prefix)
+  , nr_threads_ (nr_threads == 0 ? 1 : nr_threads)
+  , max_queue_size_ (max_queue_size == 0 ? 1 : max_queue_size)
+  , max_queue_bytes_ (0)
+  , policy_ (BLOCK)
+  , compress_ (false)
+  , running_ (false)
+  , quit_ (false)
+  , queue_ ()
+  , queued_bytes_ (0)
+  , in_flight_ (0)
+  , next_sequence_ (0)
+  , max_queue_depth_ (0)
+  , frames_written_ (0)
+  , frames_dropped_ (0)
+  , frames_failed_ (0)
+  , bytes_written_ (0)
+  , stats_start_time_ (pcl::getTime ())
+  , queue_mutex_ ()
+  , not_empty_ ()
+  , not_full_ ()
+  , threads_ ()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::PCDRecorder<PointT>::~PCDRecorder ()
+{
+  stop (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDRecorder<PointT>::setMaxQueueSize (size_t max_queue_size)
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  max_queue_size_ = max_queue_size == 0 ? 1 : max_queue_size;
+  not_full_.notify_all ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDRecorder<PointT>::setMaxQueueBytes (size_t max_queue_bytes)
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  max_queue_bytes_ = max_queue_bytes;
+  not_full_.notify_all ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDRecorder<PointT>::start ()
+{
+  if (running_)
+    return;
+
+  {
+    boost::mutex::scoped_lock lock (queue_mutex_);
+    quit_ = false;
+    running_ = true;
+  }
+  for (unsigned int i = 0; i < nr_threads_; ++i)
+    threads_.create_thread (boost::bind (&PCDRecorder<PointT>::writerThread, this));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDRecorder<PointT>::stop (bool flush)
+{
+  if (!running_)
+    return;
+
+  {
+    boost::mutex::scoped_lock lock (queue_mutex_);
+    if (!flush)
+    {
+      frames_dropped_ += queue_.size ();
+      queue_.clear ();
+      queued_bytes_ = 0;
+    }
+    quit_ = true;
+    not_empty_.notify_all ();
+    not_full_.notify_all ();
+  }
+  threads_.join_all ();
+
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  running_ = false;
+  // Frames pushed with BLOCK while stopping may still be here
+  frames_dropped_ += queue_.size ();
+  queue_.clear ();
+  queued_bytes_ = 0;
+  not_full_.notify_all ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PCDRecorder<PointT>::push (const PointCloudConstPtr &cloud)
+{
+  if (!cloud)
+    return (false);
+
+  size_t bytes = getCloudBytes (cloud);
+  boost::mutex::scoped_lock lock (queue_mutex_);
+
+  if (!running_ || quit_)
+  {
+    ++frames_dropped_;
+    return (false);
+  }
+
+  if (!fits (bytes))
+  {
+    switch (policy_)
+    {
+      case BLOCK:
+      {
+        while (!fits (bytes) && !quit_)
+          not_full_.wait (lock);
+        if (quit_)
+        {
+          ++frames_dropped_;
+          return (false);
+        }
+        break;
+      }
+      case DROP_OLDEST:
+      {
+        while (!fits (bytes))
+        {
+          queued_bytes_ -= getCloudBytes (queue_.front ().cloud);
+          queue_.pop_front ();
+          ++frames_dropped_;
+        }
+        break;
+      }
+      case DROP_NEWEST:
+      {
+        ++frames_dropped_;
+        return (false);
+      }
+    }
+  }
+
+  queue_.push_back (Frame (cloud, next_sequence_++));
+  queued_bytes_ += bytes;
+  if (queue_.size () > max_queue_depth_)
+    max_queue_depth_ = queue_.size ();
+  not_empty_.notify_one ();
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDRecorder<PointT>::waitUntilEmpty ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  while (running_ && (!queue_.empty () || in_flight_ > 0))
+    not_full_.wait (lock);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDRecorder<PointT>::writerThread ()
+{
+  // Each thread owns its writer, PCDWriter is not meant to be shared
+  pcl::PCDWriter writer;
+  writer.setMapSynchronization (false);
+
+  while (true)
+  {
+    Frame frame;
+    {
+      boost::mutex::scoped_lock lock (queue_mutex_);
+      while (queue_.empty () && !quit_)
+        not_empty_.wait (lock);
+      if (queue_.empty ())
+        return;
+
+      frame = queue_.front ();
+      queue_.pop_front ();
+      queued_bytes_ -= getCloudBytes (frame.cloud);
+      ++in_flight_;
+      not_full_.notify_all ();
+    }
+
+    int res = writeFrame (writer, frame);
+
+    boost::mutex::scoped_lock lock (queue_mutex_);
+    --in_flight_;
+    if (res == 0)
+    {
+      ++frames_written_;
+      bytes_written_ += getCloudBytes (frame.cloud);
+    }
+    else
+    {
+      ++frames_failed_;
+      PCL_ERROR ("[pcl::PCDRecorder::writerThread] Error writing %s!\n", getFileName (frame.sequence).c_str ());
+    }
+    not_full_.notify_all ();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDRecorder<PointT>::writeFrame (pcl::PCDWriter &writer, const Frame &frame)
+{
+  std::string file_name = getFileName (frame.sequence);
+  try
+  {
+    if (compress_)
+      return (writer.writeBinaryCompressed<PointT> (file_name, *frame.cloud));
+    return (writer.writeBinary<PointT> (file_name, *frame.cloud));
+  }
+  catch (pcl::PCLException &e)
+  {
+    PCL_ERROR ("%s\n", e.what ());
+    return (-1);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::string
+pcl::PCDRecorder<PointT>::getFileName (size_t sequence) const
+{
+  std::stringstream ss;
+  ss << file_prefix_ << std::setfill ('0') << std::setw (6) << sequence << ".pcd";
+  return (ss.str ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> size_t
+pcl::PCDRecorder<PointT>::getQueueDepth ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  return (queue_.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> size_t
+pcl::PCDRecorder<PointT>::getMaxQueueDepth ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  return (max_queue_depth_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> size_t
+pcl::PCDRecorder<PointT>::getFramesWritten ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  return (frames_written_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> size_t
+pcl::PCDRecorder<PointT>::getFramesDropped ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  return (frames_dropped_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> size_t
+pcl::PCDRecorder<PointT>::getFramesFailed ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  return (frames_failed_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> size_t
+pcl::PCDRecorder<PointT>::getBytesWritten ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  return (bytes_written_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> double
+pcl::PCDRecorder<PointT>::getFramesPerSecond ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  double elapsed = pcl::getTime () - stats_start_time_;
+  return (elapsed > 0 ? static_cast<double> (frames_written_) / elapsed : 0.0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> double
+pcl::PCDRecorder<PointT>::getMegabytesPerSecond ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  double elapsed = pcl::getTime () - stats_start_time_;
+  return (elapsed > 0 ? static_cast<double> (bytes_written_) / (1024.0 * 1024.0 * elapsed) : 0.0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDRecorder<PointT>::resetStatistics ()
+{
+  boost::mutex::scoped_lock lock (queue_mutex_);
+  max_queue_depth_ = queue_.size ();
+  frames_written_ = frames_dropped_ = frames_failed_ = bytes_written_ = 0;
+  stats_start_time_ = pcl::getTime ();
+}
+
+#endif  //#ifndef PCL_IO_PCD_RECORDER_IMPL_H_
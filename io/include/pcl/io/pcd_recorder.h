@@ -0,0 +1,322 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_IO_PCD_RECORDER_H_
+#define PCL_IO_PCD_RECORDER_H_
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <pcl/point_cloud.h>
+#include <pcl/io/pcd_io.h>
+
+namespace pcl
+{
+  /** \brief PCDRecorder writes a stream of point clouds (e.g., the output of a
+    * \ref Grabber) to disk asynchronously.
+    *
+    * Calls to \ref push only enqueue the shared cloud pointer, so the caller
+    * (usually a grabber callback) never waits for open/mmap/LZF. A pool of
+    * writer threads drains the queue and saves every frame to
+    * <prefix><frame number>.pcd, in either BINARY or BINARY_COMPRESSED format.
+    *
+    * The queue is bounded both in number of frames and in bytes. When it is
+    * full, the behavior is given by the \ref QueuePolicy:
+    *   - BLOCK: the producer waits until a writer thread frees up space;
+    *   - DROP_OLDEST: the oldest queued frame is discarded to make room;
+    *   - DROP_NEWEST: the incoming frame is discarded.
+    *
+    * Usage example:
+    * \code
+    * pcl::PCDRecorder<pcl::PointXYZRGBA> recorder ("frame_", 2);
+    * recorder.setQueuePolicy (pcl::PCDRecorder<pcl::PointXYZRGBA>::DROP_OLDEST);
+    * recorder.start ();
+    * boost::function<void (const pcl::PointCloud<pcl::PointXYZRGBA>::ConstPtr&)> f =
+    *   boost::bind (&pcl::PCDRecorder<pcl::PointXYZRGBA>::push, &recorder, _1);
+    * grabber.registerCallback (f);
+    * \endcode
+    *
+    * \ingroup io
+    */
+  template <typename PointT>
+  class PCDRecorder
+  {
+    public:
+      typedef pcl::PointCloud<PointT> PointCloud;
+      typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+
+      /** \brief Behavior of \ref push when the queue is full. */
+      enum QueuePolicy
+      {
+        BLOCK,
+        DROP_OLDEST,
+        DROP_NEWEST
+      };
+
+      /** \brief Constructor.
+        * \param[in] file_prefix the prefix of the file names written to disk
+        * \param[in] nr_threads the number of writer threads (default: 1)
+        * \param[in] max_queue_size the maximum number of frames held in the queue (default: 16)
+        */
+      PCDRecorder (const std::string &file_prefix = "frame_", 
+                   unsigned int nr_threads = 1,
+                   size_t max_queue_size = 16);
+
+      /** \brief Destructor. Stops the writer threads after flushing the queue. */
+      virtual ~PCDRecorder ();
+
+      /** \brief Set the prefix of the file names written to disk. */
+      inline void
+      setFilePrefix (const std::string &file_prefix) { file_prefix_ = file_prefix; }
+
+      /** \brief Get the prefix of the file names written to disk. */
+      inline std::string
+      getFilePrefix () const { return (file_prefix_); }
+
+      /** \brief Set the number of writer threads. Takes effect on the next \ref start. */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { nr_threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      /** \brief Get the number of writer threads. */
+      inline unsigned int
+      getNumberOfThreads () const { return (nr_threads_); }
+
+      /** \brief Set whether the frames should be saved as BINARY_COMPRESSED (true) or BINARY (false, default). */
+      inline void
+      setCompression (bool compress) { compress_ = compress; }
+
+      /** \brief Get whether the frames are saved as BINARY_COMPRESSED. */
+      inline bool
+      getCompression () const { return (compress_); }
+
+      /** \brief Set the queue policy applied when the queue is full (default: BLOCK). */
+      inline void
+      setQueuePolicy (QueuePolicy policy) { policy_ = policy; }
+
+      /** \brief Get the queue policy applied when the queue is full. */
+      inline QueuePolicy
+      getQueuePolicy () const { return (policy_); }
+
+      /** \brief Set the maximum number of frames held in the queue. */
+      void
+      setMaxQueueSize (size_t max_queue_size);
+
+      /** \brief Get the maximum number of frames held in the queue. */
+      inline size_t
+      getMaxQueueSize () const { return (max_queue_size_); }
+
+      /** \brief Set the maximum number of point data bytes held in the queue.
+        * A frame larger than this limit is still accepted when the queue is empty.
+        * \param[in] max_queue_bytes the memory bound, 0 for unlimited (default)
+        */
+      void
+      setMaxQueueBytes (size_t max_queue_bytes);
+
+      /** \brief Get the maximum number of point data bytes held in the queue. */
+      inline size_t
+      getMaxQueueBytes () const { return (max_queue_bytes_); }
+
+      /** \brief Start the writer threads. */
+      void
+      start ();
+
+      /** \brief Stop the writer threads.
+        * \param[in] flush if true (default), write all queued frames before
+        * returning, otherwise discard them (they are counted as dropped)
+        */
+      void
+      stop (bool flush = true);
+
+      /** \brief Check whether the writer threads are running. */
+      inline bool
+      isRunning () const { return (running_); }
+
+      /** \brief Enqueue a cloud for writing. The cloud is not copied, so it must
+        * not be modified by the caller afterwards.
+        * \param[in] cloud the point cloud to write
+        * \return true if the cloud was enqueued, false if it was dropped
+        */
+      bool
+      push (const PointCloudConstPtr &cloud);
+
+      /** \brief Block until all queued frames have been written to disk. */
+      void
+      waitUntilEmpty ();
+
+      /** \brief Get the number of frames currently waiting in the queue. */
+      size_t
+      getQueueDepth ();
+
+      /** \brief Get the largest queue depth observed since the last \ref resetStatistics. */
+      size_t
+      getMaxQueueDepth ();
+
+      /** \brief Get the number of frames successfully written to disk. */
+      size_t
+      getFramesWritten ();
+
+      /** \brief Get the number of frames dropped because of the queue policy or a stop without flush. */
+      size_t
+      getFramesDropped ();
+
+      /** \brief Get the number of frames for which the write failed. */
+      size_t
+      getFramesFailed ();
+
+      /** \brief Get the number of point data bytes written to disk (before compression). */
+      size_t
+      getBytesWritten ();
+
+      /** \brief Get the write throughput in frames per second since the last \ref resetStatistics. */
+      double
+      getFramesPerSecond ();
+
+      /** \brief Get the write throughput in (uncompressed) megabytes per second since the last \ref resetStatistics. */
+      double
+      getMegabytesPerSecond ();
+
+      /** \brief Reset the throughput and queue depth counters. */
+      void
+      resetStatistics ();
+
+    protected:
+      /** \brief A queued frame together with its sequence number. */
+      struct Frame
+      {
+        Frame () : cloud (), sequence (0) {}
+        Frame (const PointCloudConstPtr &c, size_t s) : cloud (c), sequence (s) {}
+
+        PointCloudConstPtr cloud;
+        size_t sequence;
+      };
+
+      /** \brief Main loop of a writer thread. */
+      void
+      writerThread ();
+
+      /** \brief Write a single frame to disk.
+        * \param[in] writer the PCD writer owned by the calling thread
+        * \param[in] frame the frame to write
+        * \return 0 on success, the PCDWriter error code otherwise
+        */
+      int
+      writeFrame (pcl::PCDWriter &writer, const Frame &frame);
+
+      /** \brief Get the file name of a given frame. */
+      std::string
+      getFileName (size_t sequence) const;
+
+      /** \brief Number of point data bytes of a cloud. */
+      static inline size_t
+      getCloudBytes (const PointCloudConstPtr &cloud)
+      {
+        return (cloud->points.size () * sizeof (PointT));
+      }
+
+      /** \brief Check whether a cloud of the given size fits in the queue. Assumes queue_mutex_ is held. */
+      inline bool
+      fits (size_t bytes) const
+      {
+        if (queue_.empty ())
+          return (true);
+        if (queue_.size () >= max_queue_size_)
+          return (false);
+        return (max_queue_bytes_ == 0 || queued_bytes_ + bytes <= max_queue_bytes_);
+      }
+
+      /** \brief The prefix of the file names written to disk. */
+      std::string file_prefix_;
+
+      /** \brief The number of writer threads. */
+      unsigned int nr_threads_;
+
+      /** \brief The maximum number of frames held in the queue. */
+      size_t max_queue_size_;
+
+      /** \brief The maximum number of point data bytes held in the queue (0 = unlimited). */
+      size_t max_queue_bytes_;
+
+      /** \brief The queue policy. */
+      QueuePolicy policy_;
+
+      /** \brief Set to true to write BINARY_COMPRESSED files. */
+      bool compress_;
+
+      /** \brief True between \ref start and \ref stop. */
+      bool running_;
+
+      /** \brief Set to true to make the writer threads exit once the queue is empty. */
+      bool quit_;
+
+      /** \brief The frame queue. */
+      std::deque<Frame> queue_;
+
+      /** \brief Number of point data bytes in the queue. */
+      size_t queued_bytes_;
+
+      /** \brief Number of frames popped from the queue but not yet written. */
+      size_t in_flight_;
+
+      /** \brief Sequence number assigned to the next pushed frame. */
+      size_t next_sequence_;
+
+      /** \brief Statistics. */
+      size_t max_queue_depth_, frames_written_, frames_dropped_, frames_failed_, bytes_written_;
+      double stats_start_time_;
+
+      /** \brief Protects the queue and all counters. */
+      boost::mutex queue_mutex_;
+
+      /** \brief Signaled when a frame is pushed or when stopping. */
+      boost::condition_variable not_empty_;
+
+      /** \brief Signaled when a frame leaves the queue or is written. */
+      boost::condition_variable not_full_;
+
+      /** \brief The writer threads. */
+      boost::thread_group threads_;
+  };
+}
+
+#include <pcl/io/impl/pcd_recorder.hpp>
+
+#endif  //#ifndef PCL_IO_PCD_RECORDER_H_
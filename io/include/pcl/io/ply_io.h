@@ -86,7 +86,9 @@ namespace pcl
         : FileReader ()
         , origin_ (Eigen::Vector4f::Zero ())
         , orientation_ (Eigen::Matrix3f::Zero ())
+        , cloud_ (0)
         , range_grid_ (0)
+        , polygons_ (0)
       {}
 
       ~PLYReader () { delete range_grid_; }
@@ -150,9 +152,29 @@ namespace pcl
       read (const std::string &file_name, pcl::PointCloud<PointT> &cloud)
       {
         sensor_msgs::PointCloud2 blob;
+
+        // binary files are converted straight into the point type
+        std::vector<sensor_msgs::PointField> fields;
+        pcl::getFields (cloud, fields);
+        cloud_ = &blob;
+        int res = readBinary (file_name, &fields, 
+                              std::tr1::bind (&PLYReader::resizePoints<PointT>, &cloud, std::tr1::placeholders::_1),
+                              sizeof (PointT));
+        if (res < 0)
+          return (res);
+        if (res == 0)
+        {
+          cloud.width = blob.width;
+          cloud.height = blob.height;
+          cloud.is_dense = blob.is_dense;
+          cloud.sensor_origin_ = origin_;
+          cloud.sensor_orientation_ = Eigen::Quaternionf (orientation_);
+          return (0);
+        }
+
         int ply_version;
-        int res = read (file_name, blob, cloud.sensor_origin_, cloud.sensor_orientation_,
-                        ply_version);
+        res = read (file_name, blob, cloud.sensor_origin_, cloud.sensor_orientation_,
+                    ply_version);
 
         // Exit in case of error
         if (res < 0)
@@ -160,8 +182,94 @@ namespace pcl
         pcl::fromROSMsg (blob, cloud);
         return (0);
       }
+
+      /** \brief Read a polygonal mesh from a PLY file. The vertices are stored in mesh.cloud, the 
+        * vertex_indices (or vertex_index) lists of the face element in mesh.polygons.
+        * \param[in] file_name the name of the file containing the mesh
+        * \param[out] mesh the resultant polygonal mesh
+        */
+      int
+      read (const std::string &file_name, pcl::PolygonMesh &mesh);
       
     private:
+      /** \brief Scalar or list property of an element in a binary PLY file */
+      struct BinaryProperty
+      {
+        std::string name;
+        /** \brief sensor_msgs::PointField datatype of the scalar or of the list items */
+        int type;
+        /** \brief sensor_msgs::PointField datatype of the list size, 0 for scalar properties */
+        int size_type;
+      };
+
+      /** \brief Element of a binary PLY file */
+      struct BinaryElement
+      {
+        std::string name;
+        size_t count;
+        std::vector<BinaryProperty> properties;
+      };
+
+      /** \brief Single conversion of the vertex copy plan, executed for every vertex record */
+      struct VertexCopyOperation
+      {
+        enum { COPY_FLOAT32, UINT8_TO_FLOAT32, PACK_RGB } type;
+        /** \brief source offsets in the vertex record, only PACK_RGB uses all three */
+        size_t src_offset[3];
+        /** \brief destination offset in the point */
+        size_t dst_offset;
+      };
+
+      /** \brief Read a binary PLY file without the per-scalar callbacks of the parser. The layout of the 
+        * vertex element is compiled into a copy plan which is applied to the memory mapped vertex records. 
+        * The other elements are walked record by record.
+        * \param[in] file_name the name of the file to load
+        * \param[in] point_fields the fields of the destination point type, or 0 to fill cloud_->data
+        * \param[in] resize_points resizes the destination to a given number of points and returns its data
+        * \param[in] point_step the size of a destination point
+        * \return 0 on success, -1 on error, 1 if the file must be read by the generic parser 
+        * (ascii files, list properties in the vertex element, range grids with a point type destination)
+        */
+      int
+      readBinary (const std::string &file_name,
+                  const std::vector<sensor_msgs::PointField> *point_fields = 0,
+                  const std::tr1::function<uint8_t* (size_t)> &resize_points = std::tr1::function<uint8_t* (size_t)> (),
+                  size_t point_step = 0);
+
+      /** \brief Parse the header of a binary PLY file.
+        * \param[in] file_name the name of the file to load
+        * \param[out] elements the elements and their properties
+        * \param[out] swap_bytes true if the byte order of the file differs from the host byte order
+        * \param[out] data_idx the offset of the first data byte in the file
+        * \return 0 on success, 1 for ascii or malformed headers which are left to the generic parser
+        */
+      int
+      readBinaryHeader (const std::string &file_name, std::vector<BinaryElement> &elements,
+                        bool &swap_bytes, size_t &data_idx);
+
+      /** \brief Convert the memory mapped data of a binary PLY file.
+        * \param[in] data the first data byte
+        * \param[in] data_end one past the last data byte
+        * \param[in] elements the elements and their properties
+        * \param[in] swap_bytes true if the byte order of the file differs from the host byte order
+        * \param[in] point_fields the fields of the destination point type, or 0 to fill cloud_->data
+        * \param[in] resize_points resizes the destination to a given number of points and returns its data
+        * \param[in] point_step the size of a destination point
+        * \return false if the data is truncated
+        */
+      bool
+      readBinaryData (const char *data, const char *data_end, const std::vector<BinaryElement> &elements,
+                      bool swap_bytes, const std::vector<sensor_msgs::PointField> *point_fields,
+                      const std::tr1::function<uint8_t* (size_t)> &resize_points, size_t point_step);
+
+      /** \brief Resize a point cloud and return a pointer to its points */
+      template <typename PointT> static uint8_t*
+      resizePoints (pcl::PointCloud<PointT> *cloud, size_t nr_points)
+      {
+        cloud->points.resize (nr_points);
+        return (nr_points > 0 ? reinterpret_cast<uint8_t*> (&cloud->points[0]) : 0);
+      }
+
       ::pcl::io::ply::ply_parser parser_;
 
       bool
@@ -372,6 +480,18 @@ namespace pcl
       void
       rangeGridEndCallback ();
 
+      /** Callback function for the begin of a face vertex_indices property
+        * param[in] size vertex_indices list size
+        */
+      void
+      faceVertexIndicesBeginCallback (pcl::io::ply::uint8 size);
+
+      /** Callback function for each face vertex_indices element
+        * param[in] vertex_index index of the vertex in vertex_indices
+        */
+      void
+      faceVertexIndicesElementCallback (pcl::io::ply::int32 vertex_index);
+
       /** Callback function for obj_info */
       void
       objInfoCallback (const std::string& line);
@@ -390,6 +510,8 @@ namespace pcl
       std::vector<std::vector <int> > *range_grid_;
       size_t range_count_, range_grid_vertex_indices_element_index_;
       size_t rgb_offset_before_;
+      //face element artifacts, only read into a PolygonMesh
+      std::vector<pcl::Vertices> *polygons_;
       
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -636,6 +758,18 @@ namespace pcl
       return (p.read (file_name, cloud));
     }
 
+    /** \brief Load a PLY file into a PolygonMesh
+      * \param[in] file_name the name of the file to load
+      * \param[out] mesh the resultant polygonal mesh
+      * \ingroup io
+      */
+    inline int
+    loadPLYFile (const std::string &file_name, pcl::PolygonMesh &mesh)
+    {
+      pcl::PLYReader p;
+      return (p.read (file_name, mesh));
+    }
+
     /** \brief Save point cloud data to a PLY file containing n-D points
       * \param[in] file_name the output file name
       * \param[in] cloud the point cloud data message
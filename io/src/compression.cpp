@@ -45,9 +45,23 @@
 #include "pcl/compression/entropy_range_coder.h"
 #include "pcl/compression/impl/entropy_range_coder.hpp"
 
+#include "pcl/compression/entropy_rans_coder.h"
+#include "pcl/compression/impl/entropy_rans_coder.hpp"
+
 #include "pcl/compression/octree_pointcloud_compression.h"
 #include "pcl/compression/impl/octree_pointcloud_compression.hpp"
 
+#include "pcl/compression/octree_pointcloud_compression_stream.h"
+#include "pcl/compression/impl/octree_pointcloud_compression_stream.hpp"
+
 template class PCL_EXPORTS pcl::octree::PointCloudCompression<pcl::PointXYZ>;
 template class PCL_EXPORTS pcl::octree::PointCloudCompression<pcl::PointXYZRGB>;
 template class PCL_EXPORTS pcl::octree::PointCloudCompression<pcl::PointXYZRGBA>;
+
+template class PCL_EXPORTS pcl::octree::CompressedStreamWriter<pcl::PointXYZ>;
+template class PCL_EXPORTS pcl::octree::CompressedStreamWriter<pcl::PointXYZRGB>;
+template class PCL_EXPORTS pcl::octree::CompressedStreamWriter<pcl::PointXYZRGBA>;
+
+template class PCL_EXPORTS pcl::octree::CompressedStreamReader<pcl::PointXYZ>;
+template class PCL_EXPORTS pcl::octree::CompressedStreamReader<pcl::PointXYZRGB>;
+template class PCL_EXPORTS pcl::octree::CompressedStreamReader<pcl::PointXYZRGBA>;
@@ -46,8 +46,84 @@
 #include <sstream>
 #include <boost/algorithm/string.hpp>
 
+#ifdef _WIN32
+# include <io.h>
+# include <windows.h>
+# define pcl_open                    _open
+# define pcl_close(fd)               _close(fd)
+# define pcl_lseek(fd,offset,origin) _lseek(fd,offset,origin)
+#else
+# include <sys/mman.h>
+# define pcl_open                    open
+# define pcl_close(fd)               close(fd)
+# define pcl_lseek(fd,offset,origin) lseek(fd,offset,origin)
+#endif
+
 using namespace std::tr1::placeholders;
 
+////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Map a PLY scalar type name to a sensor_msgs::PointField datatype, 0 if unknown */
+static int
+plyTypeToDatatype (const std::string &type)
+{
+  using namespace pcl::io::ply;
+  if ((type == type_traits<int8>::name ()) || (type == type_traits<int8>::old_name ()))
+    return (::sensor_msgs::PointField::INT8);
+  if ((type == type_traits<int16>::name ()) || (type == type_traits<int16>::old_name ()))
+    return (::sensor_msgs::PointField::INT16);
+  if ((type == type_traits<int32>::name ()) || (type == type_traits<int32>::old_name ()))
+    return (::sensor_msgs::PointField::INT32);
+  if ((type == type_traits<uint8>::name ()) || (type == type_traits<uint8>::old_name ()))
+    return (::sensor_msgs::PointField::UINT8);
+  if ((type == type_traits<uint16>::name ()) || (type == type_traits<uint16>::old_name ()))
+    return (::sensor_msgs::PointField::UINT16);
+  if ((type == type_traits<uint32>::name ()) || (type == type_traits<uint32>::old_name ()))
+    return (::sensor_msgs::PointField::UINT32);
+  if ((type == type_traits<float32>::name ()) || (type == type_traits<float32>::old_name ()))
+    return (::sensor_msgs::PointField::FLOAT32);
+  if ((type == type_traits<float64>::name ()) || (type == type_traits<float64>::old_name ()))
+    return (::sensor_msgs::PointField::FLOAT64);
+  return (0);
+}
+
+/** \brief Read a scalar from unaligned binary PLY data */
+template <typename ScalarType> inline ScalarType
+readBinaryScalar (const char *data, bool swap_bytes)
+{
+  ScalarType value;
+  memcpy (&value, data, sizeof (ScalarType));
+  if (swap_bytes)
+    pcl::io::ply::swap_byte_order (value);
+  return (value);
+}
+
+/** \brief Read a list size or a vertex index of any PLY type from binary PLY data */
+static uint32_t
+readBinaryIndex (const char *data, int datatype, bool swap_bytes)
+{
+  switch (datatype)
+  {
+    case ::sensor_msgs::PointField::INT8:
+      return (static_cast<uint32_t> (readBinaryScalar<pcl::io::ply::int8> (data, swap_bytes)));
+    case ::sensor_msgs::PointField::UINT8:
+      return (static_cast<uint32_t> (readBinaryScalar<pcl::io::ply::uint8> (data, swap_bytes)));
+    case ::sensor_msgs::PointField::INT16:
+      return (static_cast<uint32_t> (readBinaryScalar<pcl::io::ply::int16> (data, swap_bytes)));
+    case ::sensor_msgs::PointField::UINT16:
+      return (static_cast<uint32_t> (readBinaryScalar<pcl::io::ply::uint16> (data, swap_bytes)));
+    case ::sensor_msgs::PointField::INT32:
+      return (static_cast<uint32_t> (readBinaryScalar<pcl::io::ply::int32> (data, swap_bytes)));
+    case ::sensor_msgs::PointField::UINT32:
+      return (readBinaryScalar<pcl::io::ply::uint32> (data, swap_bytes));
+    case ::sensor_msgs::PointField::FLOAT32:
+      return (static_cast<uint32_t> (readBinaryScalar<pcl::io::ply::float32> (data, swap_bytes)));
+    case ::sensor_msgs::PointField::FLOAT64:
+      return (static_cast<uint32_t> (readBinaryScalar<pcl::io::ply::float64> (data, swap_bytes)));
+    default:
+      return (0);
+  }
+}
+
 std::tr1::tuple<std::tr1::function<void ()>, std::tr1::function<void ()> > 
 pcl::PLYReader::elementDefinitionCallback (const std::string& element_name, std::size_t count)
 {
@@ -65,12 +141,11 @@ pcl::PLYReader::elementDefinitionCallback (const std::string& element_name, std:
               std::tr1::bind (&pcl::PLYReader::vertexBeginCallback, this),
               std::tr1::bind (&pcl::PLYReader::vertexEndCallback, this)));
   }
-  // else if (element_name == "face")
-  // {
-  //   return (std::tr1::tuple<std::tr1::function<void ()>, std::tr1::function<void ()> > (
-  //             std::tr1::bind (&pcl::PLYReader::faceBegin, this),
-  //             std::tr1::bind (&pcl::PLYReader::faceEnd, this)));
-  // }
+  else if ((element_name == "face") && polygons_)
+  {
+    polygons_->reserve (polygons_->size () + count);
+    return (std::tr1::tuple<std::tr1::function<void ()>, std::tr1::function<void ()> > (0, 0));
+  }
   else if (element_name == "camera")
   {
     cloud_->is_dense = true;
@@ -237,13 +312,15 @@ namespace pcl
         std::tr1::bind (&pcl::PLYReader::rangeGridVertexIndicesEndCallback, this)
       );
     }
-    // else if ((element_name == "face") && (property_name == "vertex_indices")) {
-    // return std::tr1::tuple<std::tr1::function<void (pcl::io::ply::uint8)>, std::tr1::function<void (pcl::io::ply::int32)>, std::tr1::function<void ()> > (
-    //     std::tr1::bind (&pcl::PLYReader::faceVertexIndicesBegin, this, _1),
-    //     std::tr1::bind (&pcl::PLYReader::faceVertexIndicesElement, this, _1),
-    //     std::tr1::bind (&pcl::PLYReader::faceVertexIndicesEnd, this)
-    //   );
-    // } 
+    else if ((element_name == "face") && polygons_ &&
+             ((property_name == "vertex_indices") || (property_name == "vertex_index")))
+    {
+      return std::tr1::tuple<std::tr1::function<void (pcl::io::ply::uint8)>, std::tr1::function<void (pcl::io::ply::int32)>, std::tr1::function<void ()> > (
+        std::tr1::bind (&pcl::PLYReader::faceVertexIndicesBeginCallback, this, _1),
+        std::tr1::bind (&pcl::PLYReader::faceVertexIndicesElementCallback, this, _1),
+        0
+      );
+    }
     else {
       return std::tr1::tuple<std::tr1::function<void (pcl::io::ply::uint8)>, std::tr1::function<void (pcl::io::ply::int32)>, std::tr1::function<void ()> > (0, 0, 0);
     }
@@ -328,6 +405,19 @@ pcl::PLYReader::rangeGridEndCallback ()
   ++range_count_;
 }
 
+void 
+pcl::PLYReader::faceVertexIndicesBeginCallback (pcl::io::ply::uint8 size)
+{
+  polygons_->push_back (pcl::Vertices ());
+  polygons_->back ().vertices.reserve (size);
+}
+
+void 
+pcl::PLYReader::faceVertexIndicesElementCallback (pcl::io::ply::int32 vertex_index)
+{
+  polygons_->back ().vertices.push_back (vertex_index);
+}
+
 void 
 pcl::PLYReader::objInfoCallback (const std::string& line)
 {
@@ -399,13 +489,22 @@ int
 pcl::PLYReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cloud,
                       Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, int &ply_version)
 {
-  // kept only for backward compatibility
-  int data_type, data_idx;
+  // binary files are converted through a compiled copy plan, everything else goes through the parser
+  cloud_ = &cloud;
+  int res = readBinary (file_name);
+  if (res < 0)
+    return (-1);
 
-  if (this->readHeader (file_name, cloud, origin, orientation, ply_version, data_type, data_idx))
+  if (res > 0)
   {
-    PCL_ERROR ("[pcl::PLYReader::read] problem parsing header!\n");
-    return (-1);
+    // kept only for backward compatibility
+    int data_type, data_idx;
+
+    if (this->readHeader (file_name, cloud, origin, orientation, ply_version, data_type, data_idx))
+    {
+      PCL_ERROR ("[pcl::PLYReader::read] problem parsing header!\n");
+      return (-1);
+    }
   }
     
   // a range_grid element was found ?
@@ -444,6 +543,424 @@ pcl::PLYReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
   return (0);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PLYReader::read (const std::string &file_name, pcl::PolygonMesh &mesh)
+{
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int ply_version;
+
+  mesh.polygons.clear ();
+  polygons_ = &mesh.polygons;
+  int res = read (file_name, mesh.cloud, origin, orientation, ply_version);
+  polygons_ = 0;
+
+  return (res);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PLYReader::readBinaryHeader (const std::string &file_name, std::vector<BinaryElement> &elements,
+                                  bool &swap_bytes, size_t &data_idx)
+{
+  std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+  if (!fs.is_open () || fs.fail ())
+    return (1);
+
+  std::string line;
+  std::vector<std::string> st;
+  bool binary = false;
+
+  std::getline (fs, line);
+  boost::trim (line);
+  if (line != "ply")
+    return (1);
+
+  while (std::getline (fs, line))
+  {
+    boost::trim (line);
+    boost::split (st, line, boost::is_any_of (std::string ( "\t\r ")), boost::token_compress_on);
+    if (st.empty () || st[0].empty ())
+      continue;
+
+    if (st[0] == "format")
+    {
+      if ((st.size () != 3) || (st[2] != "1.0"))
+        return (1);
+      if (st[1] == "binary_little_endian")
+        swap_bytes = (pcl::io::ply::host_byte_order != pcl::io::ply::little_endian_byte_order);
+      else if (st[1] == "binary_big_endian")
+        swap_bytes = (pcl::io::ply::host_byte_order != pcl::io::ply::big_endian_byte_order);
+      else
+        return (1);
+      binary = true;
+    }
+    else if (st[0] == "element")
+    {
+      if (st.size () != 3)
+        return (1);
+      elements.push_back (BinaryElement ());
+      elements.back ().name = st[1];
+      elements.back ().count = strtoul (st[2].c_str (), 0, 10);
+    }
+    else if (st[0] == "property")
+    {
+      if (elements.empty ())
+        return (1);
+      BinaryProperty property;
+      if ((st.size () == 5) && (st[1] == "list"))
+      {
+        property.size_type = plyTypeToDatatype (st[2]);
+        property.type = plyTypeToDatatype (st[3]);
+        property.name = st[4];
+        if (property.size_type == 0)
+          return (1);
+      }
+      else if (st.size () == 3)
+      {
+        property.size_type = 0;
+        property.type = plyTypeToDatatype (st[1]);
+        property.name = st[2];
+      }
+      else
+        return (1);
+      if (property.type == 0)
+        return (1);
+      elements.back ().properties.push_back (property);
+    }
+    else if (st[0] == "end_header")
+    {
+      data_idx = fs.tellg ();
+      return (binary ? 0 : 1);
+    }
+    // comment and obj_info lines are ignored, as by the parser
+  }
+
+  return (1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PLYReader::readBinary (const std::string &file_name,
+                            const std::vector<sensor_msgs::PointField> *point_fields,
+                            const std::tr1::function<uint8_t* (size_t)> &resize_points,
+                            size_t point_step)
+{
+  std::vector<BinaryElement> elements;
+  bool swap_bytes = false;
+  size_t data_idx = 0;
+
+  if (readBinaryHeader (file_name, elements, swap_bytes, data_idx) != 0)
+    return (1);
+
+  for (size_t e = 0; e < elements.size (); ++e)
+  {
+    // vertex records must have a fixed size to be converted in bulk
+    if (elements[e].name == "vertex")
+      for (size_t p = 0; p < elements[e].properties.size (); ++p)
+        if (elements[e].properties[p].size_type != 0)
+          return (1);
+
+    // range grids are resolved on the sensor_msgs/PointCloud2 representation
+    if (point_fields && (elements[e].name == "range_grid"))
+      return (1);
+  }
+
+  // Open for reading
+  int fd = pcl_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+    return (-1);
+
+  size_t file_size = pcl_lseek (fd, 0, SEEK_END);
+  if (file_size <= data_idx)
+  {
+    pcl_close (fd);
+    PCL_ERROR ("[pcl::PLYReader::readBinary] No data in %s!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  // Prepare the map
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  char *map = static_cast<char*>(MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+  if (map == NULL)
+  {
+    CloseHandle (fm);
+    pcl_close (fd);
+    return (-1);
+  }
+#else
+  char *map = (char*)mmap (0, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+  {
+    pcl_close (fd);
+    return (-1);
+  }
+#endif
+
+  if (range_grid_)
+    range_grid_->clear ();
+  else
+    range_grid_ = new std::vector<std::vector<int> >;
+
+  bool success = readBinaryData (map + data_idx, map + file_size, elements, swap_bytes, 
+                                 point_fields, resize_points, point_step);
+
+  // Unmap the pages of memory
+#if _WIN32
+  UnmapViewOfFile (map);
+  CloseHandle (fm);
+#else
+  munmap (map, file_size);
+#endif
+  pcl_close (fd);
+
+  if (!success)
+  {
+    PCL_ERROR ("[pcl::PLYReader::readBinary] Unexpected end of data in %s!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  cloud_->row_step = cloud_->point_step * cloud_->width;
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PLYReader::readBinaryData (const char *data, const char *data_end, const std::vector<BinaryElement> &elements,
+                                bool swap_bytes, const std::vector<sensor_msgs::PointField> *point_fields,
+                                const std::tr1::function<uint8_t* (size_t)> &resize_points, size_t point_step)
+{
+  for (size_t e = 0; e < elements.size (); ++e)
+  {
+    const BinaryElement &element = elements[e];
+    const size_t nr_properties = element.properties.size ();
+
+    // element callbacks reset the cloud, range grid and polygons exactly as with the parser
+    std::tr1::tuple<std::tr1::function<void ()>, std::tr1::function<void ()> > element_callbacks = 
+      elementDefinitionCallback (element.name, element.count);
+
+    if (element.name == "vertex")
+    {
+      // compile the vertex layout into a copy plan
+      std::vector<VertexCopyOperation> operations;
+      VertexCopyOperation rgb_operation;
+      bool has_color[3] = {false, false, false};
+      size_t record_size = 0;
+
+      for (size_t p = 0; p < nr_properties; ++p)
+      {
+        const BinaryProperty &property = element.properties[p];
+        VertexCopyOperation operation;
+        operation.src_offset[0] = record_size;
+
+        if (property.type == ::sensor_msgs::PointField::FLOAT32)
+        {
+          appendFloatProperty (property.name);
+          operation.type = VertexCopyOperation::COPY_FLOAT32;
+          operation.dst_offset = cloud_->fields.back ().offset;
+          operations.push_back (operation);
+        }
+        else if ((property.type == ::sensor_msgs::PointField::UINT8) && (property.name == "intensity"))
+        {
+          appendFloatProperty (property.name);
+          operation.type = VertexCopyOperation::UINT8_TO_FLOAT32;
+          operation.dst_offset = cloud_->fields.back ().offset;
+          operations.push_back (operation);
+        }
+        else if (property.type == ::sensor_msgs::PointField::UINT8)
+        {
+          int color = (property.name == "red") ? 0 : (property.name == "green") ? 1 : (property.name == "blue") ? 2 : -1;
+          if (color == 0)
+          {
+            appendFloatProperty ("rgb");
+            rgb_operation.type = VertexCopyOperation::PACK_RGB;
+            rgb_operation.dst_offset = cloud_->fields.back ().offset;
+          }
+          if (color >= 0)
+          {
+            rgb_operation.src_offset[color] = record_size;
+            has_color[color] = true;
+          }
+        }
+
+        record_size += pcl::getFieldSize (property.type);
+      }
+      if (has_color[0] && has_color[1] && has_color[2])
+        operations.push_back (rgb_operation);
+
+      if (static_cast<size_t> (data_end - data) / record_size < element.count)
+        return (false);
+
+      // destination of the conversion
+      uint8_t *points;
+      size_t step;
+      if (point_fields)
+      {
+        // redirect the plan to the fields of the point type with the same name
+        std::vector<VertexCopyOperation> point_operations;
+        for (size_t f = 0; f < cloud_->fields.size (); ++f)
+        {
+          for (size_t o = 0; o < operations.size (); ++o)
+          {
+            if (operations[o].dst_offset != cloud_->fields[f].offset)
+              continue;
+            for (size_t d = 0; d < point_fields->size (); ++d)
+            {
+              if (((*point_fields)[d].name == cloud_->fields[f].name) && 
+                  ((*point_fields)[d].datatype == ::sensor_msgs::PointField::FLOAT32))
+              {
+                point_operations.push_back (operations[o]);
+                point_operations.back ().dst_offset = (*point_fields)[d].offset;
+              }
+            }
+          }
+        }
+        operations.swap (point_operations);
+        points = resize_points (element.count);
+        step = point_step;
+      }
+      else
+      {
+        cloud_->data.resize (cloud_->point_step * cloud_->width * cloud_->height);
+        points = cloud_->data.empty () ? 0 : &cloud_->data[0];
+        step = cloud_->point_step;
+      }
+
+      const int nr_points = static_cast<int> (element.count);
+      const int nr_operations = static_cast<int> (operations.size ());
+#pragma omp parallel for schedule (static)
+      for (int i = 0; i < nr_points; ++i)
+      {
+        const char *record = data + i * record_size;
+        uint8_t *point = points + i * step;
+        for (int o = 0; o < nr_operations; ++o)
+        {
+          const VertexCopyOperation &operation = operations[o];
+          switch (operation.type)
+          {
+            case VertexCopyOperation::COPY_FLOAT32:
+            {
+              pcl::io::ply::float32 value = readBinaryScalar<pcl::io::ply::float32> (record + operation.src_offset[0], swap_bytes);
+              memcpy (point + operation.dst_offset, &value, sizeof (pcl::io::ply::float32));
+              break;
+            }
+            case VertexCopyOperation::UINT8_TO_FLOAT32:
+            {
+              pcl::io::ply::float32 value = static_cast<pcl::io::ply::uint8> (record[operation.src_offset[0]]);
+              memcpy (point + operation.dst_offset, &value, sizeof (pcl::io::ply::float32));
+              break;
+            }
+            case VertexCopyOperation::PACK_RGB:
+            {
+              int32_t rgb = int32_t (static_cast<pcl::io::ply::uint8> (record[operation.src_offset[0]])) << 16 | 
+                            int32_t (static_cast<pcl::io::ply::uint8> (record[operation.src_offset[1]])) << 8 | 
+                            int32_t (static_cast<pcl::io::ply::uint8> (record[operation.src_offset[2]]));
+              memcpy (point + operation.dst_offset, &rgb, sizeof (int32_t));
+              break;
+            }
+          }
+        }
+      }
+
+      data += element.count * record_size;
+      vertex_count_ = element.count;
+      continue;
+    }
+
+    // scalar and list callbacks of the other elements, set up as by the parser
+    std::vector<std::tr1::function<void (pcl::io::ply::float32)> > float32_callbacks (nr_properties);
+    std::vector<std::tr1::function<void (pcl::io::ply::int32)> > int32_callbacks (nr_properties);
+    std::vector<std::tr1::function<void (pcl::io::ply::uint8)> > uint8_callbacks (nr_properties);
+    std::vector<std::tr1::tuple<std::tr1::function<void (pcl::io::ply::uint8)>, std::tr1::function<void (pcl::io::ply::int32)>, std::tr1::function<void ()> > > 
+      list_callbacks (nr_properties);
+    std::vector<bool> face_lists (nr_properties, false);
+    size_t face_begin = 0;
+
+    for (size_t p = 0; p < nr_properties; ++p)
+    {
+      const BinaryProperty &property = element.properties[p];
+      if (property.size_type == 0)
+      {
+        if (property.type == ::sensor_msgs::PointField::FLOAT32)
+          float32_callbacks[p] = scalarPropertyDefinitionCallback<pcl::io::ply::float32> (element.name, property.name);
+        else if (property.type == ::sensor_msgs::PointField::INT32)
+          int32_callbacks[p] = scalarPropertyDefinitionCallback<pcl::io::ply::int32> (element.name, property.name);
+        else if (property.type == ::sensor_msgs::PointField::UINT8)
+          uint8_callbacks[p] = scalarPropertyDefinitionCallback<pcl::io::ply::uint8> (element.name, property.name);
+      }
+      else if (polygons_ && (element.name == "face") && 
+               ((property.name == "vertex_indices") || (property.name == "vertex_index")))
+      {
+        // faces are bulk loaded for any list and index type
+        face_lists[p] = true;
+        face_begin = polygons_->size ();
+        polygons_->resize (face_begin + element.count);
+      }
+      else if ((property.size_type == ::sensor_msgs::PointField::UINT8) && (property.type == ::sensor_msgs::PointField::INT32))
+        list_callbacks[p] = listPropertyDefinitionCallback<pcl::io::ply::uint8, pcl::io::ply::int32> (element.name, property.name);
+    }
+
+    for (size_t r = 0; r < element.count; ++r)
+    {
+      if (std::tr1::get<0> (element_callbacks))
+        std::tr1::get<0> (element_callbacks) ();
+
+      for (size_t p = 0; p < nr_properties; ++p)
+      {
+        const BinaryProperty &property = element.properties[p];
+        const size_t scalar_size = pcl::getFieldSize (property.type);
+
+        if (property.size_type == 0)
+        {
+          if (static_cast<size_t> (data_end - data) < scalar_size)
+            return (false);
+          if (float32_callbacks[p])
+            float32_callbacks[p] (readBinaryScalar<pcl::io::ply::float32> (data, swap_bytes));
+          else if (int32_callbacks[p])
+            int32_callbacks[p] (readBinaryScalar<pcl::io::ply::int32> (data, swap_bytes));
+          else if (uint8_callbacks[p])
+            uint8_callbacks[p] (readBinaryScalar<pcl::io::ply::uint8> (data, swap_bytes));
+          data += scalar_size;
+          continue;
+        }
+
+        const size_t size_size = pcl::getFieldSize (property.size_type);
+        if (static_cast<size_t> (data_end - data) < size_size)
+          return (false);
+        const uint32_t list_size = readBinaryIndex (data, property.size_type, swap_bytes);
+        data += size_size;
+        if (static_cast<size_t> (data_end - data) / scalar_size < list_size)
+          return (false);
+
+        if (face_lists[p])
+        {
+          std::vector<uint32_t> &vertices = (*polygons_)[face_begin + r].vertices;
+          vertices.resize (list_size);
+          for (uint32_t i = 0; i < list_size; ++i)
+            vertices[i] = readBinaryIndex (data + i * scalar_size, property.type, swap_bytes);
+        }
+        else if (std::tr1::get<1> (list_callbacks[p]))
+        {
+          if (std::tr1::get<0> (list_callbacks[p]))
+            std::tr1::get<0> (list_callbacks[p]) (static_cast<pcl::io::ply::uint8> (list_size));
+          for (uint32_t i = 0; i < list_size; ++i)
+            std::tr1::get<1> (list_callbacks[p]) (readBinaryScalar<pcl::io::ply::int32> (data + i * scalar_size, swap_bytes));
+          if (std::tr1::get<2> (list_callbacks[p]))
+            std::tr1::get<2> (list_callbacks[p]) ();
+        }
+        data += list_size * scalar_size;
+      }
+
+      if (std::tr1::get<1> (element_callbacks))
+        std::tr1::get<1> (element_callbacks) ();
+    }
+  }
+
+  return (true);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 
 std::string
@@ -44,7 +44,9 @@
 #include <pcl/common/io.h>
 #include <pcl/console/print.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/io/pcd_recorder.h>
 #include <pcl/io/ply_io.h>
+#include <algorithm>
 #include <fstream>
 #include <locale>
 #include <stdexcept>
@@ -938,6 +940,77 @@ TEST (PCL, PLYReaderWriter)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename T> void
+writeBinaryPLYScalar (std::ofstream &fs, T value, bool big_endian)
+{
+  char *bytes = reinterpret_cast<char*> (&value);
+  if (big_endian)
+    std::reverse (bytes, bytes + sizeof (T));
+  fs.write (bytes, sizeof (T));
+}
+
+TEST (PCL, PLYReaderBinaryMesh)
+{
+  const float xyz[4][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.5f}};
+  const int faces[2][4] = {{0, 1, 2, -1}, {0, 1, 2, 3}};
+
+  for (int big_endian = 0; big_endian < 2; ++big_endian)
+  {
+    {
+      std::ofstream fs ("test_pcl_io_mesh.ply", std::ios::out | std::ios::binary);
+      fs << "ply\n"
+         << "format " << (big_endian ? "binary_big_endian" : "binary_little_endian") << " 1.0\n"
+         << "comment PCL test\n"
+         << "element vertex 4\n"
+         << "property float x\nproperty float y\nproperty float z\n"
+         << "property uchar red\nproperty uchar green\nproperty uchar blue\n"
+         << "element face 2\n"
+         << "property list uchar int vertex_indices\n"
+         << "end_header\n";
+      for (int i = 0; i < 4; ++i)
+      {
+        for (int d = 0; d < 3; ++d)
+          writeBinaryPLYScalar (fs, xyz[i][d], big_endian != 0);
+        writeBinaryPLYScalar<uint8_t> (fs, static_cast<uint8_t> (10 * i), false);
+        writeBinaryPLYScalar<uint8_t> (fs, 20, false);
+        writeBinaryPLYScalar<uint8_t> (fs, 30, false);
+      }
+      for (int f = 0; f < 2; ++f)
+      {
+        writeBinaryPLYScalar<uint8_t> (fs, static_cast<uint8_t> (3 + f), false);
+        for (int v = 0; v < 3 + f; ++v)
+          writeBinaryPLYScalar (fs, faces[f][v], big_endian != 0);
+      }
+    }
+
+    // vertices converted straight into the point type
+    PointCloud<PointXYZRGB> cloud;
+    EXPECT_EQ (loadPLYFile ("test_pcl_io_mesh.ply", cloud), 0);
+    EXPECT_EQ (cloud.size (), 4);
+    for (int i = 0; i < 4; ++i)
+    {
+      EXPECT_FLOAT_EQ (cloud[i].x, xyz[i][0]);
+      EXPECT_FLOAT_EQ (cloud[i].y, xyz[i][1]);
+      EXPECT_FLOAT_EQ (cloud[i].z, xyz[i][2]);
+      EXPECT_EQ (cloud[i].r, 10 * i);
+      EXPECT_EQ (cloud[i].g, 20);
+      EXPECT_EQ (cloud[i].b, 30);
+    }
+
+    PolygonMesh mesh;
+    EXPECT_EQ (loadPLYFile ("test_pcl_io_mesh.ply", mesh), 0);
+    EXPECT_EQ (mesh.cloud.width * mesh.cloud.height, 4);
+    EXPECT_EQ (mesh.polygons.size (), 2);
+    for (int f = 0; f < 2; ++f)
+    {
+      EXPECT_EQ (mesh.polygons[f].vertices.size (), 3 + f);
+      for (int v = 0; v < 3 + f; ++v)
+        EXPECT_EQ (mesh.polygons[f].vertices[v], faces[f][v]);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 struct PointXYZFPFH33
@@ -957,6 +1030,64 @@ inline std::ostream& operator << (std::ostream& os, const PointXYZFPFH33& p)
   return os;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FromROSMsgLayouts)
+{
+  PointCloud<PointXYZRGBNormal> cloud;
+  cloud.width  = 160;
+  cloud.height = 120;
+  cloud.points.resize (cloud.width * cloud.height);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    cloud.points[i].x = float (i);
+    cloud.points[i].y = -float (i);
+    cloud.points[i].z = 0.5f * float (i);
+    cloud.points[i].rgba = uint32_t (i);
+    cloud.points[i].curvature = 2.0f * float (i);
+  }
+  sensor_msgs::PointCloud2 msg, padded;
+  toROSMsg (cloud, msg);
+
+  // Same layout with padded rows
+  padded = msg;
+  padded.row_step = msg.row_step + 12;
+  padded.data.assign (padded.row_step * padded.height, 0);
+  for (uint32_t row = 0; row < msg.height; ++row)
+    memcpy (&padded.data[row * padded.row_step], &msg.data[row * msg.row_step], msg.row_step);
+
+  // Repeated conversions reuse the cached mappings of each layout
+  for (int rep = 0; rep < 2; ++rep)
+  {
+    PointCloud<PointXYZRGBNormal> same;
+    PointCloud<PointXYZ> xyz, xyz_padded;
+    PointCloud<PointNormal> normals;
+    fromROSMsg (msg, same);
+    fromROSMsg (msg, xyz);
+    fromROSMsg (padded, xyz_padded);
+    fromROSMsg (msg, normals);
+
+    ASSERT_EQ (same.points.size (), cloud.points.size ());
+    ASSERT_EQ (xyz_padded.points.size (), cloud.points.size ());
+    EXPECT_EQ (xyz.width, cloud.width);
+    EXPECT_EQ (xyz.height, cloud.height);
+    for (size_t i = 0; i < cloud.points.size (); ++i)
+    {
+      EXPECT_EQ (same.points[i].rgba, cloud.points[i].rgba);
+      EXPECT_EQ (xyz.points[i].y, cloud.points[i].y);
+      EXPECT_EQ (xyz_padded.points[i].z, cloud.points[i].z);
+      EXPECT_EQ (normals.points[i].curvature, cloud.points[i].curvature);
+    }
+  }
+
+  // Missing fields are still reported for every conversion
+  PointCloud<PointXYZ> xyz;
+  PointCloud<PointXYZRGB> rgb;
+  fromROSMsg (msg, xyz);
+  toROSMsg (xyz, msg);
+  EXPECT_THROW (fromROSMsg (msg, rgb), pcl::InvalidConversionException);
+  EXPECT_THROW (fromROSMsg (msg, rgb), pcl::InvalidConversionException);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, ExtendedIO)
 {
@@ -1264,6 +1395,74 @@ TEST (PCL, Locale)
 #endif
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDRecorder)
+{
+  const int nr_frames = 10;
+  std::vector<PointCloud<PointXYZ>::ConstPtr> frames;
+  for (int f = 0; f < nr_frames; ++f)
+  {
+    PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+    cloud->width = 64; cloud->height = 1; cloud->is_dense = true;
+    cloud->points.resize (cloud->width);
+    for (size_t i = 0; i < cloud->points.size (); ++i)
+    {
+      cloud->points[i].x = static_cast<float> (f);
+      cloud->points[i].y = static_cast<float> (i);
+      cloud->points[i].z = static_cast<float> (f * i);
+    }
+    frames.push_back (cloud);
+  }
+
+  // Blocking, compressed, multiple writers: every frame must reach the disk
+  {
+    PCDRecorder<PointXYZ> recorder ("test_pcl_io_recorder_", 3, 2);
+    recorder.setCompression (true);
+    recorder.start ();
+    for (int f = 0; f < nr_frames; ++f)
+      EXPECT_TRUE (recorder.push (frames[f]));
+    recorder.stop ();
+
+    EXPECT_EQ (recorder.getFramesWritten (), size_t (nr_frames));
+    EXPECT_EQ (recorder.getFramesDropped (), size_t (0));
+    EXPECT_EQ (recorder.getFramesFailed (), size_t (0));
+    EXPECT_LE (recorder.getMaxQueueDepth (), size_t (2));
+    EXPECT_EQ (recorder.getBytesWritten (), nr_frames * 64 * sizeof (PointXYZ));
+  }
+
+  PCDReader reader;
+  for (int f = 0; f < nr_frames; ++f)
+  {
+    std::stringstream ss;
+    ss << "test_pcl_io_recorder_" << std::setfill ('0') << std::setw (6) << f << ".pcd";
+    PointCloud<PointXYZ> cloud;
+    EXPECT_EQ (reader.read (ss.str (), cloud), 0);
+    ASSERT_EQ (cloud.points.size (), frames[f]->points.size ());
+    for (size_t i = 0; i < cloud.points.size (); ++i)
+    {
+      EXPECT_EQ (cloud.points[i].x, frames[f]->points[i].x);
+      EXPECT_EQ (cloud.points[i].y, frames[f]->points[i].y);
+      EXPECT_EQ (cloud.points[i].z, frames[f]->points[i].z);
+    }
+  }
+
+  // Dropping the newest frame never blocks and accounts for every frame
+  {
+    PCDRecorder<PointXYZ> recorder ("test_pcl_io_recorder_", 1, 1);
+    recorder.setQueuePolicy (PCDRecorder<PointXYZ>::DROP_NEWEST);
+    recorder.start ();
+    for (int f = 0; f < nr_frames; ++f)
+      recorder.push (frames[f]);
+    recorder.stop ();
+    EXPECT_EQ (recorder.getFramesWritten () + recorder.getFramesDropped (), size_t (nr_frames));
+  }
+
+  // Pushing to a stopped recorder drops the frame
+  PCDRecorder<PointXYZ> recorder ("test_pcl_io_recorder_");
+  EXPECT_FALSE (recorder.push (frames[0]));
+  EXPECT_EQ (recorder.getFramesDropped (), size_t (1));
+}
+
 /* ---[ */
 int
   main (int argc, char** argv)
@@ -41,6 +41,8 @@
 
 #include "pcl/compression/entropy_range_coder.h"
 #include "pcl/compression/impl/entropy_range_coder.hpp"
+#include "pcl/compression/entropy_rans_coder.h"
+#include "pcl/compression/impl/entropy_rans_coder.hpp"
 
 #include <gtest/gtest.h>
 #include <vector>
@@ -166,9 +168,107 @@ TEST (PCL, Static_Range_Coder_Test)
     EXPECT_EQ (inputIntData[i], outputIntData[i]);
   }
 
+  // integer vectors with a symbol count of one or 256 need a wider frequency table entry
+  const unsigned int shortVectorSizes[] = { 1, 256 };
+  for (size_t v = 0; v < 2; v++)
+  {
+    std::stringstream shortStream;
+
+    inputIntData.assign (shortVectorSizes[v], 3);
+    outputIntData.resize (shortVectorSizes[v]);
+
+    writeByteLen = rangeCoder.encodeIntVectorToStream(inputIntData, shortStream);
+    readByteLen = rangeCoder.decodeStreamToIntVector(shortStream, outputIntData);
+
+    EXPECT_EQ (writeByteLen, readByteLen);
+    for (i=0; i<shortVectorSizes[v]; i++)
+    {
+      EXPECT_EQ (inputIntData[i], outputIntData[i]);
+    }
+  }
+
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Static_RANS_Coder_Test)
+{
+  size_t i;
+  std::vector<unsigned int> vectorSizes;
+
+  unsigned long writeByteLen;
+  unsigned long readByteLen;
+
+  // cover empty vectors and sizes that are not a multiple of the interleaving factor
+  vectorSizes.push_back (0);
+  vectorSizes.push_back (1);
+  vectorSizes.push_back (7);
+  vectorSizes.push_back (1000);
+  vectorSizes.push_back (100003);
+
+  for (size_t v = 0; v < vectorSizes.size (); v++)
+  {
+    const unsigned int vectorSize = vectorSizes[v];
+
+    std::vector<char> inputCharData (vectorSize);
+    std::vector<char> skewedCharData (vectorSize);
+    std::vector<char> outputCharData (vectorSize);
+
+    std::vector<unsigned int> inputIntData (vectorSize);
+    std::vector<unsigned int> outputIntData (vectorSize);
+
+    // fill vectors with random and with highly skewed data
+    for (i=0; i<vectorSize; i++)
+    {
+      inputCharData[i] = (char)rand() & 0xFF;
+      skewedCharData[i] = (rand() % 100) ? 0 : (char)rand() & 0xFF;
+      inputIntData[i]  = (i % 3) ? (unsigned int)rand() & 0xF : (unsigned int)rand();
+    }
+
+    // initialize static rANS coder
+    pcl::StaticRANSCoder ransCoder;
+
+    for (int d = 0; d < 2; d++)
+    {
+      const std::vector<char>& charData = d ? skewedCharData : inputCharData;
+      std::stringstream sstream;
+
+      // encode char vector to stringstream
+      writeByteLen = ransCoder.encodeCharVectorToStream(charData, sstream);
+
+      // decode stringstream to char vector
+      readByteLen = ransCoder.decodeStreamToCharVector(sstream, outputCharData);
+
+      // compare amount of bytes that are read and written to/from stream
+      EXPECT_EQ (writeByteLen, readByteLen);
+      EXPECT_EQ (writeByteLen, sstream.str().length());
+
+      // compare input and output vector - should be identical
+      for (i=0; i<vectorSize; i++)
+      {
+        EXPECT_EQ (charData[i], outputCharData[i]);
+      }
+    }
+
+    std::stringstream sstream;
+
+    // encode integer vector to stringstream
+    writeByteLen = ransCoder.encodeIntVectorToStream(inputIntData, sstream);
+
+    // decode stringstream to integer vector
+    readByteLen = ransCoder.decodeStreamToIntVector(sstream, outputIntData);
+
+    // compare amount of bytes that are read and written to/from stream
+    EXPECT_EQ (writeByteLen, readByteLen);
+    EXPECT_EQ (writeByteLen, sstream.str().length());
+
+    // compare input and output vector - should be identical
+    for (i=0; i<vectorSize; i++)
+    {
+      EXPECT_EQ (inputIntData[i], outputIntData[i]);
+    }
+  }
+}
 
 /* ---[ */
 int
@@ -0,0 +1,164 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <iostream>
+#include <sstream>
+#include <pcl/point_types.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/common/time.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/compression/octree_pointcloud_compression.h>
+
+using namespace pcl;
+using namespace pcl::octree;
+using namespace pcl::console;
+
+typedef PointXYZRGBA PointT;
+typedef PointCloudCompression<PointT> Compression;
+
+int default_profile = MED_RES_ONLINE_COMPRESSION_WITH_COLOR;
+int default_iterations = 5;
+int default_subtree_depth = 0;
+
+void
+printHelp (int argc, char **argv)
+{
+  print_error ("Syntax is: %s frame_0.pcd [frame_1.pcd ...] <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -profile X    = compression profile index, 0..11 (default: ");
+  print_value ("%d", default_profile); print_info (")\n");
+  print_info ("                     -iterations X = number of passes over all frames (default: ");
+  print_value ("%d", default_iterations); print_info (")\n");
+  print_info ("                     -subtree_depth X = octree depth at which the leaf data is split into\n");
+  print_info ("                                        subtrees that are coded in parallel (default: ");
+  print_value ("%d", default_subtree_depth); print_info (")\n");
+}
+
+/** \brief Encode and decode all frames with the given entropy coder, reporting time and size. */
+bool
+benchmark (const std::vector<PointCloud<PointT>::ConstPtr> &frames, compression_Profiles_e profile,
+           entropyCoder_e coder, int iterations, int subtree_depth)
+{
+  double encode_time = 0, decode_time = 0;
+  size_t compressed_bytes = 0, points = 0;
+  bool success = true;
+
+  for (int it = 0; it < iterations; ++it)
+  {
+    // fresh coder instances per pass, so every pass starts with an I-frame
+    Compression encoder (profile);
+    Compression decoder;
+    encoder.setEntropyCoder (coder);
+    encoder.setSubtreeDepth ((unsigned char)subtree_depth);
+
+    for (size_t f = 0; f < frames.size (); ++f)
+    {
+      std::stringstream stream;
+      PointCloud<PointT>::Ptr decoded (new PointCloud<PointT>);
+
+      double start = getTime ();
+      encoder.encodePointCloud (frames[f], stream);
+      double middle = getTime ();
+      decoder.decodePointCloud (stream, decoded);
+      double end = getTime ();
+
+      encode_time += middle - start;
+      decode_time += end - middle;
+      compressed_bytes += stream.str ().size ();
+      points += frames[f]->points.size ();
+
+      success &= (decoder.getEntropyCoder () == coder);
+    }
+  }
+
+  size_t nr_frames = frames.size () * iterations;
+  print_info ("%s: ", coder == RANS_CODER ? "rANS coder " : "range coder");
+  print_value ("%8.3f", encode_time * 1000.0 / nr_frames); print_info (" ms encoding, ");
+  print_value ("%8.3f", decode_time * 1000.0 / nr_frames); print_info (" ms decoding, ");
+  print_value ("%8.3f", 8.0 * compressed_bytes / points); print_info (" bits per point\n");
+
+  return (success);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Compare the entropy coders of pcl::octree::PointCloudCompression on the same frames. For more information, use: %s -h\n", argv[0]);
+
+  std::vector<int> p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.empty () || find_switch (argc, argv, "-h"))
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  int profile = default_profile;
+  int iterations = default_iterations;
+  parse_argument (argc, argv, "-profile", profile);
+  int subtree_depth = default_subtree_depth;
+  parse_argument (argc, argv, "-iterations", iterations);
+  parse_argument (argc, argv, "-subtree_depth", subtree_depth);
+  if (profile < 0 || profile >= COMPRESSION_PROFILE_COUNT || iterations < 1 || subtree_depth < 0 || subtree_depth > 255)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  std::vector<PointCloud<PointT>::ConstPtr> frames;
+  for (size_t i = 0; i < p_file_indices.size (); ++i)
+  {
+    PointCloud<PointT>::Ptr cloud (new PointCloud<PointT>);
+    if (io::loadPCDFile (argv[p_file_indices[i]], *cloud) < 0)
+    {
+      print_error ("Unable to load %s.\n", argv[p_file_indices[i]]);
+      return (-1);
+    }
+    frames.push_back (cloud);
+  }
+  print_info ("Loaded "); print_value ("%d", (int)frames.size ()); print_info (" frames.\n");
+
+  bool success = true;
+  success &= benchmark (frames, (compression_Profiles_e)profile, RANGE_CODER, iterations, subtree_depth);
+  success &= benchmark (frames, (compression_Profiles_e)profile, RANS_CODER, iterations, subtree_depth);
+
+  return (success ? 0 : -1);
+}
+/* ]--- */
@@ -70,7 +70,7 @@ pcl::KdTreeFLANN<PointT, Dist>::setInputCloud (const PointCloudConstPtr &cloud,
     convertCloudToArray (*input_);
   }
 
-  flann_index_ = new FLANNIndex (flann::Matrix<float> (cloud_, index_mapping_.size (), dim_),
+  flann_index_ = new FLANNIndex (flann::Matrix<ElementType> (cloud_, index_mapping_.size (), dim_),
                                  flann::KDTreeSingleIndexParams (15)); // max 15 points/leaf
   flann_index_->buildIndex ();
 }
@@ -92,13 +92,13 @@ pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, int k,
   k_indices.resize (k);
   k_distances.resize (k);
 
-  std::vector<float> query (dim_);
+  std::vector<ElementType> query (dim_);
   point_representation_->vectorize ((PointT)point, query);
 
   flann::Matrix<int> k_indices_mat (&k_indices[0], 1, k);
   flann::Matrix<float> k_distances_mat (&k_distances[0], 1, k);
   // Wrap the k_indices and k_distances vectors (no data copy)
-  flann_index_->knnSearch (flann::Matrix<float> (&query[0], 1, dim_), 
+  flann_index_->knnSearch (flann::Matrix<ElementType> (&query[0], 1, dim_), 
                            k_indices_mat, k_distances_mat,
                            k, param_k_);
 
@@ -122,7 +122,7 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
 {
   assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
 
-  std::vector<float> query (dim_);
+  std::vector<ElementType> query (dim_);
   point_representation_->vectorize ((PointT)point, query);
 
   int neighbors_in_radius = 0;
@@ -132,7 +132,7 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   {
     flann::Matrix<int> k_indices_mat (&k_indices[0], 1, k_indices.size ());
     flann::Matrix<float> k_distances_mat (&k_sqr_dists[0], 1, k_sqr_dists.size ());
-    neighbors_in_radius = flann_index_->radiusSearch (flann::Matrix<float> (&query[0], 1, dim_),
+    neighbors_in_radius = flann_index_->radiusSearch (flann::Matrix<ElementType> (&query[0], 1, dim_),
                                                       k_indices_mat,
                                                       k_distances_mat,
                                                       (float) (radius * radius), 
@@ -146,7 +146,7 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
 
     static flann::Matrix<int> indices_empty;
     static flann::Matrix<float> dists_empty;
-    neighbors_in_radius = flann_index_->radiusSearch (flann::Matrix<float> (&query[0], 1, dim_),
+    neighbors_in_radius = flann_index_->radiusSearch (flann::Matrix<ElementType> (&query[0], 1, dim_),
                                                       indices_empty,
                                                       dists_empty,
                                                       (float) (radius * radius), 
@@ -159,7 +159,7 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
     {
       flann::Matrix<int> k_indices_mat (&k_indices[0], 1, k_indices.size ());
       flann::Matrix<float> k_distances_mat (&k_sqr_dists[0], 1, k_sqr_dists.size ());
-      flann_index_->radiusSearch (flann::Matrix<float> (&query[0], 1, dim_),
+      flann_index_->radiusSearch (flann::Matrix<ElementType> (&query[0], 1, dim_),
                                   k_indices_mat,
                                   k_distances_mat,
                                   (float) (radius * radius), 
@@ -180,6 +180,20 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   return (neighbors_in_radius);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int 
+pcl::KdTreeFLANN<PointT, Dist>::radiusCount (const PointT &point, double radius, unsigned int max_nn) const
+{
+  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to radiusCount!");
+
+  std::vector<ElementType> query (dim_);
+  point_representation_->vectorize ((PointT)point, query);
+
+  detail::CountingRadiusResultSet<float> result_set ((float) (radius * radius), (int) max_nn);
+  flann_index_->findNeighbors (result_set, &query[0], param_radius_);
+  return (result_set.size ());
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> void 
 pcl::KdTreeFLANN<PointT, Dist>::cleanup ()
@@ -212,8 +226,8 @@ pcl::KdTreeFLANN<PointT, Dist>::convertCloudToArray (const PointCloud &cloud)
 
   int original_no_of_points = (int) cloud.points.size ();
 
-  cloud_ = (float*)malloc (original_no_of_points * dim_ * sizeof(float));
-  float* cloud_ptr = cloud_;
+  cloud_ = (ElementType*)malloc (original_no_of_points * dim_ * sizeof (ElementType));
+  ElementType* cloud_ptr = cloud_;
   index_mapping_.reserve (original_no_of_points);
   identity_mapping_ = true;
 
@@ -246,8 +260,8 @@ pcl::KdTreeFLANN<PointT, Dist>::convertCloudToArray (const PointCloud &cloud, co
 
   int original_no_of_points = (int) indices.size ();
 
-  cloud_ = (float*)malloc (original_no_of_points * dim_ * sizeof (float));
-  float* cloud_ptr = cloud_;
+  cloud_ = (ElementType*)malloc (original_no_of_points * dim_ * sizeof (ElementType));
+  ElementType* cloud_ptr = cloud_;
   index_mapping_.reserve (original_no_of_points);
 
   // true only identity: 
@@ -273,6 +287,7 @@ pcl::KdTreeFLANN<PointT, Dist>::convertCloudToArray (const PointCloud &cloud, co
 }
 
 #define PCL_INSTANTIATE_KdTreeFLANN(T) template class PCL_EXPORTS pcl::KdTreeFLANN<T>;
+#define PCL_INSTANTIATE_KdTreeFLANN_L2_SQR_uint8(T) template class PCL_EXPORTS pcl::KdTreeFLANN<T, pcl::L2_SQR_Distance<pcl::uint8_t> >;
 
 #endif  //#ifndef _PCL_KDTREE_KDTREE_IMPL_FLANN_H_
 
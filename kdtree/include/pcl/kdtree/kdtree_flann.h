@@ -47,9 +47,58 @@
 
 namespace pcl
 {
+  namespace detail
+  {
+    /** \brief FLANN result set which only counts the points found in a given radius. Once \a max_nn points
+      * have been counted, the worst distance collapses below zero, so FLANN prunes every remaining branch and
+      * the search terminates early.
+      */
+    template <typename DistanceType>
+    class CountingRadiusResultSet : public flann::ResultSet<DistanceType>
+    {
+      public:
+        CountingRadiusResultSet (DistanceType radius, int max_nn) : radius_ (radius), max_nn_ (max_nn), count_ (0) {}
+
+        inline bool
+        full () const
+        {
+          return (max_nn_ > 0 && count_ >= max_nn_);
+        }
+
+        inline void
+        addPoint (DistanceType dist, int)
+        {
+          if (dist < radius_)
+            ++count_;
+        }
+
+        inline DistanceType
+        worstDist () const
+        {
+          return (full () ? DistanceType (-1) : radius_);
+        }
+
+        /** \brief Get the number of points counted, bounded by \a max_nn if given. */
+        inline int
+        size () const
+        {
+          return (max_nn_ > 0 && count_ > max_nn_ ? max_nn_ : count_);
+        }
+
+      private:
+        DistanceType radius_;
+        int max_nn_;
+        int count_;
+    };
+  }
+
   /** \brief KdTreeFLANN is a generic type of 3D spatial locator using kD-tree structures. The class is making use of
     * the FLANN (Fast Library for Approximate Nearest Neighbor) project by Marius Muja and David Lowe.
     *
+    * The points are stored in the index as arrays of Dist::ElementType, so a distance functor over uint8_t (e.g.
+    * pcl::L2_SQR_Distance<uint8_t> from pcl/common/norms.h) together with a quantized descriptor type (e.g.
+    * \ref QuantizedFPFHSignature33) keeps the index at one byte per dimension. Dist::ResultType must be float.
+    *
     * \author Radu B. Rusu, Marius Muja
     * \ingroup kdtree 
     */
@@ -72,10 +121,11 @@ namespace pcl
       typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
 
       typedef flann::Index<Dist> FLANNIndex;
+      typedef typename Dist::ElementType ElementType;
 
       // Boost shared pointers
-      typedef boost::shared_ptr<KdTreeFLANN<PointT> > Ptr;
-      typedef boost::shared_ptr<const KdTreeFLANN<PointT> > ConstPtr;
+      typedef boost::shared_ptr<KdTreeFLANN<PointT, Dist> > Ptr;
+      typedef boost::shared_ptr<const KdTreeFLANN<PointT, Dist> > ConstPtr;
 
       /** \brief Default Constructor for KdTreeFLANN.
         * \param[in] sorted set to true if the application that the tree will be used for requires sorted nearest neighbor indices (default). False otherwise. 
@@ -109,7 +159,7 @@ namespace pcl
         param_radius_ = flann::SearchParams (-1 ,epsilon_, sorted_);
       }
       
-      inline Ptr makeShared () { return Ptr (new KdTreeFLANN<PointT> (*this)); } 
+      inline Ptr makeShared () { return Ptr (new KdTreeFLANN<PointT, Dist> (*this)); } 
 
       /** \brief Destructor for KdTreeFLANN. 
         * Deletes all allocated data arrays and destroys the kd-tree structures. 
@@ -164,6 +214,18 @@ namespace pcl
       radiusSearch (const PointT &point, double radius, std::vector<int> &k_indices,
                     std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
 
+      /** \brief Count all the nearest neighbors of the query point in a given radius, without collecting their
+        * indices and distances. The search stops as soon as \a max_nn neighbors have been found.
+        * 
+        * \param[in] point a given \a valid (i.e., finite) query point
+        * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+        * \param[in] max_nn if given, the search stops once this many neighbors have been found. If \a max_nn is
+        * set to 0, all neighbors in \a radius are counted.
+        * \return number of neighbors found in radius, at most \a max_nn if given
+        */
+      int 
+      radiusCount (const PointT &point, double radius, unsigned int max_nn = 0) const;
+
     private:
       /** \brief Internal cleanup method. */
       void 
@@ -193,7 +255,7 @@ namespace pcl
       FLANNIndex* flann_index_;
 
       /** \brief Internal pointer to data. */
-      float* cloud_;
+      ElementType* cloud_;
       
       /** \brief mapping between internal and external indices. */
       std::vector<int> index_mapping_;
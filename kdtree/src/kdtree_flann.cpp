@@ -37,9 +37,12 @@
 
 #include "pcl/impl/instantiate.hpp"
 #include "pcl/point_types.h"
+#include "pcl/common/norms.h"
 #include "pcl/kdtree/kdtree_flann.h"
 #include "pcl/kdtree/impl/kdtree_flann.hpp"
 
 // Instantiations of specific point types
 PCL_INSTANTIATE(KdTreeFLANN, PCL_POINT_TYPES)
+// Quantized descriptors are indexed as bytes and compared with an 8-bit squared L2 distance
+PCL_INSTANTIATE(KdTreeFLANN_L2_SQR_uint8, PCL_QUANTIZED_FEATURE_POINT_TYPES)
 
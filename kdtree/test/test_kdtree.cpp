@@ -44,6 +44,8 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <pcl/common/distances.h>
+#include <pcl/common/norms.h>
+#include <pcl/common/descriptor_quantization.h>
 
 using namespace std;
 using namespace pcl;
@@ -395,6 +397,58 @@ TEST (PCL, KdTreeFLANN_setPointRepresentation)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTreeFLANN_quantizedDescriptors)
+{
+  srand (12345);
+  PointCloud<FPFHSignature33> fpfhs;
+  fpfhs.points.resize (500);
+  fpfhs.width = 500; fpfhs.height = 1;
+  for (size_t i = 0; i < fpfhs.points.size (); ++i)
+    for (int d = 0; d < 33; ++d)
+      fpfhs.points[i].histogram[d] = 100.0f * rand () / RAND_MAX;
+
+  PointCloud<QuantizedFPFHSignature33>::Ptr fpfhs_q (new PointCloud<QuantizedFPFHSignature33>);
+  quantizeDescriptors (fpfhs, *fpfhs_q);
+
+  KdTreeFLANN<QuantizedFPFHSignature33, L2_SQR_Distance<uint8_t> > kdtree;
+  kdtree.setInputCloud (fpfhs_q);
+
+  const int k = 5;
+  vector<int> k_indices (k);
+  vector<float> k_distances (k);
+  for (size_t q = 0; q < fpfhs_q->points.size (); q += 50)
+  {
+    const QuantizedFPFHSignature33 &query = fpfhs_q->points[q];
+
+    // Brute force reference, in squared quantization steps
+    vector<float> distances (fpfhs_q->points.size ());
+    for (size_t i = 0; i < fpfhs_q->points.size (); ++i)
+      distances[i] = L2_Norm_SQR<const uint8_t*> (query.histogram, fpfhs_q->points[i].histogram, 33);
+    vector<float> sorted_distances (distances);
+    std::sort (sorted_distances.begin (), sorted_distances.end ());
+
+    EXPECT_EQ (kdtree.nearestKSearch (query, k, k_indices, k_distances), k);
+    EXPECT_EQ (k_indices[0], (int) q);
+    for (int i = 0; i < k; ++i)
+    {
+      EXPECT_EQ (k_distances[i], sorted_distances[i]);
+      EXPECT_EQ (k_distances[i], distances[k_indices[i]]);
+    }
+
+    // radiusSearch takes the radius in quantization steps as well
+    double radius = sqrt (sorted_distances[10]) + 0.5;
+    vector<int> r_indices;
+    vector<float> r_distances;
+    int nr_found = kdtree.radiusSearch (query, radius, r_indices, r_distances);
+    int nr_expected = 0;
+    for (size_t i = 0; i < distances.size (); ++i)
+      if (distances[i] < radius * radius)
+        ++nr_expected;
+    EXPECT_EQ (nr_found, nr_expected);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -42,65 +42,9 @@
 //#include "pcl/registration/ppf_registration.h"
 #include <pcl/features/ppf.h>
 #include <pcl/common/transforms.h>
+#include <boost/unordered_map.hpp>
 
 #include <pcl/features/pfh.h>
-//////////////////////////////////////////////////////////////////////////////////////////////
-void
-pcl::PPFHashMapSearch::setInputFeatureCloud (PointCloud<PPFSignature>::ConstPtr feature_cloud)
-{
-  // Discretize the feature cloud and insert it in the hash map
-  feature_hash_map_->clear ();
-  unsigned int n = sqrt ((float)feature_cloud->points.size ());
-  int d1, d2, d3, d4;
-  max_dist_ = -1.0;
-  alpha_m_.resize (n);
-  for (size_t i = 0; i < n; ++i)
-  {
-    std::vector <float> alpha_m_row (n);
-    for (size_t j = 0; j < n; ++j)
-    {
-      d1 = floor (feature_cloud->points[i*n+j].f1 / angle_discretization_step_);
-      d2 = floor (feature_cloud->points[i*n+j].f2 / angle_discretization_step_);
-      d3 = floor (feature_cloud->points[i*n+j].f3 / angle_discretization_step_);
-      d4 = floor (feature_cloud->points[i*n+j].f4 / distance_discretization_step_);
-      feature_hash_map_->insert (std::pair<HashKeyStruct, std::pair<size_t, size_t> > (HashKeyStruct (d1, d2, d3, d4), std::pair<size_t, size_t> (i, j)));
-      alpha_m_row [j] = feature_cloud->points[i*n + j].alpha_m;
-
-      if (max_dist_ < feature_cloud->points[i*n + j].f4)
-        max_dist_ = feature_cloud->points[i*n + j].f4;
-    }
-    alpha_m_[i] = alpha_m_row;
-  }
-
-  internals_initialized_ = true;
-}
-
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-void
-pcl::PPFHashMapSearch::nearestNeighborSearch (float &f1, float &f2, float &f3, float &f4,
-                                              std::vector<std::pair<size_t, size_t> > &indices)
-{
-  if (!internals_initialized_)
-  {
-    PCL_ERROR("[pcl::PPFRegistration::nearestNeighborSearch]: input feature cloud has not been set - skipping search!\n");
-    return;
-  }
-
-  int d1 = floor (f1 / angle_discretization_step_),
-      d2 = floor (f2 / angle_discretization_step_),
-      d3 = floor (f3 / angle_discretization_step_),
-      d4 = floor (f4 / distance_discretization_step_);
-
-  indices.clear ();
-  HashKeyStruct key = HashKeyStruct (d1, d2, d3, d4);
-  std::pair <FeatureHashMapType::iterator, FeatureHashMapType::iterator> map_iterator_pair = feature_hash_map_->equal_range (key);
-  for (; map_iterator_pair.first != map_iterator_pair.second; ++ map_iterator_pair.first)
-    indices.push_back (std::pair<size_t, size_t> (map_iterator_pair.first->second.first,
-                                                  map_iterator_pair.first->second.second));
-}
-
-
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget> void
 pcl::PPFRegistration<PointSource, PointTarget>::setInputTarget (const PointCloudTargetConstPtr &cloud)
@@ -122,111 +66,130 @@ pcl::PPFRegistration<PointSource, PointTarget>::computeTransformation (PointClou
     return;
   }
 
-  if (guess != Eigen::Matrix4f::Identity ())
+  if (search_method_->getNumberOfPoints () != input_->points.size ())
   {
-    PCL_ERROR("[pcl::PPFRegistration::computeTransformation] setting initial transform (guess) not implemented!\n");
+    PCL_ERROR("[pcl::PPFRegistration::computeTransformation] The search method was trained with %u points, but the input cloud has %lu - skipping computeTransformation!\n", search_method_->getNumberOfPoints (), (unsigned long) input_->points.size ());
+    return;
   }
 
-  PoseWithVotesList voted_poses;
-  std::vector <std::vector <unsigned int> > accumulator_array;
-  accumulator_array.resize (input_->points.size ());
-  for (size_t i = 0; i < input_->points.size (); ++i)
+  if (guess != Eigen::Matrix4f::Identity ())
   {
-    std::vector <unsigned int> aux ((size_t)floor(2*M_PI / search_method_->getAngleDiscretizationStep ()), 0);
-    accumulator_array[i] = aux;
+    PCL_ERROR("[pcl::PPFRegistration::computeTransformation] setting initial transform (guess) not implemented!\n");
   }
-  PCL_INFO ("Accumulator array size: %u x %u.\n", accumulator_array.size (), accumulator_array.back ().size ());
 
-  // Consider every <scene_reference_point_sampling_rate>-th point as the reference point => fix s_r
-  float f1, f2, f3, f4;
-  for (size_t scene_reference_index = 0; scene_reference_index < target_->points.size (); scene_reference_index += scene_reference_point_sampling_rate_)
-  {
-    Eigen::Vector3f scene_reference_point = target_->points[scene_reference_index].getVector3fMap (),
-        scene_reference_normal = target_->points[scene_reference_index].getNormalVector3fMap ();
+  const size_t nr_model_points = input_->points.size ();
+  const size_t nr_angle_bins = (size_t)floor(2*M_PI / search_method_->getAngleDiscretizationStep ());
+  const int angle_offset = floor (M_PI / search_method_->getAngleDiscretizationStep ());
+  PCL_INFO ("Accumulator array size: %u x %u.\n", nr_model_points, nr_angle_bins);
 
-    Eigen::AngleAxisf rotation_sg (acos (scene_reference_normal.dot (Eigen::Vector3f::UnitX ())),
-                                   scene_reference_normal.cross (Eigen::Vector3f::UnitX ()). normalized());
-    Eigen::Affine3f transform_sg = Eigen::Translation3f ( rotation_sg* ((-1)*scene_reference_point)) * rotation_sg;
+  // Consider every <scene_reference_point_sampling_rate>-th point as the reference point => fix s_r
+  const int nr_scene_reference_points = static_cast<int> ((target_->points.size () + scene_reference_point_sampling_rate_ - 1) / scene_reference_point_sampling_rate_);
+  Eigen::Affine3f no_pose (Eigen::Affine3f::Identity ());
+  unsigned int no_votes = 0;
+  PoseWithVotesList voted_poses (nr_scene_reference_points, PoseWithVotes (no_pose, no_votes));
 
-    // For every other point in the scene => now have pair (s_r, s_i) fixed
+#pragma omp parallel num_threads (threads_)
+  {
+    // The accumulator array of this thread, cleared after every reference point through the list of the bins
+    // that received votes
+    std::vector<unsigned int> accumulator_array (nr_model_points * nr_angle_bins, 0);
+    std::vector<size_t> voted_bins;
     std::vector<int> indices;
     std::vector<float> distances;
-    scene_search_tree_->radiusSearch (target_->points[scene_reference_index],
-                                     search_method_->getModelDiameter () /2,
-                                     indices,
-                                     distances);
-    for(size_t i = 0; i < indices.size (); ++i)
-//    for(size_t i = 0; i < target_->points.size (); ++i)
+    float f1, f2, f3, f4;
+
+#pragma omp for schedule (dynamic, 4)
+    for (int reference_i = 0; reference_i < nr_scene_reference_points; ++reference_i)
     {
-      //size_t scene_point_index = i;
-      size_t scene_point_index = indices[i];
-      if (scene_reference_index != scene_point_index)
+      size_t scene_reference_index = reference_i * scene_reference_point_sampling_rate_;
+      Eigen::Vector3f scene_reference_point = target_->points[scene_reference_index].getVector3fMap (),
+          scene_reference_normal = target_->points[scene_reference_index].getNormalVector3fMap ();
+
+      Eigen::AngleAxisf rotation_sg (acos (scene_reference_normal.dot (Eigen::Vector3f::UnitX ())),
+                                     scene_reference_normal.cross (Eigen::Vector3f::UnitX ()). normalized());
+      Eigen::Affine3f transform_sg = Eigen::Translation3f ( rotation_sg* ((-1)*scene_reference_point)) * rotation_sg;
+
+      // For every other point in the scene => now have pair (s_r, s_i) fixed
+      scene_search_tree_->radiusSearch (target_->points[scene_reference_index],
+                                       search_method_->getModelDiameter () /2,
+                                       indices,
+                                       distances);
+      for(size_t i = 0; i < indices.size (); ++i)
       {
-        if (/*pcl::computePPFPairFeature*/pcl::computePairFeatures (target_->points[scene_reference_index].getVector4fMap (),
-                                        target_->points[scene_reference_index].getNormalVector4fMap (),
-                                        target_->points[scene_point_index].getVector4fMap (),
-                                        target_->points[scene_point_index].getNormalVector4fMap (),
-                                        f1, f2, f3, f4))
+        size_t scene_point_index = indices[i];
+        if (scene_reference_index == scene_point_index)
+          continue;
+
+        if (!pcl::computePairFeatures (target_->points[scene_reference_index].getVector4fMap (),
+                                       target_->points[scene_reference_index].getNormalVector4fMap (),
+                                       target_->points[scene_point_index].getVector4fMap (),
+                                       target_->points[scene_point_index].getNormalVector4fMap (),
+                                       f1, f2, f3, f4))
         {
-          std::vector<std::pair<size_t, size_t> > nearest_indices;
-          search_method_->nearestNeighborSearch (f1, f2, f3, f4, nearest_indices);
-
-          // Compute alpha_s angle
-          Eigen::Vector3f scene_point = target_->points[scene_point_index].getVector3fMap ();
-          Eigen::AngleAxisf rotation_sg (acos (scene_reference_normal.dot (Eigen::Vector3f::UnitX ())),
-                                         scene_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
-          Eigen::Affine3f transform_sg = Eigen::Translation3f ( rotation_sg * ((-1) * scene_reference_point)) * rotation_sg;
-//          float alpha_s = acos (Eigen::Vector3f::UnitY ().dot ((transform_sg * scene_point).normalized ()));
-
-          Eigen::Vector3f scene_point_transformed = transform_sg * scene_point;
-          float alpha_s = atan2f ( -scene_point_transformed(2), scene_point_transformed(1));
-          if ( alpha_s != alpha_s)
-          {
-            PCL_ERROR ("alpha_s is nan\n");
-            continue;
-          }
-          if (sin (alpha_s) * scene_point_transformed(2) < 0.0f)
-            alpha_s *= (-1);
+          PCL_ERROR ("[pcl::PPFRegistration::computeTransformation] Computing pair feature vector between points %lu and %lu went wrong.\n", (unsigned long) scene_reference_index, (unsigned long) scene_point_index);
+          continue;
+        }
+
+        // Point pairs in the model with the same discretized feature
+        const uint32_t *pair_begin, *pair_end;
+        search_method_->nearestNeighborSearch (f1, f2, f3, f4, pair_begin, pair_end);
+        if (pair_begin == pair_end)
+          continue;
+
+        // Compute alpha_s angle
+        Eigen::Vector3f scene_point_transformed = transform_sg * target_->points[scene_point_index].getVector3fMap ();
+        float alpha_s = atan2f ( -scene_point_transformed(2), scene_point_transformed(1));
+        if ( alpha_s != alpha_s)
+        {
+          PCL_ERROR ("alpha_s is nan\n");
+          continue;
+        }
+        if (sin (alpha_s) * scene_point_transformed(2) < 0.0f)
           alpha_s *= (-1);
+        alpha_s *= (-1);
 
-          // Go through point pairs in the model with the same discretized feature
-          for (std::vector<std::pair<size_t, size_t> >::iterator v_it = nearest_indices.begin (); v_it != nearest_indices.end (); ++ v_it)
-          {
-            size_t model_reference_index = v_it->first,
-                model_point_index = v_it->second;
-            // Calculate angle alpha = alpha_m - alpha_s
-            float alpha = search_method_->alpha_m_[model_reference_index][model_point_index] - alpha_s;
-            unsigned int alpha_discretized = floor(alpha) + floor(M_PI / search_method_->getAngleDiscretizationStep ());
-            accumulator_array[model_reference_index][alpha_discretized] ++;
-          }
+        for (const uint32_t *pair = pair_begin; pair != pair_end; ++pair)
+        {
+          size_t model_reference_index = *pair / nr_model_points,
+              model_point_index = *pair % nr_model_points;
+          // Calculate angle alpha = alpha_m - alpha_s
+          float alpha = search_method_->alpha_m_[model_reference_index][model_point_index] - alpha_s;
+          int alpha_discretized = static_cast<int> (floor (alpha)) + angle_offset;
+          if (alpha_discretized < 0 || alpha_discretized >= static_cast<int> (nr_angle_bins))
+            continue;
+
+          size_t bin = model_reference_index * nr_angle_bins + alpha_discretized;
+          if (accumulator_array[bin]++ == 0)
+            voted_bins.push_back (bin);
         }
-        else PCL_ERROR ("[pcl::PPFRegistration::computeTransformation] Computing pair feature vector between points %lu and %lu went wrong.\n", (unsigned long) scene_reference_index, (unsigned long) scene_point_index);
       }
-    }
-
-    size_t max_votes_i = 0, max_votes_j = 0;
-    unsigned int max_votes = 0;
 
-    for (size_t i = 0; i < accumulator_array.size (); ++i)
-      for (size_t j = 0; j < accumulator_array.back ().size (); ++j)
+      // Take the bin with the most votes, the first one in the accumulator array on ties
+      size_t max_votes_bin = 0;
+      unsigned int max_votes = 0;
+      for (size_t b = 0; b < voted_bins.size (); ++b)
       {
-        if (accumulator_array[i][j] > max_votes)
+        unsigned int votes = accumulator_array[voted_bins[b]];
+        if (votes > max_votes || (votes == max_votes && voted_bins[b] < max_votes_bin))
         {
-          max_votes = accumulator_array[i][j];
-          max_votes_i = i;
-          max_votes_j = j;
+          max_votes = votes;
+          max_votes_bin = voted_bins[b];
         }
         // Reset accumulator_array for the next set of iterations with a new scene reference point
-        accumulator_array[i][j] = 0;
+        accumulator_array[voted_bins[b]] = 0;
       }
+      voted_bins.clear ();
+      size_t max_votes_i = max_votes_bin / nr_angle_bins,
+          max_votes_j = max_votes_bin % nr_angle_bins;
 
-    Eigen::Vector3f model_reference_point = input_->points[max_votes_i].getVector3fMap (),
-        model_reference_normal = input_->points[max_votes_i].getNormalVector3fMap ();
-    Eigen::AngleAxisf rotation_mg (acos (model_reference_normal.dot (Eigen::Vector3f::UnitX ())), model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
-    Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
-    Eigen::Affine3f max_transform = transform_sg.inverse () * Eigen::AngleAxisf ( (max_votes_j - floor(M_PI / search_method_->getAngleDiscretizationStep ())) * search_method_->getAngleDiscretizationStep (), Eigen::Vector3f::UnitX ()) * transform_mg;
+      Eigen::Vector3f model_reference_point = input_->points[max_votes_i].getVector3fMap (),
+          model_reference_normal = input_->points[max_votes_i].getNormalVector3fMap ();
+      Eigen::AngleAxisf rotation_mg (acos (model_reference_normal.dot (Eigen::Vector3f::UnitX ())), model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
+      Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
+      Eigen::Affine3f max_transform = transform_sg.inverse () * Eigen::AngleAxisf ( (max_votes_j - floor(M_PI / search_method_->getAngleDiscretizationStep ())) * search_method_->getAngleDiscretizationStep (), Eigen::Vector3f::UnitX ()) * transform_mg;
 
-    voted_poses.push_back (PoseWithVotes (max_transform, max_votes));
+      voted_poses[reference_i] = PoseWithVotes (max_transform, max_votes);
+    }
   }
   PCL_INFO ("Done with the Hough Transform ...\n");
 
@@ -250,31 +213,59 @@ pcl::PPFRegistration<PointSource, PointTarget>::clusterPoses (typename pcl::PPFR
   // Start off by sorting the poses by the number of votes
   sort(poses.begin (), poses.end (), poseWithVotesCompareFunction);
 
+  // A pose joins the first cluster whose first pose is close enough to it. As the translations have to be closer
+  // than the position threshold, such a cluster can only be in one of the 27 grid cells around the pose, with
+  // cells as wide as the threshold
+  const float cell_size = clustering_position_diff_threshold_;
+  boost::unordered_map<uint64_t, std::vector<size_t> > cluster_grid;
+
   std::vector<PoseWithVotesList> clusters;
   std::vector<std::pair<size_t, unsigned int> > cluster_votes;
   for (size_t poses_i = 0; poses_i < poses.size(); ++ poses_i)
   {
-    bool found_cluster = false;
-    for (size_t clusters_i = 0; clusters_i < clusters.size(); ++ clusters_i)
+    Eigen::Vector3f translation = poses[poses_i].pose.translation ();
+    bool use_grid = cell_size > 0.0f && pcl_isfinite (translation[0]) && pcl_isfinite (translation[1]) && pcl_isfinite (translation[2]);
+    int cell[3] = {0, 0, 0};
+
+    size_t found_cluster = clusters.size ();
+    if (use_grid)
     {
-      if (posesWithinErrorBounds (poses[poses_i].pose, clusters[clusters_i].front ().pose))
-      {
-        found_cluster = true;
-        clusters[clusters_i].push_back (poses[poses_i]);
-        cluster_votes[clusters_i].second += poses[poses_i].votes;
-        break;
-      }
+      for (int d = 0; d < 3; ++d)
+        cell[d] = static_cast<int> (floor (translation[d] / cell_size));
+
+      for (int dx = -1; dx <= 1; ++dx)
+        for (int dy = -1; dy <= 1; ++dy)
+          for (int dz = -1; dz <= 1; ++dz)
+          {
+            boost::unordered_map<uint64_t, std::vector<size_t> >::const_iterator it = cluster_grid.find (getClusterCellKey (cell[0] + dx, cell[1] + dy, cell[2] + dz));
+            if (it == cluster_grid.end ())
+              continue;
+            // The clusters of a cell are in creation order, so the first match is the one to compare with the other cells
+            for (size_t c = 0; c < it->second.size () && it->second[c] < found_cluster; ++c)
+              if (posesWithinErrorBounds (poses[poses_i].pose, clusters[it->second[c]].front ().pose))
+              {
+                found_cluster = it->second[c];
+                break;
+              }
+          }
     }
 
-    if (found_cluster == false)
+    if (found_cluster < clusters.size ())
+    {
+      clusters[found_cluster].push_back (poses[poses_i]);
+      cluster_votes[found_cluster].second += poses[poses_i].votes;
+    }
+    else
     {
       // Create a new cluster with the current pose
       PoseWithVotesList new_cluster;
       new_cluster.push_back (poses[poses_i]);
       clusters.push_back (new_cluster);
       cluster_votes.push_back (std::pair<size_t, unsigned int> (clusters.size () - 1, poses[poses_i].votes));
+      if (use_grid)
+        cluster_grid[getClusterCellKey (cell[0], cell[1], cell[2])].push_back (clusters.size () - 1);
     }
- }
+  }
 
   // Sort clusters by total number of votes
   std::sort (cluster_votes.begin (), cluster_votes.end (), clusterVotesCompareFunction);
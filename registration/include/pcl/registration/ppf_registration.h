@@ -41,30 +41,24 @@
 
 #include "pcl/registration/registration.h"
 #include <pcl/features/ppf.h>
-#include <boost/unordered_map.hpp>
+#include <string>
 
 namespace pcl
 {
+  /** \brief Search structure for the PPFSignature features of a model, holding the model point pairs by
+    * discretized feature.
+    *
+    * The pairs are stored in a flat, compressed table: the pairs of each discretized feature are contiguous, and an
+    * open addressing hash table maps the discretized features to their range of pairs. This takes 4 bytes per pair
+    * (plus 4 bytes for its alpha_m angle), and the whole structure can be saved to a file and loaded back with
+    * \ref saveHashMap and \ref loadHashMap, so that a model database only needs to be trained once.
+    *
+    * \note The features of a model are expected to come from a PPFEstimation over all the points of the model
+    * (i.e., one feature for each ordered pair of points), and the model can have at most 65535 points.
+    */
   class PCL_EXPORTS PPFHashMapSearch
   {
     public:
-      /** \brief Data structure to hold the information for the key in the feature hash map of the
-        * PPFHashMapSearch class
-        * \note It uses multiple pair levels in order to enable the usage of the boost::hash function
-        * which has the std::pair implementation (i.e., does not require a custom hash function)
-        */
-      struct HashKeyStruct : public std::pair <int, std::pair <int, std::pair <int, int> > >
-      {
-        HashKeyStruct(int a, int b, int c, int d)
-        {
-          this->first = a;
-          this->second.first = b;
-          this->second.second.first = c;
-          this->second.second.second = d;
-        }
-      };
-      typedef boost::unordered_multimap<HashKeyStruct, std::pair<size_t, size_t> > FeatureHashMapType;
-      typedef boost::shared_ptr<FeatureHashMapType> FeatureHashMapTypePtr;
       typedef boost::shared_ptr<PPFHashMapSearch> Ptr;
 
 
@@ -74,12 +68,14 @@ namespace pcl
        */
       PPFHashMapSearch (float angle_discretization_step = 12.0 / 180 * M_PI,
                         float distance_discretization_step = 0.01)
-      :  angle_discretization_step_ (angle_discretization_step),
-         distance_discretization_step_ (distance_discretization_step)
+      :  alpha_m_ (),
+         keys_ (), key_offsets_ (), pairs_ (), table_ (),
+         nr_points_ (0),
+         internals_initialized_ (false),
+         angle_discretization_step_ (angle_discretization_step),
+         distance_discretization_step_ (distance_discretization_step),
+         max_dist_ (-1.0)
       {
-        feature_hash_map_ = FeatureHashMapTypePtr (new FeatureHashMapType);
-        internals_initialized_ = false;
-        max_dist_ = -1.0;
       }
 
       /** \brief Method that sets the feature cloud to be inserted in the hash map
@@ -100,6 +96,33 @@ namespace pcl
       nearestNeighborSearch (float &f1, float &f2, float &f3, float &f4,
                              std::vector<std::pair<size_t, size_t> > &indices);
 
+      /** \brief Find the model pairs in the bin of the given feature, without copying them. Every pair (i, j) is
+       * given as i * \ref getNumberOfPoints () + j.
+       * \param[in] f1 The 1st value describing the query PPFSignature feature
+       * \param[in] f2 The 2nd value describing the query PPFSignature feature
+       * \param[in] f3 The 3rd value describing the query PPFSignature feature
+       * \param[in] f4 The 4th value describing the query PPFSignature feature
+       * \param[out] begin the first pair of the bin
+       * \param[out] end one past the last pair of the bin (equal to begin if the bin is empty)
+       */
+      void
+      nearestNeighborSearch (float f1, float f2, float f3, float f4,
+                             const uint32_t *&begin, const uint32_t *&end) const;
+
+      /** \brief Save the discretization steps and the trained hash map to a binary file.
+       * \param file_name the name of the file to write
+       * \return true if the file was written successfully
+       */
+      bool
+      saveHashMap (const std::string &file_name) const;
+
+      /** \brief Load a hash map saved with \ref saveHashMap, replacing the current one and its discretization steps.
+       * \param file_name the name of the file to read
+       * \return true if the file was read successfully
+       */
+      bool
+      loadHashMap (const std::string &file_name);
+
       /** \brief Convenience method for returning a copy of the class instance as a boost::shared_ptr */
       Ptr
       makeShared() { return Ptr (new PPFHashMapSearch (*this)); }
@@ -116,9 +139,50 @@ namespace pcl
       inline float
       getModelDiameter () { return max_dist_; }
 
+      /** \brief Returns the number of points of the model the hash map was trained with */
+      inline unsigned int
+      getNumberOfPoints () const { return (nr_points_); }
+
+      /** \brief Returns the number of distinct discretized features in the hash map */
+      inline size_t
+      getNumberOfBins () const { return (keys_.size () / 4); }
+
       std::vector <std::vector <float> > alpha_m_;
     private:
-      FeatureHashMapTypePtr feature_hash_map_;
+      /** \brief Discretize a feature.
+       * \param[in] f1 the 1st value of the feature
+       * \param[in] f2 the 2nd value of the feature
+       * \param[in] f3 the 3rd value of the feature
+       * \param[in] f4 the 4th value of the feature
+       * \param[out] key the discretized feature
+       * \return false if the feature is not finite, and can thus not be discretized
+       */
+      bool
+      discretize (float f1, float f2, float f3, float f4, int key[4]) const;
+
+      /** \brief Find the index of a discretized feature in keys_, or -1 if the model has no such feature. */
+      int
+      findKey (const int key[4]) const;
+
+      /** \brief Build the hash table from keys_. */
+      void
+      buildTable ();
+
+      /** \brief The distinct discretized features, 4 values each. */
+      std::vector<int> keys_;
+
+      /** \brief The position of the first pair of every discretized feature in pairs_, plus the total number of pairs. */
+      std::vector<uint32_t> key_offsets_;
+
+      /** \brief The model point pairs, as i * nr_points_ + j, grouped by discretized feature. */
+      std::vector<uint32_t> pairs_;
+
+      /** \brief Open addressing hash table holding the index of a discretized feature in keys_ plus one, or 0 if empty. */
+      std::vector<uint32_t> table_;
+
+      /** \brief The number of points of the model. */
+      uint32_t nr_points_;
+
       bool internals_initialized_;
 
       float angle_discretization_step_, distance_discretization_step_;
@@ -134,6 +198,10 @@ namespace pcl
    *
    * \note This class works in tandem with the PPFEstimation class
    *
+   * The scene reference points vote in parallel (see \ref setNumberOfThreads), each thread reusing its own
+   * accumulator array and clearing only the bins it touched. The voted poses are clustered through a grid
+   * hashed on their translation, so that a pose is only compared to the clusters around it.
+   *
    * \author Alexandru-Eugen Ichim
    */
   template <typename PointSource, typename PointTarget>
@@ -179,9 +247,28 @@ namespace pcl
          search_method_ (),
          scene_reference_point_sampling_rate_ (5),
          clustering_position_diff_threshold_ (0.01),
-         clustering_rotation_diff_threshold_ (20.0 / 180 * M_PI)
+         clustering_rotation_diff_threshold_ (20.0 / 180 * M_PI),
+         threads_ (1)
       {}
 
+      /** \brief Set the number of threads the scene reference points vote with.
+       * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+       */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads the scene reference points vote with. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
       /** \brief Method for setting the position difference clustering parameter
        * \param clustering_position_diff_threshold distance threshold below which two poses are
        * considered close enough to be in the same cluster (for the clustering phase of the algorithm)
@@ -253,6 +340,9 @@ namespace pcl
         * poses are considered to be in the same cluster (for the clustering phase of the algorithm) */
       float clustering_position_diff_threshold_, clustering_rotation_diff_threshold_;
 
+      /** \brief the number of threads the scene reference points vote with */
+      unsigned int threads_;
+
       /** \brief use a kd-tree with range searches of range max_dist to skip an O(N) pass through the point cloud */
       typename pcl::KdTreeFLANN<PointTarget>::Ptr scene_search_tree_;
 
@@ -274,6 +364,15 @@ namespace pcl
       clusterPoses (PoseWithVotesList &poses,
                     PoseWithVotesList &result);
 
+      /** \brief Get the key of a cell of the grid the clusters of poses are hashed in. */
+      static inline uint64_t
+      getClusterCellKey (int x, int y, int z)
+      {
+        return ((static_cast<uint64_t> (static_cast<uint32_t> (x) & 0x1FFFFF) << 42) |
+                (static_cast<uint64_t> (static_cast<uint32_t> (y) & 0x1FFFFF) << 21) |
+                 static_cast<uint64_t> (static_cast<uint32_t> (z) & 0x1FFFFF));
+      }
+
       /** \brief Method that checks whether two poses are close together - based on the clustering threshold parameters
        * of the class */
       bool
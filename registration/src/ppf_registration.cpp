@@ -35,6 +35,328 @@
  * $Id: ppf_registration.cpp 1457 2011-06-22 21:46:18Z aichim $
  */
 
+#include "pcl/registration/ppf_registration.h"
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+namespace
+{
+  /** \brief A model point pair with its discretized feature, used to group the pairs by feature. */
+  struct DiscretizedPair
+  {
+    int key[4];
+    uint32_t pair;
+
+    bool
+    operator< (const DiscretizedPair &other) const
+    {
+      for (int d = 0; d < 4; ++d)
+        if (key[d] != other.key[d])
+          return (key[d] < other.key[d]);
+      return (pair < other.pair);
+    }
+  };
+
+  /** \brief Hash a discretized feature (the 64 bit finalizer of MurmurHash3). */
+  inline uint64_t
+  hashKey (const int key[4])
+  {
+    uint64_t h = 0;
+    for (int d = 0; d < 4; ++d)
+    {
+      h ^= static_cast<uint32_t> (key[d]);
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+    }
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (h);
+  }
+
+  /** \brief The first bytes of a file written by PPFHashMapSearch::saveHashMap, followed by the format version. */
+  const char ppf_hash_map_magic[] = "PCL_PPF_HASH_MAP";
+  const uint32_t ppf_hash_map_version = 1;
+
+  template <typename T> inline void
+  writeBinary (std::ofstream &fs, const T *data, size_t count)
+  {
+    fs.write (reinterpret_cast<const char*> (data), count * sizeof (T));
+  }
+
+  template <typename T> inline void
+  readBinary (std::ifstream &fs, T *data, size_t count)
+  {
+    fs.read (reinterpret_cast<char*> (data), count * sizeof (T));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PPFHashMapSearch::setInputFeatureCloud (PointCloud<PPFSignature>::ConstPtr feature_cloud)
+{
+  internals_initialized_ = false;
+  keys_.clear ();
+  key_offsets_.clear ();
+  pairs_.clear ();
+  table_.clear ();
+
+  unsigned int n = sqrt ((float)feature_cloud->points.size ());
+  if (n > 65535)
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::setInputFeatureCloud] The model has %u points, more than the 65535 supported!\n", n);
+    return;
+  }
+  nr_points_ = n;
+  max_dist_ = -1.0;
+
+  // Discretize all the pairs and sort them by feature. The pairs whose feature could not be computed (e.g. the
+  // pairs of a point with itself) can never be found, so they are left out
+  std::vector<DiscretizedPair> discretized_pairs;
+  discretized_pairs.reserve (static_cast<size_t> (n) * n);
+  alpha_m_.resize (n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    alpha_m_[i].resize (n);
+    for (size_t j = 0; j < n; ++j)
+    {
+      const PPFSignature &feature = feature_cloud->points[i*n + j];
+      alpha_m_[i][j] = feature.alpha_m;
+
+      DiscretizedPair discretized_pair;
+      if (!discretize (feature.f1, feature.f2, feature.f3, feature.f4, discretized_pair.key))
+        continue;
+      discretized_pair.pair = static_cast<uint32_t> (i*n + j);
+      discretized_pairs.push_back (discretized_pair);
+
+      if (max_dist_ < feature.f4)
+        max_dist_ = feature.f4;
+    }
+  }
+  std::sort (discretized_pairs.begin (), discretized_pairs.end ());
+
+  // Keep every distinct feature once, with the range of its pairs
+  pairs_.resize (discretized_pairs.size ());
+  for (size_t p = 0; p < discretized_pairs.size (); ++p)
+  {
+    if (p == 0 || !std::equal (discretized_pairs[p].key, discretized_pairs[p].key + 4, discretized_pairs[p-1].key))
+    {
+      keys_.insert (keys_.end (), discretized_pairs[p].key, discretized_pairs[p].key + 4);
+      key_offsets_.push_back (static_cast<uint32_t> (p));
+    }
+    pairs_[p] = discretized_pairs[p].pair;
+  }
+  key_offsets_.push_back (static_cast<uint32_t> (pairs_.size ()));
+
+  buildTable ();
+  internals_initialized_ = true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PPFHashMapSearch::nearestNeighborSearch (float &f1, float &f2, float &f3, float &f4,
+                                              std::vector<std::pair<size_t, size_t> > &indices)
+{
+  if (!internals_initialized_)
+  {
+    PCL_ERROR("[pcl::PPFRegistration::nearestNeighborSearch]: input feature cloud has not been set - skipping search!\n");
+    return;
+  }
+
+  indices.clear ();
+  int key[4];
+  if (!discretize (f1, f2, f3, f4, key))
+    return;
+  int key_index = findKey (key);
+  if (key_index < 0)
+    return;
+
+  indices.reserve (key_offsets_[key_index + 1] - key_offsets_[key_index]);
+  for (uint32_t p = key_offsets_[key_index]; p < key_offsets_[key_index + 1]; ++p)
+    indices.push_back (std::pair<size_t, size_t> (pairs_[p] / nr_points_, pairs_[p] % nr_points_));
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PPFHashMapSearch::nearestNeighborSearch (float f1, float f2, float f3, float f4,
+                                              const uint32_t *&begin, const uint32_t *&end) const
+{
+  begin = end = NULL;
+  int key[4];
+  if (!internals_initialized_ || !discretize (f1, f2, f3, f4, key))
+    return;
+  int key_index = findKey (key);
+  if (key_index < 0)
+    return;
+
+  begin = &pairs_[0] + key_offsets_[key_index];
+  end = &pairs_[0] + key_offsets_[key_index + 1];
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PPFHashMapSearch::saveHashMap (const std::string &file_name) const
+{
+  if (!internals_initialized_)
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::saveHashMap] Input feature cloud has not been set - nothing to save!\n");
+    return (false);
+  }
+
+  std::ofstream fs (file_name.c_str (), std::ios::out | std::ios::binary);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::saveHashMap] Could not open file %s for writing!\n", file_name.c_str ());
+    return (false);
+  }
+
+  const uint64_t sizes[3] = { keys_.size (), key_offsets_.size (), pairs_.size () };
+  const float params[3] = { angle_discretization_step_, distance_discretization_step_, max_dist_ };
+  writeBinary (fs, ppf_hash_map_magic, sizeof (ppf_hash_map_magic));
+  writeBinary (fs, &ppf_hash_map_version, 1);
+  writeBinary (fs, params, 3);
+  writeBinary (fs, &nr_points_, 1);
+  writeBinary (fs, sizes, 3);
+  for (size_t i = 0; i < alpha_m_.size (); ++i)
+    writeBinary (fs, &alpha_m_[i][0], alpha_m_[i].size ());
+  if (!pairs_.empty ())
+  {
+    writeBinary (fs, &keys_[0], keys_.size ());
+    writeBinary (fs, &pairs_[0], pairs_.size ());
+  }
+  writeBinary (fs, &key_offsets_[0], key_offsets_.size ());
+
+  fs.close ();
+  if (!fs)
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::saveHashMap] Error while writing file %s!\n", file_name.c_str ());
+    return (false);
+  }
+  return (true);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PPFHashMapSearch::loadHashMap (const std::string &file_name)
+{
+  std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::loadHashMap] Could not open file %s!\n", file_name.c_str ());
+    return (false);
+  }
+
+  char magic[sizeof (ppf_hash_map_magic)];
+  uint32_t version = 0, nr_points = 0;
+  uint64_t sizes[3] = { 0, 0, 0 };
+  float params[3];
+  readBinary (fs, magic, sizeof (magic));
+  readBinary (fs, &version, 1);
+  if (!fs || memcmp (magic, ppf_hash_map_magic, sizeof (magic)) != 0 || version != ppf_hash_map_version)
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::loadHashMap] File %s is not a PPF hash map, or was written by another version!\n", file_name.c_str ());
+    return (false);
+  }
+  readBinary (fs, params, 3);
+  readBinary (fs, &nr_points, 1);
+  readBinary (fs, sizes, 3);
+  if (!fs || sizes[0] % 4 != 0 || sizes[1] != sizes[0] / 4 + 1 || (sizes[0] == 0) != (sizes[2] == 0) ||
+      sizes[2] > static_cast<uint64_t> (nr_points) * nr_points)
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::loadHashMap] File %s has an invalid header!\n", file_name.c_str ());
+    return (false);
+  }
+
+  internals_initialized_ = false;
+  alpha_m_.resize (nr_points);
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+    alpha_m_[i].resize (nr_points);
+    readBinary (fs, &alpha_m_[i][0], nr_points);
+  }
+  keys_.resize (sizes[0]);
+  key_offsets_.resize (sizes[1]);
+  pairs_.resize (sizes[2]);
+  if (!pairs_.empty ())
+  {
+    readBinary (fs, &keys_[0], keys_.size ());
+    readBinary (fs, &pairs_[0], pairs_.size ());
+  }
+  readBinary (fs, &key_offsets_[0], key_offsets_.size ());
+  if (!fs || key_offsets_.back () != pairs_.size ())
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::loadHashMap] File %s is truncated or corrupted!\n", file_name.c_str ());
+    keys_.clear ();
+    key_offsets_.clear ();
+    pairs_.clear ();
+    return (false);
+  }
+
+  angle_discretization_step_ = params[0];
+  distance_discretization_step_ = params[1];
+  max_dist_ = params[2];
+  nr_points_ = nr_points;
+  buildTable ();
+  internals_initialized_ = true;
+  return (true);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PPFHashMapSearch::discretize (float f1, float f2, float f3, float f4, int key[4]) const
+{
+  if (!pcl_isfinite (f1) || !pcl_isfinite (f2) || !pcl_isfinite (f3) || !pcl_isfinite (f4))
+    return (false);
+
+  key[0] = floor (f1 / angle_discretization_step_);
+  key[1] = floor (f2 / angle_discretization_step_);
+  key[2] = floor (f3 / angle_discretization_step_);
+  key[3] = floor (f4 / distance_discretization_step_);
+  return (true);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PPFHashMapSearch::findKey (const int key[4]) const
+{
+  const size_t mask = table_.size () - 1;
+  for (size_t slot = hashKey (key) & mask; table_[slot] != 0; slot = (slot + 1) & mask)
+  {
+    const int *candidate = &keys_[(table_[slot] - 1) * 4];
+    if (std::equal (key, key + 4, candidate))
+      return (static_cast<int> (table_[slot] - 1));
+  }
+  return (-1);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PPFHashMapSearch::buildTable ()
+{
+  // At most half full, so that the probe sequences stay short
+  const size_t nr_keys = keys_.size () / 4;
+  size_t table_size = 2;
+  while (table_size < 2 * nr_keys)
+    table_size *= 2;
+  table_.assign (table_size, 0);
+
+  const size_t mask = table_size - 1;
+  for (size_t k = 0; k < nr_keys; ++k)
+  {
+    size_t slot = hashKey (&keys_[k * 4]) & mask;
+    while (table_[slot] != 0)
+      slot = (slot + 1) & mask;
+    table_[slot] = static_cast<uint32_t> (k + 1);
+  }
+}
+
 /** Re-enable these once all of registration is separated into H/HPP correctly. */
 //#include "pcl/point_types.h"
 //#include "pcl/impl/instantiate.hpp"
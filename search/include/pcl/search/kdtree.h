@@ -71,6 +71,7 @@ namespace pcl
         using pcl::search::Search<PointT>::getInputCloud;
         using pcl::search::Search<PointT>::nearestKSearch;
         using pcl::search::Search<PointT>::radiusSearch;
+        using pcl::search::Search<PointT>::radiusCount;
         using pcl::search::Search<PointT>::sorted_results_;
 
         typedef boost::shared_ptr<KdTree<PointT> > Ptr;
@@ -169,6 +170,20 @@ namespace pcl
           return (tree_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
         }
 
+        /** \brief Count the nearest neighbors of the query point in a given radius, stopping as soon as
+          * \a max_nn neighbors have been found.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_nn if given, the search stops once this many neighbors have been found. If \a max_nn is
+          * set to 0, all neighbors in \a radius are counted.
+          * \return number of neighbors found in radius, at most \a max_nn if given
+          */
+        inline int
+        radiusCount (const PointT& point, const double radius, unsigned int max_nn = 0) const
+        {
+          return (tree_->radiusCount (point, radius, max_nn));
+        }
+
       protected:
         /** \brief A pointer to the internal KdTreeFLANN object. */
         KdTreeFLANNPtr tree_;
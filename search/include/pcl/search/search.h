@@ -394,6 +394,55 @@ namespace pcl
           }
         }
 
+        /** \brief Count the nearest neighbors of the query point in a given radius, without returning them.
+          * Search methods which support it stop as soon as \a max_nn neighbors have been found, which makes this
+          * much cheaper than \ref radiusSearch when only a lower bound on the number of neighbors is needed.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_nn if given, the search stops once this many neighbors have been found. If \a max_nn is
+          * set to 0, all neighbors in \a radius are counted.
+          * \return number of neighbors found in radius, at most \a max_nn if given
+          */
+        virtual int
+        radiusCount (const PointT &point, double radius, unsigned int max_nn = 0) const
+        {
+          std::vector<int> k_indices;
+          std::vector<float> k_sqr_distances;
+          int k = radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn);
+          if (max_nn > 0 && k > (int)max_nn)
+            k = (int)max_nn;
+          return (k);
+        }
+
+        /** \brief Count the nearest neighbors of the query point in a given radius, without returning them
+          * (zero-copy).
+          *
+          * \attention This method does not do any bounds checking for the input index
+          * (i.e., index >= cloud.points.size () || index < 0), and assumes valid (i.e., finite) data.
+          *
+          * \param[in] index a \a valid index representing a \a valid query point in the dataset given
+          * by \a setInputCloud. If indices were given in setInputCloud, index will be the position in
+          * the indices vector.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_nn if given, the search stops once this many neighbors have been found. If \a max_nn is
+          * set to 0, all neighbors in \a radius are counted.
+          * \return number of neighbors found in radius, at most \a max_nn if given
+          */
+        virtual int
+        radiusCount (int index, double radius, unsigned int max_nn = 0) const
+        {
+          if (indices_ == NULL)
+          {
+            assert (index >= 0 && index < (int)input_->points.size () && "Out-of-bounds error in radiusCount!");
+            return (radiusCount (input_->points[index], radius, max_nn));
+          }
+          else
+          {
+            assert (index >= 0 && index < (int)indices_->size () && "Out-of-bounds error in radiusCount!");
+            return (radiusCount (input_->points[(*indices_)[index]], radius, max_nn));
+          }
+        }
+
         /** \brief Search for all the nearest neighbors of the query point in a given radius.
           * \param[in] cloud the point cloud data
           * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
@@ -44,22 +44,30 @@
 #include <pcl/features/feature.h>
 #include <pcl/features/normal_3d_omp.h>
 #include <pcl/features/moment_invariants.h>
+#include <pcl/features/moment_invariants_omp.h>
 #include <pcl/features/boundary.h>
+#include <pcl/features/boundary_omp.h>
 #include <pcl/features/principal_curvatures.h>
+#include <pcl/features/principal_curvatures_omp.h>
 #include <pcl/features/pfh.h>
+#include <pcl/features/pfh_omp.h>
 #include <pcl/features/shot.h>
 #include <pcl/features/shot_omp.h>
 #include <pcl/features/spin_image.h>
+#include <pcl/features/spin_image_omp.h>
 #include <pcl/features/fpfh.h>
 #include <pcl/features/fpfh_omp.h>
 #include <pcl/features/ppf.h>
 #include <pcl/features/vfh.h>
+#include <pcl/features/cvfh.h>
 #include <pcl/features/rsd.h>
 #include <pcl/features/intensity_gradient.h>
 #include <pcl/features/intensity_spin.h>
 #include <pcl/features/rift.h>
 #include <pcl/features/3dsc.h>
+#include <pcl/features/3dsc_omp.h>
 #include <pcl/features/usc.h>
+#include <pcl/features/usc_omp.h>
 #include <iostream>
 
 using namespace pcl;
@@ -594,6 +602,38 @@ TEST (PCL, MomentInvariantsEstimation)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MomentInvariantsEstimationOpenMP)
+{
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+
+  MomentInvariantsEstimation<PointXYZ, MomentInvariants> mi;
+  mi.setInputCloud (cloud.makeShared ());
+  mi.setIndices (indicesptr);
+  mi.setSearchMethod (tree);
+  mi.setKSearch (20);
+  PointCloud<MomentInvariants> moments;
+  mi.compute (moments);
+
+  MomentInvariantsEstimationOMP<PointXYZ, MomentInvariants> mi_omp (4);
+  EXPECT_EQ (mi_omp.getNumberOfThreads (), 4);
+  mi_omp.setInputCloud (cloud.makeShared ());
+  mi_omp.setIndices (indicesptr);
+  mi_omp.setSearchMethod (tree);
+  mi_omp.setKSearch (20);
+  PointCloud<MomentInvariants> moments_omp;
+  mi_omp.compute (moments_omp);
+
+  ASSERT_EQ (moments_omp.points.size (), moments.points.size ());
+  EXPECT_EQ (moments_omp.is_dense, moments.is_dense);
+  for (size_t i = 0; i < moments.points.size (); ++i)
+  {
+    EXPECT_NEAR (moments_omp.points[i].j1, moments.points[i].j1, 1e-6);
+    EXPECT_NEAR (moments_omp.points[i].j2, moments.points[i].j2, 1e-6);
+    EXPECT_NEAR (moments_omp.points[i].j3, moments.points[i].j3, 1e-6);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, BoundaryEstimation)
 {
@@ -671,6 +711,68 @@ TEST (PCL, BoundaryEstimation)
   EXPECT_EQ (pt, true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, BoundaryEstimationOpenMP)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  BoundaryEstimation<PointXYZ, Normal, Boundary> b;
+  b.setInputCloud (cloud.makeShared ());
+  b.setInputNormals (normals);
+  b.setIndices (indicesptr);
+  b.setSearchMethod (tree);
+  b.setKSearch (20);
+  PointCloud<Boundary> bps;
+  b.compute (bps);
+
+  BoundaryEstimationOMP<PointXYZ, Normal, Boundary> b_omp (4);
+  EXPECT_EQ (b_omp.getNumberOfThreads (), 4);
+  b_omp.setInputCloud (cloud.makeShared ());
+  b_omp.setInputNormals (normals);
+  b_omp.setIndices (indicesptr);
+  b_omp.setSearchMethod (tree);
+  b_omp.setKSearch (20);
+  PointCloud<Boundary> bps_omp;
+  b_omp.compute (bps_omp);
+
+  ASSERT_EQ (bps_omp.points.size (), bps.points.size ());
+  EXPECT_EQ (bps_omp.is_dense, bps.is_dense);
+
+  // Check the result against the largest gap between the sorted angles
+  std::vector<int> nn_indices (20);
+  std::vector<float> nn_dists (20);
+  Eigen::Vector4f u, v;
+  int nr_boundary_points = 0;
+  for (size_t i = 0; i < bps.points.size (); ++i)
+  {
+    EXPECT_EQ (bps_omp.points[i].boundary_point, bps.points[i].boundary_point);
+
+    b.getSearchMethod ()->nearestKSearch (cloud, indices[i], 20, nn_indices, nn_dists);
+    b.getCoordinateSystemOnPlane (normals->points[i], u, v);
+    std::vector<float> angles;
+    for (size_t j = 0; j < nn_indices.size (); ++j)
+    {
+      Eigen::Vector4f delta = cloud.points[nn_indices[j]].getVector4fMap () - cloud.points[indices[i]].getVector4fMap ();
+      angles.push_back (atan2f (v.dot (delta), u.dot (delta)));
+    }
+    std::sort (angles.begin (), angles.end ());
+    float max_dif = static_cast<float> (2 * M_PI - angles.back () + angles.front ());
+    for (size_t j = 1; j < angles.size (); ++j)
+      max_dif = (std::max) (max_dif, angles[j] - angles[j - 1]);
+    EXPECT_EQ (bps.points[i].boundary_point, max_dif > M_PI / 2.0);
+    nr_boundary_points += bps.points[i].boundary_point;
+  }
+  EXPECT_GT (nr_boundary_points, 0);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PrincipalCurvaturesEstimation)
 {
@@ -760,6 +862,50 @@ TEST (PCL, PrincipalCurvaturesEstimation)
   EXPECT_NEAR (pcs->points[indices.size () - 1].pc2, 0.17906941473484039, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PrincipalCurvaturesEstimationOpenMP)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  PrincipalCurvaturesEstimation<PointXYZ, Normal, PrincipalCurvatures> pc;
+  pc.setInputCloud (cloud.makeShared ());
+  pc.setInputNormals (normals);
+  pc.setIndices (indicesptr);
+  pc.setSearchMethod (tree);
+  pc.setKSearch (20);
+  PointCloud<PrincipalCurvatures> pcs;
+  pc.compute (pcs);
+
+  PrincipalCurvaturesEstimationOMP<PointXYZ, Normal, PrincipalCurvatures> pc_omp (4);
+  EXPECT_EQ (pc_omp.getNumberOfThreads (), 4);
+  pc_omp.setInputCloud (cloud.makeShared ());
+  pc_omp.setInputNormals (normals);
+  pc_omp.setIndices (indicesptr);
+  pc_omp.setSearchMethod (tree);
+  pc_omp.setKSearch (20);
+  PointCloud<PrincipalCurvatures> pcs_omp;
+  pc_omp.compute (pcs_omp);
+
+  ASSERT_EQ (pcs_omp.points.size (), pcs.points.size ());
+  EXPECT_EQ (pcs_omp.is_dense, pcs.is_dense);
+  for (size_t i = 0; i < pcs.points.size (); ++i)
+  {
+    EXPECT_NEAR (pcs_omp.points[i].principal_curvature[0], pcs.points[i].principal_curvature[0], 1e-5);
+    EXPECT_NEAR (pcs_omp.points[i].principal_curvature[1], pcs.points[i].principal_curvature[1], 1e-5);
+    EXPECT_NEAR (pcs_omp.points[i].principal_curvature[2], pcs.points[i].principal_curvature[2], 1e-5);
+    EXPECT_NEAR (pcs_omp.points[i].pc1, pcs.points[i].pc1, 1e-6);
+    EXPECT_NEAR (pcs_omp.points[i].pc2, pcs.points[i].pc2, 1e-6);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, SHOTShapeEstimation)
 {
@@ -1098,6 +1244,84 @@ TEST (PCL,SHOTShapeAndColorEstimationOpenMP)
   (cloudWithColors.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SHOTVectorizedInterpolation)
+{
+  double mr = 0.002;
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (20 * mr);
+  n.compute (*normals);
+
+  // Shape only: the serial reference against the vectorized kernel, in the serial and in the OpenMP estimators
+  SHOTEstimation<PointXYZ, Normal, SHOT> shot;
+  shot.setInputNormals (normals);
+  shot.setRadiusSearch (20 * mr);
+  shot.setInputCloud (cloud.makeShared ());
+  shot.setSearchMethod (tree);
+  EXPECT_FALSE (shot.getUseVectorizedInterpolation ());
+  PointCloud<SHOT> reference, shots, shots_omp;
+  shot.compute (reference);
+  shot.setUseVectorizedInterpolation (true);
+  EXPECT_TRUE (shot.getUseVectorizedInterpolation ());
+  shot.compute (shots);
+
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT> shot_omp (4);
+  shot_omp.setInputNormals (normals);
+  shot_omp.setRadiusSearch (20 * mr);
+  shot_omp.setInputCloud (cloud.makeShared ());
+  shot_omp.setSearchMethod (tree);
+  shot_omp.setUseVectorizedInterpolation (true);
+  shot_omp.compute (shots_omp);
+
+  ASSERT_EQ (shots.points.size (), reference.points.size ());
+  ASSERT_EQ (shots_omp.points.size (), reference.points.size ());
+  for (size_t i = 0; i < reference.points.size (); ++i)
+  {
+    ASSERT_EQ (shots.points[i].descriptor.size (), reference.points[i].descriptor.size ());
+    for (size_t d = 0; d < reference.points[i].descriptor.size (); ++d)
+    {
+      ASSERT_NEAR (shots.points[i].descriptor[d], reference.points[i].descriptor[d], 1e-4);
+      ASSERT_NEAR (shots_omp.points[i].descriptor[d], reference.points[i].descriptor[d], 1e-4);
+    }
+  }
+
+  // Shape and color
+  PointCloud<PointXYZRGBA>::Ptr cloudWithColors (new PointCloud<PointXYZRGBA>);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    PointXYZRGBA p;
+    p.x = cloud.points[i].x;
+    p.y = cloud.points[i].y;
+    p.z = cloud.points[i].z;
+
+    p.rgba = ( (i%255) << 16 ) + ( ( (255 - i ) %255) << 8) + ( ( i*37 ) %255);
+    cloudWithColors->push_back (p);
+  }
+  search::KdTree<PointXYZRGBA>::Ptr rgbaTree (new search::KdTree<PointXYZRGBA> (false));
+
+  SHOTEstimation<PointXYZRGBA, Normal, SHOT> shot_color (true, true);
+  shot_color.setInputNormals (normals);
+  shot_color.setRadiusSearch (20 * mr);
+  shot_color.setInputCloud (cloudWithColors);
+  shot_color.setSearchMethod (rgbaTree);
+  PointCloud<SHOT> reference_color, shots_color;
+  shot_color.compute (reference_color);
+  shot_color.setUseVectorizedInterpolation (true);
+  shot_color.compute (shots_color);
+
+  ASSERT_EQ (shots_color.points.size (), reference_color.points.size ());
+  for (size_t i = 0; i < reference_color.points.size (); ++i)
+  {
+    ASSERT_EQ (shots_color.points[i].descriptor.size (), reference_color.points[i].descriptor.size ());
+    for (size_t d = 0; d < reference_color.points[i].descriptor.size (); ++d)
+      ASSERT_NEAR (shots_color.points[i].descriptor[d], reference_color.points[i].descriptor[d], 1e-4);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, 3DSCEstimation)
 {
@@ -1184,6 +1408,58 @@ TEST (PCL, 3DSCEstimation)
   (cloudptr, normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, 3DSCEstimationOpenMP)
+{
+  float meshRes = 0.002;
+  float radius = 20.0 * meshRes;
+
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> ne;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  ne.setInputCloud (cloudptr);
+  ne.setSearchMethod (tree);
+  ne.setRadiusSearch (radius);
+  ne.compute (*normals);
+
+  // Both estimators start from the same seed, so they must draw the same X axes
+  ShapeContext3DEstimation<PointXYZ, Normal, SHOT> sc3d;
+  ShapeContext3DEstimationOMP<PointXYZ, Normal, SHOT> sc3d_omp (false, 4);
+  PointCloud<SHOT> sc3ds, sc3ds_omp;
+  ShapeContext3DEstimation<PointXYZ, Normal, SHOT> *estimators[2] = { &sc3d, &sc3d_omp };
+  PointCloud<SHOT> *outputs[2] = { &sc3ds, &sc3ds_omp };
+  for (int e = 0; e < 2; ++e)
+  {
+    estimators[e]->setInputCloud (cloudptr);
+    estimators[e]->setInputNormals (normals);
+    estimators[e]->setSearchMethod (tree);
+    estimators[e]->setRadiusSearch (radius);
+    estimators[e]->setAzimuthBins (4);
+    estimators[e]->setElevationBins (4);
+    estimators[e]->setRadiusBins (4);
+    estimators[e]->setMinimalRadius (radius / 10.0);
+    estimators[e]->setPointDensityRadius (radius / 5.0);
+    estimators[e]->compute (*outputs[e]);
+  }
+  EXPECT_EQ (sc3ds_omp.size (), cloud.size ());
+  EXPECT_EQ (sc3ds_omp.is_dense, sc3ds.is_dense);
+
+  EXPECT_EQ (sc3ds_omp[0].descriptor.size (), 64);
+  EXPECT_NEAR (sc3ds_omp[0].descriptor[4], 52.2474f, 1e-4f);
+  EXPECT_NEAR (sc3ds_omp[0].descriptor[6], 150.901611328125, 1e-4f);
+  EXPECT_NEAR (sc3ds_omp[2].descriptor[7], 209.97763061523438, 1e-4f);
+  EXPECT_NEAR (sc3ds_omp[2].descriptor[23], 275.63433837890625, 1e-4f);
+
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    ASSERT_EQ (sc3ds_omp[i].descriptor.size (), sc3ds[i].descriptor.size ());
+    for (size_t j = 0; j < sc3ds[i].descriptor.size (); ++j)
+      ASSERT_NEAR (sc3ds_omp[i].descriptor[j], sc3ds[i].descriptor[j], 1e-4f);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, USCEstimation)
 {
@@ -1249,6 +1525,48 @@ TEST (PCL, USCEstimation)
   (cloud.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, USCEstimationOpenMP)
+{
+  float meshRes = 0.002;
+  float radius = 20.0 * meshRes;
+
+  UniqueShapeContext<PointXYZ, SHOT> uscd;
+  UniqueShapeContextOMP<PointXYZ, SHOT> uscd_omp (4);
+  PointCloud<SHOT> uscds, uscds_omp;
+  UniqueShapeContext<PointXYZ, SHOT> *estimators[2] = { &uscd, &uscd_omp };
+  PointCloud<SHOT> *outputs[2] = { &uscds, &uscds_omp };
+  for (int e = 0; e < 2; ++e)
+  {
+    estimators[e]->setInputCloud (cloud.makeShared ());
+    estimators[e]->setSearchMethod (tree);
+    estimators[e]->setRadiusSearch (radius);
+    estimators[e]->setAzimuthBins (4);
+    estimators[e]->setElevationBins (4);
+    estimators[e]->setRadiusBins (4);
+    estimators[e]->setMinimalRadius (radius / 10.0);
+    estimators[e]->setPointDensityRadius (radius / 5.0);
+    estimators[e]->setLocalRadius (radius);
+    estimators[e]->compute (*outputs[e]);
+  }
+  EXPECT_EQ (uscds_omp.size (), cloud.size ());
+
+  EXPECT_NEAR (uscds_omp[0].rf[0], 0.9876f, 1e-4f);
+  EXPECT_NEAR (uscds_omp[0].rf[8], -0.7904f, 1e-4f);
+  EXPECT_EQ (uscds_omp[0].descriptor.size (), 64);
+  EXPECT_NEAR (uscds_omp[0].descriptor[6], 176.2354f, 1e-4f);
+  EXPECT_NEAR (uscds_omp[2].descriptor[23], 172.8134f, 1e-4f);
+
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    for (int d = 0; d < 9; ++d)
+      ASSERT_NEAR (uscds_omp[i].rf[d], uscds[i].rf[d], 1e-4f);
+    ASSERT_EQ (uscds_omp[i].descriptor.size (), uscds[i].descriptor.size ());
+    for (size_t j = 0; j < uscds[i].descriptor.size (); ++j)
+      ASSERT_NEAR (uscds_omp[i].descriptor[j], uscds[i].descriptor[j], 1e-4f);
+  }
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PFHEstimation)
@@ -1370,6 +1688,56 @@ TEST (PCL, PFHEstimation)
   (cloud.makeShared (), normals, test_indices, 125);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PFHEstimationOpenMP)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  // Serial reference
+  PFHEstimation<PointXYZ, Normal, PFHSignature125> pfh;
+  pfh.setInputNormals (normals);
+  pfh.setInputCloud (cloud.makeShared ());
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (30);
+  PointCloud<PFHSignature125> reference;
+  pfh.compute (reference);
+
+  PFHEstimationOMP<PointXYZ, Normal, PFHSignature125> pfh_omp (4); // instantiate 4 threads
+  pfh_omp.setInputNormals (normals);
+  pfh_omp.setInputCloud (cloud.makeShared ());
+  pfh_omp.setSearchMethod (tree);
+  pfh_omp.setKSearch (30);
+
+  // Without the cache, with a shared cache large enough for all the pairs, and with one that keeps evicting
+  unsigned int cache_sizes[3] = {0, 1 << 20, 8};
+  for (int c = 0; c < 3; ++c)
+  {
+    pfh_omp.setUseInternalCache (cache_sizes[c] > 0);
+    if (cache_sizes[c] > 0)
+      pfh_omp.setMaximumCacheSize (cache_sizes[c]);
+    PointCloud<PFHSignature125> output;
+    pfh_omp.compute (output);
+    ASSERT_EQ (output.points.size (), reference.points.size ());
+    for (size_t i = 0; i < output.points.size (); ++i)
+      for (int d = 0; d < 125; ++d)
+        ASSERT_NEAR (output.points[i].histogram[d], reference.points[i].histogram[d], 1e-4);
+  }
+
+  // Test results when setIndices and/or setSearchSurface are used
+  boost::shared_ptr<vector<int> > test_indices (new vector<int> (0));
+  for (size_t i = 0; i < cloud.size (); i+=3)
+    test_indices->push_back (i);
+
+  testIndicesAndSearchSurface<PFHEstimationOMP<PointXYZ, Normal, PFHSignature125>, PointXYZ, Normal, PFHSignature125>
+  (cloud.makeShared (), normals, test_indices, 125);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, FPFHEstimation)
 {
@@ -1605,6 +1973,25 @@ TEST (PCL, FPFHEstimationOpenMP)
 
   testIndicesAndSearchSurface<FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33>, PointXYZ, Normal, FPFHSignature33>
   (cloud.makeShared (), normals, test_indices, 33);
+
+  // The parallel estimation matches the serial one, with a radius search and on a subset of the points
+  FPFHEstimation<PointXYZ, Normal, FPFHSignature33> fpfh_serial;
+  fpfh_serial.setInputNormals (normals);
+  fpfh_serial.setInputCloud (cloud.makeShared ());
+  fpfh_serial.setIndices (test_indices);
+  fpfh_serial.setSearchMethod (tree);
+  fpfh_serial.setRadiusSearch (0.01);
+  PointCloud<FPFHSignature33> serial_fpfhs;
+  fpfh_serial.compute (serial_fpfhs);
+
+  fpfh.setIndices (test_indices);
+  fpfh.setKSearch (0);
+  fpfh.setRadiusSearch (0.01);
+  fpfh.compute (*fpfhs);
+  ASSERT_EQ (fpfhs->points.size (), serial_fpfhs.points.size ());
+  for (size_t i = 0; i < fpfhs->points.size (); ++i)
+    for (int d = 0; d < 33; ++d)
+      EXPECT_NEAR (fpfhs->points[i].histogram[d], serial_fpfhs.points[i].histogram[d], 1e-4);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1651,6 +2038,24 @@ TEST (PCL, PPFEstimation)
   EXPECT_NEAR (feature_cloud->points[45381].f3, 0.868716, 1e-4);
   EXPECT_NEAR (feature_cloud->points[45381].f4, 0.140129, 1e-4);
   EXPECT_NEAR (feature_cloud->points[45381].alpha_m, -1.97276, 1e-4);
+
+  // The pairs computed in parallel must be the same
+  PointCloud<PPFSignature> feature_cloud_omp;
+  ppf_estimation.setNumberOfThreads (4);
+  ppf_estimation.compute (feature_cloud_omp);
+  ASSERT_EQ (feature_cloud_omp.points.size (), feature_cloud->points.size ());
+  EXPECT_EQ (feature_cloud_omp.is_dense, feature_cloud->is_dense);
+  for (size_t i = 0; i < feature_cloud->points.size (); ++i)
+  {
+    if (pcl_isnan (feature_cloud->points[i].f1))
+    {
+      EXPECT_TRUE (pcl_isnan (feature_cloud_omp.points[i].f1));
+      continue;
+    }
+    EXPECT_EQ (feature_cloud_omp.points[i].f1, feature_cloud->points[i].f1);
+    EXPECT_EQ (feature_cloud_omp.points[i].f4, feature_cloud->points[i].f4);
+    EXPECT_EQ (feature_cloud_omp.points[i].alpha_m, feature_cloud->points[i].alpha_m);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1690,6 +2095,102 @@ TEST (PCL, VFHEstimation)
   //  std::cerr << vfhs.points[0].histogram[d] << std::endl;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, VFHEstimationClusters)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  // Split the cloud in slices along the X axis, plus a degenerate cluster
+  Eigen::Vector4f min_pt, max_pt;
+  getMinMax3D (cloud, min_pt, max_pt);
+  const int nr_slices = 4;
+  vector<PointIndices> clusters (nr_slices + 1);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    int slice = (int) floor (nr_slices * (cloud.points[i].x - min_pt[0]) / (max_pt[0] - min_pt[0] + 1e-6));
+    clusters[slice].indices.push_back ((int) i);
+  }
+  clusters[nr_slices].indices.push_back (0);
+
+  VFHEstimation<PointXYZ, Normal, VFHSignature308> vfh;
+  vfh.setInputCloud (cloud.makeShared ());
+  vfh.setInputNormals (normals);
+  vfh.setSearchMethod (tree);
+  vfh.setNumberOfThreads (4);
+  EXPECT_EQ (vfh.getNumberOfThreads (), 4);
+
+  PointCloud<VFHSignature308> vfhs;
+  vfh.computeClusters (clusters, vfhs);
+  ASSERT_EQ (vfhs.points.size (), clusters.size ());
+  EXPECT_FALSE (vfhs.is_dense);
+  for (int d = 0; d < 308; ++d)
+    EXPECT_FALSE (pcl_isfinite (vfhs.points[nr_slices].histogram[d]));
+
+  // Each signature must match the one of the cluster computed on its own
+  PointCloud<VFHSignature308> vfh_cluster;
+  for (int c = 0; c < nr_slices; ++c)
+  {
+    vfh.setIndices (boost::shared_ptr<vector<int> > (new vector<int> (clusters[c].indices)));
+    vfh.compute (vfh_cluster);
+    ASSERT_EQ (vfh_cluster.points.size (), 1);
+    for (int d = 0; d < 308; ++d)
+      EXPECT_EQ (vfhs.points[c].histogram[d], vfh_cluster.points[0].histogram[d]);
+  }
+
+  CVFHEstimation<PointXYZ, Normal, VFHSignature308> cvfh;
+  cvfh.setInputCloud (cloud.makeShared ());
+  cvfh.setInputNormals (normals);
+  cvfh.setSearchMethod (tree);
+  cvfh.setRadiusNormals (0.03f);
+  cvfh.setClusterTolerance (0.03f);
+  cvfh.setMinPoints (20);
+  cvfh.setCurvatureThreshold (1.0f);
+
+  // The whole cloud as one cluster must give the same signatures as compute ()
+  PointCloud<VFHSignature308> cvfhs;
+  cvfh.compute (cvfhs);
+  ASSERT_GT (cvfhs.points.size (), 0);
+  vector<PointIndices> whole_cloud (1);
+  whole_cloud[0].indices.resize (cloud.points.size ());
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+    whole_cloud[0].indices[i] = (int) i;
+  vector<PointCloud<VFHSignature308> > cvfhs_clusters;
+  cvfh.computeClusters (whole_cloud, cvfhs_clusters);
+  ASSERT_EQ (cvfhs_clusters.size (), 1);
+  ASSERT_EQ (cvfhs_clusters[0].points.size (), cvfhs.points.size ());
+  for (size_t i = 0; i < cvfhs.points.size (); ++i)
+    for (int d = 0; d < 308; ++d)
+      EXPECT_EQ (cvfhs_clusters[0].points[i].histogram[d], cvfhs.points[i].histogram[d]);
+
+  // The result must not depend on the number of threads
+  cvfh.computeClusters (clusters, cvfhs_clusters);
+  ASSERT_EQ (cvfhs_clusters.size (), clusters.size ());
+  EXPECT_EQ (cvfhs_clusters[nr_slices].points.size (), 0);
+  vector<Eigen::Vector3f> centroids;
+  cvfh.getCentroidClusters (centroids);
+  size_t nr_signatures = 0;
+  for (size_t c = 0; c < cvfhs_clusters.size (); ++c)
+    nr_signatures += cvfhs_clusters[c].points.size ();
+  EXPECT_EQ (centroids.size (), nr_signatures);
+
+  vector<PointCloud<VFHSignature308> > cvfhs_clusters_omp;
+  cvfh.setNumberOfThreads (4);
+  cvfh.computeClusters (clusters, cvfhs_clusters_omp);
+  ASSERT_EQ (cvfhs_clusters_omp.size (), clusters.size ());
+  for (size_t c = 0; c < clusters.size (); ++c)
+  {
+    ASSERT_EQ (cvfhs_clusters_omp[c].points.size (), cvfhs_clusters[c].points.size ());
+    for (size_t i = 0; i < cvfhs_clusters[c].points.size (); ++i)
+      for (int d = 0; d < 308; ++d)
+        EXPECT_EQ (cvfhs_clusters_omp[c].points[i].histogram[d], cvfhs_clusters[c].points[i].histogram[d]);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, RSDEstimation)
 {
@@ -2011,6 +2512,53 @@ TEST (PCL, SpinImageEstimation)
   EXPECT_NEAR (spin_images->points[300].histogram[144], 0.272542, 1e-5);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SpinImageEstimationOpenMP)
+{
+  // Estimate normals first
+  double mr = 0.002;
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (20 * mr);
+  n.compute (*normals);
+
+  typedef Histogram<153> SpinImage;
+  SpinImageEstimation<PointXYZ, Normal, SpinImage> spin_est (8, 0.5, 16);
+  SpinImageEstimationOMP<PointXYZ, Normal, SpinImage> spin_est_omp (8, 0.5, 16, 4);
+  PointCloud<SpinImage> spin_images, spin_images_omp;
+  SpinImageEstimation<PointXYZ, Normal, SpinImage> *estimators[2] = { &spin_est, &spin_est_omp };
+  PointCloud<SpinImage> *outputs[2] = { &spin_images, &spin_images_omp };
+
+  // Check the plain, radial and angular spin-images
+  for (int variant = 0; variant < 3; ++variant)
+  {
+    for (int e = 0; e < 2; ++e)
+    {
+      estimators[e]->setInputCloud (cloud.makeShared ());
+      estimators[e]->setInputNormals (normals);
+      estimators[e]->setIndices (indicesptr);
+      estimators[e]->setSearchMethod (tree);
+      estimators[e]->setRadiusSearch (40*mr);
+      estimators[e]->setRadialStructure (variant == 1);
+      estimators[e]->setAngularDomain (variant == 2);
+      estimators[e]->compute (*outputs[e]);
+    }
+    EXPECT_EQ (spin_images_omp.points.size (), indices.size ());
+
+    for (size_t i = 0; i < spin_images.points.size (); ++i)
+      for (int d = 0; d < 153; ++d)
+        ASSERT_NEAR (spin_images_omp.points[i].histogram[d], spin_images.points[i].histogram[d], 1e-5);
+  }
+
+  // A support too small for a spin-image must still be reported after the parallel loop
+  spin_est_omp.setMinPointCountInNeighbourhood (static_cast<unsigned int> (cloud.size ()) + 1);
+  EXPECT_THROW (spin_est_omp.compute (spin_images_omp), PCLException);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IntensitySpinEstimation)
 {
@@ -42,13 +42,18 @@
 #include <pcl/filters/filter.h>
 #include <pcl/filters/passthrough.h>
 #include <pcl/filters/voxel_grid.h>
+#include <pcl/filters/approximate_voxel_grid.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/project_inliers.h>
 #include <pcl/filters/radius_outlier_removal.h>
 #include <pcl/filters/statistical_outlier_removal.h>
 #include <pcl/filters/conditional_removal.h>
 #include <pcl/filters/random_sample.h>
+#include <pcl/filters/normal_space.h>
 #include <pcl/filters/crop_box.h>
+#include <pcl/filters/crop_hull.h>
+#include <pcl/filters/bilateral.h>
+#include <pcl/filters/filter_pipeline.h>
 
 #include "pcl/common/transforms.h"
 #include "pcl/common/eigen.h"
@@ -770,6 +775,69 @@ TEST (VoxelGrid_RGB, Filters)
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+compareX (const PointXYZ &p1, const PointXYZ &p2)
+{
+  return (p1.x < p2.x);
+}
+
+TEST (ApproximateVoxelGrid, Filters)
+{
+  // 256 voxels along x, which map to distinct slots of a history of 256 or more, with 20 points each in random order
+  const int nr_voxels = 256, nr_points_per_voxel = 20;
+  const float leaf = 0.01f;
+  PointCloud<PointXYZ>::Ptr line (new PointCloud<PointXYZ>);
+  srand (12345);
+  for (int v = 0; v < nr_voxels; ++v)
+    for (int j = 0; j < nr_points_per_voxel; ++j)
+      line->points.push_back (PointXYZ ((v + 0.05f + 0.9f * rand () / RAND_MAX) * leaf,
+                                        (0.05f + 0.9f * rand () / RAND_MAX) * leaf,
+                                        (0.05f + 0.9f * rand () / RAND_MAX) * leaf));
+  for (size_t i = line->points.size () - 1; i > 0; --i)
+    std::swap (line->points[i], line->points[rand () % (i + 1)]);
+  line->width = (uint32_t) line->points.size ();
+  line->height = 1;
+
+  // Exact centroids
+  std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > centroids (nr_voxels, Eigen::Vector3f::Zero ());
+  for (size_t i = 0; i < line->points.size (); ++i)
+    centroids[(int)floor (line->points[i].x / leaf)] += line->points[i].getVector3fMap () / nr_points_per_voxel;
+
+  ApproximateVoxelGrid<PointXYZ> grid;
+  grid.setLeafSize (leaf, leaf, leaf);
+  grid.setInputCloud (line);
+  grid.setHistorySize (300);
+  EXPECT_EQ ((int)grid.getHistorySize (), 512);
+
+  // Without collisions, each voxel is written out once, even if its points are split between threads
+  PointCloud<PointXYZ> output;
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads += 3)
+  {
+    grid.setNumberOfThreads (nr_threads);
+    grid.filter (output);
+    ASSERT_EQ ((int)output.points.size (), nr_voxels);
+    std::sort (output.points.begin (), output.points.end (), compareX);
+    for (int v = 0; v < nr_voxels; ++v)
+    {
+      EXPECT_NEAR (output.points[v].x, centroids[v][0], 1e-5);
+      EXPECT_NEAR (output.points[v].y, centroids[v][1], 1e-5);
+      EXPECT_NEAR (output.points[v].z, centroids[v][2], 1e-5);
+    }
+  }
+
+  // A small history causes collisions, unless its size is chosen from the collision rate
+  grid.setNumberOfThreads (1);
+  grid.setHistorySize (16);
+  grid.filter (output);
+  EXPECT_GT ((int)output.points.size (), 2 * nr_voxels);
+
+  grid.setAdaptiveHistorySize (true);
+  EXPECT_TRUE (grid.getAdaptiveHistorySize ());
+  grid.filter (output);
+  EXPECT_EQ ((int)output.points.size (), nr_voxels);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ProjectInliers, Filters)
 {
   // Test the PointCloud<PointT> method
@@ -875,6 +943,70 @@ TEST (RadiusOutlierRemoval, Filters)
   EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].z, -0.021299, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RadiusOutlierRemovalCount, Filters)
+{
+  // The counting search must agree with the full radius search, up to the requested bound
+  search::KdTree<PointXYZ> tree (false);
+  tree.setInputCloud (cloud);
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+  {
+    int k = tree.radiusSearch ((int)i, 0.02, nn_indices, nn_dists);
+    EXPECT_EQ (tree.radiusCount ((int)i, 0.02), k);
+    EXPECT_EQ (tree.radiusCount (cloud->points[i], 0.02, 15), std::min (k, 15));
+  }
+
+  // The result must not depend on the number of threads
+  PointCloud<PointXYZ> cloud_out, cloud_out_mt;
+  RadiusOutlierRemoval<PointXYZ> outrem (true);
+  outrem.setInputCloud (cloud);
+  outrem.setRadiusSearch (0.02);
+  outrem.setMinNeighborsInRadius (15);
+  outrem.filter (cloud_out);
+
+  RadiusOutlierRemoval<PointXYZ> outrem_mt (true);
+  outrem_mt.setInputCloud (cloud);
+  outrem_mt.setRadiusSearch (0.02);
+  outrem_mt.setMinNeighborsInRadius (15);
+  outrem_mt.setNumberOfThreads (4);
+  EXPECT_EQ ((int)outrem_mt.getNumberOfThreads (), 4);
+  outrem_mt.filter (cloud_out_mt);
+
+  EXPECT_EQ ((int)cloud_out_mt.points.size (), 307);
+  ASSERT_EQ (cloud_out_mt.points.size (), cloud_out.points.size ());
+  for (size_t i = 0; i < cloud_out.points.size (); ++i)
+  {
+    EXPECT_EQ (cloud_out_mt.points[i].x, cloud_out.points[i].x);
+    EXPECT_EQ (cloud_out_mt.points[i].y, cloud_out.points[i].y);
+    EXPECT_EQ (cloud_out_mt.points[i].z, cloud_out.points[i].z);
+  }
+  EXPECT_EQ (*outrem_mt.getRemovedIndices (), *outrem.getRemovedIndices ());
+
+  // Dense grid, where whole cells are accepted without a search, plus a few isolated points
+  PointCloud<PointXYZ>::Ptr grid (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 20; ++i)
+    for (int j = 0; j < 20; ++j)
+      for (int k = 0; k < 20; ++k)
+        grid->points.push_back (PointXYZ (0.001f * i, 0.001f * j, 0.001f * k));
+  grid->points.push_back (PointXYZ (1.0f, 1.0f, 1.0f));
+  grid->points.push_back (PointXYZ (-1.0f, 0.0f, 0.0f));
+  grid->points.push_back (PointXYZ (0.0f, 0.0f, std::numeric_limits<float>::quiet_NaN ()));
+  grid->width = (uint32_t)grid->points.size ();
+  grid->height = 1;
+  grid->is_dense = false;
+
+  RadiusOutlierRemoval<PointXYZ> outrem_grid;
+  outrem_grid.setInputCloud (grid);
+  outrem_grid.setRadiusSearch (0.005);
+  outrem_grid.setMinNeighborsInRadius (20);
+  outrem_grid.setNumberOfThreads (2);
+  outrem_grid.filter (cloud_out);
+  EXPECT_EQ ((int)cloud_out.points.size (), 20 * 20 * 20);
+  EXPECT_EQ ((bool)cloud_out.is_dense, true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RandomSample, Filters)
 {
@@ -938,6 +1070,120 @@ TEST (RandomSample, Filters)
     EXPECT_NEAR (cloud->points[indices2[i]].y, cloud_out.points[i].y, 1e-4);
     EXPECT_NEAR (cloud->points[indices2[i]].z, cloud_out.points[i].z, 1e-4);
   }
+
+  // Sample the cloud as a stream of chunks through the reservoir
+  sample.setSeed (42);
+  sample.initReservoir ();
+  for (size_t start = 0; start < cloud->points.size (); start += 97)
+  {
+    PointCloud<PointXYZ> chunk;
+    for (size_t i = start; i < std::min (start + 97, cloud->points.size ()); ++i)
+      chunk.points.push_back (cloud->points[i]);
+    sample.addToReservoir (chunk);
+  }
+  EXPECT_EQ (sample.getStreamSize (), cloud->points.size ());
+
+  vector<int> positions;
+  sample.getReservoirIndices (positions);
+  sample.getReservoir (cloud_out);
+  ASSERT_EQ ((int)positions.size (), 10);
+  ASSERT_EQ ((int)cloud_out.width, 10);
+  for (size_t i = 0; i < positions.size (); ++i)
+  {
+    if (i > 0)
+      EXPECT_LT (positions[i - 1], positions[i]);
+    EXPECT_LT (positions[i], (int)cloud->points.size ());
+    EXPECT_EQ (cloud->points[positions[i]].x, cloud_out.points[i].x);
+    EXPECT_EQ (cloud->points[positions[i]].y, cloud_out.points[i].y);
+    EXPECT_EQ (cloud->points[positions[i]].z, cloud_out.points[i].z);
+  }
+
+  // Every position of a stream is kept with probability sample / N
+  RandomSample<PointXYZ> stream;
+  stream.setSample (10);
+  stream.setSeed (7);
+  PointCloud<PointXYZ> chunk;
+  chunk.points.resize (50);
+  vector<int> hits (200, 0);
+  for (int trial = 0; trial < 2000; ++trial)
+  {
+    stream.setSeed (trial);
+    stream.initReservoir ();
+    for (int c = 0; c < 4; ++c)
+      stream.addToReservoir (chunk);
+    stream.getReservoirIndices (positions);
+    ASSERT_EQ ((int)positions.size (), 10);
+    for (size_t i = 0; i < positions.size (); ++i)
+      ++hits[positions[i]];
+  }
+  int first_half = 0;
+  for (int i = 0; i < 100; ++i)
+    first_half += hits[i];
+  EXPECT_NEAR (first_half / 20000.0, 0.5, 0.03);
+  EXPECT_NEAR (hits[0] / 2000.0, 0.05, 0.025);
+  EXPECT_NEAR (hits[199] / 2000.0, 0.05, 0.025);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (NormalSpaceSampling, Filters)
+{
+  // Two thirds of the points face +z and one third +x
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  for (int i = 0; i < 3000; ++i)
+  {
+    input->points.push_back (PointXYZ (float (i), 0.0f, 0.0f));
+    Normal n;
+    n.normal_x = (i % 3 == 0) ? 1.0f : 0.0f;
+    n.normal_y = 0.0f;
+    n.normal_z = (i % 3 == 0) ? 0.0f : 1.0f;
+    normals->points.push_back (n);
+  }
+  input->width = normals->width = 3000;
+  input->height = normals->height = 1;
+
+  NormalSpaceSampling<PointXYZ, Normal> normal_space;
+  normal_space.setInputCloud (input);
+  normal_space.setNormals (normals);
+  normal_space.setBins (4, 4, 4);
+  normal_space.setSeed (0);
+  normal_space.setSample (100);
+
+  // The sample is spread evenly over the two occupied bins, without repetitions
+  vector<int> indices;
+  normal_space.filter (indices);
+  ASSERT_EQ ((int)indices.size (), 100);
+  int facing_x = 0;
+  for (size_t i = 0; i < indices.size (); ++i)
+    facing_x += (indices[i] % 3 == 0);
+  EXPECT_EQ (facing_x, 50);
+  vector<int> sorted (indices);
+  std::sort (sorted.begin (), sorted.end ());
+  EXPECT_TRUE (std::unique (sorted.begin (), sorted.end ()) == sorted.end ());
+
+  // Once the +x bin runs out, the rest of the sample comes from the +z one
+  normal_space.setSample (2500);
+  normal_space.setNumberOfThreads (2);
+  normal_space.filter (indices);
+  ASSERT_EQ ((int)indices.size (), 2500);
+  facing_x = 0;
+  for (size_t i = 0; i < indices.size (); ++i)
+    facing_x += (indices[i] % 3 == 0);
+  EXPECT_EQ (facing_x, 1000);
+  sorted = indices;
+  std::sort (sorted.begin (), sorted.end ());
+  EXPECT_TRUE (std::unique (sorted.begin (), sorted.end ()) == sorted.end ());
+
+  // The result does not depend on the number of threads, and the cloud matches the indices
+  vector<int> serial;
+  normal_space.setNumberOfThreads (1);
+  normal_space.filter (serial);
+  EXPECT_EQ (serial, indices);
+  PointCloud<PointXYZ> output;
+  normal_space.filter (output);
+  ASSERT_EQ (output.points.size (), indices.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    EXPECT_EQ (output.points[i].x, input->points[indices[i]].x);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1216,6 +1462,245 @@ TEST (StatisticalOutlierRemoval, Filters)
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (StatisticalOutlierRemovalParallel, Filters)
+{
+  PointCloud<PointXYZ> output, output_mt;
+  StatisticalOutlierRemoval<PointXYZ> outrem (true);
+  outrem.setInputCloud (cloud);
+  outrem.setMeanK (50);
+  outrem.setStddevMulThresh (1.0);
+  outrem.filter (output);
+
+  // The result must not depend on the number of threads
+  StatisticalOutlierRemoval<PointXYZ> outrem_mt (true);
+  outrem_mt.setInputCloud (cloud);
+  outrem_mt.setMeanK (50);
+  outrem_mt.setStddevMulThresh (1.0);
+  outrem_mt.setNumberOfThreads (4);
+  EXPECT_EQ ((int)outrem_mt.getNumberOfThreads (), 4);
+  outrem_mt.filter (output_mt);
+
+  EXPECT_EQ ((int)output_mt.points.size (), 352);
+  ASSERT_EQ (output_mt.points.size (), output.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output_mt.points[i].x, output.points[i].x);
+    EXPECT_EQ (output_mt.points[i].y, output.points[i].y);
+    EXPECT_EQ (output_mt.points[i].z, output.points[i].z);
+  }
+  EXPECT_EQ (*outrem_mt.getRemovedIndices (), *outrem.getRemovedIndices ());
+
+  // A search object which already holds the input cloud is reused
+  search::KdTree<PointXYZ>::Ptr tree (new search::KdTree<PointXYZ> (false));
+  tree->setInputCloud (cloud);
+  outrem_mt.setSearchMethod (tree);
+  outrem_mt.filter (output_mt);
+  EXPECT_EQ (outrem_mt.getSearchMethod (), tree);
+  EXPECT_EQ ((int)output_mt.points.size (), 352);
+
+  PointCloud2 output2;
+  StatisticalOutlierRemoval<PointCloud2> outrem2;
+  outrem2.setInputCloud (cloud_blob);
+  outrem2.setMeanK (50);
+  outrem2.setStddevMulThresh (1.0);
+  outrem2.setNumberOfThreads (4);
+  outrem2.filter (output2);
+  fromROSMsg (output2, output_mt);
+  EXPECT_EQ ((int)output_mt.points.size (), 352);
+
+  // Organized cloud: a regular grid with a few points pulled away from the surface
+  PointCloud<PointXYZ>::Ptr organized (new PointCloud<PointXYZ> (40, 30));
+  for (int v = 0; v < 30; ++v)
+    for (int u = 0; u < 40; ++u)
+      organized->at (u, v) = PointXYZ (0.01f * u, 0.01f * v, 1.0f);
+  organized->at (5, 5).z = 2.0f;
+  organized->at (20, 15).z = 0.5f;
+  organized->at (35, 25).x = std::numeric_limits<float>::quiet_NaN ();
+  organized->is_dense = false;
+
+  StatisticalOutlierRemoval<PointXYZ> outrem_img (true);
+  outrem_img.setInputCloud (organized);
+  outrem_img.setMeanK (8);
+  outrem_img.setStddevMulThresh (1.0);
+  outrem_img.setUseImageNeighborhood (true);
+  outrem_img.setNumberOfThreads (2);
+  EXPECT_EQ (outrem_img.getUseImageNeighborhood (), true);
+  outrem_img.filter (output);
+
+  // Only the two points off the plane are removed, invalid points are kept as before
+  EXPECT_EQ ((int)output.points.size (), 40 * 30 - 2);
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (output.points[i].z, 1.0f);
+
+  outrem_img.setImageNeighborhoodRadius (3);
+  EXPECT_EQ (outrem_img.getImageNeighborhoodRadius (), 3);
+  outrem_img.filter (output);
+  EXPECT_EQ ((int)output.points.size (), 40 * 30 - 2);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CropHull, Filters)
+{
+  // 3D: the [-1, 1]^3 cube, each face split into 6 x 6 squares of 2 triangles
+  const int n = 6;
+  PointCloud<PointXYZ>::Ptr cube (new PointCloud<PointXYZ>);
+  std::vector<Vertices> triangles;
+  for (int axis = 0; axis < 3; ++axis)
+    for (int side = -1; side <= 1; side += 2)
+      for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+        {
+          Vertices t1, t2;
+          for (int k = 0; k < 4; ++k)
+          {
+            Eigen::Vector3f p;
+            p[axis] = (float)side;
+            p[(axis + 1) % 3] = -1.0f + 2.0f * (i + (k == 1 || k == 2)) / n;
+            p[(axis + 2) % 3] = -1.0f + 2.0f * (j + (k >= 2)) / n;
+            cube->points.push_back (PointXYZ (p[0], p[1], p[2]));
+          }
+          uint32_t first = (uint32_t)cube->points.size () - 4;
+          t1.vertices.push_back (first);
+          t1.vertices.push_back (first + 1);
+          t1.vertices.push_back (first + 2);
+          t2.vertices.push_back (first);
+          t2.vertices.push_back (first + 2);
+          t2.vertices.push_back (first + 3);
+          triangles.push_back (t1);
+          triangles.push_back (t2);
+        }
+
+  // Random points, away from the faces
+  PointCloud<PointXYZ>::Ptr points (new PointCloud<PointXYZ>);
+  srand (12345);
+  while (points->points.size () < 2000)
+  {
+    PointXYZ p (3.0f * rand () / RAND_MAX - 1.5f, 3.0f * rand () / RAND_MAX - 1.5f, 3.0f * rand () / RAND_MAX - 1.5f);
+    if (fabs (p.getVector3fMap ().cwiseAbs ().maxCoeff () - 1.0f) > 0.02f)
+      points->points.push_back (p);
+  }
+  points->width = (uint32_t)points->points.size ();
+  points->height = 1;
+
+  CropHull<PointXYZ> crop_hull;
+  crop_hull.setHullCloud (cube);
+  crop_hull.setHullIndices (triangles);
+  crop_hull.setDim (3);
+  crop_hull.setInputCloud (points);
+  crop_hull.setNumberOfThreads (4);
+
+  for (int crop_outside = 0; crop_outside < 2; ++crop_outside)
+  {
+    crop_hull.setCropOutside (crop_outside != 0);
+    std::vector<int> indices;
+    crop_hull.filter (indices);
+    std::vector<int> expected;
+    for (int i = 0; i < (int)points->points.size (); ++i)
+      if ((points->points[i].getVector3fMap ().cwiseAbs ().maxCoeff () < 1.0f) == (crop_outside != 0))
+        expected.push_back (i);
+    EXPECT_EQ (indices, expected);
+
+    PointCloud<PointXYZ> output;
+    crop_hull.filter (output);
+    EXPECT_EQ (output.points.size (), expected.size ());
+  }
+
+  // 2D: an L shape and a square in the z = 0 plane
+  PointCloud<PointXYZ>::Ptr polygon_cloud (new PointCloud<PointXYZ>);
+  const float corners[10][2] = { {0, 0}, {2, 0}, {2, 1}, {1, 1}, {1, 2}, {0, 2}, {3, 0}, {4, 0}, {4, 1}, {3, 1} };
+  for (int i = 0; i < 10; ++i)
+    polygon_cloud->points.push_back (PointXYZ (corners[i][0], corners[i][1], 0.0f));
+  std::vector<Vertices> polygons (2);
+  for (uint32_t i = 0; i < 6; ++i)
+    polygons[0].vertices.push_back (i);
+  for (uint32_t i = 6; i < 10; ++i)
+    polygons[1].vertices.push_back (i);
+
+  PointCloud<PointXYZ>::Ptr plane_points (new PointCloud<PointXYZ>);
+  while (plane_points->points.size () < 2000)
+  {
+    PointXYZ p (5.0f * rand () / RAND_MAX - 0.5f, 3.0f * rand () / RAND_MAX - 0.5f, 0.0f);
+    if (fabs (p.x - floor (p.x + 0.5f)) > 0.01f && fabs (p.y - floor (p.y + 0.5f)) > 0.01f)
+      plane_points->points.push_back (p);
+  }
+  plane_points->width = (uint32_t)plane_points->points.size ();
+  plane_points->height = 1;
+
+  crop_hull.setHullCloud (polygon_cloud);
+  crop_hull.setHullIndices (polygons);
+  crop_hull.setDim (2);
+  crop_hull.setInputCloud (plane_points);
+  for (int crop_outside = 0; crop_outside < 2; ++crop_outside)
+  {
+    crop_hull.setCropOutside (crop_outside != 0);
+    std::vector<int> indices;
+    crop_hull.filter (indices);
+    std::vector<int> expected;
+    for (int i = 0; i < (int)plane_points->points.size (); ++i)
+    {
+      const PointXYZ &p = plane_points->points[i];
+      bool in_l = (p.x > 0 && p.y > 0 && ((p.x < 2 && p.y < 1) || (p.x < 1 && p.y < 2)));
+      bool in_square = (p.x > 3 && p.x < 4 && p.y > 0 && p.y < 1);
+      if ((in_l || in_square) == (crop_outside != 0))
+        expected.push_back (i);
+    }
+    EXPECT_EQ (indices, expected);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (BilateralFilter, Filters)
+{
+  // Organized plane with unit spacing, so that distances in pixels and in meters are the same. The intensity
+  // is a step from 0 to 100 with some integer noise.
+  PointCloud<PointXYZI>::Ptr plane (new PointCloud<PointXYZI>);
+  plane->width = 40;
+  plane->height = 30;
+  plane->points.resize (plane->width * plane->height);
+  srand (12345);
+  for (int v = 0; v < (int)plane->height; ++v)
+    for (int u = 0; u < (int)plane->width; ++u)
+    {
+      PointXYZI &p = plane->points[v * plane->width + u];
+      p.x = (float)u;
+      p.y = (float)v;
+      p.z = 0;
+      p.intensity = (u < 20 ? 0.0f : 100.0f) + (float)(rand () % 11 - 5);
+    }
+
+  BilateralFilter<PointXYZI> bf;
+  bf.setInputCloud (plane);
+  bf.setHalfSize (1.3);
+  bf.setStdDev (10.0);
+  EXPECT_EQ (bf.getMethod (), BilateralFilter<PointXYZI>::EXACT);
+
+  PointCloud<PointXYZI> exact, organized, grid;
+  bf.filter (exact);
+
+  bf.setMethod (BilateralFilter<PointXYZI>::ORGANIZED_WINDOW);
+  bf.setNumberOfThreads (4);
+  bf.filter (organized);
+
+  bf.setMethod (BilateralFilter<PointXYZI>::BILATERAL_GRID);
+  bf.filter (grid);
+
+  ASSERT_EQ (exact.points.size (), plane->points.size ());
+  ASSERT_EQ (organized.points.size (), plane->points.size ());
+  ASSERT_EQ (grid.points.size (), plane->points.size ());
+  double grid_error = 0;
+  for (size_t i = 0; i < plane->points.size (); ++i)
+  {
+    // The image window holds the same neighbors as the radius search
+    EXPECT_NEAR (organized.points[i].intensity, exact.points[i].intensity, 1e-3);
+
+    // The grid approximation smooths the noise but preserves the step
+    EXPECT_NEAR (grid.points[i].intensity, (plane->points[i].x < 20 ? 0.0f : 100.0f), 5.0);
+    grid_error += fabs (grid.points[i].intensity - exact.points[i].intensity);
+  }
+  EXPECT_LT (grid_error / plane->points.size (), 2.0);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemoval, Filters)
 {
@@ -1302,6 +1787,157 @@ TEST (ConditionalRemoval, Filters)
   EXPECT_EQ ((int)num_not_nan, cloud->points.size()-condrem_.getRemovedIndices()->size());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ConditionalRemovalCompiled, Filters)
+{
+  // Random colored cloud, with a few invalid points
+  PointCloud<PointXYZRGB>::Ptr colored (new PointCloud<PointXYZRGB>);
+  colored->width = 1000;
+  colored->height = 1;
+  colored->is_dense = false;
+  colored->points.resize (colored->width);
+  srand (12345);
+  for (size_t i = 0; i < colored->points.size (); ++i)
+  {
+    PointXYZRGB &p = colored->points[i];
+    p.x = (float)rand () / RAND_MAX;
+    p.y = (float)rand () / RAND_MAX;
+    p.z = (i % 97 == 0) ? std::numeric_limits<float>::quiet_NaN () : (float)rand () / RAND_MAX;
+    uint32_t rgb = ((uint32_t)(rand () % 256) << 16) | ((uint32_t)(rand () % 256) << 8) | (uint32_t)(rand () % 256);
+    memcpy (&p.rgb, &rgb, sizeof (uint32_t));
+  }
+
+  // z < 0.8 AND x >= 0.2 AND (r > 100.5 OR h <= 10 OR s == 128) AND (empty OR)
+  ConditionOr<PointXYZRGB>::Ptr color_cond (new ConditionOr<PointXYZRGB> ());
+  color_cond->addComparison (ComparisonBase<PointXYZRGB>::ConstPtr (
+      new PackedRGBComparison<PointXYZRGB> ("r", ComparisonOps::GT, 100.5)));
+  color_cond->addComparison (ComparisonBase<PointXYZRGB>::ConstPtr (
+      new PackedHSIComparison<PointXYZRGB> ("h", ComparisonOps::LE, 10)));
+  color_cond->addComparison (ComparisonBase<PointXYZRGB>::ConstPtr (
+      new PackedHSIComparison<PointXYZRGB> ("s", ComparisonOps::EQ, 128)));
+  ConditionAnd<PointXYZRGB>::Ptr cond (new ConditionAnd<PointXYZRGB> ());
+  cond->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (
+      new FieldComparison<PointXYZRGB> ("z", ComparisonOps::LT, 0.8)));
+  cond->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (
+      new FieldComparison<PointXYZRGB> ("x", ComparisonOps::GE, 0.2)));
+  cond->addCondition (color_cond);
+  cond->addCondition (ConditionOr<PointXYZRGB>::Ptr (new ConditionOr<PointXYZRGB> ()));
+
+  // Reference: evaluate the condition tree point by point
+  std::vector<int> reference;
+  for (size_t i = 0; i < colored->points.size (); ++i)
+    if (pcl_isfinite (colored->points[i].z) && cond->evaluate (colored->points[i]))
+      reference.push_back ((int)i);
+  ASSERT_GT ((int)reference.size (), 0);
+  ASSERT_LT ((int)reference.size (), (int)colored->points.size ());
+
+  ConditionalRemoval<PointXYZRGB> condrem (cond);
+  condrem.setNumberOfThreads (4);
+  EXPECT_EQ ((int)condrem.getNumberOfThreads (), 4);
+  condrem.setInputCloud (colored);
+
+  std::vector<int> indices;
+  condrem.filter (indices);
+  EXPECT_EQ (indices, reference);
+
+  PointCloud<PointXYZRGB> output;
+  condrem.filter (output);
+  EXPECT_EQ (output.points.size (), reference.size ());
+
+  // The organized version does not check the validity of the points
+  condrem.setKeepOrganized (true);
+  condrem.filter (output);
+  ASSERT_EQ (output.points.size (), colored->points.size ());
+  for (size_t i = 0; i < colored->points.size (); ++i)
+    EXPECT_EQ (cond->evaluate (colored->points[i]), pcl_isfinite (output.points[i].x));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (FilterPipeline, Filters)
+{
+  boost::shared_ptr<PassThrough<PointXYZ> > pass (new PassThrough<PointXYZ>);
+  pass->setFilterFieldName ("z");
+  pass->setFilterLimits (0.0, 0.05);
+
+  boost::shared_ptr<CropBox<PointXYZ> > crop (new CropBox<PointXYZ>);
+  crop->setMin (Eigen::Vector4f (-0.08f, 0.05f, -1.0f, 1.0f));
+  crop->setMax (Eigen::Vector4f (0.05f, 0.2f, 1.0f, 1.0f));
+
+  ConditionAnd<PointXYZ>::Ptr range_cond (new ConditionAnd<PointXYZ> ());
+  range_cond->addComparison (FieldComparison<PointXYZ>::ConstPtr (new FieldComparison<PointXYZ> ("y",
+                                                                                                 ComparisonOps::LT,
+                                                                                                 0.15)));
+  boost::shared_ptr<ConditionalRemoval<PointXYZ> > condrem (new ConditionalRemoval<PointXYZ> (range_cond));
+
+  boost::shared_ptr<VoxelGrid<PointXYZ> > grid (new VoxelGrid<PointXYZ>);
+  grid->setLeafSize (0.01f, 0.01f, 0.01f);
+
+  // Reference: apply the filters one after another
+  PointCloud<PointXYZ>::Ptr pass_out (new PointCloud<PointXYZ>), crop_out (new PointCloud<PointXYZ>);
+  PointCloud<PointXYZ>::Ptr cond_out (new PointCloud<PointXYZ>);
+  PointCloud<PointXYZ> grid_out;
+  pass->setInputCloud (cloud);
+  pass->filter (*pass_out);
+  crop->setInputCloud (pass_out);
+  crop->filter (*crop_out);
+  condrem->setInputCloud (crop_out);
+  condrem->filter (*cond_out);
+  grid->setInputCloud (cond_out);
+  grid->filter (grid_out);
+  ASSERT_GT ((int)cond_out->points.size (), 0);
+  ASSERT_LT ((int)cond_out->points.size (), (int)pass_out->points.size ());
+
+  FilterPipeline<PointXYZ> pipeline (true);
+  pipeline.addFilter (pass);
+  pipeline.addFilter (crop);
+  pipeline.addFilter (condrem);
+  EXPECT_EQ ((int)pipeline.getNumberOfFilters (), 3);
+  pipeline.setInputCloud (cloud);
+
+  // Without a reducer, the surviving points are copied in their original order
+  PointCloud<PointXYZ> output;
+  pipeline.filter (output);
+  ASSERT_EQ (output.points.size (), cond_out->points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output.points[i].x, cond_out->points[i].x);
+    EXPECT_EQ (output.points[i].y, cond_out->points[i].y);
+    EXPECT_EQ (output.points[i].z, cond_out->points[i].z);
+  }
+  EXPECT_EQ (pipeline.getRemovedIndices ()->size () + output.points.size (), cloud->points.size ());
+
+  std::vector<int> indices;
+  pipeline.filter (indices);
+  ASSERT_EQ (indices.size (), cond_out->points.size ());
+  for (size_t i = 1; i < indices.size (); ++i)
+    EXPECT_LT (indices[i - 1], indices[i]);
+
+  // A stage that cannot be fused splits the pass, without changing the result
+  boost::shared_ptr<RandomSample<PointXYZ> > sample (new RandomSample<PointXYZ>);
+  sample->setSample ((unsigned int)cloud->points.size ());
+  FilterPipeline<PointXYZ> split;
+  split.addFilter (pass);
+  split.addFilter (sample);
+  split.addFilter (crop);
+  split.addFilter (condrem);
+  split.setInputCloud (cloud);
+  std::vector<int> split_indices;
+  split.filter (split_indices);
+  std::sort (split_indices.begin (), split_indices.end ());
+  EXPECT_EQ (split_indices, indices);
+
+  // The reducer works directly on the surviving points of the input
+  pipeline.setReducer (grid);
+  pipeline.filter (output);
+  ASSERT_EQ (output.points.size (), grid_out.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_NEAR (output.points[i].x, grid_out.points[i].x, 1e-6);
+    EXPECT_NEAR (output.points[i].y, grid_out.points[i].y, 1e-6);
+    EXPECT_NEAR (output.points[i].z, grid_out.points[i].z, 1e-6);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -490,6 +490,97 @@ TEST (PCL, IINormalEstimationSimple3DGradient)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+createWavyCloud (unsigned width, unsigned height, float phase, PointCloud<PointXYZ> &wavy)
+{
+  wavy.width = width;
+  wavy.height = height;
+  wavy.points.resize (width * height);
+  wavy.is_dense = true;
+  for (unsigned v = 0; v < height; ++v)
+    for (unsigned u = 0; u < width; ++u)
+    {
+      wavy (u, v).x = static_cast<float> (u) * 0.01f;
+      wavy (u, v).y = static_cast<float> (v) * 0.01f;
+      wavy (u, v).z = 2.0f + 0.1f * sinf (static_cast<float> (u) * 0.05f + phase) * cosf (static_cast<float> (v) * 0.03f);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+expectEqualNormals (const PointCloud<Normal> &a, const PointCloud<Normal> &b)
+{
+  ASSERT_EQ (a.points.size (), b.points.size ());
+  for (size_t i = 0; i < a.points.size (); ++i)
+  {
+    EXPECT_EQ (pcl_isfinite (a.points[i].normal_x), pcl_isfinite (b.points[i].normal_x));
+    if (!pcl_isfinite (a.points[i].normal_x) || !pcl_isfinite (b.points[i].normal_x))
+      continue;
+    EXPECT_NEAR (a.points[i].normal_x, b.points[i].normal_x, 1e-5);
+    EXPECT_NEAR (a.points[i].normal_y, b.points[i].normal_y, 1e-5);
+    EXPECT_NEAR (a.points[i].normal_z, b.points[i].normal_z, 1e-5);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationOpenMPAndFrameReuse)
+{
+  PointCloud<PointXYZ> frame1, frame2, small_frame;
+  createWavyCloud (320, 240, 0.0f, frame1);
+  createWavyCloud (320, 240, 1.0f, frame2);
+  createWavyCloud (160, 120, 2.0f, small_frame);
+
+  IntegralImageNormalEstimation<PointXYZ, Normal>::NormalEstimationMethod methods[] =
+    { ne.COVARIANCE_MATRIX, ne.AVERAGE_3D_GRADIENT, ne.AVERAGE_DEPTH_CHANGE, ne.SIMPLE_3D_GRADIENT };
+
+  for (size_t m = 0; m < sizeof (methods) / sizeof (methods[0]); ++m)
+  {
+    IntegralImageNormalEstimation<PointXYZ, Normal> serial, parallel;
+    serial.setNormalEstimationMethod (methods[m]);
+    serial.setMaxDepthChangeFactor (0.02f);
+    serial.setNormalSmoothingSize (10.0f);
+    parallel.setNormalEstimationMethod (methods[m]);
+    parallel.setMaxDepthChangeFactor (0.02f);
+    parallel.setNormalSmoothingSize (10.0f);
+    parallel.setNumberOfThreads (4);
+    EXPECT_EQ (parallel.getNumberOfThreads (), 4);
+
+    // The same frame has to give the same normals regardless of the number of threads
+    PointCloud<Normal> output_serial, output_parallel;
+    serial.setInputCloud (frame1.makeShared ());
+    serial.compute (output_serial);
+    parallel.setInputCloud (frame1.makeShared ());
+    parallel.compute (output_parallel);
+    expectEqualNormals (output_serial, output_parallel);
+
+    // Reusing the estimator on the next frame has to give the same result as a new estimator
+    IntegralImageNormalEstimation<PointXYZ, Normal> fresh;
+    fresh.setNormalEstimationMethod (methods[m]);
+    fresh.setMaxDepthChangeFactor (0.02f);
+    fresh.setNormalSmoothingSize (10.0f);
+    PointCloud<Normal> output_fresh;
+    fresh.setInputCloud (frame2.makeShared ());
+    fresh.compute (output_fresh);
+    parallel.setInputCloud (frame2.makeShared ());
+    parallel.compute (output_parallel);
+    expectEqualNormals (output_fresh, output_parallel);
+
+    // ... and so does a frame of a different size
+    IntegralImageNormalEstimation<PointXYZ, Normal> fresh_small;
+    fresh_small.setNormalEstimationMethod (methods[m]);
+    fresh_small.setMaxDepthChangeFactor (0.02f);
+    fresh_small.setNormalSmoothingSize (10.0f);
+    fresh_small.setInputCloud (small_frame.makeShared ());
+    fresh_small.compute (output_fresh);
+    parallel.setInputCloud (small_frame.makeShared ());
+    parallel.compute (output_parallel);
+    EXPECT_EQ (output_parallel.width, small_frame.width);
+    EXPECT_EQ (output_parallel.height, small_frame.height);
+    expectEqualNormals (output_fresh, output_parallel);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
 {
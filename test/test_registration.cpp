@@ -489,6 +489,147 @@ TEST (PCL, PyramidFeatureHistogram)
 
 // Suat G: disabled, since the transformation does not look correct.
 // ToDo: update transformation from the ground truth.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PPFHashMapSearch)
+{
+  PointCloud<PointXYZ>::Ptr cloud_source_ptr = cloud_source.makeShared ();
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  search::KdTree<PointXYZ>::Ptr tree (new search::KdTree<PointXYZ>);
+  NormalEstimation<PointXYZ, Normal> normal_estimation;
+  normal_estimation.setSearchMethod (tree);
+  normal_estimation.setRadiusSearch (0.05);
+  normal_estimation.setInputCloud (cloud_source_ptr);
+  normal_estimation.compute (*normals);
+
+  PPFEstimation<PointXYZ, Normal, PPFSignature> ppf_estimator;
+  PointCloud<PPFSignature>::Ptr features (new PointCloud<PPFSignature> ());
+  ppf_estimator.setInputCloud (cloud_source_ptr);
+  ppf_estimator.setInputNormals (normals);
+  ppf_estimator.setNumberOfThreads (4);
+  ppf_estimator.compute (*features);
+
+  const float angle_step = 12.0f / 180 * M_PI, distance_step = 0.01f;
+  PPFHashMapSearch hash_map_search (angle_step, distance_step);
+  hash_map_search.setInputFeatureCloud (features);
+
+  const size_t n = cloud_source.points.size ();
+  float max_dist = -1.0f;
+  for (size_t p = 0; p < features->points.size (); ++p)
+    if (features->points[p].f4 > max_dist)
+      max_dist = features->points[p].f4;
+  EXPECT_EQ (hash_map_search.getModelDiameter (), max_dist);
+  EXPECT_GT (hash_map_search.getNumberOfBins (), 0);
+
+  // A feature must find exactly the pairs whose features fall in the same bin
+  vector<pair<size_t, size_t> > found, expected;
+  for (size_t q = 1; q < features->points.size (); q += 997)
+  {
+    PPFSignature f = features->points[q];
+    if (!pcl_isfinite (f.f1))
+      continue;
+    hash_map_search.nearestNeighborSearch (f.f1, f.f2, f.f3, f.f4, found);
+
+    expected.clear ();
+    for (size_t p = 0; p < features->points.size (); ++p)
+    {
+      const PPFSignature &g = features->points[p];
+      if (pcl_isfinite (g.f1) &&
+          floor (g.f1 / angle_step) == floor (f.f1 / angle_step) &&
+          floor (g.f2 / angle_step) == floor (f.f2 / angle_step) &&
+          floor (g.f3 / angle_step) == floor (f.f3 / angle_step) &&
+          floor (g.f4 / distance_step) == floor (f.f4 / distance_step))
+        expected.push_back (make_pair (p / n, p % n));
+    }
+    sort (found.begin (), found.end ());
+    ASSERT_EQ (found.size (), expected.size ());
+    EXPECT_TRUE (found == expected);
+  }
+
+  // A saved hash map must be loaded back unchanged
+  const std::string file_name = "test_ppf_hash_map.bin";
+  ASSERT_TRUE (hash_map_search.saveHashMap (file_name));
+  PPFHashMapSearch loaded_search;
+  ASSERT_TRUE (loaded_search.loadHashMap (file_name));
+  remove (file_name.c_str ());
+
+  EXPECT_EQ (loaded_search.getAngleDiscretizationStep (), angle_step);
+  EXPECT_EQ (loaded_search.getDistanceDiscretizationStep (), distance_step);
+  EXPECT_EQ (loaded_search.getModelDiameter (), max_dist);
+  EXPECT_EQ (loaded_search.getNumberOfBins (), hash_map_search.getNumberOfBins ());
+  // The alpha_m angles of the pairs of a point with itself are NaN, so compare the bits
+  ASSERT_EQ (loaded_search.alpha_m_.size (), n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    ASSERT_EQ (loaded_search.alpha_m_[i].size (), n);
+    EXPECT_EQ (memcmp (&loaded_search.alpha_m_[i][0], &hash_map_search.alpha_m_[i][0], n * sizeof (float)), 0);
+  }
+  for (size_t q = 1; q < features->points.size (); q += 997)
+  {
+    PPFSignature f = features->points[q];
+    hash_map_search.nearestNeighborSearch (f.f1, f.f2, f.f3, f.f4, expected);
+    loaded_search.nearestNeighborSearch (f.f1, f.f2, f.f3, f.f4, found);
+    EXPECT_TRUE (found == expected);
+  }
+
+  EXPECT_FALSE (loaded_search.loadHashMap ("this_file_does_not_exist.bin"));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PPFRegistrationOpenMP)
+{
+  PointCloud<PointXYZ>::Ptr cloud_source_ptr = cloud_source.makeShared ();
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  search::KdTree<PointXYZ>::Ptr tree (new search::KdTree<PointXYZ>);
+  NormalEstimation<PointXYZ, Normal> normal_estimation;
+  normal_estimation.setSearchMethod (tree);
+  normal_estimation.setRadiusSearch (0.05);
+  normal_estimation.setInputCloud (cloud_source_ptr);
+  normal_estimation.compute (*normals);
+
+  PointCloud<PointNormal>::Ptr cloud_with_normals (new PointCloud<PointNormal> ());
+  concatenateFields (cloud_source, *normals, *cloud_with_normals);
+
+  PPFEstimation<PointNormal, PointNormal, PPFSignature> ppf_estimator;
+  PointCloud<PPFSignature>::Ptr features (new PointCloud<PPFSignature> ());
+  ppf_estimator.setInputCloud (cloud_with_normals);
+  ppf_estimator.setInputNormals (cloud_with_normals);
+  ppf_estimator.setNumberOfThreads (4);
+  ppf_estimator.compute (*features);
+
+  PPFHashMapSearch::Ptr hash_map_search (new PPFHashMapSearch (12.0f / 180 * M_PI, 0.01f));
+  hash_map_search->setInputFeatureCloud (features);
+
+  // The model is registered to itself, so the result must not depend on the number of threads
+  PPFRegistration<PointNormal, PointNormal> ppf_registration;
+  ppf_registration.setSceneReferencePointSamplingRate (10);
+  ppf_registration.setPositionClusteringThreshold (0.01f);
+  ppf_registration.setRotationClusteringThreshold (30.0f / 180 * M_PI);
+  ppf_registration.setSearchMethod (hash_map_search);
+  ppf_registration.setInputCloud (cloud_with_normals);
+  ppf_registration.setInputTarget (cloud_with_normals);
+
+  PointCloud<PointNormal> output;
+  ppf_registration.align (output);
+  EXPECT_TRUE (ppf_registration.hasConverged ());
+  EXPECT_EQ (output.points.size (), cloud_with_normals->points.size ());
+  Eigen::Matrix4f transformation = ppf_registration.getFinalTransformation ();
+
+  ppf_registration.setNumberOfThreads (4);
+  EXPECT_EQ (ppf_registration.getNumberOfThreads (), 4);
+  ppf_registration.align (output);
+  EXPECT_TRUE (ppf_registration.hasConverged ());
+  Eigen::Matrix4f transformation_omp = ppf_registration.getFinalTransformation ();
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_EQ (transformation (i, j), transformation_omp (i, j));
+
+  // A search method trained on another cloud is rejected
+  PPFHashMapSearch::Ptr empty_search (new PPFHashMapSearch ());
+  ppf_registration.setSearchMethod (empty_search);
+  ppf_registration.align (output);
+  EXPECT_FALSE (ppf_registration.hasConverged ());
+}
+
 #if 0
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PPFRegistration)
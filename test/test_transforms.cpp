@@ -202,6 +202,71 @@ TEST (PCL, Transform)
   EXPECT_EQ (1, points2[3].z);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TransformBlocks)
+{
+  // More points than a single block, not a multiple of the block size, with NaNs and Infs
+  PointCloud<PointNormal> input;
+  input.width    = 1001;
+  input.height   = 1;
+  input.is_dense = false;
+  input.points.resize (input.width);
+  for (size_t i = 0; i < input.points.size (); ++i)
+  {
+    PointNormal &p = input.points[i];
+    p.x = 0.01f * i; p.y = -0.02f * i; p.z = 1.0f + 0.03f * i;
+    p.normal_x = 0.0f; p.normal_y = 0.0f; p.normal_z = 1.0f;
+    p.curvature = float (i);
+    if (i % 7 == 3)
+      p.y = std::numeric_limits<float>::quiet_NaN ();
+    if (i % 13 == 5)
+      p.z = std::numeric_limits<float>::infinity ();
+  }
+
+  Eigen::Affine3f transform;
+  transform = Eigen::Translation3f (1.0f, 2.0f, 3.0f) * Eigen::AngleAxisf (PI / 3, Eigen::Vector3f (1, 1, 0).normalized ());
+
+  PointCloud<PointNormal> output, in_place (input), indexed;
+  transformPointCloudWithNormals (input, output, transform);
+  transformPointCloudWithNormals (in_place, in_place, transform);
+
+  std::vector<int> indices;
+  for (int i = static_cast<int> (input.points.size ()) - 1; i >= 0; i -= 3)
+    indices.push_back (i);
+  transformPointCloud (input, indices, indexed, transform);
+
+  ASSERT_EQ (output.points.size (), input.points.size ());
+  ASSERT_EQ (indexed.points.size (), indices.size ());
+  for (size_t i = 0; i < input.points.size (); ++i)
+  {
+    const PointNormal &p = input.points[i];
+    if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z))
+    {
+      // Non-finite points are left untouched
+      EXPECT_EQ (output.points[i].x, p.x);
+      EXPECT_EQ (output.points[i].normal_z, p.normal_z);
+      EXPECT_EQ (in_place.points[i].normal_z, p.normal_z);
+      continue;
+    }
+    Eigen::Vector3f xyz = transform * p.getVector3fMap ();
+    Eigen::Vector3f normal = transform.rotation () * p.getNormalVector3fMap ();
+    for (int d = 0; d < 3; ++d)
+    {
+      EXPECT_NEAR (output.points[i].getVector3fMap ()[d], xyz[d], 1e-4);
+      EXPECT_NEAR (output.points[i].getNormalVector3fMap ()[d], normal[d], 1e-4);
+      EXPECT_EQ (in_place.points[i].getVector3fMap ()[d], output.points[i].getVector3fMap ()[d]);
+      EXPECT_EQ (in_place.points[i].getNormalVector3fMap ()[d], output.points[i].getNormalVector3fMap ()[d]);
+    }
+    EXPECT_EQ (output.points[i].curvature, p.curvature);
+  }
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    EXPECT_EQ (indexed.points[i].x, output.points[indices[i]].x);
+    EXPECT_EQ (indexed.points[i].z, output.points[indices[i]].z);
+    EXPECT_EQ (indexed.points[i].curvature, input.points[indices[i]].curvature);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, commonTransform)
 {
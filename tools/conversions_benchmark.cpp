@@ -0,0 +1,142 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <pcl/point_types.h>
+#include <pcl/ros/conversions.h>
+#include <pcl/common/time.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+
+using namespace pcl;
+using namespace pcl::console;
+
+int default_points = 307200;
+int default_iterations = 100;
+
+void
+printHelp (int argc, char **argv)
+{
+  print_error ("Syntax is: %s <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -points X     = number of points per message (default: ");
+  print_value ("%d", default_points); print_info (")\n");
+  print_info ("                     -iterations X = number of conversions per point type (default: ");
+  print_value ("%d", default_iterations); print_info (")\n");
+}
+
+/** \brief Convert the same message into PointT, once recreating the field mapping for every message as 
+  * before and once with the mappings cached per field layout.
+  */
+template <typename PointT> void
+benchmark (const char *name, const sensor_msgs::PointCloud2 &msg, int iterations)
+{
+  PointCloud<PointT> cloud;
+
+  double start = getTime ();
+  for (int i = 0; i < iterations; ++i)
+  {
+    MsgFieldMap field_map;
+    createMapping<PointT> (msg.fields, field_map);
+    fromROSMsg (msg, cloud, field_map);
+  }
+  double middle = getTime ();
+  for (int i = 0; i < iterations; ++i)
+    fromROSMsg (msg, cloud);
+  double end = getTime ();
+
+  print_info ("%-18s: ", name);
+  print_value ("%8.3f", (middle - start) * 1000.0 / iterations); print_info (" ms per message uncached, ");
+  print_value ("%8.3f", (end - middle) * 1000.0 / iterations); print_info (" ms cached\n");
+}
+
+/** \brief Benchmark the conversions of a message holding PointInT into the common point types. */
+template <typename PointInT> void
+benchmarkMessage (const char *name, int nr_points, int iterations)
+{
+  PointCloud<PointInT> input;
+  input.width  = nr_points;
+  input.height = 1;
+  input.points.resize (nr_points);
+  for (int i = 0; i < nr_points; ++i)
+  {
+    input.points[i].x = static_cast<float> (i);
+    input.points[i].y = static_cast<float> (2 * i);
+    input.points[i].z = static_cast<float> (3 * i);
+  }
+
+  sensor_msgs::PointCloud2 msg;
+  toROSMsg (input, msg);
+
+  print_info ("Messages of "); print_value ("%s", name); print_info (" (point step ");
+  print_value ("%d", msg.point_step); print_info (")\n");
+  benchmark<PointXYZ> ("PointXYZ", msg, iterations);
+  benchmark<PointInT> (name, msg, iterations);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Benchmark the conversion of sensor_msgs::PointCloud2 messages into point clouds. For more information, use: %s -h\n", argv[0]);
+
+  if (find_switch (argc, argv, "-h"))
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  int nr_points = default_points;
+  int iterations = default_iterations;
+  parse_argument (argc, argv, "-points", nr_points);
+  parse_argument (argc, argv, "-iterations", iterations);
+  if (nr_points < 1 || iterations < 1)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  benchmarkMessage<PointXYZ> ("PointXYZ", nr_points, iterations);
+  benchmarkMessage<PointXYZRGBA> ("PointXYZRGBA", nr_points, iterations);
+  benchmarkMessage<PointXYZI> ("PointXYZI", nr_points, iterations);
+  benchmarkMessage<PointNormal> ("PointNormal", nr_points, iterations);
+  benchmarkMessage<PointXYZRGBNormal> ("PointXYZRGBNormal", nr_points, iterations);
+
+  return (0);
+}
+/* ]--- */